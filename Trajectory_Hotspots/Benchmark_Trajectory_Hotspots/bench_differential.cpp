@@ -0,0 +1,321 @@
+#include "../Trajectory_Hotspots/pch.h"
+#include "../Trajectory_Hotspots/vec2.h"
+#include "../Trajectory_Hotspots/trajectory.h"
+#include "../Trajectory_Hotspots/trajectory_generator.h"
+#include "../Trajectory_Hotspots/trajectory_reference.h"
+
+#include "benchmark.h"
+#include "bench_differential.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    const Trajectory_Shape all_shapes[] = { Trajectory_Shape::random_walk, Trajectory_Shape::levy_flight, Trajectory_Shape::vehicle, Trajectory_Shape::degenerate };
+    const Hotspot_Query all_queries[] = { Hotspot_Query::fixed_radius, Hotspot_Query::fixed_length, Hotspot_Query::fixed_radius_contiguous, Hotspot_Query::fixed_length_contiguous };
+
+    //A trial of the default options that is worse than the reference because of the known issue of its query
+    struct Known_Failure
+    {
+        Trajectory_Shape shape;
+        Hotspot_Query query;
+        size_t vertex_count;
+        unsigned int trajectory_seed;
+        float parameter;
+    };
+
+    //Only these trials are masked, any other worse result fails, also on a query with a known issue
+    //Remove the trials that a fix of the issue makes pass, as printed by the KNOWN lines
+    const Known_Failure pinned_known_failures[] =
+    {
+        { Trajectory_Shape::random_walk, Hotspot_Query::fixed_radius_contiguous, 101, 4259238847u, 3.98116922f },
+        { Trajectory_Shape::random_walk, Hotspot_Query::fixed_radius_contiguous, 89, 2633579470u, 2.85577869f },
+        { Trajectory_Shape::random_walk, Hotspot_Query::fixed_radius_contiguous, 295, 2147032987u, 6.93226242f },
+        { Trajectory_Shape::random_walk, Hotspot_Query::fixed_radius_contiguous, 187, 790405530u, 3.24603105f },
+        { Trajectory_Shape::random_walk, Hotspot_Query::fixed_radius_contiguous, 197, 2873857168u, 3.62784767f },
+        { Trajectory_Shape::random_walk, Hotspot_Query::fixed_radius_contiguous, 192, 3283104724u, 3.37989163f },
+        { Trajectory_Shape::random_walk, Hotspot_Query::fixed_radius_contiguous, 495, 1184674011u, 6.68681431f },
+        { Trajectory_Shape::random_walk, Hotspot_Query::fixed_radius_contiguous, 186, 81750048u, 1.08139098f },
+        { Trajectory_Shape::random_walk, Hotspot_Query::fixed_radius_contiguous, 138, 4132699897u, 3.94855309f },
+        { Trajectory_Shape::random_walk, Hotspot_Query::fixed_radius_contiguous, 387, 3220208971u, 2.93898392f },
+        { Trajectory_Shape::levy_flight, Hotspot_Query::fixed_radius_contiguous, 497, 703079790u, 11.5349474f },
+        { Trajectory_Shape::levy_flight, Hotspot_Query::fixed_radius_contiguous, 73, 2736740470u, 8.38265514f },
+        { Trajectory_Shape::levy_flight, Hotspot_Query::fixed_radius_contiguous, 158, 1014492988u, 15.771142f },
+        { Trajectory_Shape::levy_flight, Hotspot_Query::fixed_radius_contiguous, 287, 3303372578u, 21.9850407f },
+        { Trajectory_Shape::levy_flight, Hotspot_Query::fixed_radius_contiguous, 145, 506493985u, 35.2327805f },
+        { Trajectory_Shape::levy_flight, Hotspot_Query::fixed_radius_contiguous, 409, 1434551790u, 41.3462715f },
+        { Trajectory_Shape::levy_flight, Hotspot_Query::fixed_radius_contiguous, 36, 2106945937u, 1.66287696f },
+        { Trajectory_Shape::levy_flight, Hotspot_Query::fixed_radius_contiguous, 290, 2026541128u, 1.72007394f },
+        { Trajectory_Shape::levy_flight, Hotspot_Query::fixed_radius_contiguous, 375, 1545124230u, 2.35340285f },
+        { Trajectory_Shape::levy_flight, Hotspot_Query::fixed_radius_contiguous, 23, 1810820195u, 1.26659799f },
+        { Trajectory_Shape::levy_flight, Hotspot_Query::fixed_radius_contiguous, 397, 166918142u, 28.1658077f },
+        { Trajectory_Shape::levy_flight, Hotspot_Query::fixed_radius_contiguous, 45, 3715714557u, 9.49059391f },
+        { Trajectory_Shape::levy_flight, Hotspot_Query::fixed_radius_contiguous, 289, 1704682257u, 20.9359932f },
+        { Trajectory_Shape::levy_flight, Hotspot_Query::fixed_length_contiguous, 45, 2562965136u, 7.03786755f },
+        { Trajectory_Shape::levy_flight, Hotspot_Query::fixed_length_contiguous, 384, 717403679u, 122.360344f },
+        { Trajectory_Shape::levy_flight, Hotspot_Query::fixed_length_contiguous, 350, 2423876831u, 191.916199f },
+        { Trajectory_Shape::vehicle, Hotspot_Query::fixed_radius_contiguous, 404, 4042646295u, 33.382122f },
+        { Trajectory_Shape::vehicle, Hotspot_Query::fixed_radius_contiguous, 429, 4076235762u, 99.478569f },
+        { Trajectory_Shape::vehicle, Hotspot_Query::fixed_radius_contiguous, 234, 996507071u, 74.3928375f },
+        { Trajectory_Shape::vehicle, Hotspot_Query::fixed_radius_contiguous, 390, 3755004777u, 90.2204361f },
+        { Trajectory_Shape::vehicle, Hotspot_Query::fixed_length_contiguous, 298, 438606753u, 26.0529022f },
+        { Trajectory_Shape::vehicle, Hotspot_Query::fixed_length_contiguous, 471, 1024502566u, 243.285904f },
+        { Trajectory_Shape::degenerate, Hotspot_Query::fixed_radius_contiguous, 353, 1232816260u, 4.68285084f },
+        { Trajectory_Shape::degenerate, Hotspot_Query::fixed_radius_contiguous, 268, 394825142u, 14.2863979f },
+        { Trajectory_Shape::degenerate, Hotspot_Query::fixed_radius_contiguous, 272, 1911648401u, 8.95708752f },
+        { Trajectory_Shape::degenerate, Hotspot_Query::fixed_radius_contiguous, 283, 2046817427u, 4.92354774f },
+        { Trajectory_Shape::degenerate, Hotspot_Query::fixed_radius_contiguous, 426, 797313039u, 8.08346081f },
+        { Trajectory_Shape::degenerate, Hotspot_Query::fixed_radius_contiguous, 66, 544662562u, 1.25634265f },
+        { Trajectory_Shape::degenerate, Hotspot_Query::fixed_radius_contiguous, 160, 1939742605u, 2.16174865f },
+        { Trajectory_Shape::degenerate, Hotspot_Query::fixed_radius_contiguous, 360, 3043223221u, 4.58594418f },
+        { Trajectory_Shape::degenerate, Hotspot_Query::fixed_radius_contiguous, 308, 3979424406u, 13.1060591f },
+        { Trajectory_Shape::degenerate, Hotspot_Query::fixed_length_contiguous, 430, 1901463477u, 31.8674622f },
+    };
+
+    bool is_known_failure(const Trajectory_Shape shape, const Hotspot_Query query, const size_t vertex_count, const unsigned int trajectory_seed, const float parameter)
+    {
+        return std::any_of(std::begin(pinned_known_failures), std::end(pinned_known_failures), [&](const Known_Failure& known_failure)
+            {
+                return known_failure.shape == shape && known_failure.query == query && known_failure.vertex_count == vertex_count
+                    && known_failure.trajectory_seed == trajectory_seed && known_failure.parameter == parameter;
+            });
+    }
+
+    struct Options
+    {
+        std::vector<Trajectory_Shape> shapes;
+        std::vector<Hotspot_Query> queries;
+
+        size_t trials = 20;
+        size_t min_vertices = 10;
+        size_t max_vertices = 500;
+
+        //Grid samples per segment of the reference, more is slower but closer to the optimum
+        size_t samples = 4;
+
+        //Relative tolerance of the comparisons, absolute for values below 1
+        double tolerance = 1e-4;
+
+        //Queries on small trajectories are repeated for at least this long to time them
+        double min_time = 0.01;
+
+        unsigned int seed = 1;
+
+        //Count the known failures as failures too
+        bool strict = false;
+    };
+
+    void print_usage()
+    {
+        std::fprintf(stderr,
+            "Usage: Benchmark_Trajectory_Hotspots differential [options]\n"
+            "  --shapes=<list>          random_walk,levy_flight,vehicle,degenerate, all by default\n"
+            "  --queries=<list>         fixed_radius,fixed_length,fixed_radius_contiguous,fixed_length_contiguous, all by default\n"
+            "  --trials=<n>             Random trajectories per shape and query, 20 by default\n"
+            "  --min-vertices=<n>       Smallest trajectory, 10 by default\n"
+            "  --max-vertices=<n>       Largest trajectory, 500 by default\n"
+            "  --samples=<n>            Grid samples per segment of the reference, 4 by default\n"
+            "  --tolerance=<t>          Relative tolerance of the comparisons, 1e-4 by default\n"
+            "  --seed=<n>               Seed of the trials, 1 by default\n"
+            "  --strict                 Also fail on the known failures\n"
+            "The radius or length of each trial is a random fraction of the size of the trajectory\n"
+            "A valid hotspot that is worse than the reference is a known failure only for the pinned trials of the known issues, see the README\n");
+    }
+
+    bool parse_options(int argc, char* argv[], Options& options)
+    {
+        options.shapes.assign(std::begin(all_shapes), std::end(all_shapes));
+        options.queries.assign(std::begin(all_queries), std::end(all_queries));
+
+        //argv[1] is the differential command
+        for (int i = 2; i < argc; i++)
+        {
+            const char* argument = argv[i];
+
+            if (std::strcmp(argument, "--strict") == 0)
+            {
+                options.strict = true;
+                continue;
+            }
+
+            const char* value = std::strchr(argument, '=');
+
+            if (value == nullptr)
+            {
+                return false;
+            }
+
+            const std::string name(argument, value - argument);
+            value++;
+
+            if (name == "--shapes")
+            {
+                if (!Benchmark::parse_list(value, options.shapes, parse_trajectory_shape)) return false;
+            }
+            else if (name == "--queries")
+            {
+                if (!Benchmark::parse_list(value, options.queries, parse_hotspot_query)) return false;
+            }
+            else if (name == "--trials") options.trials = std::strtoull(value, nullptr, 10);
+            else if (name == "--min-vertices") options.min_vertices = std::strtoull(value, nullptr, 10);
+            else if (name == "--max-vertices") options.max_vertices = std::strtoull(value, nullptr, 10);
+            else if (name == "--samples") options.samples = std::strtoull(value, nullptr, 10);
+            else if (name == "--tolerance") options.tolerance = std::atof(value);
+            else if (name == "--seed") options.seed = static_cast<unsigned int>(std::strtoul(value, nullptr, 10));
+            else
+            {
+                return false;
+            }
+        }
+
+        return options.min_vertices >= 2 && options.max_vertices >= options.min_vertices && options.samples > 0;
+    }
+
+    //Seconds per call, the average over repeated calls until min_time has passed
+    template<typename Query>
+    double time_calls(Query query, const double min_time, AABB& result)
+    {
+        size_t calls = 0;
+        const auto start = std::chrono::steady_clock::now();
+        double elapsed = 0.0;
+
+        do
+        {
+            result = query();
+            Benchmark::do_not_optimize(result);
+            calls++;
+
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } while (elapsed < min_time);
+
+        return elapsed / static_cast<double>(calls);
+    }
+
+    //A random radius or length between 5% and 50% of the size of the trajectory, so the hotspots are neither trivial nor everything
+    float get_random_parameter(const Trajectory& trajectory, const Hotspot_Query query, std::mt19937& generator)
+    {
+        const std::vector<Segment>& segments = trajectory.get_ordered_trajectory_segments();
+        const float fraction = 0.05f + 0.45f * static_cast<float>(generator() >> 8) * (1.f / 16777216.f);
+
+        if (hotspot_query_uses_timestamps(query))
+        {
+            AABB bounding_box = segments.front().get_AABB();
+            for (const Segment& segment : segments)
+            {
+                bounding_box.combine(segment.get_AABB());
+            }
+
+            return std::max(bounding_box.max_size().get_value() * fraction, 0.001f);
+        }
+
+        return std::max((segments.back().end_t - segments.front().start_t).get_value() * fraction, 0.001f);
+    }
+
+    void print_time(const double seconds)
+    {
+        if (seconds < 1e-3) std::printf(" %9.1fus", seconds * 1e6);
+        else if (seconds < 1.0) std::printf(" %9.1fms", seconds * 1e3);
+        else std::printf(" %10.2fs", seconds);
+    }
+}
+
+int run_differential_benchmark(int argc, char* argv[])
+{
+    Options options;
+
+    if (!parse_options(argc, argv, options))
+    {
+        print_usage();
+        return 1;
+    }
+
+    std::printf("%-12s %-24s %7s %9s %6s %11s %11s %9s\n", "shape", "query", "trials", "failures", "known", "query", "reference", "speedup");
+
+    size_t total_failures = 0;
+    std::vector<Hotspot_Query> known_failure_queries;
+
+    for (const Trajectory_Shape shape : options.shapes)
+    {
+        for (const Hotspot_Query query : options.queries)
+        {
+            if (!hotspot_query_implemented(query))
+            {
+                std::printf("%-12s %-24s not implemented\n", trajectory_shape_name(shape), hotspot_query_name(query));
+                continue;
+            }
+
+            std::mt19937 generator(options.seed * 1000003u + static_cast<unsigned int>(shape) * 1009u + static_cast<unsigned int>(query));
+
+            size_t failures = 0;
+            size_t known_failures = 0;
+            double query_seconds = 0.0;
+            double reference_seconds = 0.0;
+            double log_speedup = 0.0;
+
+            for (size_t trial = 0; trial < options.trials; trial++)
+            {
+                const size_t vertex_count = options.min_vertices + generator() % (options.max_vertices - options.min_vertices + 1);
+                const unsigned int trajectory_seed = generator();
+
+                const Trajectory trajectory = generate_trajectory(shape, vertex_count, trajectory_seed).build_trajectory(hotspot_query_uses_timestamps(query));
+                const float parameter = get_random_parameter(trajectory, query, generator);
+
+                AABB hotspot;
+                AABB reference_hotspot;
+
+                const double trial_query_seconds = time_calls([&]() { return run_hotspot_query(trajectory, query, parameter); }, options.min_time, hotspot);
+                const double trial_reference_seconds = time_calls([&]() { return run_reference_hotspot_query(trajectory, query, parameter, options.samples); }, 0.0, reference_hotspot);
+
+                query_seconds += trial_query_seconds;
+                reference_seconds += trial_reference_seconds;
+                log_speedup += log(trial_reference_seconds / trial_query_seconds);
+
+                std::string error;
+                if (!check_hotspot(trajectory, query, parameter, hotspot, reference_hotspot, options.tolerance, error))
+                {
+                    //A valid hotspot that is only worse than the reference is expected for the pinned trials of the known issues
+                    std::string validity_error;
+                    const bool known = !options.strict && hotspot_query_known_issue(query) != nullptr && is_known_failure(shape, query, vertex_count, trajectory_seed, parameter)
+                        && check_hotspot_valid(trajectory, query, parameter, hotspot, options.tolerance, validity_error);
+
+                    //Enough to reproduce the trial with generate_trajectory
+                    std::fprintf(stderr, "%s %s vertices=%zu seed=%u parameter=%.9g %s\n", known ? "KNOWN" : "FAIL", trajectory_shape_name(shape), vertex_count, trajectory_seed, parameter, error.c_str());
+
+                    if (known)
+                    {
+                        known_failures++;
+                    }
+                    else
+                    {
+                        failures++;
+                    }
+                }
+            }
+
+            total_failures += failures;
+
+            if (known_failures > 0 && std::find(known_failure_queries.begin(), known_failure_queries.end(), query) == known_failure_queries.end())
+            {
+                known_failure_queries.push_back(query);
+            }
+
+            const double trials = static_cast<double>(std::max<size_t>(options.trials, 1));
+
+            std::printf("%-12s %-24s %7zu %9zu %6zu", trajectory_shape_name(shape), hotspot_query_name(query), options.trials, failures, known_failures);
+            print_time(query_seconds / trials);
+            print_time(reference_seconds / trials);
+            std::printf(" %8.1fx\n", exp(log_speedup / trials));
+            std::fflush(stdout);
+        }
+    }
+
+    for (const Hotspot_Query query : known_failure_queries)
+    {
+        std::printf("Known issue of %s: %s\n", hotspot_query_name(query), hotspot_query_known_issue(query));
+    }
+
+    return total_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+//Differential test of the hotspot queries against the slow reference implementations on random synthetic trajectories
+//Every trial generates a trajectory of a random size and a random radius or length, runs the query and its reference,
+//checks that the answer is at least as good as the reference and records the speedup of the query over the reference
+//
+//  Benchmark_Trajectory_Hotspots differential [--shapes=random_walk,vehicle] [--trials=100] [--max-vertices=500]
+//
+//Returns the exit code of the program, 1 if any query gave a worse answer than the reference outside the pinned known failures
+int run_differential_benchmark(int argc, char* argv[]);
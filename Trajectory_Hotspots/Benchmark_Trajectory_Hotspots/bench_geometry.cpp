@@ -0,0 +1,426 @@
+#include "../Trajectory_Hotspots/pch.h"
+#include "../Trajectory_Hotspots/vec2.h"
+#include "../Trajectory_Hotspots/trajectory.h"
+#include "../Trajectory_Hotspots/trajectory_batch.h"
+
+#include "benchmark.h"
+
+//Microbenchmarks of the geometry kernels that the hotspot algorithms spend their time in
+//The argument is the input size, operations are spread over the input so the caches see realistic access patterns
+
+namespace
+{
+    //Vertices of a random walk, the same input for every run with the same count
+    std::vector<Vec2> make_random_walk(const size_t vertex_count, const unsigned int seed = 1)
+    {
+        std::mt19937 generator(seed);
+        std::uniform_real_distribution<float> step(-1.f, 1.f);
+
+        std::vector<Vec2> vertices;
+        vertices.reserve(vertex_count);
+
+        Vec2 position(0.f, 0.f);
+        for (size_t i = 0; i < vertex_count; i++)
+        {
+            vertices.push_back(position);
+            position = position + Vec2(step(generator), step(generator));
+        }
+
+        return vertices;
+    }
+
+    //Segments of a random walk with the length along the trajectory as time, like Trajectory(const std::vector<Vec2>&)
+    std::vector<Segment> make_segments(const size_t segment_count, const unsigned int seed = 1)
+    {
+        const std::vector<Vec2> vertices = make_random_walk(segment_count + 1, seed);
+
+        std::vector<Segment> segments;
+        segments.reserve(segment_count);
+
+        Float start_t = 0.f;
+        for (size_t i = 0; i < segment_count; i++)
+        {
+            segments.emplace_back(vertices[i], vertices[i + 1], start_t);
+            start_t = segments.back().end_t;
+        }
+
+        return segments;
+    }
+
+    //The (t, x) projection of the segments, as built by the fixed radius contiguous query
+    std::vector<Segment> make_projected_segments(const std::vector<Segment>& segments)
+    {
+        std::vector<Segment> projected_segments;
+        projected_segments.reserve(segments.size());
+
+        for (const Segment& segment : segments)
+        {
+            projected_segments.emplace_back(Vec2(segment.start_t, segment.start.x), Vec2(segment.end_t, segment.end.x), segment.start_t, segment.end_t);
+        }
+
+        return projected_segments;
+    }
+
+    //Random times within the segments, sorted pairs for range queries
+    std::vector<Float> make_times(const std::vector<Segment>& segments, const size_t count)
+    {
+        std::mt19937 generator(2);
+        std::uniform_real_distribution<float> time(segments.front().start_t.get_value(), segments.back().end_t.get_value());
+
+        std::vector<Float> times;
+        times.reserve(count);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            times.push_back(time(generator));
+        }
+
+        for (size_t i = 0; i + 1 < count; i += 2)
+        {
+            if (times[i + 1] < times[i])
+            {
+                std::swap(times[i], times[i + 1]);
+            }
+        }
+
+        return times;
+    }
+
+    void bench_float_less(Benchmark::State& state)
+    {
+        const std::vector<Vec2> values = make_random_walk(static_cast<size_t>(state.range(0)));
+
+        for ([[maybe_unused]] auto _ : state)
+        {
+            size_t count = 0;
+            for (const Vec2& value : values)
+            {
+                count += value.x < value.y;
+            }
+            Benchmark::do_not_optimize(count);
+        }
+
+        state.set_operations_per_iteration(values.size());
+    }
+    BENCHMARK(bench_float_less)->range(64, 4096);
+
+    void bench_float_equal(Benchmark::State& state)
+    {
+        const std::vector<Vec2> values = make_random_walk(static_cast<size_t>(state.range(0)));
+
+        for ([[maybe_unused]] auto _ : state)
+        {
+            size_t count = 0;
+            for (size_t i = 1; i < values.size(); i++)
+            {
+                count += values[i].x == values[i - 1].x;
+            }
+            Benchmark::do_not_optimize(count);
+        }
+
+        state.set_operations_per_iteration(values.size() - 1);
+    }
+    BENCHMARK(bench_float_equal)->range(64, 4096);
+
+    void bench_float_less_or_equal(Benchmark::State& state)
+    {
+        const std::vector<Vec2> values = make_random_walk(static_cast<size_t>(state.range(0)));
+
+        for ([[maybe_unused]] auto _ : state)
+        {
+            size_t count = 0;
+            for (const Vec2& value : values)
+            {
+                count += value.x <= value.y;
+            }
+            Benchmark::do_not_optimize(count);
+        }
+
+        state.set_operations_per_iteration(values.size());
+    }
+    BENCHMARK(bench_float_less_or_equal)->range(64, 4096);
+
+    void bench_vec2_arithmetic(Benchmark::State& state)
+    {
+        const std::vector<Vec2> values = make_random_walk(static_cast<size_t>(state.range(0)));
+        const Float scalar = 0.5f;
+
+        for ([[maybe_unused]] auto _ : state)
+        {
+            Vec2 sum(0.f, 0.f);
+            for (size_t i = 1; i < values.size(); i++)
+            {
+                sum += (values[i] - values[i - 1]) * scalar;
+            }
+            Benchmark::do_not_optimize(sum);
+        }
+
+        state.set_operations_per_iteration(values.size() - 1);
+    }
+    BENCHMARK(bench_vec2_arithmetic)->range(64, 4096);
+
+    void bench_aabb_combine(Benchmark::State& state)
+    {
+        const std::vector<Segment> segments = make_segments(static_cast<size_t>(state.range(0)));
+
+        std::vector<AABB> boxes;
+        for (const Segment& segment : segments)
+        {
+            boxes.emplace_back(segment);
+        }
+
+        for ([[maybe_unused]] auto _ : state)
+        {
+            AABB bounding_box = boxes.front();
+            for (const AABB& box : boxes)
+            {
+                bounding_box.combine(box);
+            }
+            Benchmark::do_not_optimize(bounding_box);
+        }
+
+        state.set_operations_per_iteration(boxes.size());
+    }
+    BENCHMARK(bench_aabb_combine)->range(64, 4096);
+
+    void bench_segment_get_point_at_time(Benchmark::State& state)
+    {
+        const std::vector<Segment> segments = make_segments(static_cast<size_t>(state.range(0)));
+
+        for ([[maybe_unused]] auto _ : state)
+        {
+            Vec2 sum(0.f, 0.f);
+            for (const Segment& segment : segments)
+            {
+                sum += segment.get_point_at_time((segment.start_t + segment.end_t) * 0.5f);
+            }
+            Benchmark::do_not_optimize(sum);
+        }
+
+        state.set_operations_per_iteration(segments.size());
+    }
+    BENCHMARK(bench_segment_get_point_at_time)->range(64, 4096);
+
+    void bench_segment_x_intersects(Benchmark::State& state)
+    {
+        const std::vector<Segment> segments = make_segments(static_cast<size_t>(state.range(0)));
+
+        for ([[maybe_unused]] auto _ : state)
+        {
+            size_t count = 0;
+            Float intersection_y = 0.f;
+            for (const Segment& segment : segments)
+            {
+                count += segment.x_intersects((segment.start.x + segment.end.x) * 0.5f, intersection_y);
+            }
+            Benchmark::do_not_optimize(count);
+            Benchmark::do_not_optimize(intersection_y);
+        }
+
+        state.set_operations_per_iteration(segments.size());
+    }
+    BENCHMARK(bench_segment_x_intersects)->range(64, 4096);
+
+    void bench_segment_points_with_distance_l(Benchmark::State& state)
+    {
+        const std::vector<Segment> segments = make_segments(static_cast<size_t>(state.range(0)));
+        const size_t offset = 4;
+        const Float length = 2.f;
+
+        for ([[maybe_unused]] auto _ : state)
+        {
+            size_t count = 0;
+            Vec2 point_on_start_segment, point_on_end_segment;
+            for (size_t i = 0; i + offset < segments.size(); i++)
+            {
+                count += Segment::get_points_on_same_axis_with_distance_l(segments[i], segments[i + offset], length, (i & 1) == 0, point_on_start_segment, point_on_end_segment);
+            }
+            Benchmark::do_not_optimize(count);
+            Benchmark::do_not_optimize(point_on_end_segment);
+        }
+
+        state.set_operations_per_iteration(segments.size() - offset);
+    }
+    BENCHMARK(bench_segment_points_with_distance_l)->range(64, 4096);
+
+    void bench_segment_search_tree_build(Benchmark::State& state)
+    {
+        const std::vector<Segment> segments = make_segments(static_cast<size_t>(state.range(0)));
+
+        for ([[maybe_unused]] auto _ : state)
+        {
+            const Segment_Search_Tree tree(segments);
+            Benchmark::do_not_optimize(tree.root.bounding_box);
+        }
+    }
+    BENCHMARK(bench_segment_search_tree_build)->range(1 << 10, 1 << 18);
+
+    void bench_segment_search_tree_query_range(Benchmark::State& state)
+    {
+        const std::vector<Segment> segments = make_segments(static_cast<size_t>(state.range(0)));
+        const Segment_Search_Tree tree(segments);
+        const std::vector<Float> times = make_times(segments, 1024);
+
+        for ([[maybe_unused]] auto _ : state)
+        {
+            for (size_t i = 0; i + 1 < times.size(); i += 2)
+            {
+                Benchmark::do_not_optimize(tree.query(times[i], times[i + 1]));
+            }
+        }
+
+        state.set_operations_per_iteration(times.size() / 2);
+    }
+    BENCHMARK(bench_segment_search_tree_query_range)->range(1 << 10, 1 << 18);
+
+    void bench_segment_search_tree_query_time(Benchmark::State& state)
+    {
+        const std::vector<Segment> segments = make_segments(static_cast<size_t>(state.range(0)));
+        const Segment_Search_Tree tree(segments);
+        const std::vector<Float> times = make_times(segments, 1024);
+
+        for ([[maybe_unused]] auto _ : state)
+        {
+            for (const Float& time : times)
+            {
+                Benchmark::do_not_optimize(tree.query(time));
+            }
+        }
+
+        state.set_operations_per_iteration(times.size());
+    }
+    BENCHMARK(bench_segment_search_tree_query_time)->range(1 << 10, 1 << 18);
+
+    void bench_trapezoidal_map_build(Benchmark::State& state)
+    {
+        const std::vector<Segment> projected_segments = make_projected_segments(make_segments(static_cast<size_t>(state.range(0))));
+
+        for ([[maybe_unused]] auto _ : state)
+        {
+            const Trapezoidal_Map map(projected_segments, 1);
+            Benchmark::do_not_optimize(map);
+        }
+    }
+    BENCHMARK(bench_trapezoidal_map_build)->range(1 << 10, 1 << 16);
+
+    void bench_trapezoidal_map_trace_left_right(Benchmark::State& state)
+    {
+        const std::vector<Segment> projected_segments = make_projected_segments(make_segments(static_cast<size_t>(state.range(0))));
+        const Trapezoidal_Map map(projected_segments, 1);
+
+        //Trace from the vertices, like the fixed radius contiguous query
+        const size_t stride = std::max(size_t(1), projected_segments.size() / 1024);
+
+        std::vector<Vec2> points;
+        for (size_t i = 0; i < projected_segments.size(); i += stride)
+        {
+            points.push_back(projected_segments[i].start);
+        }
+
+        for ([[maybe_unused]] auto _ : state)
+        {
+            for (size_t i = 0; i < points.size(); i++)
+            {
+                const Segment* left_segment = nullptr;
+                const Segment* right_segment = nullptr;
+                map.trace_left_right(points[i], (i & 1) == 0, left_segment, right_segment);
+                Benchmark::do_not_optimize(left_segment);
+                Benchmark::do_not_optimize(right_segment);
+            }
+        }
+
+        state.set_operations_per_iteration(points.size());
+    }
+    BENCHMARK(bench_trapezoidal_map_trace_left_right)->range(1 << 10, 1 << 16);
+
+    //The whole fixed radius contiguous query, its time goes to building the trapezoidal maps of the projections
+    void bench_fixed_radius_contiguous(Benchmark::State& state)
+    {
+        const Trajectory trajectory(make_random_walk(static_cast<size_t>(state.range(0))));
+
+        //A hotspot that holds a few segments of the walk
+        const Float radius = 2.f;
+
+        for ([[maybe_unused]] auto _ : state)
+        {
+            Benchmark::do_not_optimize(trajectory.get_hotspot_fixed_radius_contiguous(radius));
+        }
+    }
+    BENCHMARK(bench_fixed_radius_contiguous)->range(1 << 8, 1 << 11);
+
+    //Same query with the temporaries in an arena that is reused between the iterations, it shows the cost of the heap allocations
+    void bench_fixed_radius_contiguous_arena(Benchmark::State& state)
+    {
+        const Trajectory trajectory(make_random_walk(static_cast<size_t>(state.range(0))));
+
+        const Float radius = 2.f;
+
+        Scratch_Arena arena;
+
+        for ([[maybe_unused]] auto _ : state)
+        {
+            Benchmark::do_not_optimize(trajectory.get_hotspot_fixed_radius_contiguous(radius, &arena));
+        }
+    }
+    BENCHMARK(bench_fixed_radius_contiguous_arena)->range(1 << 8, 1 << 11);
+
+    //The whole fixed length contiguous query, its time goes to the loop over the breakpoints of type III, IV and V
+    void bench_fixed_length_contiguous(Benchmark::State& state)
+    {
+        const Trajectory trajectory(make_random_walk(static_cast<size_t>(state.range(0))));
+
+        //Steps are 0.77 long on average, so the subtrajectories span about 20 segments
+        const Float length = 16.f;
+
+        for ([[maybe_unused]] auto _ : state)
+        {
+            Benchmark::do_not_optimize(trajectory.get_hotspot_fixed_length_contiguous(length));
+        }
+    }
+    BENCHMARK(bench_fixed_length_contiguous)->range(1 << 8, 1 << 14);
+
+    //Fixed length contiguous queries on many short trips at once, the argument is the number of worker threads
+    //Operations are trips, so the time per operation falls linearly with the threads when the batch scales
+    void bench_batch_fixed_length_contiguous(Benchmark::State& state)
+    {
+        const size_t trip_count = 1024;
+
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<size_t> offsets = { 0 };
+
+        for (size_t i = 0; i < trip_count; i++)
+        {
+            for (const Vec2& vertex : make_random_walk(50 + (i * 37) % 150, static_cast<unsigned int>(i + 1)))
+            {
+                x.push_back(vertex.x.get_value());
+                y.push_back(vertex.y.get_value());
+            }
+
+            offsets.push_back(x.size());
+        }
+
+        Trajectory_Batch batch;
+        batch.x = x.data();
+        batch.y = y.data();
+        batch.offsets = offsets.data();
+        batch.trajectory_count = trip_count;
+
+        Trajectory_Batch_Query query;
+        query.query = Hotspot_Query::fixed_length_contiguous;
+        query.parameter = 16.f;
+
+        Trajectory_Batch_Engine engine(static_cast<size_t>(state.range(0)));
+        std::vector<AABB> results(trip_count);
+        std::string error;
+
+        for ([[maybe_unused]] auto _ : state)
+        {
+            engine.run(batch, query, results.data(), error);
+            Benchmark::do_not_optimize(results.data());
+        }
+
+        state.set_operations_per_iteration(trip_count);
+    }
+    BENCHMARK(bench_batch_fixed_length_contiguous)->arg(1)->arg(2)->arg(4)->arg(8);
+}
@@ -0,0 +1,676 @@
+#include "benchmark.h"
+#include "bench_regression.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+    //The microbenchmarks the gate runs, the Float and Segment kernels show up in all of them
+    const char* const gated_benchmarks[] = {
+        "bench_segment_search_tree_query_range",
+        "bench_segment_search_tree_query_time",
+        "bench_trapezoidal_map_build",
+        "bench_fixed_radius_contiguous",
+        "bench_fixed_length_contiguous",
+    };
+
+    struct Options
+    {
+        std::string filter;
+
+        //Empty for <baseline_directory>/<machine>.json
+        std::string baseline_path;
+        std::string baseline_directory = "benchmark_baselines";
+        std::string machine;
+
+        bool save = false;
+
+        //Relative slowdown of the median that fails the gate
+        double threshold = 0.1;
+
+        size_t samples = 10;
+        double min_time = 0.05;
+    };
+
+    //Time per operation of every sample of one benchmark run
+    struct Run_Samples
+    {
+        std::string name;
+        std::vector<double> nanoseconds;
+    };
+
+    //Median with its 95% confidence interval
+    struct Summary
+    {
+        double median = 0.0;
+        double lower = 0.0;
+        double upper = 0.0;
+    };
+
+    void print_usage()
+    {
+        std::fprintf(stderr,
+            "Usage: Benchmark_Trajectory_Hotspots regression [options]\n"
+            "  --save                   Record the baseline instead of comparing with it, keeps runs of the baseline that are filtered out\n"
+            "  --filter=<substring>     Only the runs of the gated benchmarks whose name contains the substring\n"
+            "  --threshold=<fraction>   Slowdown of the median that fails, 0.1 by default\n"
+            "  --samples=<n>            Timed samples per run, 10 by default\n"
+            "  --min-time=<seconds>     Minimum time of a sample, 0.05 by default\n"
+            "  --machine=<name>         Name of the baseline, the host name by default\n"
+            "  --baseline-dir=<path>    Directory of the baselines, benchmark_baselines by default\n"
+            "  --baseline=<path>        Baseline file, <baseline-dir>/<machine>.json by default\n"
+            "Exits with 1 when a run regressed or there is no baseline to compare with\n");
+    }
+
+    bool parse_options(int argc, char* argv[], Options& options)
+    {
+        //argv[1] is the regression command
+        for (int i = 2; i < argc; i++)
+        {
+            const char* argument = argv[i];
+
+            if (std::strcmp(argument, "--save") == 0)
+            {
+                options.save = true;
+                continue;
+            }
+
+            const char* value = std::strchr(argument, '=');
+
+            if (value == nullptr)
+            {
+                return false;
+            }
+
+            const std::string name(argument, value - argument);
+            value++;
+
+            if (name == "--filter") options.filter = value;
+            else if (name == "--threshold") options.threshold = std::atof(value);
+            else if (name == "--samples") options.samples = std::strtoull(value, nullptr, 10);
+            else if (name == "--min-time") options.min_time = std::atof(value);
+            else if (name == "--machine") options.machine = value;
+            else if (name == "--baseline-dir") options.baseline_directory = value;
+            else if (name == "--baseline") options.baseline_path = value;
+            else
+            {
+                return false;
+            }
+        }
+
+        return options.threshold > 0.0 && options.samples >= 3 && options.min_time > 0.0;
+    }
+
+    //Host name with only the characters that are safe in a file name
+    std::string get_machine_name()
+    {
+        char host_name[256] = {};
+
+#if defined(_WIN32)
+        DWORD size = sizeof(host_name);
+        if (!GetComputerNameA(host_name, &size))
+        {
+            return "unknown";
+        }
+#else
+        if (gethostname(host_name, sizeof(host_name) - 1) != 0)
+        {
+            return "unknown";
+        }
+#endif
+
+        std::string name = host_name;
+        for (char& c : name)
+        {
+            if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_' && c != '.')
+            {
+                c = '_';
+            }
+        }
+
+        return name.empty() ? "unknown" : name;
+    }
+
+    //The median is between the k-th smallest and the k-th largest sample with a probability of at least 95%,
+    //k follows from the binomial distribution of the number of samples below the true median
+    Summary summarize(std::vector<double> samples)
+    {
+        Summary summary;
+
+        if (samples.empty())
+        {
+            return summary;
+        }
+
+        std::sort(samples.begin(), samples.end());
+
+        const size_t n = samples.size();
+        summary.median = (n % 2 == 1) ? samples[n / 2] : 0.5 * (samples[n / 2 - 1] + samples[n / 2]);
+
+        double probability = std::pow(0.5, static_cast<double>(n));
+        double cumulative = probability;
+        size_t k = 0;
+
+        while (k < n / 2 && cumulative <= 0.025)
+        {
+            k++;
+            probability *= static_cast<double>(n - k + 1) / static_cast<double>(k);
+            cumulative += probability;
+        }
+
+        //Too few samples for 95%, the interval is the range
+        k = std::max(k, size_t(1));
+
+        summary.lower = samples[k - 1];
+        summary.upper = samples[n - k];
+
+        return summary;
+    }
+
+    //Calibrates the iterations once, then times every sample with the same number of iterations
+    Run_Samples run_samples(const Benchmark::Registration& registration, const std::vector<int64_t>& arguments, const Options& options)
+    {
+        Run_Samples run;
+        run.name = Benchmark::get_run_name(registration, arguments);
+
+        const uint64_t iterations = Benchmark::run_benchmark(registration, arguments, options.min_time).iterations();
+
+        for (size_t i = 0; i < options.samples; i++)
+        {
+            Benchmark::State state(arguments, iterations);
+            registration.function(state);
+
+            const double operations = static_cast<double>(state.iterations()) * static_cast<double>(state.get_operations_per_iteration());
+            run.nanoseconds.push_back(state.get_elapsed_seconds() * 1e9 / operations);
+        }
+
+        return run;
+    }
+
+    bool is_gated(const std::string& benchmark_name)
+    {
+        return std::find_if(std::begin(gated_benchmarks), std::end(gated_benchmarks),
+            [&](const char* gated_name) { return benchmark_name == gated_name; }) != std::end(gated_benchmarks);
+    }
+
+    //Reader for the baseline files written below, skips values it doesn't know
+    class Baseline_Reader
+    {
+    public:
+
+        explicit Baseline_Reader(const std::string& text) : text(text) {}
+
+        bool read(std::vector<Run_Samples>& runs, std::string& error)
+        {
+            bool valid = expect('{');
+
+            while (valid && !peek('}'))
+            {
+                std::string key;
+                valid = read_string(key) && expect(':');
+
+                if (!valid)
+                {
+                    break;
+                }
+
+                if (key == "runs")
+                {
+                    valid = read_runs(runs);
+                }
+                else
+                {
+                    valid = skip_value();
+                }
+
+                if (valid && !peek('}'))
+                {
+                    valid = expect(',');
+                }
+            }
+
+            if (!valid || !expect('}'))
+            {
+                error = "invalid JSON at offset " + std::to_string(position);
+                return false;
+            }
+
+            return true;
+        }
+
+    private:
+
+        bool read_runs(std::vector<Run_Samples>& runs)
+        {
+            if (!expect('['))
+            {
+                return false;
+            }
+
+            while (!peek(']'))
+            {
+                Run_Samples run;
+
+                if (!expect('{'))
+                {
+                    return false;
+                }
+
+                while (!peek('}'))
+                {
+                    std::string key;
+                    if (!read_string(key) || !expect(':'))
+                    {
+                        return false;
+                    }
+
+                    bool valid = true;
+
+                    if (key == "name")
+                    {
+                        valid = read_string(run.name);
+                    }
+                    else if (key == "ns_per_op")
+                    {
+                        valid = read_numbers(run.nanoseconds);
+                    }
+                    else
+                    {
+                        valid = skip_value();
+                    }
+
+                    if (!valid || (!peek('}') && !expect(',')))
+                    {
+                        return false;
+                    }
+                }
+
+                expect('}');
+                runs.push_back(run);
+
+                if (!peek(']') && !expect(','))
+                {
+                    return false;
+                }
+            }
+
+            return expect(']');
+        }
+
+        bool read_numbers(std::vector<double>& numbers)
+        {
+            if (!expect('['))
+            {
+                return false;
+            }
+
+            while (!peek(']'))
+            {
+                double number = 0.0;
+                if (!read_number(number))
+                {
+                    return false;
+                }
+
+                numbers.push_back(number);
+
+                if (!peek(']') && !expect(','))
+                {
+                    return false;
+                }
+            }
+
+            return expect(']');
+        }
+
+        bool read_number(double& number)
+        {
+            skip_whitespace();
+
+            const char* start = text.c_str() + position;
+            char* end = nullptr;
+            number = std::strtod(start, &end);
+
+            if (end == start)
+            {
+                return false;
+            }
+
+            position += end - start;
+            return true;
+        }
+
+        //The names are benchmark and machine names, escapes are only skipped over
+        bool read_string(std::string& value)
+        {
+            if (!expect('"'))
+            {
+                return false;
+            }
+
+            value.clear();
+
+            while (position < text.size() && text[position] != '"')
+            {
+                if (text[position] == '\\' && position + 1 < text.size())
+                {
+                    position++;
+                }
+
+                value += text[position++];
+            }
+
+            return expect('"');
+        }
+
+        bool skip_value()
+        {
+            skip_whitespace();
+
+            if (position >= text.size())
+            {
+                return false;
+            }
+
+            const char c = text[position];
+
+            if (c == '"')
+            {
+                std::string value;
+                return read_string(value);
+            }
+
+            if (c == '[' || c == '{')
+            {
+                const char close = (c == '[') ? ']' : '}';
+                position++;
+
+                while (!peek(close))
+                {
+                    if (c == '{')
+                    {
+                        std::string key;
+                        if (!read_string(key) || !expect(':'))
+                        {
+                            return false;
+                        }
+                    }
+
+                    if (!skip_value() || (!peek(close) && !expect(',')))
+                    {
+                        return false;
+                    }
+                }
+
+                return expect(close);
+            }
+
+            for (const char* literal : { "true", "false", "null" })
+            {
+                if (text.compare(position, std::strlen(literal), literal) == 0)
+                {
+                    position += std::strlen(literal);
+                    return true;
+                }
+            }
+
+            double number = 0.0;
+            return read_number(number);
+        }
+
+        void skip_whitespace()
+        {
+            while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position])))
+            {
+                position++;
+            }
+        }
+
+        bool peek(const char c)
+        {
+            skip_whitespace();
+            return position < text.size() && text[position] == c;
+        }
+
+        bool expect(const char c)
+        {
+            if (!peek(c))
+            {
+                return false;
+            }
+
+            position++;
+            return true;
+        }
+
+        const std::string text;
+        size_t position = 0;
+    };
+
+    bool read_baseline(const std::string& path, std::vector<Run_Samples>& runs, std::string& error)
+    {
+        std::ifstream file(path, std::ios::binary);
+
+        if (!file)
+        {
+            error = "can't open " + path;
+            return false;
+        }
+
+        std::stringstream text;
+        text << file.rdbuf();
+
+        Baseline_Reader reader(text.str());
+
+        if (!reader.read(runs, error))
+        {
+            error = path + ": " + error;
+            return false;
+        }
+
+        return true;
+    }
+
+    //The samples are what the gate compares, the summary is there for people reading the file
+    bool write_baseline(const std::string& path, const std::string& machine, const std::vector<Run_Samples>& runs, std::string& error)
+    {
+        const std::filesystem::path directory = std::filesystem::path(path).parent_path();
+
+        std::error_code directory_error;
+        if (!directory.empty())
+        {
+            std::filesystem::create_directories(directory, directory_error);
+        }
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+        if (!file)
+        {
+            error = "can't write " + path;
+            return false;
+        }
+
+        char number[32];
+
+        file << "{\n  \"machine\": \"" << machine << "\",\n  \"runs\": [";
+
+        for (size_t i = 0; i < runs.size(); i++)
+        {
+            const Summary summary = summarize(runs[i].nanoseconds);
+
+            file << (i == 0 ? "\n" : ",\n") << "    { \"name\": \"" << runs[i].name << "\"";
+
+            std::snprintf(number, sizeof(number), "%.9g", summary.median);
+            file << ", \"median\": " << number;
+            std::snprintf(number, sizeof(number), "%.9g", summary.lower);
+            file << ", \"lower\": " << number;
+            std::snprintf(number, sizeof(number), "%.9g", summary.upper);
+            file << ", \"upper\": " << number;
+
+            file << ", \"ns_per_op\": [";
+            for (size_t j = 0; j < runs[i].nanoseconds.size(); j++)
+            {
+                std::snprintf(number, sizeof(number), "%.9g", runs[i].nanoseconds[j]);
+                file << (j == 0 ? "" : ", ") << number;
+            }
+            file << "] }";
+        }
+
+        file << "\n  ]\n}\n";
+
+        if (!file)
+        {
+            error = "can't write " + path;
+            return false;
+        }
+
+        return true;
+    }
+
+    const Run_Samples* find_run(const std::vector<Run_Samples>& runs, const std::string& name)
+    {
+        const auto run = std::find_if(runs.begin(), runs.end(), [&](const Run_Samples& candidate) { return candidate.name == name; });
+        return run == runs.end() ? nullptr : &*run;
+    }
+}
+
+int run_regression_benchmark(int argc, char* argv[])
+{
+    Options options;
+
+    if (!parse_options(argc, argv, options))
+    {
+        print_usage();
+        return 1;
+    }
+
+    if (options.machine.empty())
+    {
+        options.machine = get_machine_name();
+    }
+
+    if (options.baseline_path.empty())
+    {
+        options.baseline_path = (std::filesystem::path(options.baseline_directory) / (options.machine + ".json")).string();
+    }
+
+    std::vector<Run_Samples> baseline;
+    std::string error;
+
+    if (!read_baseline(options.baseline_path, baseline, error) && !options.save)
+    {
+        std::fprintf(stderr, "error: no baseline for %s: %s\nRecord one with: Benchmark_Trajectory_Hotspots regression --save\n", options.machine.c_str(), error.c_str());
+        return 1;
+    }
+
+    if (options.save)
+    {
+        std::printf("%-48s %14s %14s %14s\n", "Benchmark", "ns/op", "lower", "upper");
+    }
+    else
+    {
+        std::printf("%-48s %14s %14s %9s  %s\n", "Benchmark", "baseline ns/op", "ns/op", "change", "result");
+    }
+
+    size_t regressions = 0;
+
+    for (const Benchmark::Registration* registration : Benchmark::get_registrations())
+    {
+        if (!is_gated(registration->name))
+        {
+            continue;
+        }
+
+        for (const std::vector<int64_t>& arguments : registration->argument_lists)
+        {
+            if (Benchmark::get_run_name(*registration, arguments).find(options.filter) == std::string::npos)
+            {
+                continue;
+            }
+
+            const Run_Samples run = run_samples(*registration, arguments, options);
+            const Summary summary = summarize(run.nanoseconds);
+
+            if (options.save)
+            {
+                std::printf("%-48s %14.2f %14.2f %14.2f\n", run.name.c_str(), summary.median, summary.lower, summary.upper);
+                std::fflush(stdout);
+
+                //Replace the run in the baseline, keep the ones this run filtered out
+                const auto previous = std::find_if(baseline.begin(), baseline.end(), [&](const Run_Samples& candidate) { return candidate.name == run.name; });
+                if (previous != baseline.end())
+                {
+                    *previous = run;
+                }
+                else
+                {
+                    baseline.push_back(run);
+                }
+
+                continue;
+            }
+
+            const Run_Samples* baseline_run = find_run(baseline, run.name);
+
+            if (baseline_run == nullptr || baseline_run->nanoseconds.empty())
+            {
+                std::printf("%-48s %14s %14.2f %9s  new, not in the baseline\n", run.name.c_str(), "-", summary.median, "-");
+                std::fflush(stdout);
+                continue;
+            }
+
+            const Summary baseline_summary = summarize(baseline_run->nanoseconds);
+            const double change = summary.median / baseline_summary.median - 1.0;
+
+            //Both the size of the change and the separation of the intervals, so noise alone doesn't fail the gate
+            const char* result = "ok";
+            if (change > options.threshold && summary.lower > baseline_summary.upper)
+            {
+                result = "REGRESSION";
+                regressions++;
+            }
+            else if (change < -options.threshold && summary.upper < baseline_summary.lower)
+            {
+                result = "faster";
+            }
+
+            std::printf("%-48s %14.2f %14.2f %+8.1f%%  %s\n", run.name.c_str(), baseline_summary.median, summary.median, change * 100.0, result);
+            std::fflush(stdout);
+        }
+    }
+
+    if (options.save)
+    {
+        if (!write_baseline(options.baseline_path, options.machine, baseline, error))
+        {
+            std::fprintf(stderr, "error: %s\n", error.c_str());
+            return 1;
+        }
+
+        std::printf("Baseline written to %s\n", options.baseline_path.c_str());
+        return 0;
+    }
+
+    if (regressions > 0)
+    {
+        std::printf("%zu runs regressed by more than %.0f%% against %s\n", regressions, options.threshold * 100.0, options.baseline_path.c_str());
+        return 1;
+    }
+
+    return 0;
+}
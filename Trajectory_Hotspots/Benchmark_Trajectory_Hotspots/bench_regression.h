@@ -0,0 +1,11 @@
+#pragma once
+
+//Performance regression gate of the microbenchmarks of Segment_Search_Tree::query, the Trapezoidal_Map build and the hotspot queries
+//Times every run several times and compares the median with a JSON baseline of the same machine,
+//a run regressed when its median is slower by more than the threshold and its confidence interval doesn't overlap the one of the baseline
+//
+//  Benchmark_Trajectory_Hotspots regression --save          Record the baseline of this machine
+//  Benchmark_Trajectory_Hotspots regression [--threshold=0.1] [--filter=fixed_]
+//
+//Returns the exit code of the program, 1 if any run regressed or the baseline can't be read
+int run_regression_benchmark(int argc, char* argv[]);
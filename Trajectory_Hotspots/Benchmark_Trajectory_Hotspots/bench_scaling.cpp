@@ -0,0 +1,324 @@
+#include "../Trajectory_Hotspots/pch.h"
+#include "../Trajectory_Hotspots/vec2.h"
+#include "../Trajectory_Hotspots/trajectory.h"
+#include "../Trajectory_Hotspots/trajectory_generator.h"
+#include "../Trajectory_Hotspots/hotspot_query.h"
+
+#include "benchmark.h"
+#include "bench_scaling.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+
+namespace
+{
+    const Hotspot_Query all_queries[] = { Hotspot_Query::fixed_radius, Hotspot_Query::fixed_length, Hotspot_Query::fixed_radius_contiguous, Hotspot_Query::fixed_length_contiguous };
+    const Trajectory_Shape all_shapes[] = { Trajectory_Shape::random_walk, Trajectory_Shape::levy_flight, Trajectory_Shape::vehicle, Trajectory_Shape::degenerate };
+
+    struct Options
+    {
+        std::vector<Trajectory_Shape> shapes;
+        std::vector<Hotspot_Query> queries;
+
+        size_t min_vertices = 1000;
+        size_t max_vertices = 10000000;
+        size_t steps_per_decade = 2;
+
+        //A query is not run on larger trajectories of a shape once a single call takes longer than this
+        double max_seconds = 10.0;
+
+        //Small trajectories are queried repeatedly for at least this long
+        double min_time = 0.1;
+
+        float radius = 5.f;
+        float length = 20.f;
+        unsigned int seed = 1;
+
+        bool csv = false;
+
+        //Chrome trace of the query phases, not written when empty
+        std::string trace_path;
+    };
+
+    void print_usage()
+    {
+        std::fprintf(stderr,
+            "Usage: Benchmark_Trajectory_Hotspots scaling [options]\n"
+            "  --shapes=<list>          random_walk,levy_flight,vehicle,degenerate, all by default\n"
+            "  --queries=<list>         fixed_radius,fixed_length,fixed_radius_contiguous,fixed_length_contiguous, the implemented ones by default\n"
+            "  --min-vertices=<n>       Smallest trajectory, 1000 by default\n"
+            "  --max-vertices=<n>       Largest trajectory, 10000000 by default\n"
+            "  --steps-per-decade=<n>   Trajectory sizes per factor 10, 2 by default\n"
+            "  --max-seconds=<s>        Stop growing a query once one call takes longer, 10 by default\n"
+            "  --min-time=<s>           Repeat calls on small trajectories for at least this long, 0.1 by default\n"
+            "  --radius=<r>             Radius of the radius queries, 5 by default\n"
+            "  --length=<l>             Length of the length queries, 20 by default\n"
+            "  --seed=<n>               Seed of the generators, 1 by default\n"
+            "  --format=<table|csv>     Scaling table with exponents, or one csv row per measurement\n"
+            "  --trace=<path>           Write the phases of every query call as Chrome trace JSON\n"
+            "Steps between vertices are about 1 unit and 1 time unit on every shape\n");
+    }
+
+    bool parse_options(int argc, char* argv[], Options& options)
+    {
+        options.shapes.assign(std::begin(all_shapes), std::end(all_shapes));
+        //The unimplemented queries return an empty hotspot right away, their times would only clutter the table
+        std::copy_if(std::begin(all_queries), std::end(all_queries), std::back_inserter(options.queries), hotspot_query_implemented);
+
+        //argv[1] is the scaling command
+        for (int i = 2; i < argc; i++)
+        {
+            const char* argument = argv[i];
+            const char* value = std::strchr(argument, '=');
+
+            if (value == nullptr)
+            {
+                return false;
+            }
+
+            const std::string name(argument, value - argument);
+            value++;
+
+            if (name == "--shapes")
+            {
+                if (!Benchmark::parse_list(value, options.shapes, parse_trajectory_shape)) return false;
+            }
+            else if (name == "--queries")
+            {
+                if (!Benchmark::parse_list(value, options.queries, parse_hotspot_query)) return false;
+            }
+            else if (name == "--min-vertices") options.min_vertices = std::strtoull(value, nullptr, 10);
+            else if (name == "--max-vertices") options.max_vertices = std::strtoull(value, nullptr, 10);
+            else if (name == "--steps-per-decade") options.steps_per_decade = std::strtoull(value, nullptr, 10);
+            else if (name == "--max-seconds") options.max_seconds = std::atof(value);
+            else if (name == "--min-time") options.min_time = std::atof(value);
+            else if (name == "--radius") options.radius = static_cast<float>(std::atof(value));
+            else if (name == "--length") options.length = static_cast<float>(std::atof(value));
+            else if (name == "--seed") options.seed = static_cast<unsigned int>(std::strtoul(value, nullptr, 10));
+            else if (name == "--format")
+            {
+                if (std::strcmp(value, "csv") == 0) options.csv = true;
+                else if (std::strcmp(value, "table") == 0) options.csv = false;
+                else return false;
+            }
+            else if (name == "--trace") options.trace_path = value;
+            else
+            {
+                return false;
+            }
+        }
+
+        return options.min_vertices >= 2 && options.max_vertices >= options.min_vertices && options.steps_per_decade > 0;
+    }
+
+    //Vertex counts spaced evenly on a log scale, always including the smallest and the largest
+    std::vector<size_t> get_vertex_counts(const Options& options)
+    {
+        std::vector<size_t> counts;
+
+        const double step = pow(10.0, 1.0 / static_cast<double>(options.steps_per_decade));
+
+        for (double count = static_cast<double>(options.min_vertices); count < static_cast<double>(options.max_vertices) * 0.999; count *= step)
+        {
+            counts.push_back(static_cast<size_t>(count + 0.5));
+        }
+
+        counts.push_back(options.max_vertices);
+        return counts;
+    }
+
+    //Seconds per call, the average over repeated calls until min_time has passed
+    double time_query(const Trajectory& trajectory, const Hotspot_Query query, const Options& options)
+    {
+        size_t calls = 0;
+        const auto start = std::chrono::steady_clock::now();
+        double elapsed = 0.0;
+
+        do
+        {
+            Benchmark::do_not_optimize(run_hotspot_query(trajectory, query, hotspot_query_uses_timestamps(query) ? options.radius : options.length));
+            calls++;
+
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } while (elapsed < options.min_time);
+
+        return elapsed / static_cast<double>(calls);
+    }
+
+    //Least squares fit of log(seconds) = log(c) + k * log(n), returns k
+    //Times below 10 microseconds are mostly overhead and left out, returns NaN with fewer than two measurements left
+    double fit_exponent(const std::vector<size_t>& vertex_counts, const std::vector<double>& seconds)
+    {
+        double sum_x = 0.0, sum_y = 0.0, sum_xx = 0.0, sum_xy = 0.0;
+        size_t count = 0;
+
+        for (size_t i = 0; i < seconds.size(); i++)
+        {
+            if (seconds[i] < 1e-5)
+            {
+                continue;
+            }
+
+            const double x = log(static_cast<double>(vertex_counts[i]));
+            const double y = log(seconds[i]);
+
+            sum_x += x;
+            sum_y += y;
+            sum_xx += x * x;
+            sum_xy += x * y;
+            count++;
+        }
+
+        const double denominator = static_cast<double>(count) * sum_xx - sum_x * sum_x;
+
+        if (count < 2 || denominator <= 0.0)
+        {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+
+        return (static_cast<double>(count) * sum_xy - sum_x * sum_y) / denominator;
+    }
+
+    void print_time(const double seconds)
+    {
+        if (seconds < 1e-3) std::printf(" %9.1fus", seconds * 1e6);
+        else if (seconds < 1.0) std::printf(" %9.1fms", seconds * 1e3);
+        else std::printf(" %10.2fs", seconds);
+    }
+}
+
+int run_scaling_benchmark(int argc, char* argv[])
+{
+    Options options;
+
+    if (!parse_options(argc, argv, options))
+    {
+        print_usage();
+        return 1;
+    }
+
+    const std::vector<size_t> vertex_counts = get_vertex_counts(options);
+
+    set_tracing_enabled(!options.trace_path.empty());
+
+    if (options.csv)
+    {
+        std::printf("shape,query,vertex_count,seconds\n");
+    }
+    else
+    {
+        std::printf("%-12s %-24s", "shape", "query");
+        for (const size_t vertex_count : vertex_counts)
+        {
+            std::printf(" %11zu", vertex_count);
+        }
+        std::printf(" %9s %9s\n", "exponent", "last");
+    }
+
+    for (const Trajectory_Shape shape : options.shapes)
+    {
+        //Seconds per call of every query for every vertex count, empty after the query was stopped
+        std::vector<std::vector<double>> seconds(options.queries.size());
+        std::vector<bool> stopped(options.queries.size(), false);
+
+        for (const size_t vertex_count : vertex_counts)
+        {
+            if (std::find(stopped.begin(), stopped.end(), false) == stopped.end())
+            {
+                break;
+            }
+
+            const Synthetic_Trajectory vertices = generate_trajectory(shape, vertex_count, options.seed);
+
+            for (const bool use_timestamps : { true, false })
+            {
+                //Only build the trajectories that are queried
+                bool needed = false;
+                for (size_t i = 0; i < options.queries.size(); i++)
+                {
+                    needed = needed || (!stopped[i] && hotspot_query_uses_timestamps(options.queries[i]) == use_timestamps);
+                }
+
+                if (!needed)
+                {
+                    continue;
+                }
+
+                const Trajectory trajectory = vertices.build_trajectory(use_timestamps);
+
+                for (size_t i = 0; i < options.queries.size(); i++)
+                {
+                    if (stopped[i] || hotspot_query_uses_timestamps(options.queries[i]) != use_timestamps)
+                    {
+                        continue;
+                    }
+
+                    std::fprintf(stderr, "%s %s %zu\n", trajectory_shape_name(shape), hotspot_query_name(options.queries[i]), vertex_count);
+
+                    const double query_seconds = time_query(trajectory, options.queries[i], options);
+                    seconds[i].push_back(query_seconds);
+
+                    if (options.csv)
+                    {
+                        std::printf("%s,%s,%zu,%.9g\n", trajectory_shape_name(shape), hotspot_query_name(options.queries[i]), vertex_count, query_seconds);
+                        std::fflush(stdout);
+                    }
+
+                    if (query_seconds > options.max_seconds)
+                    {
+                        stopped[i] = true;
+                    }
+                }
+            }
+        }
+
+        if (options.csv)
+        {
+            continue;
+        }
+
+        for (size_t i = 0; i < options.queries.size(); i++)
+        {
+            std::printf("%-12s %-24s", trajectory_shape_name(shape), hotspot_query_name(options.queries[i]));
+
+            for (size_t j = 0; j < vertex_counts.size(); j++)
+            {
+                if (j < seconds[i].size())
+                {
+                    print_time(seconds[i][j]);
+                }
+                else
+                {
+                    std::printf(" %11s", "-");
+                }
+            }
+
+            //The exponent over all sizes, and between the last two sizes to show where a query starts to grow faster
+            const double exponent = fit_exponent(vertex_counts, seconds[i]);
+
+            double last_exponent = std::numeric_limits<double>::quiet_NaN();
+            const size_t measured = seconds[i].size();
+
+            if (measured >= 2 && seconds[i][measured - 2] >= 1e-5)
+            {
+                last_exponent = log(seconds[i][measured - 1] / seconds[i][measured - 2]) / log(static_cast<double>(vertex_counts[measured - 1]) / static_cast<double>(vertex_counts[measured - 2]));
+            }
+
+            std::printf(" %9.2f %9.2f\n", exponent, last_exponent);
+        }
+
+        std::fflush(stdout);
+    }
+
+    std::string error;
+    if (!options.trace_path.empty() && !write_chrome_trace(options.trace_path, error))
+    {
+        std::fprintf(stderr, "error: %s: %s\n", options.trace_path.c_str(), error.c_str());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+//End-to-end scaling benchmark of the Trajectory::get_hotspot_* entry points on synthetic trajectories
+//Times every implemented query on every trajectory shape for vertex counts from 1e3 to 1e7 and fits the complexity exponent,
+//the time as c * n^k, so a query that goes quadratic on a shape stands out
+//
+//  Benchmark_Trajectory_Hotspots scaling [--shapes=random_walk,vehicle] [--queries=fixed_length_contiguous] [--max-vertices=1000000]
+//
+//Returns the exit code of the program
+int run_scaling_benchmark(int argc, char* argv[]);
@@ -0,0 +1,330 @@
+#include "benchmark.h"
+#include "bench_scaling.h"
+#include "bench_differential.h"
+#include "bench_regression.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace
+{
+    std::atomic<uint64_t> allocation_count(0);
+    std::atomic<uint64_t> allocated_bytes(0);
+}
+
+//Count every heap allocation of the process, the counts of the measured loops are the difference between two snapshots
+void* operator new(std::size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    void* memory = std::malloc(size == 0 ? 1 : size);
+
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    return memory;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+namespace Benchmark
+{
+    Allocation_Counters get_allocation_counters()
+    {
+        Allocation_Counters counters;
+        counters.allocations = allocation_count.load(std::memory_order_relaxed);
+        counters.bytes = allocated_bytes.load(std::memory_order_relaxed);
+        return counters;
+    }
+
+    State::State(const std::vector<int64_t>& arguments, const uint64_t iterations) :
+        arguments(arguments), max_iterations(iterations)
+    {
+    }
+
+    void State::pause_timing()
+    {
+        if (!timing)
+        {
+            return;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        const Allocation_Counters counters = get_allocation_counters();
+
+        elapsed_seconds += std::chrono::duration<double>(now - timing_start).count();
+        allocations.allocations += counters.allocations - allocations_at_start.allocations;
+        allocations.bytes += counters.bytes - allocations_at_start.bytes;
+
+        if (hardware_counters_open())
+        {
+            const Hardware_Counters hardware = read_hardware_counters();
+
+            //The scaled counts of multiplexed counters can step back a little
+            const auto difference = [](const uint64_t end, const uint64_t start) { return end > start ? end - start : 0; };
+
+            hardware_counters.cycles += difference(hardware.cycles, hardware_counters_at_start.cycles);
+            hardware_counters.instructions += difference(hardware.instructions, hardware_counters_at_start.instructions);
+            hardware_counters.cache_misses += difference(hardware.cache_misses, hardware_counters_at_start.cache_misses);
+            hardware_counters.branch_misses += difference(hardware.branch_misses, hardware_counters_at_start.branch_misses);
+        }
+
+        timing = false;
+    }
+
+    void State::resume_timing()
+    {
+        if (timing)
+        {
+            return;
+        }
+
+        timing = true;
+        allocations_at_start = get_allocation_counters();
+
+        if (hardware_counters_open())
+        {
+            hardware_counters_at_start = read_hardware_counters();
+        }
+
+        timing_start = std::chrono::steady_clock::now();
+    }
+
+    Registration* Registration::arg(const int64_t value)
+    {
+        argument_lists.push_back({ value });
+        return this;
+    }
+
+    Registration* Registration::range(const int64_t start, const int64_t end, const int64_t multiplier)
+    {
+        for (int64_t value = start; value < end; value *= multiplier)
+        {
+            argument_lists.push_back({ value });
+        }
+
+        argument_lists.push_back({ end });
+        return this;
+    }
+
+    Registration* Registration::args(const std::vector<int64_t>& values)
+    {
+        argument_lists.push_back(values);
+        return this;
+    }
+
+    std::vector<Registration*>& get_registrations()
+    {
+        //Function local so registrations from other translation units can run in any order
+        static std::vector<Registration*> registrations;
+        return registrations;
+    }
+
+    Registration* register_benchmark(const char* name, const Function function)
+    {
+        get_registrations().push_back(new Registration(name, function));
+        return get_registrations().back();
+    }
+
+    std::string get_run_name(const Registration& registration, const std::vector<int64_t>& arguments)
+    {
+        std::string name = registration.name;
+
+        for (const int64_t argument : arguments)
+        {
+            name += "/" + std::to_string(argument);
+        }
+
+        return name;
+    }
+
+    State run_benchmark(const Registration& registration, const std::vector<int64_t>& arguments, const double min_time)
+    {
+        uint64_t iterations = 1;
+
+        while (true)
+        {
+            State state(arguments, iterations);
+            registration.function(state);
+
+            const double elapsed = state.get_elapsed_seconds();
+
+            if (elapsed >= min_time || iterations >= 1000000000)
+            {
+                return state;
+            }
+
+            //Aim a bit over min_time, but grow at most 10 times so a noisy short run doesn't overshoot
+            const double multiplier = (elapsed <= min_time / 10.0) ? 10.0 : (min_time * 1.4 / elapsed);
+            iterations = static_cast<uint64_t>(static_cast<double>(iterations) * multiplier) + 1;
+        }
+    }
+}
+
+namespace
+{
+    struct Options
+    {
+        std::string filter;
+        double min_time = 0.2;
+        bool counters = false;
+    };
+
+    void print_usage()
+    {
+        std::fprintf(stderr,
+            "Usage: Benchmark_Trajectory_Hotspots [--filter=<substring>] [--min-time=<seconds>] [--counters] [--list]\n"
+            "       --counters adds instructions per cycle and cache and branch misses per operation, Linux only\n"
+            "       Benchmark_Trajectory_Hotspots scaling [options], see scaling --help\n"
+            "       Benchmark_Trajectory_Hotspots differential [options], see differential --help\n"
+            "       Benchmark_Trajectory_Hotspots regression [options], see regression --help\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1 && std::strcmp(argv[1], "scaling") == 0)
+    {
+        return run_scaling_benchmark(argc, argv);
+    }
+
+    if (argc > 1 && std::strcmp(argv[1], "differential") == 0)
+    {
+        return run_differential_benchmark(argc, argv);
+    }
+
+    if (argc > 1 && std::strcmp(argv[1], "regression") == 0)
+    {
+        return run_regression_benchmark(argc, argv);
+    }
+
+    Options options;
+    bool list_only = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strncmp(argv[i], "--filter=", 9) == 0)
+        {
+            options.filter = argv[i] + 9;
+        }
+        else if (std::strncmp(argv[i], "--min-time=", 11) == 0)
+        {
+            options.min_time = std::atof(argv[i] + 11);
+        }
+        else if (std::strcmp(argv[i], "--counters") == 0)
+        {
+            options.counters = true;
+        }
+        else if (std::strcmp(argv[i], "--list") == 0)
+        {
+            list_only = true;
+        }
+        else
+        {
+            print_usage();
+            return 1;
+        }
+    }
+
+    std::string error;
+    if (options.counters && !list_only && !Benchmark::open_hardware_counters(error))
+    {
+        std::fprintf(stderr, "warning: no hardware counters: %s\n", error.c_str());
+    }
+
+    const bool counters = Benchmark::hardware_counters_open();
+
+    if (!list_only)
+    {
+        std::printf("%-56s %12s %14s %12s %12s", "Benchmark", "Iterations", "ns/op", "allocs/op", "bytes/op");
+
+        if (counters)
+        {
+            std::printf(" %8s %14s %14s %14s", "IPC", "instr/op", "cache-miss/op", "branch-miss/op");
+        }
+
+        std::printf("\n");
+    }
+
+    for (const Benchmark::Registration* registration : Benchmark::get_registrations())
+    {
+        std::vector<std::vector<int64_t>> argument_lists = registration->argument_lists;
+
+        if (argument_lists.empty())
+        {
+            argument_lists.push_back({});
+        }
+
+        for (const std::vector<int64_t>& arguments : argument_lists)
+        {
+            const std::string name = Benchmark::get_run_name(*registration, arguments);
+
+            if (name.find(options.filter) == std::string::npos)
+            {
+                continue;
+            }
+
+            if (list_only)
+            {
+                std::printf("%s\n", name.c_str());
+                continue;
+            }
+
+            const Benchmark::State state = Benchmark::run_benchmark(*registration, arguments, options.min_time);
+
+            const double operations = static_cast<double>(state.iterations()) * static_cast<double>(state.get_operations_per_iteration());
+
+            std::printf("%-56s %12llu %14.2f %12.3f %12.1f",
+                name.c_str(),
+                static_cast<unsigned long long>(state.iterations()),
+                state.get_elapsed_seconds() * 1e9 / operations,
+                static_cast<double>(state.get_allocations().allocations) / operations,
+                static_cast<double>(state.get_allocations().bytes) / operations);
+
+            if (counters)
+            {
+                const Benchmark::Hardware_Counters& hardware = state.get_hardware_counters();
+
+                std::printf(" %8.2f %14.1f %14.3f %14.3f",
+                    hardware.cycles > 0 ? static_cast<double>(hardware.instructions) / static_cast<double>(hardware.cycles) : 0.0,
+                    static_cast<double>(hardware.instructions) / operations,
+                    static_cast<double>(hardware.cache_misses) / operations,
+                    static_cast<double>(hardware.branch_misses) / operations);
+            }
+
+            std::printf("\n");
+            std::fflush(stdout);
+        }
+    }
+
+    return 0;
+}
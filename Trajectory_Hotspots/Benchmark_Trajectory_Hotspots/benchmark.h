@@ -0,0 +1,212 @@
+#pragma once
+
+//Small benchmark framework in the style of Google Benchmark, so the benchmarks build anywhere the library builds without other dependencies
+//
+//  void bench_something(Benchmark::State& state)
+//  {
+//      const auto input = make_input(state.range(0));   //Setup, not measured
+//
+//      for (auto _ : state)                              //Measured, runs as many iterations as the runner needs
+//      {
+//          Benchmark::do_not_optimize(something(input));
+//      }
+//  }
+//  BENCHMARK(bench_something)->range(1 << 10, 1 << 16);
+//
+//The runner reports the time and the heap allocations per operation of the measured loop,
+//and with --counters the instructions per cycle and the cache and branch misses per operation where hardware counters are available
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Benchmark
+{
+    //Heap allocations counted by the replaced global operator new of the runner
+    struct Allocation_Counters
+    {
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+    };
+
+    Allocation_Counters get_allocation_counters();
+
+    //Hardware events of the calling thread in user space, counted with perf_event_open on Linux
+    struct Hardware_Counters
+    {
+        uint64_t cycles = 0;
+        uint64_t instructions = 0;
+        uint64_t cache_misses = 0;
+        uint64_t branch_misses = 0;
+    };
+
+    //Starts counting, returns false with the reason on other platforms or when the kernel doesn't allow it (see perf_event_paranoid)
+    bool open_hardware_counters(std::string& error);
+    bool hardware_counters_open();
+
+    //Events since the counters were opened, scaled up when the kernel had to share the hardware counters with other events
+    Hardware_Counters read_hardware_counters();
+
+    //Keeps the compiler from removing the computation of a value that is not used
+    template <class T>
+    inline void do_not_optimize(const T& value)
+    {
+#if defined(_MSC_VER)
+        const volatile void* volatile sink = &value;
+        (void)sink;
+        _ReadWriteBarrier();
+#else
+        asm volatile("" : : "m"(value) : "memory");
+#endif
+    }
+
+    class State
+    {
+    public:
+
+        State(const std::vector<int64_t>& arguments, const uint64_t iterations);
+
+        //Argument i of this run, see Registration::arg and Registration::range
+        int64_t range(const size_t i = 0) const { return arguments[i]; }
+
+        uint64_t iterations() const { return max_iterations; }
+
+        //Exclude setup inside the measured loop from the time and the allocation counts
+        void pause_timing();
+        void resume_timing();
+
+        //Operations done by one iteration, the results are reported per operation
+        void set_operations_per_iteration(const uint64_t operations) { operations_per_iteration = operations; }
+        uint64_t get_operations_per_iteration() const { return operations_per_iteration; }
+
+        double get_elapsed_seconds() const { return elapsed_seconds; }
+        const Allocation_Counters& get_allocations() const { return allocations; }
+
+        //Zero unless the hardware counters are open
+        const Hardware_Counters& get_hardware_counters() const { return hardware_counters; }
+
+        //Iterating the state times the loop body, for (auto _ : state) { ... }
+        class Iterator
+        {
+        public:
+
+            Iterator(State* state, const uint64_t remaining) : state(state), remaining(remaining) {}
+
+            int operator*() const { return 0; }
+            Iterator& operator++() { remaining--; return *this; }
+
+            bool operator!=(const Iterator&)
+            {
+                if (remaining != 0)
+                {
+                    return true;
+                }
+
+                state->pause_timing();
+                return false;
+            }
+
+        private:
+
+            State* state;
+            uint64_t remaining;
+        };
+
+        Iterator begin()
+        {
+            resume_timing();
+            return Iterator(this, max_iterations);
+        }
+
+        Iterator end() { return Iterator(this, 0); }
+
+    private:
+
+        std::vector<int64_t> arguments;
+        uint64_t max_iterations;
+        uint64_t operations_per_iteration = 1;
+
+        bool timing = false;
+        std::chrono::steady_clock::time_point timing_start;
+        Allocation_Counters allocations_at_start;
+        Hardware_Counters hardware_counters_at_start;
+
+        double elapsed_seconds = 0.0;
+        Allocation_Counters allocations;
+        Hardware_Counters hardware_counters;
+    };
+
+    typedef void (*Function)(State&);
+
+    //A benchmark function with the arguments it runs with, every argument list is a separate run
+    class Registration
+    {
+    public:
+
+        Registration(const std::string& name, const Function function) : name(name), function(function) {}
+
+        //Runs with a single argument
+        Registration* arg(const int64_t value);
+
+        //Runs with start, start * multiplier, ... and end
+        Registration* range(const int64_t start, const int64_t end, const int64_t multiplier = 8);
+
+        //Runs with the arguments of each list, range(i) is the i-th value
+        Registration* args(const std::vector<int64_t>& values);
+
+        std::string name;
+        Function function;
+        std::vector<std::vector<int64_t>> argument_lists;
+    };
+
+    Registration* register_benchmark(const char* name, const Function function);
+
+    std::vector<Registration*>& get_registrations();
+
+    //Name of one run of a benchmark, the function name with its arguments, bench_something/1024
+    std::string get_run_name(const Registration& registration, const std::vector<int64_t>& arguments);
+
+    //Runs with more iterations until the measured time is at least min_time, like Google Benchmark
+    State run_benchmark(const Registration& registration, const std::vector<int64_t>& arguments, const double min_time);
+
+    //Splits a comma separated list of a command line option and parses every item, returns false on an unknown name
+    template<typename T, typename Parse>
+    bool parse_list(const char* text, std::vector<T>& values, Parse parse)
+    {
+        values.clear();
+
+        const std::string list = text;
+        size_t begin = 0;
+
+        while (begin <= list.size())
+        {
+            size_t end = list.find(',', begin);
+            if (end == std::string::npos)
+            {
+                end = list.size();
+            }
+
+            T value;
+            if (!parse(list.substr(begin, end - begin), value))
+            {
+                return false;
+            }
+
+            values.push_back(value);
+            begin = end + 1;
+        }
+
+        return !values.empty();
+    }
+}
+
+#define BENCHMARK_CONCAT_INNER(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT_INNER(a, b)
+
+#define BENCHMARK(function) \
+    static Benchmark::Registration* BENCHMARK_CONCAT(benchmark_registration_, __LINE__) = Benchmark::register_benchmark(#function, function)
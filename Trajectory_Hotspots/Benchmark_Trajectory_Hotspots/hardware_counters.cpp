@@ -0,0 +1,137 @@
+#include "benchmark.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace
+{
+#if defined(__linux__)
+    //Cycles lead the group, so all events are enabled, multiplexed and read together
+    const uint64_t counter_configs[] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+    constexpr size_t counter_count = sizeof(counter_configs) / sizeof(counter_configs[0]);
+
+    int counter_descriptors[counter_count] = { -1, -1, -1, -1 };
+
+    //Layout of a read of the group leader with the read format below
+    struct Group_Read
+    {
+        uint64_t value_count;
+        uint64_t time_enabled;
+        uint64_t time_running;
+        uint64_t values[counter_count];
+    };
+
+    //Counts the event for the calling thread on any CPU, in user space only so it works with the default perf_event_paranoid
+    int open_counter(const uint64_t config, const int group_descriptor)
+    {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.size = sizeof(attributes);
+        attributes.config = config;
+        attributes.disabled = group_descriptor == -1 ? 1 : 0;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, group_descriptor, 0));
+    }
+
+    void close_counters()
+    {
+        for (int& descriptor : counter_descriptors)
+        {
+            if (descriptor != -1)
+            {
+                close(descriptor);
+                descriptor = -1;
+            }
+        }
+    }
+#endif
+}
+
+namespace Benchmark
+{
+#if defined(__linux__)
+    bool open_hardware_counters(std::string& error)
+    {
+        if (hardware_counters_open())
+        {
+            return true;
+        }
+
+        for (size_t i = 0; i < counter_count; i++)
+        {
+            counter_descriptors[i] = open_counter(counter_configs[i], counter_descriptors[0]);
+
+            if (counter_descriptors[i] == -1)
+            {
+                error = std::string("perf_event_open failed: ") + std::strerror(errno);
+                close_counters();
+                return false;
+            }
+        }
+
+        if (ioctl(counter_descriptors[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP) == -1 ||
+            ioctl(counter_descriptors[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) == -1)
+        {
+            error = std::string("can't enable the counters: ") + std::strerror(errno);
+            close_counters();
+            return false;
+        }
+
+        return true;
+    }
+
+    bool hardware_counters_open()
+    {
+        return counter_descriptors[0] != -1;
+    }
+
+    Hardware_Counters read_hardware_counters()
+    {
+        Hardware_Counters counters;
+        Group_Read group;
+
+        if (!hardware_counters_open() || read(counter_descriptors[0], &group, sizeof(group)) != static_cast<ssize_t>(sizeof(group)) || group.time_running == 0)
+        {
+            return counters;
+        }
+
+        const double scale = static_cast<double>(group.time_enabled) / static_cast<double>(group.time_running);
+        const auto scaled = [scale](const uint64_t value) { return static_cast<uint64_t>(static_cast<double>(value) * scale); };
+
+        counters.cycles = scaled(group.values[0]);
+        counters.instructions = scaled(group.values[1]);
+        counters.cache_misses = scaled(group.values[2]);
+        counters.branch_misses = scaled(group.values[3]);
+
+        return counters;
+    }
+#else
+    bool open_hardware_counters(std::string& error)
+    {
+        error = "hardware counters are only read on Linux";
+        return false;
+    }
+
+    bool hardware_counters_open()
+    {
+        return false;
+    }
+
+    Hardware_Counters read_hardware_counters()
+    {
+        return Hardware_Counters();
+    }
+#endif
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+//The subset of the Microsoft C++ unit test framework that the tests use, for the CMake builds outside of Visual Studio.
+//TEST_CLASS and TEST_METHOD register every test method, test_runner.cpp runs them.
+
+#include <cmath>
+#include <cstring>
+#include <strings.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Microsoft
+{
+    namespace VisualStudio
+    {
+        namespace CppUnitTestFramework
+        {
+            template<typename T>
+            std::wstring ToString(const T& value)
+            {
+                if constexpr (std::is_arithmetic<T>::value)
+                {
+                    std::wstringstream stream;
+                    stream << value;
+                    return stream.str();
+                }
+                else
+                {
+                    return L"<object>";
+                }
+            }
+
+            template<typename T>
+            std::wstring ToString(const T* value)
+            {
+                std::wstringstream stream;
+                stream << static_cast<const void*>(value);
+                return stream.str();
+            }
+
+            template<typename T>
+            std::wstring ToString(T* value)
+            {
+                return ToString(static_cast<const T*>(value));
+            }
+
+            class Test_Failure : public std::runtime_error
+            {
+            public:
+                explicit Test_Failure(const std::string& message) : std::runtime_error(message) {}
+            };
+
+            class Assert
+            {
+            public:
+
+                static void IsTrue(const bool condition, const wchar_t* message = nullptr)
+                {
+                    if (!condition)
+                    {
+                        fail(L"Assert::IsTrue failed", message);
+                    }
+                }
+
+                static void IsFalse(const bool condition, const wchar_t* message = nullptr)
+                {
+                    if (condition)
+                    {
+                        fail(L"Assert::IsFalse failed", message);
+                    }
+                }
+
+                template<typename T>
+                static void AreEqual(const T& expected, const T& actual, const wchar_t* message = nullptr)
+                {
+                    if (!(expected == actual))
+                    {
+                        fail(L"Assert::AreEqual failed, expected " + ToString(expected) + L" but got " + ToString(actual), message);
+                    }
+                }
+
+                static void AreEqual(const double expected, const double actual, const double tolerance, const wchar_t* message = nullptr)
+                {
+                    if (!(std::abs(expected - actual) <= tolerance))
+                    {
+                        fail(L"Assert::AreEqual failed, expected " + ToString(expected) + L" but got " + ToString(actual), message);
+                    }
+                }
+
+                static void AreEqual(const float expected, const float actual, const float tolerance, const wchar_t* message = nullptr)
+                {
+                    if (!(std::abs(expected - actual) <= tolerance))
+                    {
+                        fail(L"Assert::AreEqual failed, expected " + ToString(expected) + L" but got " + ToString(actual), message);
+                    }
+                }
+
+                static void AreEqual(const char* expected, const char* actual, const bool ignore_case = false, const wchar_t* message = nullptr)
+                {
+                    if (ignore_case ? strcasecmp(expected, actual) != 0 : std::strcmp(expected, actual) != 0)
+                    {
+                        fail(L"Assert::AreEqual failed on strings", message);
+                    }
+                }
+
+                template<typename T>
+                static void AreNotEqual(const T& not_expected, const T& actual, const wchar_t* message = nullptr)
+                {
+                    if (not_expected == actual)
+                    {
+                        fail(L"Assert::AreNotEqual failed on " + ToString(actual), message);
+                    }
+                }
+
+                static void IsNull(const void* pointer, const wchar_t* message = nullptr)
+                {
+                    if (pointer != nullptr)
+                    {
+                        fail(L"Assert::IsNull failed", message);
+                    }
+                }
+
+                static void IsNotNull(const void* pointer, const wchar_t* message = nullptr)
+                {
+                    if (pointer == nullptr)
+                    {
+                        fail(L"Assert::IsNotNull failed", message);
+                    }
+                }
+
+                static void Fail(const wchar_t* message = nullptr)
+                {
+                    fail(L"Assert::Fail", message);
+                }
+
+            private:
+
+                static void fail(const std::wstring& description, const wchar_t* message)
+                {
+                    std::wstring text = description;
+                    if (message != nullptr)
+                    {
+                        text += L": ";
+                        text += message;
+                    }
+
+                    //The messages are ASCII
+                    throw Test_Failure(std::string(text.begin(), text.end()));
+                }
+            };
+
+            struct Test_Registration
+            {
+                const char* class_name;
+                const char* method_name;
+                void (*run)();
+            };
+
+            inline std::vector<Test_Registration>& get_test_registry()
+            {
+                static std::vector<Test_Registration> registry;
+                return registry;
+            }
+
+            template<typename Class, typename Name>
+            class Test_Class
+            {
+            protected:
+
+                typedef Class self_type;
+
+                static const char* get_test_class_name()
+                {
+                    return Name::value;
+                }
+            };
+        }
+    }
+}
+
+#define TEST_CLASS(name) \
+    struct name##_test_class_name { static constexpr const char* value = #name; }; \
+    class name : public ::Microsoft::VisualStudio::CppUnitTestFramework::Test_Class<name, name##_test_class_name>
+
+#define TEST_METHOD(name) \
+    struct name##_registrar \
+    { \
+        name##_registrar() \
+        { \
+            ::Microsoft::VisualStudio::CppUnitTestFramework::get_test_registry().push_back({ get_test_class_name(), #name, []() { self_type test; test.name(); } }); \
+        } \
+    }; \
+    static inline name##_registrar name##_registration; \
+    void name()
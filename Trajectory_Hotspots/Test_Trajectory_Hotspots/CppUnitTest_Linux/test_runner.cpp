@@ -0,0 +1,84 @@
+#include "CppUnitTest.h"
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace
+{
+    //A filter selects a test class by name, or one method as Class::method
+    bool matches_filter(const Test_Registration& test, const char* filter)
+    {
+        if (filter == nullptr)
+        {
+            return true;
+        }
+
+        const std::string full_name = std::string(test.class_name) + "::" + test.method_name;
+        return full_name == filter || std::strcmp(test.class_name, filter) == 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const char* filter = nullptr;
+    bool list_only = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strncmp(argv[i], "--filter=", 9) == 0)
+        {
+            filter = argv[i] + 9;
+        }
+        else if (std::strcmp(argv[i], "--list") == 0)
+        {
+            list_only = true;
+        }
+        else
+        {
+            std::fprintf(stderr, "Usage: Test_Trajectory_Hotspots [--filter=<class>|<class>::<method>] [--list]\n");
+            return 2;
+        }
+    }
+
+    size_t run = 0;
+    size_t failed = 0;
+
+    for (const Test_Registration& test : get_test_registry())
+    {
+        if (!matches_filter(test, filter))
+        {
+            continue;
+        }
+
+        if (list_only)
+        {
+            std::printf("%s::%s\n", test.class_name, test.method_name);
+            continue;
+        }
+
+        run++;
+
+        try
+        {
+            test.run();
+        }
+        catch (const std::exception& exception)
+        {
+            failed++;
+            std::printf("FAILED %s::%s: %s\n", test.class_name, test.method_name, exception.what());
+        }
+    }
+
+    if (list_only)
+    {
+        return 0;
+    }
+
+    std::printf("%zu tests, %zu failed\n", run, failed);
+
+    //A filter that selects nothing is a mistake in the test list
+    return failed == 0 && run > 0 ? 0 : 1;
+}
@@ -26,17 +26,17 @@
 //    {
 //        namespace CppUnitTestFramework
 //        {
-//            template<> static std::wstring ToString<Segment>(const class Segment& t) { return L"Segment"; }
-//            template<> static std::wstring ToString<Segment>(const class Segment* t) { return L"Segment"; }
-//            template<> static std::wstring ToString<Segment>(class Segment* t) { return L"Segment"; }
-//            template<> static std::wstring ToString<Vec2>(const class Vec2& t) { return L"Vec2"; }
-//            template<> static std::wstring ToString<Vec2>(const class Vec2* t) { return L"Vec2"; }
-//            template<> static std::wstring ToString<Vec2>(class Vec2* t) { return L"Vec2"; }
-//            template<> static std::wstring ToString<Float>(class Float* t) { return L"Float"; }
-//            template<> static std::wstring ToString<Float>(const class Float& t) { return L"Float"; }
-//            template<> static std::wstring ToString<Trapezoidal_Leaf_Node>(class Trapezoidal_Leaf_Node* t) { return L"Trapezoidal_Leaf_Node"; }
-//            template<> static std::wstring ToString<Trapezoidal_Leaf_Node>(const class Trapezoidal_Leaf_Node* t) { return L"const Trapezoidal_Leaf_Node"; }
-//            template<> static std::wstring ToString<Trapezoidal_Leaf_Node>(const class Trapezoidal_Leaf_Node& t) { return L"const Trapezoidal_Leaf_Node"; }
+//            template<> inline std::wstring ToString<Segment>(const class Segment& t) { return L"Segment"; }
+//            template<> inline std::wstring ToString<Segment>(const class Segment* t) { return L"Segment"; }
+//            template<> inline std::wstring ToString<Segment>(class Segment* t) { return L"Segment"; }
+//            template<> inline std::wstring ToString<Vec2>(const class Vec2& t) { return L"Vec2"; }
+//            template<> inline std::wstring ToString<Vec2>(const class Vec2* t) { return L"Vec2"; }
+//            template<> inline std::wstring ToString<Vec2>(class Vec2* t) { return L"Vec2"; }
+//            template<> inline std::wstring ToString<Float>(class Float* t) { return L"Float"; }
+//            template<> inline std::wstring ToString<Float>(const class Float& t) { return L"Float"; }
+//            template<> inline std::wstring ToString<Trapezoidal_Leaf_Node>(class Trapezoidal_Leaf_Node* t) { return L"Trapezoidal_Leaf_Node"; }
+//            template<> inline std::wstring ToString<Trapezoidal_Leaf_Node>(const class Trapezoidal_Leaf_Node* t) { return L"const Trapezoidal_Leaf_Node"; }
+//            template<> inline std::wstring ToString<Trapezoidal_Leaf_Node>(const class Trapezoidal_Leaf_Node& t) { return L"const Trapezoidal_Leaf_Node"; }
 //        }
 //    }
 //}
@@ -0,0 +1,113 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "../Trajectory_Hotspots/pch.h"
+#include "../Trajectory_Hotspots/vec2.h"
+#include "../Trajectory_Hotspots/trajectory.h"
+#include "../Trajectory_Hotspots/trajectory_generator.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestTrajectoryHotspots
+{
+    TEST_CLASS(TestTrajectoryHotspotsAllocationHook)
+    {
+    public:
+
+        TEST_METHOD(hook_sees_all_structures)
+        {
+            Counting_Hook counts;
+
+            Allocation_Hook hook;
+            hook.allocate = &Counting_Hook::allocate;
+            hook.deallocate = &Counting_Hook::deallocate;
+            hook.context = &counts;
+
+            set_allocation_hook(hook);
+
+            const std::vector<Segment> segments = generate_trajectory(Trajectory_Shape::random_walk, 200, 1).build_trajectory(true).get_ordered_trajectory_segments();
+
+            {
+                const Segment_Search_Tree tree(segments);
+                Assert::IsTrue(counts.allocations > 0);
+            }
+
+            //Every node was freed through the hook
+            Assert::AreEqual(counts.allocations, counts.deallocations);
+            Assert::AreEqual(size_t(0), counts.live_bytes);
+
+            const size_t tree_allocations = counts.allocations;
+
+            //The map needs segments that don't cross, like the (t, x) projection of the fixed radius query
+            std::vector<Segment> projected_segments;
+            for (const Segment& segment : segments)
+            {
+                projected_segments.emplace_back(Vec2(segment.start_t, segment.start.x), Vec2(segment.end_t, segment.end.x), segment.start_t, segment.end_t);
+            }
+
+            {
+                const Trapezoidal_Map map(projected_segments, 1);
+                Assert::IsTrue(counts.allocations > tree_allocations);
+            }
+
+            Assert::AreEqual(counts.allocations, counts.deallocations);
+            Assert::AreEqual(size_t(0), counts.live_bytes);
+
+            //The queries build both and free everything before they return
+            const Trajectory trajectory = generate_trajectory(Trajectory_Shape::random_walk, 200, 1).build_trajectory(true);
+            const size_t allocations_before_query = counts.allocations;
+
+            trajectory.get_hotspot_fixed_radius_contiguous(2.f);
+
+            Assert::IsTrue(counts.allocations > allocations_before_query);
+            Assert::AreEqual(counts.allocations, counts.deallocations);
+
+            set_allocation_hook(Allocation_Hook());
+
+            //Without the hook nothing is counted
+            const size_t allocations_with_hook = counts.allocations;
+            trajectory.get_hotspot_fixed_radius_contiguous(2.f);
+            Assert::AreEqual(allocations_with_hook, counts.allocations);
+        }
+
+        TEST_METHOD(hooked_vector)
+        {
+            Hooked_Vector<int> values;
+            for (int i = 0; i < 1000; i++)
+            {
+                values.push_back(i);
+            }
+
+            Assert::AreEqual(size_t(1000), values.size());
+            Assert::AreEqual(999, values.back());
+
+            const std::shared_ptr<Vec2> point = make_hooked_shared<Vec2>(1.f, 2.f);
+            Assert::IsTrue(*point == Vec2(1.f, 2.f));
+        }
+
+    private:
+
+        struct Counting_Hook
+        {
+            size_t allocations = 0;
+            size_t deallocations = 0;
+            size_t live_bytes = 0;
+
+            static void* allocate(size_t bytes, void* context)
+            {
+                Counting_Hook* counts = static_cast<Counting_Hook*>(context);
+                counts->allocations++;
+                counts->live_bytes += bytes;
+                return ::operator new(bytes);
+            }
+
+            static void deallocate(void* memory, size_t bytes, void* context)
+            {
+                Counting_Hook* counts = static_cast<Counting_Hook*>(context);
+                counts->deallocations++;
+                counts->live_bytes -= bytes;
+                ::operator delete(memory);
+            }
+        };
+    };
+}
@@ -0,0 +1,160 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "../Trajectory_Hotspots/pch.h"
+#include "../Trajectory_Hotspots/vec2.h"
+#include "../Trajectory_Hotspots/trajectory.h"
+#include "../Trajectory_Hotspots/compressed_trajectory.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestTrajectoryHotspots
+{
+    TEST_CLASS(TestTrajectoryHotspotsCompressedTrajectory)
+    {
+    public:
+
+        TEST_METHOD(round_trip)
+        {
+            std::vector<float> x, y, t;
+            build_random_walk(1000, x, y, t);
+
+            Compressed_Trajectory_Options options;
+            options.position_resolution = 0.01;
+            options.time_resolution = 0.001;
+            options.block_size = 64;
+
+            std::vector<char> blob;
+            std::string error;
+            Assert::IsTrue(encode_compressed_trajectory(x.data(), y.data(), t.data(), x.size(), options, blob, error));
+
+            const Compressed_Trajectory compressed(blob.data(), blob.size());
+            Assert::IsTrue(compressed.is_valid());
+            Assert::AreEqual(blob.size(), compressed.get_blob_size());
+            Assert::AreEqual(x.size(), compressed.get_vertex_count());
+            Assert::IsTrue(compressed.has_time());
+
+            //Much smaller than three floats per vertex
+            Assert::IsTrue(blob.size() * 2 < x.size() * 3 * sizeof(float));
+
+            std::vector<float> decoded_x, decoded_y, decoded_t;
+            compressed.decode(decoded_x, decoded_y, decoded_t);
+
+            Assert::AreEqual(x.size(), decoded_x.size());
+            for (size_t i = 0; i < x.size(); i++)
+            {
+                Assert::IsTrue(fabs(x[i] - decoded_x[i]) <= 0.0051f);
+                Assert::IsTrue(fabs(y[i] - decoded_y[i]) <= 0.0051f);
+                Assert::IsTrue(fabs(t[i] - decoded_t[i]) <= 0.00051f);
+            }
+
+            //Ranges decode the same values as the whole trajectory, also when they start inside a block
+            std::vector<float> range_x, range_y, range_t;
+            compressed.decode(100, 300, range_x, range_y, range_t);
+
+            Assert::AreEqual(size_t(200), range_x.size());
+            for (size_t i = 0; i < range_x.size(); i++)
+            {
+                Assert::AreEqual(decoded_x[100 + i], range_x[i]);
+                Assert::AreEqual(decoded_y[100 + i], range_y[i]);
+                Assert::AreEqual(decoded_t[100 + i], range_t[i]);
+            }
+
+            //The decoded arrays build a trajectory directly
+            const Trajectory trajectory(decoded_x.data(), decoded_y.data(), decoded_t.data(), decoded_x.size());
+            Assert::AreEqual(x.size() - 1, trajectory.get_ordered_trajectory_segments().size());
+        }
+
+        TEST_METHOD(find_time_range)
+        {
+            std::vector<float> x, y, t;
+            build_random_walk(500, x, y, t);
+
+            Compressed_Trajectory_Options options;
+            options.block_size = 32;
+
+            std::vector<char> blob;
+            std::string error;
+            Assert::IsTrue(encode_compressed_trajectory(x.data(), y.data(), t.data(), x.size(), options, blob, error));
+
+            const Compressed_Trajectory compressed(blob.data(), blob.size());
+
+            size_t first = 0;
+            size_t last = 0;
+            compressed.find_time_range(t[100] + 0.1f, t[200] + 0.1f, first, last);
+
+            //Rounded out to whole blocks
+            Assert::AreEqual(size_t(96), first);
+            Assert::AreEqual(size_t(225), last);
+
+            compressed.find_time_range(-10.f, t.back() + 10.f, first, last);
+            Assert::AreEqual(size_t(0), first);
+            Assert::AreEqual(x.size(), last);
+        }
+
+        TEST_METHOD(without_time)
+        {
+            std::vector<float> x, y, t;
+            build_random_walk(100, x, y, t);
+
+            std::vector<char> blob;
+            std::string error;
+            Assert::IsTrue(encode_compressed_trajectory(x.data(), y.data(), nullptr, x.size(), Compressed_Trajectory_Options(), blob, error));
+
+            const Compressed_Trajectory compressed(blob.data(), blob.size());
+            Assert::IsTrue(compressed.is_valid());
+            Assert::IsFalse(compressed.has_time());
+
+            std::vector<float> decoded_x, decoded_y, decoded_t;
+            compressed.decode(decoded_x, decoded_y, decoded_t);
+
+            Assert::IsTrue(decoded_t.empty());
+            Assert::IsTrue(fabs(x[50] - decoded_x[50]) <= 0.00051f);
+        }
+
+        TEST_METHOD(invalid)
+        {
+            std::vector<float> x, y, t;
+            build_random_walk(100, x, y, t);
+
+            std::vector<char> blob;
+            std::string error;
+            Assert::IsTrue(encode_compressed_trajectory(x.data(), y.data(), t.data(), x.size(), Compressed_Trajectory_Options(), blob, error));
+
+            //Truncated
+            Assert::IsFalse(Compressed_Trajectory(blob.data(), blob.size() - 8).is_valid());
+            Assert::IsFalse(Compressed_Trajectory(blob.data(), 16).is_valid());
+
+            //Varints running past the end of the data
+            std::vector<char> corrupt = blob;
+            std::fill(corrupt.end() - 8, corrupt.end(), static_cast<char>(0x80));
+            Assert::IsFalse(Compressed_Trajectory(corrupt.data(), corrupt.size()).is_valid());
+
+            //Values that can't be quantized
+            x[3] = std::numeric_limits<float>::infinity();
+            Assert::IsFalse(encode_compressed_trajectory(x.data(), y.data(), t.data(), x.size(), Compressed_Trajectory_Options(), blob, error));
+        }
+
+    private:
+
+        //Smooth random walk sampled once per second
+        void build_random_walk(const size_t count, std::vector<float>& x, std::vector<float>& y, std::vector<float>& t)
+        {
+            std::mt19937 generator(7);
+            std::uniform_real_distribution<float> step(-1.f, 1.f);
+
+            float position_x = 1000.f;
+            float position_y = -500.f;
+
+            for (size_t i = 0; i < count; i++)
+            {
+                x.push_back(position_x);
+                y.push_back(position_y);
+                t.push_back(static_cast<float>(i));
+
+                position_x += step(generator);
+                position_y += step(generator);
+            }
+        }
+    };
+}
@@ -0,0 +1,171 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "../Trajectory_Hotspots/pch.h"
+#include "../Trajectory_Hotspots/vec2.h"
+#include "../Trajectory_Hotspots/segment.h"
+#include "../Trajectory_Hotspots/segment_search_tree.h"
+#include "../Trajectory_Hotspots/dynamic_segment_search_tree.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestTrajectoryHotspots
+{
+    TEST_CLASS(TestTrajectoryHotspotsDynamicSegmentSearchTree)
+    {
+    public:
+
+        TEST_METHOD(query_segments)
+        {
+            Dynamic_Segment_Search_Tree tree;
+
+            for (int i = 0; i < 13; i++)
+            {
+                tree.push_back(Segment(Vec2(static_cast<float>(i), 0.f), Vec2(static_cast<float>(i + 1), static_cast<float>(i % 3)), static_cast<float>(i), static_cast<float>(i + 1)));
+            }
+
+            Assert::AreEqual(size_t(13), tree.size());
+
+            const AABB all = tree.query_segments(0, 12).to_AABB();
+            Assert::IsTrue(all.min == Vec2(0.f, 0.f));
+            Assert::IsTrue(all.max == Vec2(13.f, 2.f));
+
+            const AABB range = tree.query_segments(3, 4).to_AABB();
+            Assert::IsTrue(range.min == Vec2(3.f, 0.f));
+            Assert::IsTrue(range.max == Vec2(5.f, 1.f));
+        }
+
+        TEST_METHOD(matches_tree_while_growing)
+        {
+            std::mt19937 generator(29);
+            std::uniform_real_distribution<float> step(-5.f, 5.f);
+
+            std::vector<Segment> ordered_segments;
+            Dynamic_Segment_Search_Tree dynamic_tree;
+
+            Vec2 point(0.f, 0.f);
+            Float total_time_t = 0.0f;
+
+            for (int i = 0; i < 70; i++)
+            {
+                const Vec2 next_point = point + Vec2(step(generator), step(generator));
+                ordered_segments.push_back(Segment(point, next_point, total_time_t));
+                dynamic_tree.push_back(ordered_segments.back());
+
+                total_time_t = ordered_segments.back().end_t;
+                point = next_point;
+
+                //Compare against a tree built from scratch over the same segments, at sizes around the power-of-two growth
+                const std::vector<Segment_Kinematics> kinematics = build_segment_kinematics(ordered_segments);
+                const Segment_Search_Tree ss_tree(ordered_segments, &kinematics);
+
+                std::uniform_real_distribution<float> time(0.f, total_time_t.get_value());
+
+                for (int j = 0; j < 20; j++)
+                {
+                    Float start_t = time(generator);
+                    Float end_t = time(generator);
+                    if (end_t < start_t) std::swap(start_t, end_t);
+
+                    const AABB expected = ss_tree.query(start_t, end_t);
+                    const AABB result = dynamic_tree.query(start_t, end_t);
+
+                    Assert::IsTrue(expected.min == result.min);
+                    Assert::IsTrue(expected.max == result.max);
+
+                    Assert::AreEqual(ss_tree.query(start_t), dynamic_tree.query(start_t));
+                }
+
+                //Before and after the range
+                Assert::AreEqual(0, dynamic_tree.query(-1.f));
+                Assert::AreEqual(i, dynamic_tree.query(total_time_t + 1.f));
+            }
+
+            //Built at once
+            const Dynamic_Segment_Search_Tree built_tree(ordered_segments);
+            const AABB expected = dynamic_tree.query(1.5f, total_time_t - 1.5f);
+            const AABB result = built_tree.query(1.5f, total_time_t - 1.5f);
+
+            Assert::IsTrue(expected.min == result.min);
+            Assert::IsTrue(expected.max == result.max);
+        }
+
+        TEST_METHOD(matches_tree_while_sliding)
+        {
+            std::mt19937 generator(31);
+            std::uniform_real_distribution<float> step(-5.f, 5.f);
+            std::uniform_int_distribution<int> pops(0, 2);
+
+            std::deque<Segment> window;
+            Dynamic_Segment_Search_Tree dynamic_tree;
+
+            Vec2 point(0.f, 0.f);
+            Float total_time_t = 0.0f;
+
+            for (int i = 0; i < 150; i++)
+            {
+                const Vec2 next_point = point + Vec2(step(generator), step(generator));
+                window.push_back(Segment(point, next_point, total_time_t));
+                dynamic_tree.push_back(window.back());
+
+                total_time_t = window.back().end_t;
+                point = next_point;
+
+                //Pop one segment on average, so the window moves while its size changes
+                for (int j = pops(generator); j > 0 && window.size() > 1; j--)
+                {
+                    window.pop_front();
+                    dynamic_tree.pop_front();
+                }
+
+                Assert::AreEqual(window.size(), dynamic_tree.size());
+                Assert::IsTrue(window.front().start_t == dynamic_tree.get_segment(0).start_t);
+
+                //Compare against a tree built from scratch over the segments in the window
+                const std::vector<Segment> ordered_segments(window.begin(), window.end());
+                const std::vector<Segment_Kinematics> kinematics = build_segment_kinematics(ordered_segments);
+                const Segment_Search_Tree ss_tree(ordered_segments, &kinematics);
+
+                std::uniform_real_distribution<float> time(window.front().start_t.get_value(), total_time_t.get_value());
+
+                for (int j = 0; j < 20; j++)
+                {
+                    Float start_t = time(generator);
+                    Float end_t = time(generator);
+                    if (end_t < start_t) std::swap(start_t, end_t);
+
+                    const AABB expected = ss_tree.query(start_t, end_t);
+                    const AABB result = dynamic_tree.query(start_t, end_t);
+
+                    Assert::IsTrue(expected.min == result.min);
+                    Assert::IsTrue(expected.max == result.max);
+
+                    Assert::AreEqual(ss_tree.query(start_t), dynamic_tree.query(start_t));
+                }
+
+                const AABB all = dynamic_tree.query_segments(0, dynamic_tree.size() - 1).to_AABB();
+                const AABB expected_all = SIMD_AABB::from_segments(ordered_segments.data(), ordered_segments.size()).to_AABB();
+
+                Assert::IsTrue(expected_all.min == all.min);
+                Assert::IsTrue(expected_all.max == all.max);
+            }
+
+            while (!dynamic_tree.empty())
+            {
+                dynamic_tree.pop_front();
+            }
+
+            Assert::AreEqual(size_t(0), dynamic_tree.size());
+            Assert::IsTrue(dynamic_tree.query(0.f, 1.f).max_size() == 0.f);
+        }
+
+        TEST_METHOD(empty)
+        {
+            const Dynamic_Segment_Search_Tree tree;
+
+            Assert::IsTrue(tree.empty());
+            Assert::AreEqual(0, tree.query(1.f));
+            Assert::IsTrue(tree.query(0.f, 1.f).max_size() == 0.f);
+        }
+    };
+}
@@ -0,0 +1,112 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "../Trajectory_Hotspots/pch.h"
+#include "../Trajectory_Hotspots/vec2.h"
+#include "../Trajectory_Hotspots/trajectory.h"
+#include "../Trajectory_Hotspots/fixed_length_contiguous_stream.h"
+
+namespace Microsoft
+{
+    namespace VisualStudio
+    {
+        namespace CppUnitTestFramework
+        {
+            template<> inline std::wstring ToString<Float>(const class Float& t) { return L"Float"; }
+            template<> inline std::wstring ToString<Vec2>(const class Vec2& t) { return L"Vec2"; }
+        }
+    }
+}
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestTrajectoryHotspots
+{
+    TEST_CLASS(TestTrajectoryHotspotsFixedLengthContiguousStream)
+    {
+    public:
+
+        TEST_METHOD(curl)
+        {
+            //Same trajectory as get_hotspot_fixed_length_contiguous_curl, with times set to the length along the trajectory
+            const std::vector<Vec2> points = { { 4.f, 5.f }, { 2.f, 4.f }, { 5.f, 7.f }, { 8.f, 4.f }, { 10.f, 1.f } };
+
+            Fixed_Length_Contiguous_Stream stream(6.4787086646191f);
+
+            Float t = 0.f;
+            for (size_t i = 0; i < points.size(); i++)
+            {
+                if (i > 0)
+                {
+                    t += Segment(points[i - 1], points[i]).length();
+                }
+
+                Assert::IsTrue(stream.push_back(points[i], t));
+            }
+
+            const AABB hotspot = stream.get_hotspot();
+
+            Assert::IsTrue(hotspot.max_size() == 3.0f);
+            Assert::IsTrue(hotspot.min == Vec2(2.f, 4.f));
+            Assert::IsTrue(hotspot.max == Vec2(5.f, 7.f));
+
+            //Times must increase
+            Assert::IsFalse(stream.push_back(Vec2(11.f, 1.f), t));
+            Assert::AreEqual(points.size(), stream.get_vertex_count());
+        }
+
+        TEST_METHOD(matches_trajectory)
+        {
+            std::mt19937 generator(11);
+            std::uniform_real_distribution<float> step(-3.f, 3.f);
+            std::uniform_real_distribution<float> time_step(0.5f, 2.f);
+
+            const Float length = 12.f;
+            Fixed_Length_Contiguous_Stream stream(length);
+
+            std::vector<Vec2> points;
+            Vec2 position(0.f, 0.f);
+            Float time = 0.f;
+
+            for (size_t i = 0; i < 120; i++)
+            {
+                Assert::IsTrue(stream.push_back(position, time));
+
+                if (i % 17 == 5)
+                {
+                    //Standing still adds no segment
+                    time += 1.f;
+                    Assert::IsTrue(stream.push_back(position, time));
+                }
+
+                points.push_back(position);
+
+                if (points.size() > 1)
+                {
+                    //The stream gives the same hotspot as querying a trajectory of all vertices so far
+                    const Trajectory trajectory(points);
+                    const AABB expected = trajectory.get_hotspot_fixed_length_contiguous(length);
+
+                    Assert::AreEqual(expected.max_size(), stream.get_hotspot().max_size());
+                }
+
+                position = position + Vec2(step(generator), step(generator));
+                time += time_step(generator);
+            }
+
+            Assert::AreEqual(points.size(), stream.get_vertex_count());
+        }
+
+        TEST_METHOD(shorter_than_length)
+        {
+            Fixed_Length_Contiguous_Stream stream(10.f);
+
+            Assert::IsTrue(stream.push_back(Vec2(0.f, 0.f), 0.f));
+            Assert::IsTrue(stream.push_back(Vec2(3.f, 0.f), 3.f));
+
+            const AABB hotspot = stream.get_hotspot();
+            Assert::AreEqual(Vec2(0.f, 0.f), hotspot.min);
+            Assert::AreEqual(Vec2(0.f, 0.f), hotspot.max);
+        }
+    };
+}
@@ -0,0 +1,116 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "../Trajectory_Hotspots/pch.h"
+#include "../Trajectory_Hotspots/vec2.h"
+#include "../Trajectory_Hotspots/trajectory.h"
+#include "../Trajectory_Hotspots/fixed_radius_contiguous_stream.h"
+
+namespace Microsoft
+{
+    namespace VisualStudio
+    {
+        namespace CppUnitTestFramework
+        {
+            template<> inline std::wstring ToString<Float>(const class Float& t) { return L"Float"; }
+            template<> inline std::wstring ToString<Vec2>(const class Vec2& t) { return L"Vec2"; }
+        }
+    }
+}
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestTrajectoryHotspots
+{
+    TEST_CLASS(TestTrajectoryHotspotsFixedRadiusContiguousStream)
+    {
+    public:
+
+        TEST_METHOD(matches_trajectory)
+        {
+            std::mt19937 generator(3);
+            std::uniform_real_distribution<float> step(-3.f, 3.f);
+            std::uniform_real_distribution<float> time_step(0.5f, 2.f);
+
+            const Float radius = 6.f;
+            Fixed_Radius_Contiguous_Stream stream(radius);
+
+            std::vector<Segment> segments;
+            Vec2 position(0.f, 0.f);
+            Vec2 last_position;
+            Float time = 0.f;
+            Float last_time = 0.f;
+
+            for (size_t i = 0; i < 150; i++)
+            {
+                Assert::IsTrue(stream.push_back(position, time));
+
+                if (i > 0)
+                {
+                    segments.push_back(Segment(last_position, position, last_time, time));
+
+                    //The stream gives the same hotspot as querying a trajectory of all vertices so far
+                    //The crossing times can come from different segments at the same time, so the corners can be a few ulps apart
+                    const Trajectory trajectory(segments);
+                    const AABB expected = trajectory.get_hotspot_fixed_radius_contiguous(radius);
+                    const AABB result = stream.get_hotspot();
+
+                    Assert::IsTrue(fabs(expected.min.x.get_value() - result.min.x.get_value()) < 0.0001f);
+                    Assert::IsTrue(fabs(expected.min.y.get_value() - result.min.y.get_value()) < 0.0001f);
+                    Assert::IsTrue(fabs(expected.max.x.get_value() - result.max.x.get_value()) < 0.0001f);
+                    Assert::IsTrue(fabs(expected.max.y.get_value() - result.max.y.get_value()) < 0.0001f);
+                }
+
+                last_position = position;
+                last_time = time;
+
+                //Alternate between driving and waiting around a spot
+                const float scale = (i / 10) % 3 == 1 ? 0.01f : 1.f;
+                position = position + Vec2(step(generator) * scale, step(generator) * scale);
+                time += time_step(generator);
+            }
+
+            Assert::AreEqual(size_t(150), stream.get_vertex_count());
+        }
+
+        TEST_METHOD(dwell)
+        {
+            std::mt19937 generator(5);
+            std::uniform_real_distribution<float> jitter(-0.2f, 0.2f);
+
+            Fixed_Radius_Contiguous_Stream stream(2.f);
+
+            Assert::IsTrue(stream.get_hotspot().max_size() == 0.f);
+
+            float time = 0.f;
+
+            //Drive east, wait at (50, 0) for 60 seconds, and drive on
+            for (int i = 0; i < 50; i++, time += 1.f)
+            {
+                Assert::IsTrue(stream.push_back(Vec2(static_cast<float>(i), 0.f), time));
+            }
+
+            for (int i = 0; i < 60; i++, time += 1.f)
+            {
+                Assert::IsTrue(stream.push_back(Vec2(50.f + jitter(generator), jitter(generator)), time));
+            }
+
+            for (int i = 51; i < 100; i++, time += 1.f)
+            {
+                Assert::IsTrue(stream.push_back(Vec2(static_cast<float>(i), 0.f), time));
+            }
+
+            const AABB hotspot = stream.get_hotspot();
+
+            Assert::IsTrue(hotspot.max_size() <= 2.f);
+            Assert::IsTrue(hotspot.min.x <= 50.f && hotspot.max.x >= 50.f);
+            Assert::IsTrue(stream.get_hotspot_duration() >= 60.f);
+
+            //After driving away only the tests near the end can still grow
+            Assert::IsTrue(stream.get_open_test_count() < 10);
+
+            //Times must increase
+            Assert::IsFalse(stream.push_back(Vec2(100.f, 0.f), time - 1.f));
+        }
+    };
+}
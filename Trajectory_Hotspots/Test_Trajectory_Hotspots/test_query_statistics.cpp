@@ -0,0 +1,138 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "../Trajectory_Hotspots/pch.h"
+#include "../Trajectory_Hotspots/vec2.h"
+#include "../Trajectory_Hotspots/trajectory.h"
+#include "../Trajectory_Hotspots/trajectory_generator.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestTrajectoryHotspots
+{
+    TEST_CLASS(TestTrajectoryHotspotsQueryStatistics)
+    {
+    public:
+
+        TEST_METHOD(fixed_length_contiguous_statistics)
+        {
+            const Trajectory curl(std::vector<Vec2>{ { 4.f, 5.f }, { 2.f, 4.f }, { 5.f, 7.f }, { 8.f, 4.f }, { 10.f, 1.f } });
+
+            Query_Statistics statistics;
+            const AABB hotspot = curl.get_hotspot_fixed_length_contiguous(6.4787086646191f, statistics);
+
+            //Counting doesn't change the answer
+            const AABB plain_hotspot = curl.get_hotspot_fixed_length_contiguous(6.4787086646191f);
+            Assert::IsTrue(hotspot.min == plain_hotspot.min && hotspot.max == plain_hotspot.max);
+
+            if (!Query_Statistics::enabled)
+            {
+                Assert::AreEqual(uint64_t(0), statistics.tree_queries);
+                Assert::AreEqual(uint64_t(0), statistics.breakpoint_candidates[0]);
+                return;
+            }
+
+            Assert::IsTrue(statistics.tree_queries > 0);
+            Assert::IsTrue(statistics.tree_nodes_visited >= statistics.tree_queries);
+
+            //Every vertex is a type I and II breakpoint
+            Assert::IsTrue(statistics.breakpoint_candidates[0] > 0);
+            Assert::IsTrue(statistics.breakpoint_candidates[1] > 0);
+
+            for (size_t type = 0; type < Query_Statistics::breakpoint_type_count; type++)
+            {
+                Assert::IsTrue(statistics.breakpoint_accepted[type] <= statistics.breakpoint_candidates[type]);
+            }
+
+            //The query is deterministic, so are its counts, and a new scope starts from zero
+            Query_Statistics second_statistics;
+            curl.get_hotspot_fixed_length_contiguous(6.4787086646191f, second_statistics);
+            Assert::AreEqual(statistics.tree_queries, second_statistics.tree_queries);
+            Assert::AreEqual(statistics.breakpoint_candidates[0], second_statistics.breakpoint_candidates[0]);
+
+            //Nothing is counted outside of a scope
+            curl.get_hotspot_fixed_length_contiguous(6.4787086646191f);
+            Assert::AreEqual(statistics.tree_queries, second_statistics.tree_queries);
+        }
+
+        TEST_METHOD(fixed_radius_contiguous_statistics)
+        {
+            const Trajectory trajectory = generate_trajectory(Trajectory_Shape::vehicle, 200, 1).build_trajectory(true);
+
+            Query_Statistics statistics;
+            const AABB hotspot = trajectory.get_hotspot_fixed_radius_contiguous(2.f, statistics);
+            Assert::IsTrue(hotspot.max_size() <= 2.f);
+
+            if (!Query_Statistics::enabled)
+            {
+                Assert::AreEqual(uint64_t(0), statistics.map_queries);
+                Assert::AreEqual(uint64_t(0), statistics.radius_candidates);
+                return;
+            }
+
+            Assert::IsTrue(statistics.tree_queries > 0);
+            Assert::IsTrue(statistics.map_nodes > 0);
+            Assert::IsTrue(statistics.map_queries > 0);
+            Assert::IsTrue(statistics.radius_candidates > 0);
+            Assert::IsTrue(statistics.radius_rejected <= statistics.radius_candidates);
+
+            Assert::IsTrue(statistics.map_query_depth_max > 0);
+            Assert::IsTrue(statistics.get_average_map_query_depth() <= static_cast<double>(statistics.map_query_depth_max));
+        }
+
+        TEST_METHOD(fixed_radius_contiguous_whole_trajectory_statistics)
+        {
+            const Trajectory trajectory = generate_trajectory(Trajectory_Shape::vehicle, 200, 1).build_trajectory(true);
+            const AABB trajectory_bounding_box = SIMD_AABB::from_segments(trajectory.get_ordered_trajectory_segments().data(), trajectory.get_ordered_trajectory_segments().size()).to_AABB();
+
+            //A radius larger than the trajectory returns its bounding box without building the tree or the maps
+            Query_Statistics statistics;
+            const AABB hotspot = trajectory.get_hotspot_fixed_radius_contiguous(trajectory_bounding_box.max_size() + 1.f, statistics);
+
+            Assert::IsTrue(hotspot.min == trajectory_bounding_box.min);
+            Assert::IsTrue(hotspot.max == trajectory_bounding_box.max);
+
+            Assert::AreEqual(uint64_t(0), statistics.tree_queries);
+            Assert::AreEqual(uint64_t(0), statistics.map_nodes);
+            Assert::AreEqual(uint64_t(0), statistics.map_queries);
+            Assert::AreEqual(uint64_t(0), statistics.radius_candidates);
+        }
+
+        TEST_METHOD(memory_statistics_per_phase)
+        {
+            const Trajectory trajectory = generate_trajectory(Trajectory_Shape::random_walk, 200, 1).build_trajectory(true);
+
+            Query_Statistics statistics;
+            trajectory.get_hotspot_fixed_radius_contiguous(2.f, statistics);
+
+            const Memory_Statistics& tree_memory = statistics.get_memory(Query_Phase::tree_build);
+            const Memory_Statistics& map_memory = statistics.get_memory(Query_Phase::map_build);
+
+            if (!Query_Statistics::enabled)
+            {
+                Assert::AreEqual(uint64_t(0), tree_memory.allocations);
+                Assert::AreEqual(uint64_t(0), statistics.peak_live_bytes);
+                return;
+            }
+
+            //A node per tree node, and the map nodes with the projected segments
+            Assert::IsTrue(tree_memory.allocations >= 199);
+            Assert::IsTrue(map_memory.allocations > tree_memory.allocations);
+
+            //The tree is alive while the maps are built, so it counts towards their peak
+            Assert::IsTrue(tree_memory.peak_live_bytes <= tree_memory.bytes);
+            Assert::IsTrue(map_memory.peak_live_bytes > tree_memory.peak_live_bytes);
+            Assert::AreEqual(map_memory.peak_live_bytes, statistics.peak_live_bytes);
+
+            //Everything is freed at the end of the query
+            Assert::AreEqual(int64_t(0), statistics.live_bytes);
+
+            //Adding keeps the largest peak
+            Query_Statistics total;
+            total.add(statistics);
+            total.add(statistics);
+            Assert::AreEqual(2 * tree_memory.allocations, total.get_memory(Query_Phase::tree_build).allocations);
+            Assert::AreEqual(statistics.peak_live_bytes, total.peak_live_bytes);
+        }
+    };
+}
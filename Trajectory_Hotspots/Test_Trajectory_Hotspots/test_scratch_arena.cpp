@@ -0,0 +1,161 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "../Trajectory_Hotspots/pch.h"
+#include "../Trajectory_Hotspots/vec2.h"
+#include "../Trajectory_Hotspots/trajectory.h"
+#include "../Trajectory_Hotspots/trajectory_generator.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestTrajectoryHotspots
+{
+    TEST_CLASS(TestTrajectoryHotspotsScratchArena)
+    {
+    public:
+
+        TEST_METHOD(allocate_and_reset)
+        {
+            Scratch_Arena arena(256);
+
+            void* first = arena.allocate(1);
+            void* second = arena.allocate(24);
+
+            Assert::IsTrue(reinterpret_cast<uintptr_t>(first) % Scratch_Arena::alignment == 0);
+            Assert::IsTrue(reinterpret_cast<uintptr_t>(second) % Scratch_Arena::alignment == 0);
+            Assert::IsTrue(first != second);
+            Assert::IsTrue(arena.owns(first) && arena.owns(second));
+
+            //Larger than the first chunk, the arena grows by another chunk
+            void* large = arena.allocate(1000);
+            Assert::IsTrue(arena.owns(large));
+            Assert::AreEqual(size_t(2), arena.get_chunk_count());
+
+            const size_t capacity = arena.get_capacity();
+
+            //Resetting merges the chunks, the same allocations then fit in one
+            arena.reset();
+            Assert::AreEqual(size_t(1), arena.get_chunk_count());
+            Assert::AreEqual(capacity, arena.get_capacity());
+            Assert::AreEqual(size_t(0), arena.get_used_bytes());
+
+            first = arena.allocate(1);
+            arena.allocate(24);
+            arena.allocate(1000);
+            Assert::AreEqual(size_t(1), arena.get_chunk_count());
+
+            int not_in_arena = 0;
+            Assert::IsFalse(arena.owns(&not_in_arena));
+        }
+
+        TEST_METHOD(scope_routes_hooked_allocations)
+        {
+            Scratch_Arena arena;
+
+            const std::vector<Segment> segments = generate_trajectory(Trajectory_Shape::random_walk, 200, 1).build_trajectory(true).get_ordered_trajectory_segments();
+
+            //Allocated before the scope, so it is freed with operator delete inside it
+            Hooked_Vector<int>* outside = new Hooked_Vector<int>(100, 1);
+
+            {
+                const Scratch_Arena_Scope scope(arena);
+
+                Hooked_Vector<int> values;
+                for (int i = 0; i < 1000; i++)
+                {
+                    values.push_back(i);
+                }
+
+                Assert::IsTrue(arena.owns(values.data()));
+
+                const Segment_Search_Tree tree(segments);
+                Assert::IsTrue(arena.owns(tree.root.left.get()));
+
+                delete outside;
+            }
+
+            const size_t used_bytes = arena.get_used_bytes();
+            Assert::IsTrue(used_bytes > 0);
+
+            //Outside of the scope the arena isn't used
+            Hooked_Vector<int> values(1000, 1);
+            Assert::IsFalse(arena.owns(values.data()));
+            Assert::AreEqual(used_bytes, arena.get_used_bytes());
+
+            arena.reset();
+            Assert::AreEqual(size_t(0), arena.get_used_bytes());
+        }
+
+        TEST_METHOD(rewind_to_marker)
+        {
+            Scratch_Arena arena(256);
+
+            void* kept = arena.allocate(64);
+            const Scratch_Arena::Marker marker = arena.get_marker();
+            const size_t used_bytes = arena.get_used_bytes();
+
+            void* first = arena.allocate(100);
+            arena.allocate(1000);
+            Assert::AreEqual(size_t(2), arena.get_chunk_count());
+
+            //Rewinding keeps the chunks, the same allocations reuse the same memory
+            arena.rewind(marker);
+            Assert::AreEqual(used_bytes, arena.get_used_bytes());
+            Assert::IsTrue(arena.owns(kept));
+
+            Assert::IsTrue(arena.allocate(100) == first);
+            arena.allocate(1000);
+            Assert::AreEqual(size_t(2), arena.get_chunk_count());
+        }
+
+        TEST_METHOD(queries_reuse_arena)
+        {
+            const Trajectory trajectory = generate_trajectory(Trajectory_Shape::random_walk, 500, 1).build_trajectory(true);
+
+            const AABB radius_hotspot = trajectory.get_hotspot_fixed_radius_contiguous(2.f);
+            const AABB length_hotspot = trajectory.get_hotspot_fixed_length_contiguous(10.f);
+
+            Scratch_Arena arena(1024);
+
+            //Memory of the caller before the queries stays allocated
+            void* kept = arena.allocate(64);
+            const size_t used_bytes = arena.get_used_bytes();
+
+            //The first queries grow the arena
+            trajectory.get_hotspot_fixed_radius_contiguous(2.f, &arena);
+            trajectory.get_hotspot_fixed_length_contiguous(10.f, &arena);
+            Assert::AreEqual(used_bytes, arena.get_used_bytes());
+
+            const size_t capacity = arena.get_capacity();
+
+            size_t allocations = 0;
+
+            Allocation_Hook hook;
+            hook.allocate = [](size_t bytes, void* context) { (*static_cast<size_t*>(context))++; return ::operator new(bytes); };
+            hook.deallocate = [](void* memory, size_t, void*) { ::operator delete(memory); };
+            hook.context = &allocations;
+
+            set_allocation_hook(hook);
+
+            //After that no temporary of the queries leaves the arena, and it doesn't grow anymore
+            for (int i = 0; i < 3; i++)
+            {
+                const AABB arena_radius_hotspot = trajectory.get_hotspot_fixed_radius_contiguous(2.f, &arena);
+                const AABB arena_length_hotspot = trajectory.get_hotspot_fixed_length_contiguous(10.f, &arena);
+
+                Assert::IsTrue(arena_radius_hotspot.min == radius_hotspot.min && arena_radius_hotspot.max == radius_hotspot.max);
+                Assert::IsTrue(arena_length_hotspot.min == length_hotspot.min && arena_length_hotspot.max == length_hotspot.max);
+            }
+
+            set_allocation_hook(Allocation_Hook());
+
+            Assert::AreEqual(size_t(0), allocations);
+            Assert::AreEqual(capacity, arena.get_capacity());
+            Assert::AreEqual(used_bytes, arena.get_used_bytes());
+            Assert::IsTrue(arena.owns(kept));
+
+            //The arena of the thread is the same one on every call
+            Assert::IsTrue(&get_thread_scratch_arena() == &get_thread_scratch_arena());
+        }
+    };
+}
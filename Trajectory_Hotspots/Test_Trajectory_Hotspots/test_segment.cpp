@@ -10,9 +10,9 @@ namespace Microsoft
     {
         namespace CppUnitTestFramework
         {
-            template<> static std::wstring ToString<Float>(class Float* t) { return L"Float"; }
-            template<> static std::wstring ToString<Float>(const class Float& t) { return L"Float"; }
-            template<> static std::wstring ToString<Vec2>(const class Vec2& t) { return L"Vec2"; }
+            template<> inline std::wstring ToString<Float>(class Float* t) { return L"Float"; }
+            template<> inline std::wstring ToString<Float>(const class Float& t) { return L"Float"; }
+            template<> inline std::wstring ToString<Vec2>(const class Vec2& t) { return L"Vec2"; }
         }
     }
 }
@@ -193,6 +193,44 @@ namespace TestTrajectoryHotspots
             Assert::AreEqual(result_point, Vec2(7.f, 13.5f));
         }
 
+        TEST_METHOD(get_kinematics)
+        {
+            Segment segment(Vec2(-4.f, -5.f), Vec2(4.f, 23.f), 10.f);
+
+            Segment_Kinematics kinematics = segment.get_kinematics();
+
+            Assert::AreEqual(kinematics.dx, Float(8.f));
+            Assert::AreEqual(kinematics.dy, Float(28.f));
+            Assert::AreEqual(kinematics.dt, segment.length());
+
+            Assert::AreEqual(kinematics.inverse_dx, Float(0.125f));
+            Assert::AreEqual(kinematics.inverse_dy, Float(1.f / 28.f));
+            Assert::AreEqual(kinematics.inverse_dt, Float(1.f) / segment.length());
+
+            Assert::AreEqual(kinematics.length, segment.length());
+            Assert::AreEqual(kinematics.inverse_length, Float(1.f) / segment.length());
+        }
+
+        TEST_METHOD(get_time_and_point_with_kinematics)
+        {
+            Segment segment(Vec2(4.f, 10.f), Vec2(30.f, 20.f), 10.f);
+            Segment_Kinematics kinematics = segment.get_kinematics();
+
+            Assert::AreEqual(segment.get_time_at_x(12.f, kinematics), Float(18.5713158628825f));
+            Assert::AreEqual(segment.get_time_at_y(16.f, kinematics), segment.get_time_at_y(16.f));
+
+            Segment point_segment(Vec2(-4.f, -5.f), Vec2(4.f, 23.f), 10.f);
+            Segment_Kinematics point_kinematics = point_segment.get_kinematics();
+
+            Assert::AreEqual(point_segment.get_time_at_point(Vec2(2.f, 16.f), point_kinematics), Float(31.840329667841554813291907474581f));
+
+            Segment time_segment(Vec2(-14.f, -15.f), Vec2(14.f, 23.f), 2.f);
+            Segment_Kinematics time_kinematics = time_segment.get_kinematics();
+
+            Vec2 result_point = time_segment.get_point_at_time(37.401271163617839783622493448623f, time_kinematics);
+            Assert::AreEqual(result_point, Vec2(7.f, 13.5f));
+        }
+
         TEST_METHOD(get_bottom_point)
         {
             Vec2 top_point(14.f, 23.f);
@@ -0,0 +1,205 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "../Trajectory_Hotspots/pch.h"
+#include "../Trajectory_Hotspots/vec2.h"
+#include "../Trajectory_Hotspots/segment.h"
+#include "../Trajectory_Hotspots/segment_batch.h"
+
+namespace Microsoft
+{
+    namespace VisualStudio
+    {
+        namespace CppUnitTestFramework
+        {
+            template<> inline std::wstring ToString<Float>(const class Float& t) { return L"Float"; }
+            template<> inline std::wstring ToString<Vec2>(const class Vec2& t) { return L"Vec2"; }
+        }
+    }
+}
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestTrajectoryHotspots
+{
+    TEST_CLASS(TestTrajectoryHotspotsSegmentBatch)
+    {
+    public:
+
+        //More than eight lanes so both the vectorized loop and the scalar tail are used
+        TEST_METHOD(batch_x_intersects_matches_segment)
+        {
+            std::vector<Segment> segments;
+            std::vector<float> lines;
+
+            build_test_lanes(segments, lines);
+
+            Segment_Batch batch;
+            for (const Segment& segment : segments)
+            {
+                batch.push_back(segment, segment.get_kinematics());
+            }
+
+            Axis_Intersection_Batch result;
+            batch_x_intersects(batch, lines.data(), result);
+
+            Assert::AreEqual(segments.size(), result.size());
+
+            for (size_t i = 0; i < segments.size(); i++)
+            {
+                Float intersection_y;
+                const bool hit = segments[i].x_intersects(lines[i], intersection_y);
+
+                Assert::AreEqual(hit, result.hits[i] == 1);
+
+                if (hit)
+                {
+                    Assert::AreEqual(intersection_y, Float(result.intersections[i]));
+                }
+
+                //The time is only defined if the segment does not lie on the line
+                if (hit && !isinf(intersection_y.get_value()))
+                {
+                    Assert::AreEqual(segments[i].get_time_at_x(lines[i], segments[i].get_kinematics()), Float(result.times[i]));
+                }
+            }
+        }
+
+        TEST_METHOD(batch_y_intersects_matches_segment)
+        {
+            std::vector<Segment> segments;
+            std::vector<float> lines;
+
+            build_test_lanes(segments, lines);
+
+            Segment_Batch batch;
+            for (const Segment& segment : segments)
+            {
+                batch.push_back(segment, segment.get_kinematics());
+            }
+
+            Axis_Intersection_Batch result;
+            batch_y_intersects(batch, lines.data(), result);
+
+            for (size_t i = 0; i < segments.size(); i++)
+            {
+                Float intersection_x;
+                const bool hit = segments[i].y_intersects(lines[i], intersection_x);
+
+                Assert::AreEqual(hit, result.hits[i] == 1);
+
+                if (hit)
+                {
+                    Assert::AreEqual(intersection_x, Float(result.intersections[i]));
+                }
+
+                //The time is only defined if the segment does not lie on the line
+                if (hit && !isinf(intersection_x.get_value()))
+                {
+                    Assert::AreEqual(segments[i].get_time_at_y(lines[i], segments[i].get_kinematics()), Float(result.times[i]));
+                }
+            }
+        }
+
+        TEST_METHOD(batch_single_line)
+        {
+            Segment_Batch batch;
+
+            std::vector<Segment> segments;
+            for (int i = 0; i < 11; i++)
+            {
+                segments.emplace_back(Vec2(float(i), 0.f), Vec2(float(i) + 1.f, 2.f), float(i), float(i) + 1.f);
+                batch.push_back(segments.back(), segments.back().get_kinematics());
+            }
+
+            Axis_Intersection_Batch result;
+            batch_x_intersects(batch, 4.5f, result);
+
+            for (size_t i = 0; i < segments.size(); i++)
+            {
+                Assert::AreEqual(i == 4, result.hits[i] == 1);
+            }
+
+            Assert::AreEqual(Float(1.f), Float(result.intersections[4]));
+            Assert::AreEqual(Float(4.5f), Float(result.times[4]));
+        }
+
+        TEST_METHOD(batch_points_on_same_axis_matches_segment)
+        {
+            Segment start_segment(Vec2(2.f, 10.f), Vec2(6.f, 2.f), 0.f);
+
+            //End segments all starting 10 after the start segment, on both sides of it on both axes
+            const std::vector<Vec2> points = {
+                Vec2(10.f, 4.f), Vec2(18.f, 12.f), Vec2(16.5f, 10.f), Vec2(13.3f, 0.8f), Vec2(4.f, 13.f),
+                Vec2(-3.f, 6.f), Vec2(1.f, 16.f), Vec2(8.f, 8.f), Vec2(8.f, -2.f), Vec2(-4.f, 3.f), Vec2(5.f, 5.f), Vec2(11.f, 14.f)
+            };
+
+            std::vector<Segment> end_segments;
+            for (size_t i = 0; i + 1 < points.size(); i++)
+            {
+                end_segments.emplace_back(points[i], points[i + 1], start_segment.end_t + 10.f);
+            }
+
+            Segment_Batch batch;
+            for (const Segment& segment : end_segments)
+            {
+                batch.push_back(segment, segment.get_kinematics());
+            }
+
+            const Float length = 17.f;
+
+            for (const bool axis : { true, false })
+            {
+                Same_Axis_Point_Batch result;
+                batch_points_on_same_axis_with_distance_l(start_segment, start_segment.get_kinematics(), batch, length, axis, result);
+
+                Assert::AreEqual(end_segments.size(), result.size());
+
+                size_t hit_count = 0;
+
+                for (size_t i = 0; i < end_segments.size(); i++)
+                {
+                    Vec2 p, q;
+                    const bool hit = Segment::get_points_on_same_axis_with_distance_l(start_segment, end_segments[i], length, axis, p, q);
+
+                    Assert::AreEqual(hit, result.hits[i] == 1);
+
+                    if (hit)
+                    {
+                        hit_count++;
+
+                        Assert::AreEqual(p, Vec2(result.start_x[i], result.start_y[i]));
+                        Assert::AreEqual(q, Vec2(result.end_x[i], result.end_y[i]));
+
+                        Assert::AreEqual(start_segment.get_time_at_point(p, start_segment.get_kinematics()), Float(result.start_times[i]));
+                        Assert::AreEqual(end_segments[i].get_time_at_point(q, end_segments[i].get_kinematics()), Float(result.end_times[i]));
+                    }
+                }
+
+                Assert::IsTrue(hit_count > 0);
+            }
+        }
+
+    private:
+
+        //Mix of hits, misses, lines through endpoints, and segments lying on the line
+        void build_test_lanes(std::vector<Segment>& segments, std::vector<float>& lines)
+        {
+            segments = {
+                Segment(Vec2(0.f, 0.f), Vec2(4.f, 2.f), 0.f, 2.f),
+                Segment(Vec2(4.f, 2.f), Vec2(1.f, 6.f), 2.f, 7.f),
+                Segment(Vec2(1.f, 6.f), Vec2(1.f, -3.f), 7.f, 9.f),
+                Segment(Vec2(1.f, -3.f), Vec2(-5.f, -3.f), 9.f, 10.f),
+                Segment(Vec2(-5.f, -3.f), Vec2(2.5f, 7.5f), 10.f, 12.5f),
+                Segment(Vec2(2.5f, 7.5f), Vec2(3.f, 7.f), 12.5f, 13.f),
+                Segment(Vec2(3.f, 7.f), Vec2(-2.f, 1.f), 13.f, 20.f),
+                Segment(Vec2(-2.f, 1.f), Vec2(0.5f, 1.5f), 20.f, 21.f),
+                Segment(Vec2(0.5f, 1.5f), Vec2(6.f, -4.f), 21.f, 25.f),
+                Segment(Vec2(6.f, -4.f), Vec2(6.f, -4.f), 25.f, 26.f),
+                Segment(Vec2(6.f, -4.f), Vec2(-1.f, 3.f), 26.f, 30.f),
+            };
+
+            lines = { 1.f, 2.f, 1.f, -3.f, 0.f, 9.f, 2.5f, 0.5f, 3.f, 6.f, -1.f };
+        }
+    };
+}
@@ -79,6 +79,129 @@ namespace TestTrajectoryHotspots
 
         }
 
+        TEST_METHOD(flat_tree_matches_tree)
+        {
+            std::mt19937 generator(17);
+            std::uniform_real_distribution<float> step(-5.f, 5.f);
+
+            std::vector<Vec2> ordered_points;
+            Vec2 point(0.f, 0.f);
+            for (int i = 0; i < 37; i++)
+            {
+                ordered_points.push_back(point);
+                point = point + Vec2(step(generator), step(generator));
+            }
+
+            std::vector<Segment> ordered_segments;
+            Float total_time_t = 0.0f;
+            for (size_t i = 0; i < ordered_points.size() - 1; i++)
+            {
+                ordered_segments.push_back(Segment(ordered_points.at(i), ordered_points.at(i + 1), total_time_t));
+                total_time_t = ordered_segments.back().end_t;
+            }
+
+            //The flat tree interpolates like a tree with the kinematics of the segments
+            const std::vector<Segment_Kinematics> kinematics = build_segment_kinematics(ordered_segments);
+            Segment_Search_Tree ss_tree(ordered_segments, &kinematics);
+
+            const std::vector<Flat_Segment_Search_Tree_Node> nodes = Flat_Segment_Search_Tree::build_nodes(ordered_segments);
+            Flat_Segment_Search_Tree flat_tree(nodes.data(), nodes.size());
+
+            Assert::AreEqual(ordered_segments.size() * 2 - 1, nodes.size());
+
+            std::uniform_real_distribution<float> time(0.f, total_time_t.get_value());
+
+            for (int i = 0; i < 200; i++)
+            {
+                Float start_t = time(generator);
+                Float end_t = time(generator);
+                if (end_t < start_t) std::swap(start_t, end_t);
+
+                const AABB expected = ss_tree.query(start_t, end_t);
+                const AABB result = flat_tree.query(start_t, end_t);
+
+                Assert::IsTrue(expected.min == result.min);
+                Assert::IsTrue(expected.max == result.max);
+
+                Assert::AreEqual(ss_tree.query(start_t), flat_tree.query(start_t));
+            }
+        }
+
+        TEST_METHOD(tree_query_range_ends_in_left_child)
+        {
+            //Flat, then a steep last segment, so a box that wrongly reaches into the last segment is taller than the range
+            const std::vector<Vec2> ordered_points = { { 0.f, 0.f }, { 1.f, 0.f }, { 2.f, 0.f }, { 3.f, 0.f }, { 4.f, 10.f } };
+
+            std::vector<Segment> ordered_segments;
+            Float total_time_t = 0.0f;
+            for (size_t i = 0; i < ordered_points.size() - 1; i++)
+            {
+                ordered_segments.push_back(Segment(ordered_points.at(i), ordered_points.at(i + 1), total_time_t));
+                total_time_t = ordered_segments.back().end_t;
+            }
+
+            Segment_Search_Tree ss_tree(ordered_segments);
+
+            const std::vector<Flat_Segment_Search_Tree_Node> nodes = Flat_Segment_Search_Tree::build_nodes(ordered_segments);
+            Flat_Segment_Search_Tree flat_tree(nodes.data(), nodes.size());
+
+            //Starts in the left half and ends in the third segment, the left child of the right half
+            const AABB expected(Vec2(1.5f, 0.f), Vec2(2.5f, 0.f));
+
+            const AABB result = ss_tree.query(1.5f, 2.5f);
+            Assert::IsTrue(expected.min == result.min);
+            Assert::IsTrue(expected.max == result.max);
+
+            const AABB flat_result = flat_tree.query(1.5f, 2.5f);
+            Assert::IsTrue(expected.min == flat_result.min);
+            Assert::IsTrue(expected.max == flat_result.max);
+        }
+
+        TEST_METHOD(tree_query_matches_vertices)
+        {
+            std::mt19937 generator(23);
+            std::uniform_real_distribution<float> step(-5.f, 5.f);
+
+            std::vector<Segment> ordered_segments;
+            Vec2 point(0.f, 0.f);
+            Float total_time_t = 0.0f;
+            for (int i = 0; i < 29; i++)
+            {
+                const Vec2 next_point = point + Vec2(step(generator), step(generator));
+                ordered_segments.push_back(Segment(point, next_point, total_time_t));
+                total_time_t = ordered_segments.back().end_t;
+                point = next_point;
+            }
+
+            Segment_Search_Tree ss_tree(ordered_segments);
+
+            std::uniform_real_distribution<float> time(0.f, total_time_t.get_value());
+
+            for (int i = 0; i < 200; i++)
+            {
+                Float start_t = time(generator);
+                Float end_t = time(generator);
+                if (end_t < start_t) std::swap(start_t, end_t);
+
+                //The box of the points at the ends of the range and all vertices in between
+                const int start_index = ss_tree.query(start_t);
+                const int end_index = ss_tree.query(end_t);
+
+                AABB expected(ordered_segments[start_index].get_point_at_time(start_t), ordered_segments[start_index].get_point_at_time(start_t));
+                expected.augment(ordered_segments[end_index].get_point_at_time(end_t));
+
+                for (int j = start_index + 1; j <= end_index; j++)
+                {
+                    expected.augment(ordered_segments[j].start);
+                }
+
+                const AABB result = ss_tree.query(start_t, end_t);
+
+                Assert::IsTrue(expected.min == result.min);
+                Assert::IsTrue(expected.max == result.max);
+            }
+        }
+
         TEST_METHOD(tree_destruction)
         {
 
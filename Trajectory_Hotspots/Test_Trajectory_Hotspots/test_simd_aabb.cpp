@@ -0,0 +1,90 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "../Trajectory_Hotspots/pch.h"
+#include "../Trajectory_Hotspots/vec2.h"
+#include "../Trajectory_Hotspots/segment.h"
+#include "../Trajectory_Hotspots/simd_aabb.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestTrajectoryHotspots
+{
+    TEST_CLASS(TestTrajectoryHotspotsSIMDAABB)
+    {
+    public:
+
+        TEST_METHOD(segment_construction)
+        {
+            Segment segment(Vec2(4.2f, -2.8f), Vec2(-6.3f, 3.1f));
+
+            AABB aabb = SIMD_AABB(segment).to_AABB();
+
+            Assert::IsTrue(aabb.min == Vec2(-6.3f, -2.8f));
+            Assert::IsTrue(aabb.max == Vec2(4.2f, 3.1f));
+        }
+
+        TEST_METHOD(aabb_round_trip)
+        {
+            AABB aabb(-1.5f, 2.25f, 3.75f, 8.f);
+
+            AABB result = SIMD_AABB(aabb).to_AABB();
+
+            Assert::IsTrue(result.min == aabb.min);
+            Assert::IsTrue(result.max == aabb.max);
+        }
+
+        TEST_METHOD(combine)
+        {
+            SIMD_AABB a(Vec2(0.f, 0.f), Vec2(2.f, 3.f));
+            SIMD_AABB b(Vec2(-1.f, 1.f), Vec2(1.f, 5.f));
+
+            AABB combined = SIMD_AABB::combine(a, b).to_AABB();
+
+            Assert::IsTrue(combined.min == Vec2(-1.f, 0.f));
+            Assert::IsTrue(combined.max == Vec2(2.f, 5.f));
+
+            //Combining with an empty box leaves the box unchanged
+            a.combine(SIMD_AABB());
+            AABB unchanged = a.to_AABB();
+
+            Assert::IsTrue(unchanged.min == Vec2(0.f, 0.f));
+            Assert::IsTrue(unchanged.max == Vec2(2.f, 3.f));
+        }
+
+        TEST_METHOD(augment)
+        {
+            SIMD_AABB simd_aabb(Vec2(0.f, 0.f), Vec2(1.f, 1.f));
+
+            simd_aabb.augment(Vec2(-3.f, 0.5f));
+            simd_aabb.augment(Vec2(0.5f, 7.f));
+
+            AABB aabb = simd_aabb.to_AABB();
+
+            Assert::IsTrue(aabb.min == Vec2(-3.f, 0.f));
+            Assert::IsTrue(aabb.max == Vec2(1.f, 7.f));
+        }
+
+        TEST_METHOD(from_segments)
+        {
+            std::vector<Vec2> points = { { 4.2f, 2.8f }, { 6.3f, 3.1f }, { 2.422f, 7.442f }, { 9.4822f, 12.6492f }, { 1.2321f, 0.231f }, { -3.321f, -3.2323f } };
+
+            std::vector<Segment> segments;
+            for (size_t i = 0; i < points.size() - 1; i++)
+            {
+                segments.emplace_back(points[i], points[i + 1]);
+            }
+
+            //Odd and even counts take different paths through the reduction
+            AABB all = SIMD_AABB::from_segments(segments.data(), segments.size()).to_AABB();
+
+            Assert::IsTrue(all.min == Vec2(-3.321f, -3.2323f));
+            Assert::IsTrue(all.max == Vec2(9.4822f, 12.6492f));
+
+            AABB first_two = SIMD_AABB::from_segments(segments.data(), 2).to_AABB();
+
+            Assert::IsTrue(first_two.min == Vec2(2.422f, 2.8f));
+            Assert::IsTrue(first_two.max == Vec2(6.3f, 7.442f));
+        }
+    };
+}
@@ -0,0 +1,97 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "../Trajectory_Hotspots/pch.h"
+#include "../Trajectory_Hotspots/vec2.h"
+#include "../Trajectory_Hotspots/trajectory.h"
+#include "../Trajectory_Hotspots/trajectory_generator.h"
+
+#include <sstream>
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestTrajectoryHotspots
+{
+    TEST_CLASS(TestTrajectoryHotspotsTrace)
+    {
+    public:
+
+        TEST_METHOD(disabled_spans_record_nothing)
+        {
+            set_tracing_enabled(false);
+            clear_trace();
+
+            const Trajectory trajectory = generate_trajectory(Trajectory_Shape::random_walk, 100, 1).build_trajectory(true);
+            trajectory.get_hotspot_fixed_radius_contiguous(2.f);
+
+            Assert::AreEqual(size_t(0), get_trace_event_count());
+        }
+
+        TEST_METHOD(query_phases_are_traced)
+        {
+            const Trajectory radius_trajectory = generate_trajectory(Trajectory_Shape::random_walk, 100, 1).build_trajectory(true);
+            const Trajectory length_trajectory = generate_trajectory(Trajectory_Shape::random_walk, 100, 1).build_trajectory(false);
+
+            clear_trace();
+            set_tracing_enabled(true);
+
+            radius_trajectory.get_hotspot_fixed_radius_contiguous(2.f);
+            length_trajectory.get_hotspot_fixed_length_contiguous(5.f);
+
+            //A query on another thread gets its own track
+            std::thread worker([&radius_trajectory]() { radius_trajectory.get_hotspot_fixed_radius_contiguous(3.f); });
+            worker.join();
+
+            set_tracing_enabled(false);
+
+            //Query, tree, and per axis reprojection, map and vertex loop for the radius queries, query, tree and two breakpoint loops for the length query
+            Assert::AreEqual(size_t(2 * 8 + 4), get_trace_event_count());
+
+            std::ostringstream output;
+            write_chrome_trace(output);
+            const std::string trace = output.str();
+
+            for (const char* name : { "fixed_radius_contiguous", "frc_tree_build", "frc_reprojection_x", "frc_map_build_y", "frc_vertex_loop_x",
+                "fixed_length_contiguous", "flc_tree_build", "flc_breakpoints_I_II", "flc_breakpoints_III_IV_V" })
+            {
+                Assert::IsTrue(trace.find(std::string("\"name\":\"") + name + "\"") != std::string::npos);
+            }
+
+            Assert::IsTrue(trace.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[") == 0);
+            Assert::AreEqual(size_t(2), count_occurrences(trace, "\"thread_name\""));
+            Assert::AreEqual(size_t(2 * 8 + 4), count_occurrences(trace, "\"ph\":\"X\""));
+
+            clear_trace();
+            Assert::AreEqual(size_t(0), get_trace_event_count());
+        }
+
+        TEST_METHOD(span_end_records_once)
+        {
+            clear_trace();
+            set_tracing_enabled(true);
+
+            {
+                Trace_Span span("phase");
+                span.end();
+            }
+
+            set_tracing_enabled(false);
+
+            Assert::AreEqual(size_t(1), get_trace_event_count());
+            clear_trace();
+        }
+
+    private:
+
+        static size_t count_occurrences(const std::string& text, const std::string& pattern)
+        {
+            size_t count = 0;
+            for (size_t position = text.find(pattern); position != std::string::npos; position = text.find(pattern, position + 1))
+            {
+                count++;
+            }
+            return count;
+        }
+    };
+}
@@ -5,6 +5,9 @@
 #include "../Trajectory_Hotspots/vec2.h"
 #include "../Trajectory_Hotspots/segment.h"
 #include "../Trajectory_Hotspots/trajectory.h"
+#include "../Trajectory_Hotspots/dynamic_segment_search_tree.h"
+#include "../Trajectory_Hotspots/trapezoidal_map.h"
+#include "../Trajectory_Hotspots/flat_trapezoidal_map.h"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -173,6 +176,114 @@ namespace TestTrajectoryHotspots
                Assert::IsTrue(aabb.max_size() > 0.f);
         }
 
+        TEST_METHOD(get_hotspot_fixed_radius_contiguous_corner)
+        {
+            std::vector<Vec2> trajectory_points;
+
+            trajectory_points.emplace_back(0.f, 0.f);
+            trajectory_points.emplace_back(10.f, 0.f);
+            trajectory_points.emplace_back(10.f, 10.f);
+
+            Trajectory trajectory(trajectory_points);
+
+            //The trapezoidal maps are built in a random order, query repeatedly so a result that depends on it shows up
+            for (int i = 0; i < 20; i++)
+            {
+                for (const float radius : { 3.f, 5.f, 9.f })
+                {
+                    AABB hotspot = trajectory.get_hotspot_fixed_radius_contiguous(radius);
+
+                    Assert::IsTrue(hotspot.max_size() > 0.f);
+                    Assert::IsTrue(hotspot.max_size() <= radius);
+                }
+            }
+        }
+
+        TEST_METHOD(get_hotspot_fixed_radius_contiguous_square)
+        {
+            std::vector<Vec2> trajectory_points;
+
+            trajectory_points.emplace_back(0.f, 0.f);
+            trajectory_points.emplace_back(10.f, 0.f);
+            trajectory_points.emplace_back(10.f, 10.f);
+            trajectory_points.emplace_back(0.f, 10.f);
+
+            Trajectory trajectory(trajectory_points);
+
+            for (int i = 0; i < 20; i++)
+            {
+                for (const float radius : { 3.f, 5.f, 9.f })
+                {
+                    AABB hotspot = trajectory.get_hotspot_fixed_radius_contiguous(radius);
+
+                    Assert::IsTrue(hotspot.max_size() > 0.f);
+                    Assert::IsTrue(hotspot.max_size() <= radius);
+                }
+            }
+        }
+
+        TEST_METHOD(get_hotspot_fixed_radius_contiguous_whole_trajectory)
+        {
+            std::vector<Vec2> trajectory_points;
+
+            trajectory_points.emplace_back(0.f, 0.f);
+            trajectory_points.emplace_back(10.f, 0.f);
+            trajectory_points.emplace_back(10.f, 10.f);
+
+            Trajectory trajectory(trajectory_points);
+            const Dynamic_Segment_Search_Tree segment_tree(trajectory.get_ordered_trajectory_segments());
+
+            //A radius at least the size of the trajectory gives the bounding box of the whole trajectory
+            for (const float radius : { 10.f, 25.f })
+            {
+                for (const AABB& hotspot : { trajectory.get_hotspot_fixed_radius_contiguous(radius), trajectory.get_hotspot_fixed_radius_contiguous(radius, segment_tree) })
+                {
+                    Assert::AreEqual(0.f, hotspot.min.x.get_value());
+                    Assert::AreEqual(0.f, hotspot.min.y.get_value());
+                    Assert::AreEqual(10.f, hotspot.max.x.get_value());
+                    Assert::AreEqual(10.f, hotspot.max.y.get_value());
+                }
+            }
+        }
+
+        TEST_METHOD(fixed_radius_contiguous_square_trace_independent_of_build_order)
+        {
+            //The square projected to the (t, x) plane, the middle segment is horizontal
+            std::vector<Segment> projected_segments;
+            projected_segments.emplace_back(Vec2(0.f, 0.f), Vec2(10.f, 10.f), 0.f, 10.f);
+            projected_segments.emplace_back(Vec2(10.f, 10.f), Vec2(20.f, 10.f), 10.f, 20.f);
+            projected_segments.emplace_back(Vec2(20.f, 10.f), Vec2(30.f, 0.f), 20.f, 30.f);
+
+            //A vertex, a point on the horizontal segment and a point one radius below the vertex
+            const std::vector<Vec2> trace_points = { Vec2(10.f, 10.f), Vec2(15.f, 10.f), Vec2(20.f, 10.f), Vec2(10.f, 7.f) };
+
+            for (unsigned int seed = 1; seed <= 50; seed++)
+            {
+                Trapezoidal_Map trapezoidal_map(projected_segments, seed);
+
+                const Flat_Trapezoidal_Map_Data data = Flat_Trapezoidal_Map::build_data(trapezoidal_map);
+                const Flat_Trapezoidal_Map flat_map(data);
+
+                for (const Vec2& trace_point : trace_points)
+                {
+                    //Tracing just below the horizontal line hits the rising and falling segments
+                    const Segment* left_segment = nullptr;
+                    const Segment* right_segment = nullptr;
+                    trapezoidal_map.trace_left_right(trace_point, false, left_segment, right_segment);
+
+                    Assert::IsTrue(left_segment == &projected_segments[0]);
+                    Assert::IsTrue(right_segment == &projected_segments[2]);
+
+                    Segment flat_left_segment;
+                    Segment flat_right_segment;
+                    flat_map.trace_left_right(trace_point, false, flat_left_segment, flat_right_segment);
+
+                    Assert::AreEqual(projected_segments[0], flat_left_segment);
+                    Assert::AreEqual(projected_segments[2], flat_right_segment);
+                }
+            }
+        }
+
         //2B
         TEST_METHOD(get_hotspot_fixed_length_contiguous_full_diagonal)
         {
@@ -274,6 +385,27 @@ namespace TestTrajectoryHotspots
             Assert::IsTrue(hotspot.max == Vec2(8.12912178f, 16.f));
         }
 
+        TEST_METHOD(get_hotspot_fixed_length_contiguous_basic_breakpoint_IV)
+        {
+            //The subtrajectory starts on the second segment and ends on the last one, on the vertical line through (14, 19)
+            std::vector<Vec2> trajectory_points;
+
+            trajectory_points.emplace_back(6.f, 13.f);
+            trajectory_points.emplace_back(9.f, 19.f);
+            trajectory_points.emplace_back(14.f, 19.f);
+            trajectory_points.emplace_back(11.f, 16.f);
+            trajectory_points.emplace_back(15.f, 19.f);
+
+            Trajectory trajectory(trajectory_points);
+
+            Float query_length = 10.f;
+
+            AABB hotspot = trajectory.get_hotspot_fixed_length_contiguous(query_length);
+
+            Assert::IsTrue(hotspot.min == Vec2(11.f, 16.f));
+            Assert::IsTrue(hotspot.max == Vec2(14.f, 19.f));
+        }
+
     };
 
 
@@ -0,0 +1,211 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "../Trajectory_Hotspots/pch.h"
+#include "../Trajectory_Hotspots/vec2.h"
+#include "../Trajectory_Hotspots/trajectory.h"
+#include "../Trajectory_Hotspots/trajectory_csv.h"
+#include "../Trajectory_Hotspots/trajectory_archive.h"
+
+namespace Microsoft
+{
+    namespace VisualStudio
+    {
+        namespace CppUnitTestFramework
+        {
+            template<> inline std::wstring ToString<Vec2>(const class Vec2& t) { return L"Vec2"; }
+            template<> inline std::wstring ToString<Segment>(const class Segment& t) { return L"Segment"; }
+        }
+    }
+}
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestTrajectoryHotspots
+{
+    TEST_CLASS(TestTrajectoryHotspotsTrajectoryArchive)
+    {
+    public:
+
+        TEST_METHOD(write_and_open)
+        {
+            for (const bool float64_vertices : { false, true })
+            {
+                Trajectory_CSV csv;
+                parse_test_csv(csv);
+
+                Trajectory_Archive_Options options;
+                options.float64_vertices = float64_vertices;
+
+                std::string error;
+                Assert::IsTrue(write_trajectory_archive(archive_path, csv, options, error));
+
+                Trajectory_Archive archive;
+                Assert::IsTrue(archive.open(archive_path, error));
+
+                //The single vertex trajectory 5 is skipped
+                Assert::AreEqual(size_t(2), archive.trajectory_count());
+                Assert::IsTrue(archive.has_time());
+                Assert::IsFalse(archive.has_trees());
+
+                //Entries are sorted by id
+                Assert::AreEqual(int64_t(3), archive.get_entry(0).trajectory_id);
+                Assert::AreEqual(int64_t(8), archive.get_entry(1).trajectory_id);
+
+                size_t index = 0;
+                Assert::IsTrue(archive.find(8, index));
+                Assert::AreEqual(size_t(1), index);
+                Assert::IsFalse(archive.find(5, index));
+
+                Assert::IsTrue(archive.is_entry_valid(index));
+                Assert::AreEqual(Vec2(2.f, 4.f), archive.get_vertex(index, 2));
+
+                const Trajectory trajectory = archive.build_trajectory(index);
+                const Trajectory expected = csv.build_trajectory(0);
+
+                Assert::AreEqual(expected.get_ordered_trajectory_segments().size(), trajectory.get_ordered_trajectory_segments().size());
+
+                for (size_t i = 0; i < expected.get_ordered_trajectory_segments().size(); i++)
+                {
+                    Assert::AreEqual(expected.get_ordered_trajectory_segments()[i], trajectory.get_ordered_trajectory_segments()[i]);
+                }
+            }
+
+            std::remove(archive_path);
+        }
+
+        TEST_METHOD(embedded_trees)
+        {
+            Trajectory_CSV csv;
+            parse_test_csv(csv);
+
+            Trajectory_Archive_Options options;
+            options.embed_trees = true;
+
+            std::string error;
+            Assert::IsTrue(write_trajectory_archive(archive_path, csv, options, error));
+
+            Trajectory_Archive archive;
+            Assert::IsTrue(archive.open(archive_path, error));
+            Assert::IsTrue(archive.has_trees());
+
+            size_t index = 0;
+            Assert::IsTrue(archive.find(3, index));
+            Assert::IsTrue(archive.is_entry_valid(index));
+
+            const Trajectory trajectory = archive.build_trajectory(index);
+            const Segment_Search_Tree expected_tree(trajectory.get_ordered_trajectory_segments());
+
+            const Flat_Segment_Search_Tree tree = archive.get_tree(index);
+            Assert::AreEqual(size_t(5), tree.get_node_count());
+
+            const AABB expected = expected_tree.query(0.5f, 5.5f);
+            const AABB result = tree.query(0.5f, 5.5f);
+
+            Assert::IsTrue(expected.min == result.min);
+            Assert::IsTrue(expected.max == result.max);
+
+            std::remove(archive_path);
+        }
+
+        TEST_METHOD(compressed_vertices)
+        {
+            Trajectory_CSV csv;
+            parse_test_csv(csv);
+
+            Trajectory_Archive_Options options;
+            options.compress_vertices = true;
+            options.embed_trees = true;
+
+            std::string error;
+            Assert::IsTrue(write_trajectory_archive(archive_path, csv, options, error));
+
+            Trajectory_Archive archive;
+            Assert::IsTrue(archive.open(archive_path, error));
+            Assert::IsTrue(archive.is_compressed());
+            Assert::IsTrue(archive.has_time());
+            Assert::IsTrue(archive.has_trees());
+
+            size_t index = 0;
+            Assert::IsTrue(archive.find(8, index));
+            Assert::IsTrue(archive.is_entry_valid(index));
+            Assert::AreEqual(size_t(4), archive.get_compressed(index).get_vertex_count());
+
+            //The test coordinates are multiples of the resolution, so they decode exactly
+            Assert::AreEqual(Vec2(2.f, 4.f), archive.get_vertex(index, 2));
+            Assert::IsTrue(archive.get_time(index, 2) == 3.f);
+
+            const Trajectory trajectory = archive.build_trajectory(index);
+            const Trajectory expected = csv.build_trajectory(0);
+
+            Assert::AreEqual(expected.get_ordered_trajectory_segments().size(), trajectory.get_ordered_trajectory_segments().size());
+
+            for (size_t i = 0; i < expected.get_ordered_trajectory_segments().size(); i++)
+            {
+                Assert::AreEqual(expected.get_ordered_trajectory_segments()[i], trajectory.get_ordered_trajectory_segments()[i]);
+            }
+
+            Assert::AreEqual(size_t(5), archive.get_tree(index).get_node_count());
+
+            std::remove(archive_path);
+        }
+
+        TEST_METHOD(rewrite_while_open)
+        {
+            Trajectory_CSV csv;
+            parse_test_csv(csv);
+
+            Trajectory_Archive_Options options;
+            std::string error;
+            Assert::IsTrue(write_trajectory_archive(archive_path, csv, options, error));
+
+            Trajectory_Archive archive;
+            Assert::IsTrue(archive.open(archive_path, error));
+
+            //Writing replaces the file, the archive that is already open keeps reading the old one
+            const std::string text = "x,y,id\n5,5,1\n6,6,1\n";
+            Trajectory_CSV other_csv;
+            Assert::IsTrue(other_csv.parse(text.data(), text.size(), error));
+            Assert::IsTrue(write_trajectory_archive(archive_path, other_csv, options, error));
+
+            Assert::AreEqual(size_t(2), archive.trajectory_count());
+            Assert::AreEqual(int64_t(8), archive.get_entry(1).trajectory_id);
+            Assert::AreEqual(Vec2(2.f, 4.f), archive.get_vertex(1, 2));
+
+            Trajectory_Archive new_archive;
+            Assert::IsTrue(new_archive.open(archive_path, error));
+            Assert::AreEqual(size_t(1), new_archive.trajectory_count());
+
+            std::remove(archive_path);
+        }
+
+        TEST_METHOD(open_invalid)
+        {
+            const std::string text = "0,0\n1,1\n";
+
+            FILE* file = fopen(archive_path, "wb");
+            fwrite(text.data(), 1, text.size(), file);
+            fclose(file);
+
+            Trajectory_Archive archive;
+            std::string error;
+
+            Assert::IsFalse(archive.open(archive_path, error));
+            Assert::IsFalse(archive.open("missing_trajectory_archive.bin", error));
+
+            std::remove(archive_path);
+        }
+
+    private:
+
+        const char* archive_path = "test_trajectory_archive.bin";
+
+        void parse_test_csv(Trajectory_CSV& csv)
+        {
+            const std::string text = "x,y,t,id\n0,0,0,8\n2,0,1,8\n2,4,3,8\n1,1,4,8\n9,9,0,5\n0,0,0,3\n1,0,2,3\n1,1,4,3\n0,2,6,3\n";
+
+            std::string error;
+            Assert::IsTrue(csv.parse(text.data(), text.size(), error));
+        }
+    };
+}
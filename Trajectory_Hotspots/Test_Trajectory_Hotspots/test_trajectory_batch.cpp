@@ -0,0 +1,161 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "../Trajectory_Hotspots/pch.h"
+#include "../Trajectory_Hotspots/vec2.h"
+#include "../Trajectory_Hotspots/trajectory.h"
+#include "../Trajectory_Hotspots/trajectory_generator.h"
+#include "../Trajectory_Hotspots/trajectory_batch.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestTrajectoryHotspots
+{
+    TEST_CLASS(TestTrajectoryHotspotsTrajectoryBatch)
+    {
+    public:
+
+        TEST_METHOD(batch_matches_single_queries)
+        {
+            const Trips trips = make_trips(40);
+
+            Trajectory_Batch batch;
+            batch.x = trips.x.data();
+            batch.y = trips.y.data();
+            batch.offsets = trips.offsets.data();
+            batch.trajectory_count = trips.offsets.size() - 1;
+
+            Trajectory_Batch_Engine engine(4);
+            Assert::AreEqual(size_t(4), engine.get_thread_count());
+
+            for (const Hotspot_Query query_type : { Hotspot_Query::fixed_length_contiguous, Hotspot_Query::fixed_radius_contiguous })
+            {
+                const bool use_timestamps = hotspot_query_uses_timestamps(query_type);
+                batch.t = use_timestamps ? trips.t.data() : nullptr;
+
+                Trajectory_Batch_Query query;
+                query.query = query_type;
+                query.parameter = 4.f;
+
+                std::vector<AABB> results(batch.trajectory_count, AABB(Vec2(-1.f, -1.f), Vec2(-1.f, -1.f)));
+
+                std::string error;
+                Assert::IsTrue(engine.run(batch, query, results.data(), error));
+
+                for (size_t i = 0; i < batch.trajectory_count; i++)
+                {
+                    const size_t first_vertex = trips.offsets[i];
+                    const size_t vertex_count = trips.offsets[i + 1] - first_vertex;
+
+                    if (vertex_count < 2)
+                    {
+                        Assert::IsTrue(results[i].min == Vec2(0.f, 0.f) && results[i].max == Vec2(0.f, 0.f));
+                        continue;
+                    }
+
+                    const Trajectory trajectory(&trips.x[first_vertex], &trips.y[first_vertex], use_timestamps ? &trips.t[first_vertex] : nullptr, vertex_count);
+                    const AABB hotspot = run_hotspot_query(trajectory, query.query, query.parameter);
+
+                    Assert::IsTrue(results[i].min == hotspot.min && results[i].max == hotspot.max);
+                }
+
+                //The workers reuse their trajectories and arenas, a second run gives the same hotspots
+                std::vector<AABB> second_results(batch.trajectory_count);
+                Assert::IsTrue(engine.run(batch, query, second_results.data(), error));
+
+                for (size_t i = 0; i < batch.trajectory_count; i++)
+                {
+                    Assert::IsTrue(results[i].min == second_results[i].min && results[i].max == second_results[i].max);
+                }
+            }
+        }
+
+        TEST_METHOD(length_query_ignores_timestamps)
+        {
+            const Trips trips = make_trips(20);
+
+            Trajectory_Batch batch;
+            batch.x = trips.x.data();
+            batch.y = trips.y.data();
+            batch.offsets = trips.offsets.data();
+            batch.trajectory_count = trips.offsets.size() - 1;
+
+            Trajectory_Batch_Query query;
+            query.query = Hotspot_Query::fixed_length_contiguous;
+            query.parameter = 4.f;
+
+            Trajectory_Batch_Engine engine(2);
+            std::string error;
+
+            std::vector<AABB> results(batch.trajectory_count);
+            Assert::IsTrue(engine.run(batch, query, results.data(), error));
+
+            //The timestamps are not the length along the trajectory, fixed length contiguous measures the length so it gives the same hotspots
+            batch.t = trips.t.data();
+
+            std::vector<AABB> timestamp_results(batch.trajectory_count);
+            Assert::IsTrue(engine.run(batch, query, timestamp_results.data(), error));
+
+            for (size_t i = 0; i < batch.trajectory_count; i++)
+            {
+                Assert::IsTrue(results[i].min == timestamp_results[i].min && results[i].max == timestamp_results[i].max);
+            }
+        }
+
+        TEST_METHOD(invalid_offsets)
+        {
+            const std::vector<float> x = { 0.f, 1.f, 2.f };
+            const std::vector<float> y = { 0.f, 1.f, 0.f };
+            const std::vector<size_t> offsets = { 0, 3, 2 };
+
+            Trajectory_Batch batch;
+            batch.x = x.data();
+            batch.y = y.data();
+            batch.offsets = offsets.data();
+            batch.trajectory_count = 2;
+
+            Trajectory_Batch_Engine engine(2);
+            Trajectory_Batch_Query query;
+            query.parameter = 1.f;
+
+            std::vector<AABB> results(2);
+            std::string error;
+            Assert::IsFalse(engine.run(batch, query, results.data(), error));
+            Assert::IsFalse(error.empty());
+
+            //An empty batch has nothing to do
+            batch.trajectory_count = 0;
+            Assert::IsTrue(engine.run(batch, query, results.data(), error));
+        }
+
+    private:
+
+        struct Trips
+        {
+            std::vector<float> x;
+            std::vector<float> y;
+            std::vector<float> t;
+            std::vector<size_t> offsets;
+        };
+
+        //Vehicle trips of different sizes in one buffer, with an empty and a single vertex trip
+        static Trips make_trips(const size_t trip_count)
+        {
+            Trips trips;
+            trips.offsets.push_back(0);
+
+            for (size_t i = 0; i < trip_count; i++)
+            {
+                const size_t vertex_count = (i == 3) ? 0 : (i == 7) ? 1 : 2 + (i * 37) % 150;
+                const Synthetic_Trajectory trip = generate_trajectory(Trajectory_Shape::vehicle, vertex_count, static_cast<unsigned int>(i + 1));
+
+                trips.x.insert(trips.x.end(), trip.x.begin(), trip.x.end());
+                trips.y.insert(trips.y.end(), trip.y.begin(), trip.y.end());
+                trips.t.insert(trips.t.end(), trip.t.begin(), trip.t.end());
+                trips.offsets.push_back(trips.x.size());
+            }
+
+            return trips;
+        }
+    };
+}
@@ -0,0 +1,164 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "../Trajectory_Hotspots/pch.h"
+#include "../Trajectory_Hotspots/vec2.h"
+#include "../Trajectory_Hotspots/trajectory.h"
+#include "../Trajectory_Hotspots/trajectory_csv.h"
+
+namespace Microsoft
+{
+    namespace VisualStudio
+    {
+        namespace CppUnitTestFramework
+        {
+            template<> inline std::wstring ToString<Vec2>(const class Vec2& t) { return L"Vec2"; }
+            template<> inline std::wstring ToString<Segment>(const class Segment& t) { return L"Segment"; }
+        }
+    }
+}
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestTrajectoryHotspots
+{
+    TEST_CLASS(TestTrajectoryHotspotsTrajectoryCSV)
+    {
+    public:
+
+        TEST_METHOD(parse_xy_without_header)
+        {
+            const std::string text = "0,0\n1.5,-2\r\n3e1, 4\n\n";
+
+            Trajectory_CSV csv;
+            std::string error;
+
+            Assert::IsTrue(csv.parse(text.data(), text.size(), error));
+
+            Assert::IsFalse(csv.has_time);
+            Assert::IsFalse(csv.has_trajectory_id);
+            Assert::AreEqual(size_t(1), csv.trajectory_count());
+            Assert::AreEqual(size_t(3), csv.vertex_count());
+
+            Assert::AreEqual(Vec2(1.5f, -2.f), csv.points[1]);
+            Assert::AreEqual(Vec2(30.f, 4.f), csv.points[2]);
+        }
+
+        TEST_METHOD(parse_trajectory_ids)
+        {
+            const std::string text = "0,0,0,7\n1,0,1,7\n5,5,0,9\n6,5,2,9\n7,5,3,9\n";
+
+            Trajectory_CSV csv;
+            std::string error;
+
+            Assert::IsTrue(csv.parse(text.data(), text.size(), error));
+
+            Assert::IsTrue(csv.has_time);
+            Assert::IsTrue(csv.has_trajectory_id);
+            Assert::AreEqual(size_t(2), csv.trajectory_count());
+
+            Assert::AreEqual(int64_t(7), csv.trajectory_ids[0]);
+            Assert::AreEqual(int64_t(9), csv.trajectory_ids[1]);
+
+            Assert::AreEqual(size_t(0), csv.trajectory_begin(0));
+            Assert::AreEqual(size_t(2), csv.trajectory_end(0));
+            Assert::AreEqual(size_t(2), csv.trajectory_begin(1));
+            Assert::AreEqual(size_t(5), csv.trajectory_end(1));
+
+            Assert::AreEqual(3.f, csv.times[4]);
+        }
+
+        TEST_METHOD(parse_header_column_order)
+        {
+            const std::string text = "id,time,y,x\n3,0.5,2,1\n3,1.5,4,3\n";
+
+            Trajectory_CSV csv;
+            std::string error;
+
+            Assert::IsTrue(csv.parse(text.data(), text.size(), error));
+
+            Assert::AreEqual(size_t(1), csv.trajectory_count());
+            Assert::AreEqual(int64_t(3), csv.trajectory_ids[0]);
+            Assert::AreEqual(Vec2(1.f, 2.f), csv.points[0]);
+            Assert::AreEqual(Vec2(3.f, 4.f), csv.points[1]);
+            Assert::AreEqual(1.5f, csv.times[1]);
+        }
+
+        TEST_METHOD(parse_errors)
+        {
+            Trajectory_CSV csv;
+            std::string error;
+
+            const std::string missing_column = "x,y,t\n0,0,0\n1,1\n";
+            Assert::IsFalse(csv.parse(missing_column.data(), missing_column.size(), error));
+
+            const std::string invalid_number = "0,0\n1,abc\n";
+            Assert::IsFalse(csv.parse(invalid_number.data(), invalid_number.size(), error));
+
+            const std::string missing_y = "x,t\n0,0\n";
+            Assert::IsFalse(csv.parse(missing_y.data(), missing_y.size(), error));
+        }
+
+        TEST_METHOD(parse_time_errors)
+        {
+            Trajectory_CSV csv;
+            std::string error;
+
+            const std::string equal_times = "0,0,0\n1,0,0\n2,0,0\n";
+            Assert::IsFalse(csv.parse(equal_times.data(), equal_times.size(), error));
+            Assert::AreEqual(std::string("line 2: time doesn't increase in trajectory 0"), error);
+
+            const std::string backwards_time = "x,y,t,id\n0,0,0,4\n1,0,2,4\n2,0,1,4\n";
+            Assert::IsFalse(csv.parse(backwards_time.data(), backwards_time.size(), error));
+            Assert::AreEqual(std::string("line 4: time doesn't increase in trajectory 4"), error);
+
+            const std::string repeated_point = "0,0\n1,1\n1,1\n";
+            Assert::IsFalse(csv.parse(repeated_point.data(), repeated_point.size(), error));
+            Assert::AreEqual(std::string("line 3: point repeats the previous point in trajectory 0"), error);
+
+            //The time only has to increase within a trajectory
+            const std::string next_trajectory = "0,0,5,1\n1,0,6,1\n0,0,0,2\n1,1,1,2\n";
+            Assert::IsTrue(csv.parse(next_trajectory.data(), next_trajectory.size(), error));
+        }
+
+        TEST_METHOD(parse_repeated_trajectory_ids)
+        {
+            const std::string text = "0,0,0,1\n1,0,1,1\n0,0,0,2\n1,0,1,2\n2,0,2,1\n3,0,3,1\n0,1,2,2\n0,2,3,2\n0,3,4,2\n";
+
+            Trajectory_CSV csv;
+            std::string error;
+
+            Assert::IsTrue(csv.parse(text.data(), text.size(), error));
+
+            //Each run of rows is its own trajectory, the ids that appear again are reported once
+            Assert::AreEqual(size_t(4), csv.trajectory_count());
+            Assert::AreEqual(size_t(2), csv.repeated_trajectory_ids.size());
+            Assert::AreEqual(int64_t(1), csv.repeated_trajectory_ids[0]);
+            Assert::AreEqual(int64_t(2), csv.repeated_trajectory_ids[1]);
+
+            const std::string consecutive = "0,0,0,1\n1,0,1,1\n0,0,0,2\n1,0,1,2\n";
+            Assert::IsTrue(csv.parse(consecutive.data(), consecutive.size(), error));
+            Assert::IsTrue(csv.repeated_trajectory_ids.empty());
+        }
+
+        TEST_METHOD(build_trajectory_with_times)
+        {
+            const std::string text = "x,y,t\n0,0,0\n2,0,1\n2,4,3\n";
+
+            Trajectory_CSV csv;
+            std::string error;
+
+            Assert::IsTrue(csv.parse(text.data(), text.size(), error));
+
+            const Trajectory trajectory = csv.build_trajectory(0);
+            const std::vector<Segment>& segments = trajectory.get_ordered_trajectory_segments();
+
+            Assert::AreEqual(size_t(2), segments.size());
+            Assert::AreEqual(Segment(Vec2(2.f, 0.f), Vec2(2.f, 4.f), 1.f, 3.f), segments[1]);
+
+            //Without the timestamps the times are the length along the trajectory
+            const Trajectory length_trajectory = csv.build_trajectory(0, false);
+            Assert::AreEqual(Segment(Vec2(2.f, 0.f), Vec2(2.f, 4.f), 2.f, 6.f), length_trajectory.get_ordered_trajectory_segments()[1]);
+        }
+    };
+}
@@ -0,0 +1,88 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "../Trajectory_Hotspots/pch.h"
+#include "../Trajectory_Hotspots/vec2.h"
+#include "../Trajectory_Hotspots/trajectory.h"
+#include "../Trajectory_Hotspots/trajectory_generator.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestTrajectoryHotspots
+{
+    TEST_CLASS(TestTrajectoryHotspotsTrajectoryGenerator)
+    {
+    public:
+
+        TEST_METHOD(same_seed_same_trajectory)
+        {
+            for (const Trajectory_Shape shape : { Trajectory_Shape::random_walk, Trajectory_Shape::levy_flight, Trajectory_Shape::vehicle, Trajectory_Shape::degenerate })
+            {
+                const Synthetic_Trajectory first = generate_trajectory(shape, 1000, 7);
+                const Synthetic_Trajectory second = generate_trajectory(shape, 1000, 7);
+                const Synthetic_Trajectory other_seed = generate_trajectory(shape, 1000, 8);
+
+                Assert::AreEqual(size_t(1000), first.vertex_count());
+                Assert::IsTrue(first.x == second.x && first.y == second.y && first.t == second.t);
+                Assert::IsFalse(first.x == other_seed.x && first.y == other_seed.y);
+
+                //One vertex per time unit
+                Assert::AreEqual(999.f, first.t.back());
+
+                Trajectory_Shape parsed_shape;
+                Assert::IsTrue(parse_trajectory_shape(trajectory_shape_name(shape), parsed_shape));
+                Assert::IsTrue(parsed_shape == shape);
+            }
+
+            Trajectory_Shape parsed_shape;
+            Assert::IsFalse(parse_trajectory_shape("spiral", parsed_shape));
+        }
+
+        TEST_METHOD(vehicle_stops)
+        {
+            const Synthetic_Trajectory vehicle = generate_trajectory(Trajectory_Shape::vehicle, 5000, 1);
+
+            //A stop only moves by the GPS noise, look for 30 vertices within a few units
+            size_t longest_stop = 0;
+            size_t stop_start = 0;
+
+            for (size_t i = 1; i < vehicle.vertex_count(); i++)
+            {
+                if (fabs(vehicle.x[i] - vehicle.x[stop_start]) > 0.5f || fabs(vehicle.y[i] - vehicle.y[stop_start]) > 0.5f)
+                {
+                    stop_start = i;
+                }
+
+                longest_stop = std::max(longest_stop, i - stop_start);
+            }
+
+            Assert::IsTrue(longest_stop >= 30);
+
+            //The radius query finds a stop, the whole trajectory is much larger
+            const Trajectory trajectory = vehicle.build_trajectory(true);
+            const AABB hotspot = trajectory.get_hotspot_fixed_radius_contiguous(1.f);
+
+            Assert::IsTrue(hotspot.max_size() <= 1.f);
+        }
+
+        TEST_METHOD(degenerate_repeats_points)
+        {
+            const Synthetic_Trajectory degenerate = generate_trajectory(Trajectory_Shape::degenerate, 1000, 1);
+
+            size_t repeated_points = 0;
+            for (size_t i = 1; i < degenerate.vertex_count(); i++)
+            {
+                repeated_points += degenerate.x[i] == degenerate.x[i - 1] && degenerate.y[i] == degenerate.y[i - 1];
+
+                //Every vertex lies on the horizontal, vertical or diagonal line through the origin
+                Assert::IsTrue(degenerate.x[i] == 0.f || degenerate.y[i] == 0.f || degenerate.x[i] == degenerate.y[i]);
+            }
+
+            Assert::IsTrue(repeated_points > 100);
+
+            //Both kinds of trajectories can be built and queried
+            const AABB length_hotspot = degenerate.build_trajectory(false).get_hotspot_fixed_length_contiguous(5.f);
+            Assert::IsTrue(length_hotspot.max_size() <= 5.f);
+        }
+    };
+}
@@ -0,0 +1,205 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "../Trajectory_Hotspots/pch.h"
+#include "../Trajectory_Hotspots/vec2.h"
+#include "../Trajectory_Hotspots/trajectory.h"
+#include "../Trajectory_Hotspots/trajectory_csv.h"
+#include "../Trajectory_Hotspots/trajectory_geo.h"
+
+namespace Microsoft
+{
+    namespace VisualStudio
+    {
+        namespace CppUnitTestFramework
+        {
+            template<> inline std::wstring ToString<Float>(const class Float& t) { return L"Float"; }
+            template<> inline std::wstring ToString<Vec2>(const class Vec2& t) { return L"Vec2"; }
+        }
+    }
+}
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestTrajectoryHotspots
+{
+    TEST_CLASS(TestTrajectoryHotspotsTrajectoryGeo)
+    {
+    public:
+
+        TEST_METHOD(projection)
+        {
+            const Geo_Projection projection(52.0, 5.0);
+
+            Assert::AreEqual(Vec2(0.f, 0.f), projection.project(52.0, 5.0));
+
+            //One thousandth of a degree north is about 111 meters anywhere, east it shrinks with the cosine of the latitude
+            const Vec2 north = projection.project(52.001, 5.0);
+            const Vec2 east = projection.project(52.0, 5.001);
+
+            Assert::IsTrue(fabs(north.y.get_value() - 111.195f) < 0.01f);
+            Assert::IsTrue(fabs(east.x.get_value() - 111.195f * cosf(52.f * 3.14159265f / 180.f)) < 0.01f);
+
+            //Across the antimeridian the frame stays continuous
+            const Geo_Projection pacific(0.0, 179.9995);
+            Assert::IsTrue(fabs(pacific.project(0.0, -179.9995).x.get_value() - 111.195f) < 0.01f);
+        }
+
+        TEST_METHOD(batch_projection_matches_projection)
+        {
+            const Geo_Projection projection(39.98, 116.31);
+
+            std::mt19937 generator(5);
+            std::uniform_real_distribution<double> offset(-0.5, 0.5);
+
+            //Not a multiple of the vector width, so the tail is tested too
+            const size_t count = 37;
+            std::vector<double> latitudes(count);
+            std::vector<double> longitudes(count);
+            for (size_t i = 0; i < count; i++)
+            {
+                latitudes[i] = 39.98 + offset(generator);
+                longitudes[i] = 116.31 + offset(generator);
+            }
+
+            std::vector<float> x(count);
+            std::vector<float> y(count);
+            project_to_local_frame(projection, latitudes.data(), longitudes.data(), count, x.data(), y.data());
+
+            for (size_t i = 0; i < count; i++)
+            {
+                const Vec2 expected = projection.project(latitudes[i], longitudes[i]);
+
+                Assert::AreEqual(expected.x.get_value(), x[i]);
+                Assert::AreEqual(expected.y.get_value(), y[i]);
+            }
+        }
+
+        TEST_METHOD(parse_gpx)
+        {
+            const std::string text =
+                "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                "<gpx version=\"1.1\" creator=\"test\">\n"
+                "  <metadata><time>2000-01-01T00:00:00Z</time></metadata>\n"
+                "  <!-- <trkpt lat=\"0\" lon=\"0\"> -->\n"
+                "  <trk><name>a</name>\n"
+                "    <trkseg>\n"
+                "      <trkpt lat=\"52.0\" lon=\"5.0\"><ele>1.5</ele><time>2009-10-17T18:37:26Z</time></trkpt>\n"
+                "      <trkpt lon=\"5.001\" lat=\"52.0\"><time>2009-10-17T18:37:31.5Z</time></trkpt>\n"
+                "    </trkseg>\n"
+                "    <trkseg></trkseg>\n"
+                "    <trkseg>\n"
+                "      <trkpt lat='52.001' lon='5.0'><time>2009-10-17T20:38:00+02:00</time></trkpt>\n"
+                "    </trkseg>\n"
+                "  </trk>\n"
+                "</gpx>\n";
+
+            Geo_Projection projection;
+            Trajectory_CSV result;
+            std::string error;
+
+            Assert::IsTrue(::parse_gpx(text.data(), text.size(), projection, result, error));
+
+            //The empty trkseg is dropped, ids count all trksegs
+            Assert::AreEqual(size_t(2), result.trajectory_count());
+            Assert::AreEqual(size_t(3), result.vertex_count());
+            Assert::AreEqual(int64_t(0), result.trajectory_ids[0]);
+            Assert::AreEqual(int64_t(2), result.trajectory_ids[1]);
+            Assert::AreEqual(size_t(2), result.trajectory_end(0));
+
+            //The first point is the origin
+            Assert::IsTrue(projection.has_origin());
+            Assert::AreEqual(52.0, projection.origin_latitude);
+            Assert::AreEqual(Vec2(0.f, 0.f), result.points[0]);
+            Assert::IsTrue(result.points[1].x > 60.f);
+            Assert::IsTrue(result.points[2].y > 110.f);
+
+            Assert::IsTrue(result.has_time);
+            Assert::AreEqual(0.f, result.times[0]);
+            Assert::AreEqual(5.5f, result.times[1]);
+            Assert::AreEqual(34.f, result.times[2]);
+        }
+
+        TEST_METHOD(parse_gpx_without_times)
+        {
+            const std::string text = "<gpx><trk><trkseg><trkpt lat=\"1\" lon=\"2\"/><trkpt lat=\"1.5\" lon=\"2\"><time>2009-10-17T18:37:26Z</time></trkpt></trkseg></trk></gpx>";
+
+            Geo_Projection projection(1.0, 2.0);
+            Trajectory_CSV result;
+            std::string error;
+
+            Assert::IsTrue(::parse_gpx(text.data(), text.size(), projection, result, error));
+            Assert::AreEqual(size_t(2), result.vertex_count());
+            Assert::IsFalse(result.has_time);
+            Assert::IsTrue(result.times.empty());
+
+            const std::string invalid = "<gpx><trk><trkseg><trkpt lat=\"north\" lon=\"2\"/></trkseg></trk></gpx>";
+            Assert::IsFalse(::parse_gpx(invalid.data(), invalid.size(), projection, result, error));
+        }
+
+        TEST_METHOD(parse_plt)
+        {
+            const std::string text =
+                "Geolife trajectory\r\n"
+                "WGS 84\r\n"
+                "Altitude is in Feet\r\n"
+                "Reserved 3\r\n"
+                "0,2,255,My Track,0,0,2,8421376\r\n"
+                "0\r\n"
+                "39.984702,116.318417,0,492,39744.1201851852,2008-10-23,02:53:04\r\n"
+                "39.984683,116.31845,0,492,39744.1202546296,2008-10-23,02:53:10\r\n"
+                "39.984686,116.318417,0,492,39744.1203125,2008-10-23,02:53:15\r\n";
+
+            Geo_Projection projection;
+            Trajectory_CSV result;
+            std::string error;
+
+            Assert::IsTrue(::parse_plt(text.data(), text.size(), projection, result, error));
+
+            Assert::AreEqual(size_t(1), result.trajectory_count());
+            Assert::AreEqual(size_t(3), result.vertex_count());
+            Assert::IsTrue(result.has_time);
+            Assert::IsTrue(fabs(result.times[1] - 6.f) < 0.01f);
+            Assert::IsTrue(fabs(result.times[2] - 11.f) < 0.01f);
+
+            const Trajectory trajectory = result.build_trajectory(0);
+            Assert::AreEqual(size_t(2), trajectory.get_ordered_trajectory_segments().size());
+
+            const std::string invalid = "1\n2\n3\n4\n5\n6\n39.98,116.31,0\n";
+            Assert::IsFalse(::parse_plt(invalid.data(), invalid.size(), projection, result, error));
+        }
+
+        TEST_METHOD(parse_geojson)
+        {
+            const std::string text =
+                "{\"type\": \"FeatureCollection\", \"features\": [\n"
+                "  {\"type\": \"Feature\", \"properties\": {\"name\": \"coordinates\"}, \"geometry\": {\"type\": \"Point\", \"coordinates\": [5.0, 52.0]}},\n"
+                "  {\"type\": \"Feature\", \"geometry\": {\"type\": \"LineString\", \"coordinates\": [[5.0, 52.0, 3.5], [5.001, 52.0], [5.001, 52.001]]}},\n"
+                "  {\"type\": \"Feature\", \"geometry\": {\"type\": \"MultiLineString\", \"coordinates\": [\n"
+                "    [[5.0, 52.0], [5.0, 52.002]],\n"
+                "    [[5.002, 52.0], [5.003, 52.0]]\n"
+                "  ]}}\n"
+                "]}\n";
+
+            Geo_Projection projection(52.0, 5.0);
+            Trajectory_CSV result;
+            std::string error;
+
+            Assert::IsTrue(::parse_geojson(text.data(), text.size(), projection, result, error));
+
+            //The point is skipped
+            Assert::AreEqual(size_t(3), result.trajectory_count());
+            Assert::AreEqual(size_t(7), result.vertex_count());
+            Assert::AreEqual(size_t(3), result.trajectory_end(0));
+            Assert::AreEqual(size_t(5), result.trajectory_end(1));
+            Assert::AreEqual(int64_t(2), result.trajectory_ids[2]);
+            Assert::IsFalse(result.has_time);
+
+            Assert::AreEqual(Vec2(0.f, 0.f), result.points[0]);
+            Assert::IsTrue(result.points[4].y > 220.f);
+
+            const std::string invalid = "{\"coordinates\": [[5.0, 52.0], [5.0, ";
+            Assert::IsFalse(::parse_geojson(invalid.data(), invalid.size(), projection, result, error));
+        }
+    };
+}
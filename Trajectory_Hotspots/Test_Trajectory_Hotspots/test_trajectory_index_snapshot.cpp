@@ -0,0 +1,148 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "../Trajectory_Hotspots/pch.h"
+#include "../Trajectory_Hotspots/vec2.h"
+#include "../Trajectory_Hotspots/trajectory.h"
+#include "../Trajectory_Hotspots/trajectory_index_snapshot.h"
+
+namespace Microsoft
+{
+    namespace VisualStudio
+    {
+        namespace CppUnitTestFramework
+        {
+            template<> inline std::wstring ToString<Vec2>(const class Vec2& t) { return L"Vec2"; }
+        }
+    }
+}
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestTrajectoryHotspots
+{
+    TEST_CLASS(TestTrajectoryHotspotsTrajectoryIndexSnapshot)
+    {
+    public:
+
+        TEST_METHOD(write_and_open)
+        {
+            const Trajectory trajectory = build_test_trajectory(29);
+
+            std::string error;
+            Assert::IsTrue(Trajectory_Index_Snapshot::write(snapshot_path, trajectory, error));
+
+            Trajectory_Index_Snapshot snapshot;
+            Assert::IsTrue(snapshot.open(snapshot_path, error));
+            Assert::IsTrue(snapshot.is_valid());
+            Assert::IsTrue(snapshot.matches(trajectory));
+            Assert::IsFalse(snapshot.matches(build_test_trajectory(31)));
+
+            Assert::AreEqual(trajectory.get_ordered_trajectory_segments().size() * 2 - 1, snapshot.get_tree().get_node_count());
+
+            //The snapshot gives the same hotspots as building the indexes
+            for (const float radius : { 1.f, 2.5f, 4.f, 7.f, 100.f })
+            {
+                const AABB expected = trajectory.get_hotspot_fixed_radius_contiguous(radius);
+                const AABB result = trajectory.get_hotspot_fixed_radius_contiguous(radius, snapshot);
+
+                Assert::AreEqual(expected.min, result.min);
+                Assert::AreEqual(expected.max, result.max);
+            }
+
+            std::remove(snapshot_path);
+        }
+
+        TEST_METHOD(rewrite_while_open)
+        {
+            const Trajectory trajectory = build_test_trajectory(29);
+            const Trajectory other_trajectory = build_test_trajectory(31);
+
+            std::string error;
+            Assert::IsTrue(Trajectory_Index_Snapshot::write(snapshot_path, trajectory, error));
+
+            Trajectory_Index_Snapshot snapshot;
+            Assert::IsTrue(snapshot.open(snapshot_path, error));
+
+            //Writing replaces the file, the snapshot that is already open keeps the old indexes
+            Assert::IsTrue(Trajectory_Index_Snapshot::write(snapshot_path, other_trajectory, error));
+
+            Assert::IsTrue(snapshot.is_valid());
+            Assert::IsTrue(snapshot.matches(trajectory));
+
+            const AABB expected = trajectory.get_hotspot_fixed_radius_contiguous(4.f);
+            const AABB result = trajectory.get_hotspot_fixed_radius_contiguous(4.f, snapshot);
+            Assert::AreEqual(expected.min, result.min);
+            Assert::AreEqual(expected.max, result.max);
+
+            Trajectory_Index_Snapshot new_snapshot;
+            Assert::IsTrue(new_snapshot.open(snapshot_path, error));
+            Assert::IsTrue(new_snapshot.matches(other_trajectory));
+
+            std::remove(snapshot_path);
+        }
+
+        TEST_METHOD(corrupt_tree)
+        {
+            const Trajectory trajectory = build_test_trajectory(29);
+
+            std::string error;
+            Assert::IsTrue(Trajectory_Index_Snapshot::write(snapshot_path, trajectory, error));
+
+            //Point the right child of the root past the end of the tree, the header stays intact
+            FILE* file = fopen(snapshot_path, "r+b");
+            Trajectory_Index_Snapshot_Header header;
+            Assert::AreEqual(size_t(1), fread(&header, sizeof(header), 1, file));
+
+            const int32_t corrupt_right = static_cast<int32_t>(header.tree_node_count);
+            fseek(file, static_cast<long>(header.tree_nodes_offset + offsetof(Flat_Segment_Search_Tree_Node, right)), SEEK_SET);
+            fwrite(&corrupt_right, sizeof(corrupt_right), 1, file);
+            fclose(file);
+
+            Trajectory_Index_Snapshot snapshot;
+            Assert::IsTrue(snapshot.open(snapshot_path, error));
+            Assert::IsTrue(snapshot.matches(trajectory));
+            Assert::IsFalse(snapshot.get_tree().is_valid());
+            Assert::IsFalse(snapshot.is_valid());
+
+            std::remove(snapshot_path);
+        }
+
+        TEST_METHOD(open_invalid)
+        {
+            const std::string text = "THINDEX1 but truncated";
+
+            FILE* file = fopen(snapshot_path, "wb");
+            fwrite(text.data(), 1, text.size(), file);
+            fclose(file);
+
+            Trajectory_Index_Snapshot snapshot;
+            std::string error;
+
+            Assert::IsFalse(snapshot.open(snapshot_path, error));
+            Assert::IsFalse(snapshot.open("missing_trajectory_index_snapshot.bin", error));
+
+            std::remove(snapshot_path);
+        }
+
+    private:
+
+        const char* snapshot_path = "test_trajectory_index_snapshot.bin";
+
+        Trajectory build_test_trajectory(const unsigned int seed)
+        {
+            std::mt19937 generator(seed);
+            std::uniform_real_distribution<float> step(-3.f, 3.f);
+
+            std::vector<Vec2> points;
+            Vec2 point(0.f, 0.f);
+            for (int i = 0; i < 40; i++)
+            {
+                points.push_back(point);
+                point = point + Vec2(step(generator), step(generator));
+            }
+
+            return Trajectory(points);
+        }
+    };
+}
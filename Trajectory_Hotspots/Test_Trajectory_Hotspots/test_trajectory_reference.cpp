@@ -0,0 +1,149 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "../Trajectory_Hotspots/pch.h"
+#include "../Trajectory_Hotspots/vec2.h"
+#include "../Trajectory_Hotspots/trajectory.h"
+#include "../Trajectory_Hotspots/trajectory_generator.h"
+#include "../Trajectory_Hotspots/trajectory_reference.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestTrajectoryHotspots
+{
+    TEST_CLASS(TestTrajectoryHotspotsTrajectoryReference)
+    {
+    public:
+
+        //The trajectories of the fixed length contiguous tests in test_trajectory.cpp
+        TEST_METHOD(fixed_length_contiguous_known_hotspots)
+        {
+            const Trajectory diagonal(std::vector<Vec2>{ { 1.f, 1.f }, { 2.f, 4.f }, { 5.f, 7.f }, { 8.f, 4.f }, { 10.f, 1.f } });
+            const Trajectory curl(std::vector<Vec2>{ { 4.f, 5.f }, { 2.f, 4.f }, { 5.f, 7.f }, { 8.f, 4.f }, { 10.f, 1.f } });
+            const Trajectory breakpoint_I(std::vector<Vec2>{ { 4.f, 24.f }, { 4.f, 20.f }, { 6.f, 16.f }, { 8.f, 14.f }, { 12.f, 10.5f } });
+            const Trajectory breakpoint_V(std::vector<Vec2>{ { 3.f, 3.f }, { 5.14f, 5.69f }, { 5.5f, 5.5f }, { 4.5f, 3.5f } });
+
+            const AABB diagonal_hotspot = reference_hotspot_fixed_length_contiguous(diagonal, 2.f, 64);
+            Assert::AreEqual(1.41421356f, diagonal_hotspot.max_size().get_value(), 0.001f);
+
+            const AABB curl_hotspot = reference_hotspot_fixed_length_contiguous(curl, 6.4787086646191f, 64);
+            Assert::AreEqual(3.0f, curl_hotspot.max_size().get_value(), 0.001f);
+
+            std::string error;
+            Assert::IsTrue(check_hotspot(curl, Hotspot_Query::fixed_length_contiguous, 6.4787086646191f, curl.get_hotspot_fixed_length_contiguous(6.4787086646191f), curl_hotspot, 1e-4, error));
+
+            //The reference is at least as good as the hotspots expected there
+            const AABB breakpoint_I_hotspot = reference_hotspot_fixed_length_contiguous(breakpoint_I, 3.f, 64);
+            Assert::IsTrue(breakpoint_I_hotspot.max_size().get_value() <= 8.12912178f - 6.f + 0.0001f);
+            Assert::IsTrue(get_longest_subtrajectory_inside(breakpoint_I, breakpoint_I_hotspot) >= 2.9999);
+
+            //Here it finds a smaller one
+            const AABB breakpoint_V_hotspot = reference_hotspot_fixed_length_contiguous(breakpoint_V, 1.8041624196468f, 64);
+            Assert::IsTrue(breakpoint_V_hotspot.max_size().get_value() < 5.5f - 4.60556459f);
+            Assert::IsTrue(get_longest_subtrajectory_inside(breakpoint_V, breakpoint_V_hotspot) >= 1.8041);
+
+            //Longer than the trajectory has no hotspot
+            Assert::IsTrue(reference_hotspot_fixed_length_contiguous(diagonal, 100.f).max_size() == 0.f);
+        }
+
+        TEST_METHOD(fixed_radius_contiguous_known_hotspots)
+        {
+            //Out along the x-axis and back up, the longest part in a radius of 3 turns the corner
+            const Trajectory corner(std::vector<Vec2>{ { 0.f, 0.f }, { 10.f, 0.f }, { 10.f, 10.f } });
+
+            const AABB hotspot = reference_hotspot_fixed_radius_contiguous(corner, 3.f);
+
+            Assert::AreEqual(3.0f, hotspot.max_size().get_value(), 0.0001f);
+            Assert::AreEqual(6.0, get_longest_subtrajectory_inside(corner, hotspot), 0.0001);
+
+            //A trajectory that fits in the radius is the hotspot
+            const AABB whole_trajectory = reference_hotspot_fixed_radius_contiguous(corner, 20.f);
+            Assert::AreEqual(10.0f, whole_trajectory.max_size().get_value(), 0.0001f);
+        }
+
+        TEST_METHOD(fixed_radius_and_length_known_hotspots)
+        {
+            //Back and forth twice over a short stretch, then one long stretch far away
+            const Trajectory trajectory(std::vector<Vec2>{ { 0.f, 0.f }, { 2.f, 0.f }, { 0.f, 0.f }, { 2.f, 0.f }, { 20.f, 0.f } });
+
+            //Length 6 inside the stretch, the long stretch only has a length of 2 in any hotspot of radius 2
+            const AABB radius_hotspot = reference_hotspot_fixed_radius(trajectory, 2.f);
+            Assert::AreEqual(6.0, get_length_inside(trajectory, radius_hotspot), 0.0001);
+            Assert::IsTrue(radius_hotspot.max_size() <= 2.f);
+
+            //The contiguous hotspot can't be larger than the non contiguous one
+            Assert::AreEqual(6.0, get_longest_subtrajectory_inside(trajectory, reference_hotspot_fixed_radius_contiguous(trajectory, 2.f)), 0.0001);
+
+            //A length of 3 fits in half the stretch
+            const AABB length_hotspot = reference_hotspot_fixed_length(trajectory, 3.f);
+            Assert::AreEqual(1.0f, length_hotspot.max_size().get_value(), 0.001f);
+            Assert::IsTrue(get_length_inside(trajectory, length_hotspot) >= 2.999);
+        }
+
+        TEST_METHOD(check_hotspot_rejects_worse_hotspots)
+        {
+            const Trajectory corner(std::vector<Vec2>{ { 0.f, 0.f }, { 10.f, 0.f }, { 10.f, 10.f } });
+            std::string error;
+
+            //Fixed radius contiguous, larger than the radius or containing less than the reference
+            const AABB radius_hotspot = reference_hotspot_fixed_radius_contiguous(corner, 3.f);
+
+            Assert::IsTrue(check_hotspot(corner, Hotspot_Query::fixed_radius_contiguous, 3.f, radius_hotspot, radius_hotspot, 1e-4, error));
+            Assert::IsFalse(check_hotspot(corner, Hotspot_Query::fixed_radius_contiguous, 3.f, AABB(6.f, 0.f, 10.f, 3.f), radius_hotspot, 1e-4, error));
+            Assert::IsFalse(error.empty());
+
+            error.clear();
+            Assert::IsFalse(check_hotspot(corner, Hotspot_Query::fixed_radius_contiguous, 3.f, AABB(0.f, 0.f, 3.f, 3.f), radius_hotspot, 1e-4, error));
+            Assert::IsFalse(error.empty());
+
+            //Fixed length contiguous, larger than the reference or not containing the length
+            //The optimum is 2 around the corner, it lies between the grid samples
+            const AABB length_hotspot = reference_hotspot_fixed_length_contiguous(corner, 4.f, 64);
+            Assert::AreEqual(2.0f, length_hotspot.max_size().get_value(), 0.1f);
+
+            Assert::IsTrue(check_hotspot(corner, Hotspot_Query::fixed_length_contiguous, 4.f, AABB(8.f, 0.f, 10.f, 2.f), length_hotspot, 1e-4, error));
+            Assert::IsFalse(check_hotspot(corner, Hotspot_Query::fixed_length_contiguous, 4.f, AABB(0.f, -1.f, 4.f, 1.f), length_hotspot, 1e-4, error));
+            Assert::IsFalse(check_hotspot(corner, Hotspot_Query::fixed_length_contiguous, 4.f, AABB(9.f, 0.f, 10.f, 1.f), length_hotspot, 1e-4, error));
+        }
+
+        TEST_METHOD(check_hotspot_valid_ignores_the_reference)
+        {
+            const Trajectory corner(std::vector<Vec2>{ { 0.f, 0.f }, { 10.f, 0.f }, { 10.f, 10.f } });
+            std::string error;
+
+            //A hotspot of the radius that misses the corner is valid, but worse than the reference
+            const AABB radius_hotspot = reference_hotspot_fixed_radius_contiguous(corner, 3.f);
+
+            Assert::IsFalse(check_hotspot(corner, Hotspot_Query::fixed_radius_contiguous, 3.f, AABB(0.f, 0.f, 3.f, 3.f), radius_hotspot, 1e-4, error));
+            Assert::IsTrue(check_hotspot_valid(corner, Hotspot_Query::fixed_radius_contiguous, 3.f, AABB(0.f, 0.f, 3.f, 3.f), 1e-4, error));
+            Assert::IsFalse(check_hotspot_valid(corner, Hotspot_Query::fixed_radius_contiguous, 3.f, AABB(6.f, 0.f, 10.f, 3.f), 1e-4, error));
+
+            //A hotspot that contains the length is valid, even when the reference is smaller
+            const AABB length_hotspot = reference_hotspot_fixed_length_contiguous(corner, 4.f, 64);
+
+            Assert::IsFalse(check_hotspot(corner, Hotspot_Query::fixed_length_contiguous, 4.f, AABB(0.f, -1.f, 4.f, 1.f), length_hotspot, 1e-4, error));
+            Assert::IsTrue(check_hotspot_valid(corner, Hotspot_Query::fixed_length_contiguous, 4.f, AABB(0.f, -1.f, 4.f, 1.f), 1e-4, error));
+            Assert::IsFalse(check_hotspot_valid(corner, Hotspot_Query::fixed_length_contiguous, 4.f, AABB(9.f, 0.f, 10.f, 1.f), 1e-4, error));
+        }
+
+        //The reference answers are valid hotspots on every shape, the checks measure them independently of how they were found
+        TEST_METHOD(reference_hotspots_are_valid)
+        {
+            for (const Trajectory_Shape shape : { Trajectory_Shape::random_walk, Trajectory_Shape::levy_flight, Trajectory_Shape::vehicle, Trajectory_Shape::degenerate })
+            {
+                for (const Hotspot_Query query : { Hotspot_Query::fixed_radius, Hotspot_Query::fixed_radius_contiguous, Hotspot_Query::fixed_length_contiguous })
+                {
+                    const size_t vertex_count = query == Hotspot_Query::fixed_radius ? 15 : 60;
+                    const Trajectory trajectory = generate_trajectory(shape, vertex_count, 3).build_trajectory(hotspot_query_uses_timestamps(query));
+                    const Float parameter = 4.f;
+
+                    const AABB hotspot = run_reference_hotspot_query(trajectory, query, parameter);
+
+                    std::string error;
+                    Assert::IsTrue(check_hotspot(trajectory, query, parameter, hotspot, hotspot, 1e-4, error));
+                    Assert::IsTrue(hotspot.max_size() > 0.f);
+                }
+            }
+        }
+    };
+}
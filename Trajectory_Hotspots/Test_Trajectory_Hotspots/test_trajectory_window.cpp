@@ -0,0 +1,145 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "../Trajectory_Hotspots/pch.h"
+#include "../Trajectory_Hotspots/vec2.h"
+#include "../Trajectory_Hotspots/trajectory.h"
+#include "../Trajectory_Hotspots/fixed_length_contiguous_stream.h"
+#include "../Trajectory_Hotspots/trajectory_window.h"
+
+namespace Microsoft
+{
+    namespace VisualStudio
+    {
+        namespace CppUnitTestFramework
+        {
+            template<> inline std::wstring ToString<Float>(const class Float& t) { return L"Float"; }
+            template<> inline std::wstring ToString<Vec2>(const class Vec2& t) { return L"Vec2"; }
+        }
+    }
+}
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace TestTrajectoryHotspots
+{
+    TEST_CLASS(TestTrajectoryHotspotsTrajectoryWindow)
+    {
+    public:
+
+        TEST_METHOD(evicts_old_segments)
+        {
+            Trajectory_Window window(10.f, 3.f);
+
+            for (int i = 0; i <= 30; i++)
+            {
+                Assert::IsTrue(window.push_back(Vec2(static_cast<float>(i), 0.f), static_cast<float>(i)));
+            }
+
+            //Segments that end at 20 or later
+            Assert::AreEqual(size_t(11), window.get_segment_count());
+            Assert::AreEqual(Float(19.f), window.get_start_time());
+            Assert::AreEqual(Float(30.f), window.get_end_time());
+
+            const AABB length_hotspot = window.get_hotspot_fixed_length_contiguous();
+            Assert::AreEqual(Float(3.f), length_hotspot.max_size());
+
+            //The radius fits the whole window
+            const AABB radius_hotspot = window.get_hotspot_fixed_radius_contiguous(20.f);
+            Assert::AreEqual(Vec2(19.f, 0.f), radius_hotspot.min);
+            Assert::AreEqual(Vec2(30.f, 0.f), radius_hotspot.max);
+
+            //Times must increase
+            Assert::IsFalse(window.push_back(Vec2(31.f, 0.f), 30.f));
+        }
+
+        TEST_METHOD(matches_trajectory_of_window)
+        {
+            std::mt19937 generator(37);
+            std::uniform_real_distribution<float> step(-3.f, 3.f);
+            std::uniform_real_distribution<float> time_step(0.5f, 2.f);
+
+            const Float duration = 40.f;
+            const Float length = 15.f;
+            const Float radius = 6.f;
+
+            Trajectory_Window window(duration, length);
+
+            //The segments in the window with their timestamps as times, and the ones that move with the length along the trajectory
+            //as times, like the stream of the window, and the timestamps of their ends
+            std::deque<Segment> timed_segments;
+            std::deque<std::pair<Segment, Float>> moving_segments;
+
+            Vec2 position(0.f, 0.f);
+            Vec2 last_position;
+            Float time = 0.f;
+            Float last_time = 0.f;
+            Float travelled = 0.f;
+
+            for (size_t i = 0; i < 150; i++)
+            {
+                Assert::IsTrue(window.push_back(position, time));
+
+                if (i > 0)
+                {
+                    timed_segments.push_back(Segment(last_position, position, last_time, time));
+
+                    if (!(position == last_position))
+                    {
+                        moving_segments.push_back({ Segment(last_position, position, travelled), time });
+                        travelled = moving_segments.back().first.end_t;
+                    }
+                }
+
+                last_position = position;
+                last_time = time;
+
+                const Float window_start = time - duration;
+
+                while (!timed_segments.empty() && timed_segments.front().end_t < window_start)
+                {
+                    timed_segments.pop_front();
+                }
+
+                while (!moving_segments.empty() && moving_segments.front().second < window_start)
+                {
+                    moving_segments.pop_front();
+                }
+
+                Assert::AreEqual(timed_segments.size(), window.get_segment_count());
+
+                if (!moving_segments.empty())
+                {
+                    std::vector<Segment> segments;
+                    for (const auto& moving_segment : moving_segments)
+                    {
+                        segments.push_back(moving_segment.first);
+                    }
+
+                    //The same hotspot as a trajectory of the moving segments in the window
+                    const Trajectory length_trajectory(segments);
+                    const AABB expected = length_trajectory.get_hotspot_fixed_length_contiguous(length);
+
+                    Assert::AreEqual(expected.max_size(), window.get_hotspot_fixed_length_contiguous().max_size());
+                }
+
+                if (!timed_segments.empty())
+                {
+                    const Trajectory radius_trajectory(std::vector<Segment>(timed_segments.begin(), timed_segments.end()));
+                    const AABB expected = radius_trajectory.get_hotspot_fixed_radius_contiguous(radius);
+                    const AABB result = window.get_hotspot_fixed_radius_contiguous(radius);
+
+                    Assert::AreEqual(expected.min, result.min);
+                    Assert::AreEqual(expected.max, result.max);
+                }
+
+                if (i % 13 != 7)
+                {
+                    position = position + Vec2(step(generator), step(generator));
+                }
+
+                time += time_step(generator);
+            }
+        }
+    };
+}
@@ -16,15 +16,15 @@ namespace Microsoft
     {
         namespace CppUnitTestFramework
         {
-            template<> static std::wstring ToString<Segment>(const class Segment& t) { return L"Segment"; }
-            template<> static std::wstring ToString<Segment>(const class Segment* t) { return L"Segment"; }
-            template<> static std::wstring ToString<Segment>(class Segment* t) { return L"Segment"; }
-            template<> static std::wstring ToString<Vec2>(const class Vec2& t) { return L"Vec2"; }
-            template<> static std::wstring ToString<Vec2>(const class Vec2* t) { return L"Vec2"; }
-            template<> static std::wstring ToString<Vec2>(class Vec2* t) { return L"Vec2"; }
-            template<> static std::wstring ToString<Trapezoidal_Leaf_Node>(class Trapezoidal_Leaf_Node* t) { return L"Trapezoidal_Leaf_Node"; }
-            template<> static std::wstring ToString<Trapezoidal_Leaf_Node>(const class Trapezoidal_Leaf_Node* t) { return L"Trapezoidal_Leaf_Node"; }
-            template<> static std::wstring ToString<Trapezoidal_Leaf_Node>(const class Trapezoidal_Leaf_Node& t) { return L"Trapezoidal_Leaf_Node"; }
+            template<> inline std::wstring ToString<Segment>(const class Segment& t) { return L"Segment"; }
+            template<> inline std::wstring ToString<Segment>(const class Segment* t) { return L"Segment"; }
+            template<> inline std::wstring ToString<Segment>(class Segment* t) { return L"Segment"; }
+            template<> inline std::wstring ToString<Vec2>(const class Vec2& t) { return L"Vec2"; }
+            template<> inline std::wstring ToString<Vec2>(const class Vec2* t) { return L"Vec2"; }
+            template<> inline std::wstring ToString<Vec2>(class Vec2* t) { return L"Vec2"; }
+            template<> inline std::wstring ToString<Trapezoidal_Leaf_Node>(class Trapezoidal_Leaf_Node* t) { return L"Trapezoidal_Leaf_Node"; }
+            template<> inline std::wstring ToString<Trapezoidal_Leaf_Node>(const class Trapezoidal_Leaf_Node* t) { return L"Trapezoidal_Leaf_Node"; }
+            template<> inline std::wstring ToString<Trapezoidal_Leaf_Node>(const class Trapezoidal_Leaf_Node& t) { return L"Trapezoidal_Leaf_Node"; }
 
         }
     }
@@ -805,6 +805,29 @@ namespace TestTrajectoryHotspots
             Trapezoidal_Map trapezoidal_map(trajectory.get_ordered_trajectory_segments(), 3);
         }
 
+        TEST_METHOD(Construction_Bug_Nearly_Equal_Heights)
+        {
+            //Check for construction bug where endpoints 3 ulps apart counted as equal heights, but the two outer ones 6 ulps apart did not,
+            //so the second segment had its endpoints swapped and its top point ended up below the bottom point of the first
+            const float low = -5791.47119f;
+            const float middle = nextafterf(nextafterf(nextafterf(low, 0.f), 0.f), 0.f);
+            const float high = nextafterf(nextafterf(nextafterf(middle, 0.f), 0.f), 0.f);
+
+            std::vector<Segment> segments;
+            segments.emplace_back(Vec2(10319.f, high), Vec2(10320.f, -5791.42383f), 10319.f, 10320.f);
+            segments.emplace_back(Vec2(10334.f, middle), Vec2(10335.f, low), 10334.f, 10335.f);
+            segments.emplace_back(Vec2(10335.f, low), Vec2(10336.f, -5791.34961f), 10335.f, 10336.f);
+
+            Trapezoidal_Map trapezoidal_map(segments, 0, false);
+
+            const Segment* left_segment = nullptr;
+            const Segment* right_segment = nullptr;
+            trapezoidal_map.trace_left_right(Vec2(10330.f, -5791.44f), true, left_segment, right_segment);
+
+            Assert::AreEqual(segments[0], *left_segment);
+            Assert::AreEqual(segments[2], *right_segment);
+        }
+
         TEST_METHOD(Trace_Bug)
         {
             const std::vector<Vec2> trajectory_points
@@ -838,5 +861,72 @@ namespace TestTrajectoryHotspots
             Assert::AreEqual(trajectory.get_ordered_trajectory_segments()[2], *left_segment);
             Assert::AreEqual(trajectory.get_ordered_trajectory_segments()[3], *right_segment);
         }
+
+        TEST_METHOD(flat_map_trace_matches_map)
+        {
+            //Random walk in the (t, x) plane, the same shape as the maps of fixed radius contiguous
+            std::mt19937 generator(23);
+            std::uniform_real_distribution<float> step(-5.f, 5.f);
+            std::uniform_real_distribution<float> duration(0.5f, 2.f);
+
+            std::vector<Segment> segments;
+            Vec2 point(0.f, 0.f);
+            for (int i = 0; i < 50; i++)
+            {
+                const Vec2 next(point.x + duration(generator), point.y + step(generator));
+                segments.emplace_back(point, next, point.x, next.x);
+                point = next;
+            }
+
+            Trapezoidal_Map trapezoidal_map(segments, 11);
+
+            const Flat_Trapezoidal_Map_Data data = Flat_Trapezoidal_Map::build_data(trapezoidal_map);
+            const Flat_Trapezoidal_Map flat_map(data);
+
+            Assert::IsTrue(flat_map.is_valid());
+
+            //Query the vertices, including the edge cases on the endpoints, and random points
+            std::vector<Vec2> trace_points;
+            for (const Segment& segment : segments)
+            {
+                trace_points.push_back(segment.start);
+            }
+            trace_points.push_back(segments.back().end);
+
+            std::uniform_real_distribution<float> time(0.f, point.x.get_value());
+            std::uniform_real_distribution<float> value(-30.f, 30.f);
+            for (int i = 0; i < 200; i++)
+            {
+                trace_points.emplace_back(time(generator), value(generator));
+            }
+
+            for (const Vec2& trace_point : trace_points)
+            {
+                for (const bool prefer_top : { true, false })
+                {
+                    const Segment* left_segment = nullptr;
+                    const Segment* right_segment = nullptr;
+                    trapezoidal_map.trace_left_right(trace_point, prefer_top, left_segment, right_segment);
+
+                    Segment flat_left_segment;
+                    Segment flat_right_segment;
+                    flat_map.trace_left_right(trace_point, prefer_top, flat_left_segment, flat_right_segment);
+
+                    //The borders lie at infinity, where the tolerant comparisons don't apply
+                    Assert::AreEqual(left_segment == &trapezoidal_map.left_border, flat_left_segment.start.x.is_inf());
+                    Assert::AreEqual(right_segment == &trapezoidal_map.right_border, flat_right_segment.start.x.is_inf());
+
+                    if (left_segment != &trapezoidal_map.left_border)
+                    {
+                        Assert::AreEqual(*left_segment, flat_left_segment);
+                    }
+
+                    if (right_segment != &trapezoidal_map.right_border)
+                    {
+                        Assert::AreEqual(*right_segment, flat_right_segment);
+                    }
+                }
+            }
+        }
     };
 }
\ No newline at end of file
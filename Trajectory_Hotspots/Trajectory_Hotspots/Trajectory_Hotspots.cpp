@@ -3,10 +3,636 @@
 #include "pch.h"
 
 #include "vec2.h"
+#include "trajectory.h"
+#include "hotspot_query.h"
+#include "memory_mapped_file.h"
+#include "trajectory_csv.h"
+#include "trajectory_geo.h"
+#include "trajectory_archive.h"
+#include "trajectory_index_snapshot.h"
+
+#include <charconv>
+#include <chrono>
+#include <fstream>
 
 //TODO: Very far away but scale segments calc by time?
 
-int main()
+namespace
+{
+    struct Query_Request
+    {
+        Hotspot_Query query;
+        float parameter;
+    };
+
+    struct Query_Result
+    {
+        int64_t trajectory_id;
+        Hotspot_Query query;
+        float parameter;
+        AABB hotspot;
+    };
+
+    //Fixed radius contiguous queries use the prebuilt indexes of the snapshot if one is given
+    //All queries share the arena of the thread, so after the largest trajectory they don't allocate anymore
+    AABB run_query(const Trajectory& trajectory, const Query_Request& request, const Trajectory_Index_Snapshot* snapshot)
+    {
+        Scratch_Arena* arena = &get_thread_scratch_arena();
+
+        if (snapshot != nullptr && request.query == Hotspot_Query::fixed_radius_contiguous)
+        {
+            return trajectory.get_hotspot_fixed_radius_contiguous(request.parameter, *snapshot, arena);
+        }
+
+        return run_hotspot_query(trajectory, request.query, request.parameter, arena);
+    }
+
+    //Returns true if the path ends with the extension, ignoring case
+    bool has_extension(const char* path, const char* extension)
+    {
+        const size_t path_size = strlen(path);
+        const size_t extension_size = strlen(extension);
+
+        if (path_size < extension_size)
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < extension_size; i++)
+        {
+            if (tolower(static_cast<unsigned char>(path[path_size - extension_size + i])) != extension[i])
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    //Parses the text with the reader that matches the file extension, CSV for unknown extensions
+    //Geographic formats are projected to a local frame around their first point
+    bool parse_input(const char* path, const char* text, const size_t text_size, Geo_Projection& projection, Trajectory_CSV& trajectories, std::string& error)
+    {
+        if (has_extension(path, ".gpx")) return parse_gpx(text, text_size, projection, trajectories, error);
+        if (has_extension(path, ".plt")) return parse_plt(text, text_size, projection, trajectories, error);
+        if (has_extension(path, ".geojson") || has_extension(path, ".json")) return parse_geojson(text, text_size, projection, trajectories, error);
+
+        return trajectories.parse(text, text_size, error);
+    }
+
+    //Milliseconds since the given time point
+    double elapsed_ms(const std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void print_usage()
+    {
+        std::cerr <<
+            "Usage: Trajectory_Hotspots <input.csv|input.gpx|input.plt|input.geojson|input archive> [options]\n"
+            "\n"
+            "Reads trajectories from a CSV file with the columns x,y[,t][,trajectory_id], or from a trajectory archive, and computes hotspots.\n"
+            "Consecutive rows with the same trajectory_id form one trajectory, and the time has to increase within it.\n"
+            "The radius queries use the times, the length queries always measure the length along the trajectory.\n"
+            "GPX, GeoLife PLT, and GeoJSON files are read by extension and projected to meters around their first point.\n"
+            "\n"
+            "Queries, each takes one or more comma separated radii or lengths and may be given multiple times:\n"
+            "  --fixed-radius <r>              Trajectory::get_hotspot_fixed_radius\n"
+            "  --fixed-length <l>              Trajectory::get_hotspot_fixed_length\n"
+            "  --fixed-radius-contiguous <r>   Trajectory::get_hotspot_fixed_radius_contiguous\n"
+            "  --fixed-length-contiguous <l>   Trajectory::get_hotspot_fixed_length_contiguous\n"
+            "\n"
+            "Output:\n"
+            "  --format <csv|json>             Result format, csv by default\n"
+            "  --output <path>                 Write results to a file instead of stdout\n"
+            "  --trajectory-id <id>            Only query the trajectory with this id\n"
+            "  --trace <path>                  Write the query phases as Chrome trace JSON, for chrome://tracing or ui.perfetto.dev\n"
+            "  --statistics                    Write the work and memory of each query type to stderr, needs a build with\n"
+            "                                  TRAJECTORY_HOTSPOTS_STATISTICS\n"
+            "\n"
+            "Archives:\n"
+            "  --write-archive <path>          Convert the CSV input to a binary trajectory archive, queries are optional\n"
+            "  --archive-float64               Store the archive vertices as float64 instead of float32\n"
+            "  --archive-trees                 Embed a segment search tree for each trajectory in the archive\n"
+            "  --archive-compress              Store the archive vertices as quantized delta varints, decoded when read\n"
+            "  --archive-resolution <r>        Quantization step of compressed coordinates and times, defaults to 0.001\n"
+            "\n"
+            "Index snapshots:\n"
+            "  --snapshot <path>               Query fixed radius contiguous with the indexes in this snapshot file, the snapshot\n"
+            "                                  is written first if it doesn't exist or was written for a different trajectory\n"
+            "                                  Needs a single trajectory, select one with --trajectory-id\n"
+            "\n"
+            "Per-phase timings are written to stderr.\n";
+    }
+
+    //Parses a comma separated list of positive values
+    bool parse_parameters(const char* text, const Hotspot_Query query, std::vector<Query_Request>& requests)
+    {
+        const char* position = text;
+        const char* const end = text + strlen(text);
+
+        while (position < end)
+        {
+            const char* value_end = static_cast<const char*>(memchr(position, ',', static_cast<size_t>(end - position)));
+            if (value_end == nullptr) value_end = end;
+
+            float value = 0.f;
+            const std::from_chars_result result = std::from_chars(position, value_end, value);
+
+            if (result.ec != std::errc() || result.ptr != value_end || !(value > 0.f))
+            {
+                return false;
+            }
+
+            requests.push_back({ query, value });
+            position = value_end + 1;
+        }
+
+        return !requests.empty();
+    }
+
+    void print_statistics(const Hotspot_Query query, const Query_Statistics& statistics)
+    {
+        std::cerr << "statistics " << hotspot_query_name(query) << ":\n"
+            << "  tree queries: " << statistics.tree_queries << ", nodes visited: " << statistics.tree_nodes_visited << "\n"
+            << "  map nodes: " << statistics.map_nodes << ", map queries: " << statistics.map_queries
+            << ", depth max: " << statistics.map_query_depth_max << ", depth average: " << statistics.get_average_map_query_depth() << "\n";
+
+        std::cerr << "  breakpoints accepted/candidates:";
+        for (size_t type = 0; type < Query_Statistics::breakpoint_type_count; type++)
+        {
+            std::cerr << " " << statistics.breakpoint_accepted[type] << "/" << statistics.breakpoint_candidates[type];
+        }
+
+        std::cerr << "\n  radius candidates: " << statistics.radius_candidates << ", rejected: " << statistics.radius_rejected << "\n";
+
+        for (const Query_Phase phase : { Query_Phase::tree_build, Query_Phase::map_build, Query_Phase::search })
+        {
+            const Memory_Statistics& memory = statistics.get_memory(phase);
+            std::cerr << "  " << query_phase_name(phase) << " allocations: " << memory.allocations << ", bytes: " << memory.bytes << ", peak live bytes: " << memory.peak_live_bytes << "\n";
+        }
+
+        std::cerr << "  peak live bytes: " << statistics.peak_live_bytes << "\n";
+    }
+
+    void write_csv(std::ostream& output, const std::vector<Query_Result>& results)
+    {
+        output << "trajectory_id,query,parameter,min_x,min_y,max_x,max_y\n";
+
+        for (const Query_Result& result : results)
+        {
+            output << result.trajectory_id << ',' << hotspot_query_name(result.query) << ',' << result.parameter << ','
+                << result.hotspot.min.x.get_value() << ',' << result.hotspot.min.y.get_value() << ','
+                << result.hotspot.max.x.get_value() << ',' << result.hotspot.max.y.get_value() << '\n';
+        }
+    }
+
+    void write_json(std::ostream& output, const std::vector<Query_Result>& results)
+    {
+        output << "[\n";
+
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const Query_Result& result = results[i];
+
+            output << "  {\"trajectory_id\": " << result.trajectory_id
+                << ", \"query\": \"" << hotspot_query_name(result.query) << "\""
+                << ", \"parameter\": " << result.parameter
+                << ", \"min\": [" << result.hotspot.min.x.get_value() << ", " << result.hotspot.min.y.get_value() << "]"
+                << ", \"max\": [" << result.hotspot.max.x.get_value() << ", " << result.hotspot.max.y.get_value() << "]}"
+                << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+
+        output << "]\n";
+    }
+}
+
+int main(int argc, char* argv[])
 {
-    
+    const char* input_path = nullptr;
+    const char* output_path = nullptr;
+    const char* archive_path = nullptr;
+    const char* snapshot_path = nullptr;
+    const char* trace_path = nullptr;
+    bool json = false;
+    bool print_query_statistics = false;
+
+    Trajectory_Archive_Options archive_options;
+
+    bool has_trajectory_id = false;
+    int64_t selected_trajectory_id = 0;
+
+    std::vector<Query_Request> requests;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string argument = argv[i];
+
+        if (argument == "--help" || argument == "-h")
+        {
+            print_usage();
+            return 0;
+        }
+
+        const bool has_value = i + 1 < argc;
+
+        Hotspot_Query query;
+        bool is_query = true;
+
+        if (argument == "--fixed-radius") query = Hotspot_Query::fixed_radius;
+        else if (argument == "--fixed-length") query = Hotspot_Query::fixed_length;
+        else if (argument == "--fixed-radius-contiguous") query = Hotspot_Query::fixed_radius_contiguous;
+        else if (argument == "--fixed-length-contiguous") query = Hotspot_Query::fixed_length_contiguous;
+        else is_query = false;
+
+        if (is_query)
+        {
+            if (!has_value || !parse_parameters(argv[++i], query, requests))
+            {
+                std::cerr << "error: " << argument << " needs a comma separated list of positive numbers\n";
+                return 1;
+            }
+        }
+        else if (argument == "--format" && has_value)
+        {
+            const std::string format = argv[++i];
+
+            if (format != "csv" && format != "json")
+            {
+                std::cerr << "error: unknown format " << format << ", expected csv or json\n";
+                return 1;
+            }
+
+            json = format == "json";
+        }
+        else if (argument == "--output" && has_value)
+        {
+            output_path = argv[++i];
+        }
+        else if (argument == "--trajectory-id" && has_value)
+        {
+            const char* value = argv[++i];
+            const std::from_chars_result result = std::from_chars(value, value + strlen(value), selected_trajectory_id);
+
+            if (result.ec != std::errc() || *result.ptr != '\0')
+            {
+                std::cerr << "error: --trajectory-id needs an integer\n";
+                return 1;
+            }
+
+            has_trajectory_id = true;
+        }
+        else if (argument == "--write-archive" && has_value)
+        {
+            archive_path = argv[++i];
+        }
+        else if (argument == "--snapshot" && has_value)
+        {
+            snapshot_path = argv[++i];
+        }
+        else if (argument == "--trace" && has_value)
+        {
+            trace_path = argv[++i];
+        }
+        else if (argument == "--statistics")
+        {
+            print_query_statistics = true;
+        }
+        else if (argument == "--archive-float64")
+        {
+            archive_options.float64_vertices = true;
+        }
+        else if (argument == "--archive-trees")
+        {
+            archive_options.embed_trees = true;
+        }
+        else if (argument == "--archive-compress")
+        {
+            archive_options.compress_vertices = true;
+        }
+        else if (argument == "--archive-resolution" && has_value)
+        {
+            const char* value = argv[++i];
+            double resolution = 0.0;
+            const std::from_chars_result result = std::from_chars(value, value + strlen(value), resolution);
+
+            if (result.ec != std::errc() || *result.ptr != '\0' || !(resolution > 0.0))
+            {
+                std::cerr << "error: --archive-resolution needs a positive number\n";
+                return 1;
+            }
+
+            archive_options.compression.position_resolution = resolution;
+            archive_options.compression.time_resolution = resolution;
+        }
+        else if (argument.size() > 0 && argument[0] != '-' && input_path == nullptr)
+        {
+            input_path = argv[i];
+        }
+        else
+        {
+            std::cerr << "error: unexpected argument " << argument << "\n";
+            print_usage();
+            return 1;
+        }
+    }
+
+    if (input_path == nullptr || (requests.empty() && archive_path == nullptr))
+    {
+        print_usage();
+        return 1;
+    }
+
+    set_tracing_enabled(trace_path != nullptr);
+
+    //Open an archive in place, or parse CSV text
+    const auto parse_start = std::chrono::steady_clock::now();
+
+    Memory_Mapped_File input;
+    if (!input.open(input_path))
+    {
+        std::cerr << "error: can't open " << input_path << "\n";
+        return 1;
+    }
+
+    const bool input_is_archive = Trajectory_Archive::is_archive(input.data(), input.size());
+    const size_t input_size = input.size();
+
+    Trajectory_Archive archive;
+    Trajectory_CSV trajectories;
+    Geo_Projection projection;
+    std::string error;
+
+    if (input_is_archive)
+    {
+        input.close();
+
+        if (!archive.open(input_path, error))
+        {
+            std::cerr << "error: " << input_path << ": " << error << "\n";
+            return 1;
+        }
+    }
+    else if (!parse_input(input_path, input.data(), input.size(), projection, trajectories, error))
+    {
+        std::cerr << "error: " << input_path << ": " << error << "\n";
+        return 1;
+    }
+
+    for (const int64_t trajectory_id : trajectories.repeated_trajectory_ids)
+    {
+        std::cerr << "warning: " << input_path << ": trajectory id " << trajectory_id << " appears again after other ids, its rows are read as separate trajectories\n";
+    }
+
+    const double parse_ms = elapsed_ms(parse_start);
+
+    //Convert to an archive
+    double archive_ms = 0.0;
+
+    if (archive_path != nullptr)
+    {
+        if (input_is_archive)
+        {
+            std::cerr << "error: " << input_path << " already is an archive\n";
+            return 1;
+        }
+
+        const auto archive_start = std::chrono::steady_clock::now();
+
+        if (!write_trajectory_archive(archive_path, trajectories, archive_options, error))
+        {
+            std::cerr << "error: " << archive_path << ": " << error << "\n";
+            return 1;
+        }
+
+        archive_ms = elapsed_ms(archive_start);
+    }
+
+    //Select the trajectories, all of them or the one with the requested id
+    const size_t trajectory_count = input_is_archive ? archive.trajectory_count() : trajectories.trajectory_count();
+
+    size_t first_trajectory = 0;
+    size_t last_trajectory = trajectory_count;
+
+    if (has_trajectory_id)
+    {
+        bool found = false;
+
+        if (input_is_archive)
+        {
+            found = archive.find(selected_trajectory_id, first_trajectory);
+        }
+        else
+        {
+            const auto id = std::find(trajectories.trajectory_ids.begin(), trajectories.trajectory_ids.end(), selected_trajectory_id);
+            found = id != trajectories.trajectory_ids.end();
+            first_trajectory = static_cast<size_t>(id - trajectories.trajectory_ids.begin());
+        }
+
+        if (!found)
+        {
+            std::cerr << "error: no trajectory with id " << selected_trajectory_id << "\n";
+            return 1;
+        }
+
+        last_trajectory = first_trajectory + 1;
+    }
+
+    if (snapshot_path != nullptr && last_trajectory - first_trajectory != 1)
+    {
+        std::cerr << "error: --snapshot needs a single trajectory, select one with --trajectory-id\n";
+        return 1;
+    }
+
+    //Build the trajectories and run the queries on each of them
+    double build_ms = 0.0;
+    double snapshot_ms = 0.0;
+    bool snapshot_written = false;
+    double query_ms[4] = { 0.0, 0.0, 0.0, 0.0 };
+    Query_Statistics query_statistics[4];
+    size_t skipped_trajectories = 0;
+
+    std::vector<Query_Result> results;
+    results.reserve((last_trajectory - first_trajectory) * requests.size());
+
+    //The length queries measure the length along the trajectory in time, so with timestamps in the input they get a second trajectory
+    //with the length as time. Without timestamps both are the same trajectory, which is only built once.
+    const bool input_has_time = input_is_archive ? archive.has_time() : trajectories.has_time;
+    const bool has_timestamp_query = std::any_of(requests.begin(), requests.end(), [](const Query_Request& request) { return hotspot_query_uses_timestamps(request.query); });
+    const bool has_length_query = std::any_of(requests.begin(), requests.end(), [](const Query_Request& request) { return !hotspot_query_uses_timestamps(request.query); });
+
+    const bool build_timestamp_trajectory = has_timestamp_query || snapshot_path != nullptr;
+    const bool build_length_trajectory = has_length_query && (input_has_time || !build_timestamp_trajectory);
+
+    for (size_t i = first_trajectory; i < last_trajectory && !requests.empty(); i++)
+    {
+        //A trajectory needs at least one segment
+        if (input_is_archive ? !archive.is_entry_valid(i) : trajectories.trajectory_end(i) - trajectories.trajectory_begin(i) < 2)
+        {
+            skipped_trajectories++;
+            continue;
+        }
+
+        const auto build_start = std::chrono::steady_clock::now();
+
+        Trajectory timestamp_trajectory;
+        Trajectory length_trajectory;
+
+        if (build_timestamp_trajectory)
+        {
+            timestamp_trajectory = input_is_archive ? archive.build_trajectory(i, true) : trajectories.build_trajectory(i, true);
+        }
+
+        if (build_length_trajectory)
+        {
+            length_trajectory = input_is_archive ? archive.build_trajectory(i, false) : trajectories.build_trajectory(i, false);
+        }
+
+        build_ms += elapsed_ms(build_start);
+
+        const int64_t trajectory_id = input_is_archive ? archive.get_entry(i).trajectory_id : trajectories.trajectory_ids[i];
+
+        //Open the snapshot, or write it when it is missing, stale, or corrupt
+        Trajectory_Index_Snapshot snapshot;
+
+        if (snapshot_path != nullptr)
+        {
+            const auto snapshot_start = std::chrono::steady_clock::now();
+
+            if (!snapshot.open(snapshot_path, error) || !snapshot.matches(timestamp_trajectory) || !snapshot.is_valid())
+            {
+                if (!Trajectory_Index_Snapshot::write(snapshot_path, timestamp_trajectory, error) || !snapshot.open(snapshot_path, error))
+                {
+                    std::cerr << "error: " << snapshot_path << ": " << error << "\n";
+                    return 1;
+                }
+
+                snapshot_written = true;
+            }
+
+            snapshot_ms += elapsed_ms(snapshot_start);
+        }
+
+        for (const Query_Request& request : requests)
+        {
+            //Statistics are only counted in builds with TRAJECTORY_HOTSPOTS_STATISTICS, the scope costs nothing otherwise
+            Query_Statistics statistics;
+            AABB hotspot;
+
+            const Trajectory& trajectory = build_length_trajectory && !hotspot_query_uses_timestamps(request.query) ? length_trajectory : timestamp_trajectory;
+
+            {
+                const Query_Statistics_Scope statistics_scope(statistics);
+
+                const auto query_start = std::chrono::steady_clock::now();
+                hotspot = run_query(trajectory, request, snapshot_path != nullptr ? &snapshot : nullptr);
+                query_ms[static_cast<int>(request.query)] += elapsed_ms(query_start);
+            }
+
+            query_statistics[static_cast<int>(request.query)].add(statistics);
+
+            results.push_back({ trajectory_id, request.query, request.parameter, hotspot });
+        }
+    }
+
+    //Write the results
+    const auto write_start = std::chrono::steady_clock::now();
+
+    std::ofstream output_file;
+    if (output_path != nullptr && !requests.empty())
+    {
+        output_file.open(output_path);
+
+        if (!output_file)
+        {
+            std::cerr << "error: can't write " << output_path << "\n";
+            return 1;
+        }
+    }
+
+    std::ostream& output = output_path != nullptr ? output_file : std::cout;
+    output.precision(9);
+
+    if (requests.empty())
+    {
+        //Only converted to an archive
+    }
+    else if (json)
+    {
+        write_json(output, results);
+    }
+    else
+    {
+        write_csv(output, results);
+    }
+
+    output.flush();
+
+    const double write_ms = elapsed_ms(write_start);
+
+    if (trace_path != nullptr && !write_chrome_trace(trace_path, error))
+    {
+        std::cerr << "error: " << trace_path << ": " << error << "\n";
+        return 1;
+    }
+
+    //Timings
+    const double megabytes = static_cast<double>(input_size) / (1024.0 * 1024.0);
+
+    std::cerr << "trajectories: " << trajectory_count << " (" << skipped_trajectories << " skipped)\n";
+
+    if (projection.has_origin())
+    {
+        std::cerr.precision(9);
+        std::cerr << "projection origin: " << projection.origin_latitude << ", " << projection.origin_longitude << "\n";
+        std::cerr.precision(6);
+    }
+
+    if (input_is_archive)
+    {
+        std::cerr << "open archive: " << parse_ms << " ms\n";
+    }
+    else
+    {
+        std::cerr << "parse: " << parse_ms << " ms (" << (parse_ms > 0.0 ? megabytes / (parse_ms / 1000.0) : 0.0) << " MB/s)\n";
+    }
+
+    if (archive_path != nullptr)
+    {
+        std::cerr << "write archive: " << archive_ms << " ms\n";
+    }
+
+    std::cerr << "build: " << build_ms << " ms\n";
+
+    if (snapshot_path != nullptr)
+    {
+        std::cerr << (snapshot_written ? "write snapshot: " : "open snapshot: ") << snapshot_ms << " ms\n";
+    }
+
+    for (int query = 0; query < 4; query++)
+    {
+        if (query_ms[query] > 0.0)
+        {
+            std::cerr << "query " << hotspot_query_name(static_cast<Hotspot_Query>(query)) << ": " << query_ms[query] << " ms\n";
+        }
+    }
+
+    if (print_query_statistics && !Query_Statistics::enabled)
+    {
+        std::cerr << "statistics: not collected, build with TRAJECTORY_HOTSPOTS_STATISTICS defined\n";
+    }
+    else if (print_query_statistics)
+    {
+        for (int query = 0; query < 4; query++)
+        {
+            if (query_ms[query] > 0.0)
+            {
+                print_statistics(static_cast<Hotspot_Query>(query), query_statistics[query]);
+            }
+        }
+    }
+
+    std::cerr << "write: " << write_ms << " ms\n";
+
+    return output ? 0 : 1;
 }
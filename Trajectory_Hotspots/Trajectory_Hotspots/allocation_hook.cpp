@@ -0,0 +1,64 @@
+#include "pch.h"
+#include "allocation_hook.h"
+
+namespace
+{
+    Allocation_Hook allocation_hook;
+}
+
+void set_allocation_hook(const Allocation_Hook& hook)
+{
+    //Both functions or neither, so memory is never freed by a different allocator than the one that allocated it
+    assert((hook.allocate == nullptr) == (hook.deallocate == nullptr));
+
+    allocation_hook = hook;
+}
+
+const Allocation_Hook& get_allocation_hook()
+{
+    return allocation_hook;
+}
+
+void* hooked_allocate(const size_t bytes)
+{
+    TRAJECTORY_HOTSPOTS_COUNT(statistics->count_allocation(bytes));
+
+    if (Scratch_Arena* arena = Scratch_Arena_Scope::active)
+    {
+        return arena->allocate(bytes);
+    }
+
+    if (allocation_hook.allocate != nullptr)
+    {
+        void* memory = allocation_hook.allocate(bytes, allocation_hook.context);
+
+        if (memory == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+
+        return memory;
+    }
+
+    return ::operator new(bytes);
+}
+
+void hooked_deallocate(void* memory, const size_t bytes)
+{
+    TRAJECTORY_HOTSPOTS_COUNT(statistics->count_deallocation(bytes));
+
+    //Arena memory is reused after the arena is reset, memory from before the scope goes back to where it came from
+    const Scratch_Arena* arena = Scratch_Arena_Scope::active;
+    if (arena != nullptr && arena->owns(memory))
+    {
+        return;
+    }
+
+    if (allocation_hook.deallocate != nullptr)
+    {
+        allocation_hook.deallocate(memory, bytes, allocation_hook.context);
+        return;
+    }
+
+    ::operator delete(memory);
+}
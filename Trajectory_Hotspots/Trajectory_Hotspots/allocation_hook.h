@@ -0,0 +1,62 @@
+#pragma once
+
+//The nodes of the trees and trapezoidal maps and the temporary vectors of the queries allocate through this hook,
+//so an application can route them to its own allocator, and the query statistics can count them per phase.
+//Without a hook they use operator new and delete. Inside a Scratch_Arena_Scope they come from its arena instead, see scratch_arena.h.
+//A hook has to return memory aligned like operator new does, the nodes hold 16 byte SIMD values.
+struct Allocation_Hook
+{
+    void* (*allocate)(size_t bytes, void* context) = nullptr;
+    void (*deallocate)(void* memory, size_t bytes, void* context) = nullptr;
+    void* context = nullptr;
+};
+
+//Replaces the hook of all threads, a default constructed hook restores operator new and delete
+//Memory is freed by the hook that is set at that time, so only change the hook while no trees, maps or queries exist.
+void set_allocation_hook(const Allocation_Hook& hook);
+const Allocation_Hook& get_allocation_hook();
+
+void* hooked_allocate(const size_t bytes);
+void hooked_deallocate(void* memory, const size_t bytes);
+
+//Standard allocator on top of the hook, for the containers of the library
+template<typename T>
+class Hooked_Allocator
+{
+public:
+
+    typedef T value_type;
+
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "The hook only guarantees the alignment of operator new");
+
+    Hooked_Allocator() = default;
+
+    template<typename U>
+    Hooked_Allocator(const Hooked_Allocator<U>&) {}
+
+    T* allocate(const size_t count)
+    {
+        return static_cast<T*>(hooked_allocate(count * sizeof(T)));
+    }
+
+    void deallocate(T* memory, const size_t count)
+    {
+        hooked_deallocate(memory, count * sizeof(T));
+    }
+
+    template<typename U>
+    bool operator==(const Hooked_Allocator<U>&) const { return true; }
+
+    template<typename U>
+    bool operator!=(const Hooked_Allocator<U>&) const { return false; }
+};
+
+template<typename T>
+using Hooked_Vector = std::vector<T, Hooked_Allocator<T>>;
+
+//Like std::make_shared, the object and its control block are allocated through the hook
+template<typename T, typename... Arguments>
+std::shared_ptr<T> make_hooked_shared(Arguments&&... arguments)
+{
+    return std::allocate_shared<T>(Hooked_Allocator<T>(), std::forward<Arguments>(arguments)...);
+}
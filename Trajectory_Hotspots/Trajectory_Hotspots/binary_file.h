@@ -0,0 +1,86 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+
+//Helpers shared by the binary file formats, which align every section to 8 bytes
+
+inline uint64_t align_to_8(const uint64_t offset)
+{
+    return (offset + 7) & ~uint64_t(7);
+}
+
+//Checks that [offset, offset + size) lies inside a file of file_size bytes
+inline bool section_fits(const uint64_t offset, const uint64_t size, const uint64_t file_size)
+{
+    return offset <= file_size && size <= file_size - offset;
+}
+
+//Writes zeros from position up to aligned_position
+inline void write_padding(std::ofstream& output, const uint64_t position, const uint64_t aligned_position)
+{
+    const char zeros[8] = {};
+    output.write(zeros, static_cast<std::streamsize>(aligned_position - position));
+}
+
+//Writes a file next to its path and moves it over the path once it is complete
+//Processes that have the old file mapped keep their copy, and a process opening the path sees the old or the whole new file, never a partial one.
+class Replacing_File_Writer
+{
+public:
+
+    //Opens the temporary file, check output before writing
+    explicit Replacing_File_Writer(const char* path) : path(path)
+    {
+        //Writers of the same path in other processes each get their own temporary file
+        temporary_path = this->path + "." + std::to_string(std::random_device()()) + ".tmp";
+        output.open(temporary_path, std::ios::binary | std::ios::trunc);
+    }
+
+    //Removes the temporary file if it wasn't moved over the path
+    ~Replacing_File_Writer()
+    {
+        if (!committed)
+        {
+            output.close();
+
+            std::error_code ignored;
+            std::filesystem::remove(temporary_path, ignored);
+        }
+    }
+
+    Replacing_File_Writer(const Replacing_File_Writer&) = delete;
+    Replacing_File_Writer& operator=(const Replacing_File_Writer&) = delete;
+
+    //Closes the written file and moves it over the path, returns false and sets error if that fails
+    bool commit(std::string& error)
+    {
+        output.close();
+
+        if (!output)
+        {
+            error = "failed closing " + temporary_path;
+            return false;
+        }
+
+        std::error_code rename_error;
+        std::filesystem::rename(temporary_path, path, rename_error);
+
+        if (rename_error)
+        {
+            error = "can't replace " + path + ": " + rename_error.message();
+            return false;
+        }
+
+        committed = true;
+        return true;
+    }
+
+    std::ofstream output;
+
+private:
+
+    std::string path;
+    std::string temporary_path;
+    bool committed = false;
+};
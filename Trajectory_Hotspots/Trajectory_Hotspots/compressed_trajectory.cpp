@@ -0,0 +1,321 @@
+#include "pch.h"
+#include "compressed_trajectory.h"
+
+namespace
+{
+    //Quantized values are kept well inside int64 so deltas can't overflow
+    constexpr double quantized_limit = 4.0e18;
+
+    inline uint64_t zigzag_encode(const int64_t value)
+    {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    inline int64_t zigzag_decode(const uint64_t value)
+    {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    inline void write_varint(std::vector<uint8_t>& output, const int64_t signed_value)
+    {
+        uint64_t value = zigzag_encode(signed_value);
+
+        while (value >= 0x80)
+        {
+            output.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+
+        output.push_back(static_cast<uint8_t>(value));
+    }
+
+    inline int64_t read_varint(const uint8_t*& position)
+    {
+        uint64_t value = 0;
+        int shift = 0;
+
+        while (*position & 0x80)
+        {
+            value |= static_cast<uint64_t>(*position++ & 0x7f) << shift;
+            shift += 7;
+        }
+
+        value |= static_cast<uint64_t>(*position++) << shift;
+
+        return zigzag_decode(value);
+    }
+
+    inline bool quantize(const float value, const double resolution, int64_t& quantized)
+    {
+        const double scaled = static_cast<double>(value) / resolution;
+
+        if (!(fabs(scaled) < quantized_limit))
+        {
+            return false;
+        }
+
+        quantized = llround(scaled);
+        return true;
+    }
+
+    inline float dequantize(const int64_t quantized, const double resolution)
+    {
+        return static_cast<float>(static_cast<double>(quantized) * resolution);
+    }
+}
+
+bool encode_compressed_trajectory(const float* x, const float* y, const float* t, const size_t count, const Compressed_Trajectory_Options& options, std::vector<char>& output, std::string& error)
+{
+    if (!(options.position_resolution > 0.0) || !(options.time_resolution > 0.0) || options.block_size == 0)
+    {
+        error = "resolutions and block size must be positive";
+        return false;
+    }
+
+    if (count > std::numeric_limits<uint32_t>::max())
+    {
+        error = "too many vertices";
+        return false;
+    }
+
+    Compressed_Trajectory_Header header = {};
+    header.vertex_count = static_cast<uint32_t>(count);
+    header.block_count = static_cast<uint32_t>((count + options.block_size - 1) / options.block_size);
+    header.block_size = options.block_size;
+    header.flags = t != nullptr ? Compressed_Trajectory_Header::has_time : 0;
+    header.position_resolution = options.position_resolution;
+    header.time_resolution = options.time_resolution;
+
+    std::vector<Compressed_Trajectory_Block> blocks;
+    blocks.reserve(header.block_count);
+
+    std::vector<uint8_t> deltas;
+    deltas.reserve(count * 3);
+
+    int64_t previous_x = 0;
+    int64_t previous_y = 0;
+    int64_t previous_t = 0;
+    int64_t previous_dt = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        int64_t quantized_x;
+        int64_t quantized_y;
+        int64_t quantized_t = 0;
+
+        if (!quantize(x[i], options.position_resolution, quantized_x) || !quantize(y[i], options.position_resolution, quantized_y) ||
+            (t != nullptr && !quantize(t[i], options.time_resolution, quantized_t)))
+        {
+            error = "vertex " + std::to_string(i) + " can't be quantized";
+            return false;
+        }
+
+        const int64_t dt = i > 0 ? quantized_t - previous_t : 0;
+
+        if (i % options.block_size == 0)
+        {
+            Compressed_Trajectory_Block block;
+            block.x = quantized_x;
+            block.y = quantized_y;
+            block.t = quantized_t;
+            block.dt = dt;
+            block.start_t = t != nullptr ? dequantize(quantized_t, options.time_resolution) : 0.f;
+            block.first_vertex = static_cast<uint32_t>(i);
+            block.data_offset = deltas.size();
+
+            blocks.push_back(block);
+        }
+        else
+        {
+            write_varint(deltas, quantized_x - previous_x);
+            write_varint(deltas, quantized_y - previous_y);
+
+            if (t != nullptr)
+            {
+                write_varint(deltas, dt - previous_dt);
+            }
+        }
+
+        previous_x = quantized_x;
+        previous_y = quantized_y;
+        previous_t = quantized_t;
+        previous_dt = dt;
+    }
+
+    //Pad the deltas so blobs written after each other stay aligned to 8 bytes
+    deltas.resize((deltas.size() + 7) & ~size_t(7), 0);
+    header.data_size = deltas.size();
+
+    const size_t begin = output.size();
+    output.resize(begin + sizeof(header) + blocks.size() * sizeof(Compressed_Trajectory_Block) + deltas.size());
+
+    char* position = output.data() + begin;
+    memcpy(position, &header, sizeof(header));
+    position += sizeof(header);
+
+    if (!blocks.empty())
+    {
+        memcpy(position, blocks.data(), blocks.size() * sizeof(Compressed_Trajectory_Block));
+        position += blocks.size() * sizeof(Compressed_Trajectory_Block);
+    }
+
+    if (!deltas.empty())
+    {
+        memcpy(position, deltas.data(), deltas.size());
+    }
+
+    return true;
+}
+
+bool Compressed_Trajectory::is_valid() const
+{
+    if (data == nullptr || size < sizeof(Compressed_Trajectory_Header))
+    {
+        return false;
+    }
+
+    const Compressed_Trajectory_Header& header = get_header();
+
+    if (header.block_size == 0 || header.block_count != (static_cast<uint64_t>(header.vertex_count) + header.block_size - 1) / header.block_size ||
+        !(header.position_resolution > 0.0) || !(header.time_resolution > 0.0))
+    {
+        return false;
+    }
+
+    const uint64_t index_size = sizeof(Compressed_Trajectory_Header) + static_cast<uint64_t>(header.block_count) * sizeof(Compressed_Trajectory_Block);
+    if (index_size > size || header.data_size > size - index_size)
+    {
+        return false;
+    }
+
+    //Every block must hold exactly its deltas, so decoding never reads past the blob
+    const Compressed_Trajectory_Block* blocks = get_blocks();
+    const uint8_t* deltas = get_deltas();
+    const uint64_t values_per_vertex = has_time() ? 3 : 2;
+
+    for (uint32_t i = 0; i < header.block_count; i++)
+    {
+        const uint64_t block_end = i + 1 < header.block_count ? blocks[i + 1].data_offset : header.data_size;
+        const uint64_t vertex_count = std::min<uint64_t>(header.block_size, header.vertex_count - static_cast<uint64_t>(i) * header.block_size);
+
+        if (blocks[i].first_vertex != static_cast<uint64_t>(i) * header.block_size || blocks[i].data_offset > block_end || block_end > header.data_size)
+        {
+            return false;
+        }
+
+        //Count the varints of the block, the last byte of each has the high bit cleared and a 64-bit value takes at most 10 bytes
+        uint64_t value_count = 0;
+        uint64_t value_bytes = 0;
+        for (uint64_t byte = blocks[i].data_offset; byte < block_end; byte++)
+        {
+            if (++value_bytes > 10)
+            {
+                return false;
+            }
+
+            if ((deltas[byte] & 0x80) == 0)
+            {
+                value_count++;
+                value_bytes = 0;
+            }
+        }
+
+        //The last block is followed by zero padding, which reads as extra zero values
+        const uint64_t expected_count = (vertex_count - 1) * values_per_vertex;
+        if (i + 1 < header.block_count ? value_count != expected_count : value_count < expected_count)
+        {
+            return false;
+        }
+
+        if (block_end > blocks[i].data_offset && (deltas[block_end - 1] & 0x80) != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+size_t Compressed_Trajectory::get_blob_size() const
+{
+    const Compressed_Trajectory_Header& header = get_header();
+    return sizeof(Compressed_Trajectory_Header) + header.block_count * sizeof(Compressed_Trajectory_Block) + static_cast<size_t>(header.data_size);
+}
+
+void Compressed_Trajectory::decode(const size_t first, const size_t last, std::vector<float>& x, std::vector<float>& y, std::vector<float>& t) const
+{
+    const Compressed_Trajectory_Header& header = get_header();
+    const bool with_time = has_time();
+
+    x.resize(last - first);
+    y.resize(last - first);
+    t.resize(with_time ? last - first : 0);
+
+    if (first >= last)
+    {
+        return;
+    }
+
+    const Compressed_Trajectory_Block* blocks = get_blocks();
+    const uint8_t* deltas = get_deltas();
+
+    for (size_t block_index = first / header.block_size; block_index < header.block_count && blocks[block_index].first_vertex < last; block_index++)
+    {
+        const Compressed_Trajectory_Block& block = blocks[block_index];
+        const size_t block_end = std::min<size_t>(last, static_cast<size_t>(block.first_vertex) + header.block_size);
+
+        int64_t quantized_x = block.x;
+        int64_t quantized_y = block.y;
+        int64_t quantized_t = block.t;
+        int64_t dt = block.dt;
+
+        const uint8_t* position = deltas + block.data_offset;
+
+        for (size_t i = block.first_vertex; i < block_end; i++)
+        {
+            if (i > block.first_vertex)
+            {
+                quantized_x += read_varint(position);
+                quantized_y += read_varint(position);
+
+                if (with_time)
+                {
+                    dt += read_varint(position);
+                    quantized_t += dt;
+                }
+            }
+
+            if (i >= first)
+            {
+                x[i - first] = dequantize(quantized_x, header.position_resolution);
+                y[i - first] = dequantize(quantized_y, header.position_resolution);
+
+                if (with_time)
+                {
+                    t[i - first] = dequantize(quantized_t, header.time_resolution);
+                }
+            }
+        }
+    }
+}
+
+void Compressed_Trajectory::decode(std::vector<float>& x, std::vector<float>& y, std::vector<float>& t) const
+{
+    decode(0, get_vertex_count(), x, y, t);
+}
+
+void Compressed_Trajectory::find_time_range(const float start_t, const float end_t, size_t& first, size_t& last) const
+{
+    const Compressed_Trajectory_Header& header = get_header();
+    const Compressed_Trajectory_Block* blocks = get_blocks();
+    const Compressed_Trajectory_Block* blocks_end = blocks + header.block_count;
+
+    //First block starting after each end, the range starts at the block before it
+    const Compressed_Trajectory_Block* start_block = std::upper_bound(blocks, blocks_end, start_t, [](const float time, const Compressed_Trajectory_Block& block) { return time < block.start_t; });
+    const Compressed_Trajectory_Block* end_block = std::upper_bound(blocks, blocks_end, end_t, [](const float time, const Compressed_Trajectory_Block& block) { return time < block.start_t; });
+
+    first = start_block != blocks ? (start_block - 1)->first_vertex : 0;
+
+    //Include the first vertex of the next block, it closes the last segment of the range
+    last = end_block != blocks_end ? static_cast<size_t>(end_block->first_vertex) + 1 : header.vertex_count;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+//Compressed encoding of the vertices of one trajectory, stored as a single position-independent blob
+//
+//Coordinates and times are quantized to a fixed resolution and stored as zigzag varint deltas in blocks of vertices.
+//Every block starts from absolute values, so a range of vertices or times is decoded without reading the blocks before it.
+//Positions store the delta to the previous vertex, times the change of that delta, which is usually zero for fixed rate GPS.
+//
+//Layout, all values little-endian:
+//  Compressed_Trajectory_Header
+//  Compressed_Trajectory_Block[block_count]
+//  data_size bytes of varint deltas
+class Compressed_Trajectory_Header
+{
+public:
+
+    static constexpr uint32_t has_time = 1;
+
+    uint32_t vertex_count;
+    uint32_t block_count;
+    uint32_t block_size;
+    uint32_t flags;
+
+    //Size of the quantization steps
+    double position_resolution;
+    double time_resolution;
+
+    uint64_t data_size;
+};
+
+static_assert(sizeof(Compressed_Trajectory_Header) == 40, "Compressed_Trajectory_Header is part of the file formats, its layout must not change");
+
+class Compressed_Trajectory_Block
+{
+public:
+
+    //Quantized values of the first vertex of the block
+    int64_t x;
+    int64_t y;
+    int64_t t;
+
+    //Delta of the time to the previous vertex, the time deltas of the block continue from it
+    int64_t dt;
+
+    //Time of the first vertex, for finding the blocks of a time range without decoding
+    float start_t;
+
+    uint32_t first_vertex;
+
+    //Byte offset of the deltas of the block in the data section
+    uint64_t data_offset;
+};
+
+static_assert(sizeof(Compressed_Trajectory_Block) == 48, "Compressed_Trajectory_Block is part of the file formats, its layout must not change");
+
+class Compressed_Trajectory_Options
+{
+public:
+
+    //Decoded values lie within half a step of the input
+    double position_resolution = 0.001;
+    double time_resolution = 0.001;
+
+    //Vertices per block, smaller blocks decode ranges with less waste but store more absolute values
+    uint32_t block_size = 256;
+};
+
+//Encodes count vertices, t may be nullptr for trajectories without times, the blob is appended to output
+//Returns false and sets error if a value doesn't fit the quantization
+bool encode_compressed_trajectory(const float* x, const float* y, const float* t, const size_t count, const Compressed_Trajectory_Options& options, std::vector<char>& output, std::string& error);
+
+//Read-only view of an encoded blob, which is decoded in place from memory or a memory mapping
+class Compressed_Trajectory
+{
+public:
+
+    Compressed_Trajectory() = default;
+
+    //The data must outlive the view, call is_valid before decoding a blob that may be corrupt
+    Compressed_Trajectory(const char* data, const size_t size) : data(data), size(size)
+    {
+    }
+
+    //Checks that the blob is complete and the block index is consistent
+    bool is_valid() const;
+
+    //Total size of the blob in bytes, only valid if is_valid
+    size_t get_blob_size() const;
+
+    size_t get_vertex_count() const { return get_header().vertex_count; }
+    bool has_time() const { return (get_header().flags & Compressed_Trajectory_Header::has_time) != 0; }
+
+    //Decodes the vertices [first, last) into the structure-of-arrays buffers, t is skipped without times
+    //The buffers are resized to last - first
+    void decode(const size_t first, const size_t last, std::vector<float>& x, std::vector<float>& y, std::vector<float>& t) const;
+
+    //Decodes all vertices
+    void decode(std::vector<float>& x, std::vector<float>& y, std::vector<float>& t) const;
+
+    //Returns a range [first, last) of vertices that covers the time range, found from the block index without decoding
+    //The range is rounded out to whole blocks and includes the vertices before start_t and after end_t, needs times
+    void find_time_range(const float start_t, const float end_t, size_t& first, size_t& last) const;
+
+private:
+
+    const Compressed_Trajectory_Header& get_header() const { return *reinterpret_cast<const Compressed_Trajectory_Header*>(data); }
+    const Compressed_Trajectory_Block* get_blocks() const { return reinterpret_cast<const Compressed_Trajectory_Block*>(data + sizeof(Compressed_Trajectory_Header)); }
+    const uint8_t* get_deltas() const { return reinterpret_cast<const uint8_t*>(data + sizeof(Compressed_Trajectory_Header) + get_header().block_count * sizeof(Compressed_Trajectory_Block)); }
+
+    const char* data = nullptr;
+    size_t size = 0;
+};
@@ -0,0 +1,178 @@
+#include "pch.h"
+#include "vec2.h"
+#include "dynamic_segment_search_tree.h"
+
+Dynamic_Segment_Search_Tree::Dynamic_Segment_Search_Tree(const std::vector<Segment>& ordered_segments) :
+    segments(ordered_segments),
+    kinematics(build_segment_kinematics(ordered_segments))
+{
+    size_t new_capacity = 1;
+    while (new_capacity < segments.size())
+    {
+        new_capacity *= 2;
+    }
+
+    rebuild(new_capacity);
+}
+
+void Dynamic_Segment_Search_Tree::push_back(const Segment& segment)
+{
+    segments.push_back(segment);
+    kinematics.push_back(segment.get_kinematics());
+
+    if (segments.size() > capacity)
+    {
+        //Full, double the leaves unless moving out the popped segments frees enough of them
+        //Either way the rebuild is paid for by the appends and pops since the last one
+        if (capacity > 0 && front * 2 >= size())
+        {
+            rebuild(capacity);
+        }
+        else
+        {
+            rebuild(capacity == 0 ? 1 : capacity * 2);
+        }
+        return;
+    }
+
+    update_leaf(segments.size() - 1, SIMD_AABB(segment));
+}
+
+void Dynamic_Segment_Search_Tree::pop_front()
+{
+    if (empty())
+    {
+        return;
+    }
+
+    update_leaf(front, SIMD_AABB());
+    front++;
+
+    if (front * 2 >= segments.size())
+    {
+        //Half of the stored segments are popped, move the rest to the front, the rebuild is paid for by the pops
+        size_t new_capacity = 1;
+        while (new_capacity < size())
+        {
+            new_capacity *= 2;
+        }
+
+        rebuild(new_capacity);
+    }
+}
+
+void Dynamic_Segment_Search_Tree::reserve(const size_t segment_count)
+{
+    segments.reserve(segment_count);
+    kinematics.reserve(segment_count);
+}
+
+void Dynamic_Segment_Search_Tree::rebuild(const size_t new_capacity)
+{
+    segments.erase(segments.begin(), segments.begin() + front);
+    kinematics.erase(kinematics.begin(), kinematics.begin() + front);
+    front = 0;
+
+    capacity = new_capacity;
+
+    nodes.assign(capacity * 2, SIMD_AABB());
+
+    for (size_t i = 0; i < segments.size(); i++)
+    {
+        nodes[capacity + i] = SIMD_AABB(segments[i]);
+    }
+
+    for (size_t i = capacity - 1; i > 0; i--)
+    {
+        nodes[i] = SIMD_AABB::combine(nodes[i * 2], nodes[i * 2 + 1]);
+    }
+}
+
+void Dynamic_Segment_Search_Tree::update_leaf(const size_t stored_index, const SIMD_AABB& bounding_box)
+{
+    size_t node = capacity + stored_index;
+    nodes[node] = bounding_box;
+
+    //Update the path to the root
+    for (node /= 2; node > 0; node /= 2)
+    {
+        nodes[node] = SIMD_AABB::combine(nodes[node * 2], nodes[node * 2 + 1]);
+    }
+}
+
+//Query tree, returns bounding box from start_t to end_t, from the partial first and last segment and the whole segments between them
+AABB Dynamic_Segment_Search_Tree::query(const Float start_t, const Float end_t) const
+{
+    if (empty())
+    {
+        return AABB();
+    }
+
+    const size_t first = query(start_t);
+    const size_t last = query(end_t);
+
+    const Vec2 start_point = get_segment(first).get_point_at_time(start_t, get_kinematics(first));
+    const Vec2 end_point = get_segment(last).get_point_at_time(end_t, get_kinematics(last));
+
+    if (first == last)
+    {
+        return SIMD_AABB(start_point, end_point).to_AABB();
+    }
+
+    SIMD_AABB bounding_box(start_point, get_segment(first).end);
+    bounding_box.combine(query_segments(first + 1, last - 1));
+    bounding_box.combine(SIMD_AABB(get_segment(last).start, end_point));
+
+    return bounding_box.to_AABB();
+}
+
+//Query tree, returns segment index that contains t (or first/last when before/after range)
+int Dynamic_Segment_Search_Tree::query(const Float t) const
+{
+    if (empty())
+    {
+        return 0;
+    }
+
+    //The first segment that ends at or after t, the same segment Segment_Search_Tree descends to
+    const auto first = segments.begin() + front;
+    const size_t index = std::partition_point(first, segments.end(), [&t](const Segment& segment)
+        {
+            return !(t <= segment.end_t);
+        }) - first;
+
+    return static_cast<int>(std::min(index, size() - 1));
+}
+
+SIMD_AABB Dynamic_Segment_Search_Tree::query_segments(const size_t first, const size_t last) const
+{
+    //Starts empty
+    SIMD_AABB bounding_box;
+
+    if (first > last)
+    {
+        return bounding_box;
+    }
+
+    //Walk up from both ends of the range, combining the nodes that are fully inside of it
+    size_t left = capacity + front + first;
+    size_t right = capacity + front + last + 1;
+
+    while (left < right)
+    {
+        if (left & 1)
+        {
+            bounding_box.combine(nodes[left++]);
+        }
+
+        if (right & 1)
+        {
+            bounding_box.combine(nodes[--right]);
+        }
+
+        left /= 2;
+        right /= 2;
+    }
+
+    return bounding_box;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+//Segment_Search_Tree over a list of segments that grows at the back and shrinks at the front, for trajectories that are not complete yet
+//and for windows over the most recent part of a trajectory
+//Owns a copy of the segments and their kinematics, so appending doesn't invalidate anything
+//The bounding boxes are stored in an implicit binary tree: a power-of-two sized array with the leaves after the internal nodes,
+//which doubles when it is full. Removed segments leave empty leaves at the front until half of the stored segments are removed,
+//then the live segments are moved to the front. Appending and removing are amortized O(log n), queries are O(log n)
+class Dynamic_Segment_Search_Tree
+{
+public:
+
+    Dynamic_Segment_Search_Tree() = default;
+
+    //Build the tree from a list of ordered segments in O(n)
+    explicit Dynamic_Segment_Search_Tree(const std::vector<Segment>& ordered_segments);
+
+    //Appends a segment, it should start at the end of the last segment
+    void push_back(const Segment& segment);
+
+    //Removes the first segment, indices of the remaining segments shift down by one
+    void pop_front();
+
+    void reserve(const size_t segment_count);
+
+    //Query tree, returns bounding box from start_t to end_t, same results as Segment_Search_Tree with kinematics
+    [[nodiscard]]
+    AABB query(const Float start_t, const Float end_t) const;
+
+    //Query tree, returns segment index that contains t (or first/last when before/after range), indices start at the first segment
+    [[nodiscard]]
+    int query(const Float t) const;
+
+    //Returns the bounding box of the whole segments [first, last], empty if first > last
+    SIMD_AABB query_segments(const size_t first, const size_t last) const;
+
+    size_t size() const { return segments.size() - front; }
+    bool empty() const { return segments.size() == front; }
+
+    const Segment& get_segment(const size_t index) const { return segments[front + index]; }
+    const Segment_Kinematics& get_kinematics(const size_t index) const { return kinematics[front + index]; }
+
+private:
+
+    //Removes the popped segments, resizes the leaves to the given power of two and rebuilds the internal nodes
+    void rebuild(const size_t new_capacity);
+
+    //Sets the leaf of a stored segment and updates the path to the root
+    void update_leaf(const size_t stored_index, const SIMD_AABB& bounding_box);
+
+    //Segments before front were popped, their leaves are empty
+    std::vector<Segment> segments;
+    std::vector<Segment_Kinematics> kinematics;
+    size_t front = 0;
+
+    //nodes[1] is the root, the children of node i are 2i and 2i + 1, stored segment i is leaf capacity + i, unused leaves are empty boxes
+    size_t capacity = 0;
+    std::vector<SIMD_AABB> nodes;
+};
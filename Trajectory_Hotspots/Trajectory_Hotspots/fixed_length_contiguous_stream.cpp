@@ -0,0 +1,293 @@
+#include "pch.h"
+#include "vec2.h"
+#include "trajectory.h"
+#include "fixed_length_contiguous_stream.h"
+
+Fixed_Length_Contiguous_Stream::Fixed_Length_Contiguous_Stream(const Float length) :
+    length(length)
+{
+}
+
+bool Fixed_Length_Contiguous_Stream::push_back(const Vec2& point, const Float t)
+{
+    if (vertex_count > 0 && t <= last_timestamp)
+    {
+        return false;
+    }
+
+    last_timestamp = t;
+
+    if (vertex_count > 0 && point == last_point)
+    {
+        //No movement, a segment without length has no time span
+        return true;
+    }
+
+    if (vertex_count > 0)
+    {
+        //Set t with the length, like Trajectory(ordered_points)
+        const Segment segment(last_point, point, trajectory_length);
+
+        trajectory_length = segment.end_t;
+
+        tree.push_back(segment);
+        segment_end_timestamps.push_back(t);
+    }
+
+    const bool added_segment = vertex_count > 0;
+
+    last_point = point;
+    vertex_count++;
+
+    if (added_segment)
+    {
+        update_hotspot();
+        add_new_candidates();
+    }
+
+    return true;
+}
+
+void Fixed_Length_Contiguous_Stream::evict_before(const Float t)
+{
+    while (!segment_end_timestamps.empty() && segment_end_timestamps.front() < t)
+    {
+        tree.pop_front();
+        segment_end_timestamps.pop_front();
+    }
+
+    if (tree.empty())
+    {
+        candidates.clear();
+        return;
+    }
+
+    //Candidates that start before the first segment contain evicted segments
+    const Float window_start = tree.get_segment(0).start_t;
+
+    while (!candidates.empty() && candidates.front().start_t < window_start)
+    {
+        candidates.pop_front();
+    }
+}
+
+AABB Fixed_Length_Contiguous_Stream::get_hotspot() const
+{
+    if (tree.empty() || length > get_segments_length())
+    {
+        //Invalid length
+        return AABB();
+    }
+
+    if (candidates.empty())
+    {
+        //Same as the initial hotspot of Trajectory::get_hotspot_fixed_length_contiguous
+        return AABB(
+            std::numeric_limits<float>::lowest() / 2.f,
+            std::numeric_limits<float>::lowest() / 2.f,
+            std::numeric_limits<float>::max() / 2.f,
+            std::numeric_limits<float>::max() / 2.f);
+    }
+
+    return candidates.front().hotspot;
+}
+
+Float Fixed_Length_Contiguous_Stream::get_segments_length() const
+{
+    if (tree.empty())
+    {
+        return 0.f;
+    }
+
+    return trajectory_length - tree.get_segment(0).start_t;
+}
+
+//Evaluates the same breakpoints as Trajectory::get_hotspot_fixed_length_contiguous, restricted to the subtrajectories that end on the last segment
+//All other breakpoints only depend on earlier segments, so they were evaluated by earlier updates
+void Fixed_Length_Contiguous_Stream::update_hotspot()
+{
+    const size_t end_index = tree.size() - 1;
+    const Segment& end_segment = tree.get_segment(end_index);
+    const Segment_Kinematics& end_kinematics = tree.get_kinematics(end_index);
+
+    //First index in [0, end_index] for which the predicate on the segment is false, the segments are ordered by time
+    const auto partition_index = [this, end_index](const auto& predicate)
+        {
+            size_t first = 0;
+            size_t count = end_index + 1;
+
+            while (count > 0)
+            {
+                const size_t half = count / 2;
+
+                if (predicate(tree.get_segment(first + half)))
+                {
+                    first += half + 1;
+                    count -= half + 1;
+                }
+                else
+                {
+                    count = half;
+                }
+            }
+
+            return first;
+        };
+
+    //Breakpoint type II, the subtrajectory ends at the new vertex
+    const Float start = end_segment.end_t - length;
+
+    if (!(start < tree.get_segment(0).start_t))
+    {
+        test_hotspot(tree.query(start, end_segment.end_t), start);
+    }
+
+    //Breakpoint type I, the subtrajectory starts at a vertex and ends on the new segment
+    //Subtrajectories that end before the new segment were tested when the trajectory ended there
+    const size_t first_vertex_index = partition_index([this, &end_segment](const Segment& segment)
+        {
+            return !(segment.start_t + length > end_segment.start_t);
+        });
+
+    for (size_t start_index = first_vertex_index; start_index <= end_index; ++start_index)
+    {
+        const Float vertex_start = tree.get_segment(start_index).start_t;
+        const Float vertex_end = vertex_start + length;
+
+        if (vertex_end > end_segment.end_t)
+        {
+            break;
+        }
+
+        test_hotspot(tree.query(vertex_start, vertex_end), vertex_start);
+    }
+
+    if (end_index == 0)
+    {
+        return;
+    }
+
+    //Breakpoints III, IV, and V for the start segments that have the new segment in their end range
+    //The end range of a start segment runs from the segment at start_t + length to the segment at end_t + length
+    const size_t range_start_index = partition_index([this, &end_segment](const Segment& segment)
+        {
+            return segment.end_t + length <= end_segment.start_t;
+        });
+
+    //One past the last start segment, which must come before the new segment
+    const size_t range_end_index = std::min(partition_index([this, &end_segment](const Segment& segment)
+        {
+            return segment.start_t + length <= end_segment.end_t;
+        }), end_index);
+
+    if (range_start_index >= range_end_index)
+    {
+        return;
+    }
+
+    //Breakpoint V, the start and end of the subtrajectory lie on the same x or y coordinate
+    end_segment_single_batch.clear();
+    end_segment_single_batch.push_back(end_segment, end_kinematics);
+
+    for (size_t start_index = range_start_index; start_index < range_end_index; ++start_index)
+    {
+        batch_points_on_same_axis_with_distance_l(tree.get_segment(start_index), tree.get_kinematics(start_index), end_segment_single_batch, length, true, x_axis_points);
+        batch_points_on_same_axis_with_distance_l(tree.get_segment(start_index), tree.get_kinematics(start_index), end_segment_single_batch, length, false, y_axis_points);
+
+        if (x_axis_points.hits[0]) { test_hotspot(tree.query(x_axis_points.start_times[0], x_axis_points.end_times[0]), x_axis_points.start_times[0]); }
+        if (y_axis_points.hits[0]) { test_hotspot(tree.query(y_axis_points.start_times[0], y_axis_points.end_times[0]), y_axis_points.start_times[0]); }
+    }
+
+    //Breakpoints III and IV need at least one segment between the start and end segment (else U & V are the same point)
+    //Lane j holds the line through the minimum side of the uv AABB of the j-th start segment, lane j + block_size the maximum side
+    const size_t block_end_index = std::min(range_end_index, end_index - 1);
+    const size_t block_size = block_end_index > range_start_index ? block_end_index - range_start_index : 0;
+
+    if (block_size == 0)
+    {
+        return;
+    }
+
+    uv_bounding_boxes.clear();
+    start_segment_batch.clear();
+    end_segment_batch.clear();
+    vertical_lines.clear();
+    horizontal_lines.clear();
+
+    for (size_t start_index = range_start_index; start_index < block_end_index; ++start_index)
+    {
+        //Obtain the bounding box of the subtrajectory between u, the vertex after the start point, and v, the vertex before the end point
+        uv_bounding_boxes.push_back(tree.query(tree.get_segment(start_index).end_t, end_segment.start_t));
+    }
+
+    for (const bool minimum_side : { true, false })
+    {
+        for (size_t j = 0; j < block_size; ++j)
+        {
+            const AABB& uv_bounding_box = uv_bounding_boxes[j];
+
+            vertical_lines.push_back(minimum_side ? uv_bounding_box.min.x.get_value() : uv_bounding_box.max.x.get_value());
+            horizontal_lines.push_back(minimum_side ? uv_bounding_box.min.y.get_value() : uv_bounding_box.max.y.get_value());
+
+            start_segment_batch.push_back(tree.get_segment(range_start_index + j), tree.get_kinematics(range_start_index + j));
+            end_segment_batch.push_back(end_segment, end_kinematics);
+        }
+    }
+
+    batch_x_intersects(start_segment_batch, vertical_lines.data(), start_x_intersections);
+    batch_y_intersects(start_segment_batch, horizontal_lines.data(), start_y_intersections);
+    batch_x_intersects(end_segment_batch, vertical_lines.data(), end_x_intersections);
+    batch_y_intersects(end_segment_batch, horizontal_lines.data(), end_y_intersections);
+
+    for (size_t j = 0; j < block_size; ++j)
+    {
+        const Segment& start_segment = tree.get_segment(range_start_index + j);
+        const Segment_Kinematics& start_kinematics = tree.get_kinematics(range_start_index + j);
+
+        const size_t min_lane = j;
+        const size_t max_lane = j + block_size;
+
+        const AABB& uv_bounding_box = uv_bounding_boxes[j];
+
+        AABB current_hotspot;
+
+        //III starts at the intersection with the start segment, IV ends at the intersection with the end segment
+        if (Trajectory::flc_breakpoint_III_x(length, start_segment, end_segment, end_kinematics, uv_bounding_box.min.x, start_x_intersections, min_lane, uv_bounding_box, current_hotspot)) { test_hotspot(current_hotspot, start_x_intersections.times[min_lane]); }
+        if (Trajectory::flc_breakpoint_III_x(length, start_segment, end_segment, end_kinematics, uv_bounding_box.max.x, start_x_intersections, max_lane, uv_bounding_box, current_hotspot)) { test_hotspot(current_hotspot, start_x_intersections.times[max_lane]); }
+        if (Trajectory::flc_breakpoint_III_y(length, start_segment, end_segment, end_kinematics, uv_bounding_box.min.y, start_y_intersections, min_lane, uv_bounding_box, current_hotspot)) { test_hotspot(current_hotspot, start_y_intersections.times[min_lane]); }
+        if (Trajectory::flc_breakpoint_III_y(length, start_segment, end_segment, end_kinematics, uv_bounding_box.max.y, start_y_intersections, max_lane, uv_bounding_box, current_hotspot)) { test_hotspot(current_hotspot, start_y_intersections.times[max_lane]); }
+
+        if (Trajectory::flc_breakpoint_IV_x(length, start_segment, end_segment, start_kinematics, uv_bounding_box.min.x, end_x_intersections, min_lane, uv_bounding_box, current_hotspot)) { test_hotspot(current_hotspot, Float(end_x_intersections.times[min_lane]) - length); }
+        if (Trajectory::flc_breakpoint_IV_x(length, start_segment, end_segment, start_kinematics, uv_bounding_box.max.x, end_x_intersections, max_lane, uv_bounding_box, current_hotspot)) { test_hotspot(current_hotspot, Float(end_x_intersections.times[max_lane]) - length); }
+        if (Trajectory::flc_breakpoint_IV_y(length, start_segment, end_segment, start_kinematics, uv_bounding_box.min.y, end_y_intersections, min_lane, uv_bounding_box, current_hotspot)) { test_hotspot(current_hotspot, Float(end_y_intersections.times[min_lane]) - length); }
+        if (Trajectory::flc_breakpoint_IV_y(length, start_segment, end_segment, start_kinematics, uv_bounding_box.max.y, end_y_intersections, max_lane, uv_bounding_box, current_hotspot)) { test_hotspot(current_hotspot, Float(end_y_intersections.times[max_lane]) - length); }
+    }
+}
+
+void Fixed_Length_Contiguous_Stream::test_hotspot(const AABB& hotspot, const Float start_t)
+{
+    new_candidates.push_back({ start_t, hotspot });
+}
+
+//All candidates have the same length, so the new ones start after the ones of earlier updates, which end on earlier segments
+void Fixed_Length_Contiguous_Stream::add_new_candidates()
+{
+    std::stable_sort(new_candidates.begin(), new_candidates.end(), [](const Candidate& a, const Candidate& b)
+        {
+            return a.start_t.get_value() < b.start_t.get_value();
+        });
+
+    for (const Candidate& candidate : new_candidates)
+    {
+        //Earlier candidates that are larger are evicted before this one, so they are never the smallest again
+        //Equal ones are kept, so the first one found stays the hotspot like in Trajectory::get_hotspot_fixed_length_contiguous
+        while (!candidates.empty() && candidate.hotspot.max_size() < candidates.back().hotspot.max_size())
+        {
+            candidates.pop_back();
+        }
+
+        candidates.push_back(candidate);
+    }
+
+    new_candidates.clear();
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+//Fixed length contiguous hotspot of a trajectory that grows one vertex at a time, for live streams
+//Every appended segment only adds the breakpoints of subtrajectories that end on it, so only those are evaluated
+//Like Trajectory(ordered_points), the segment times are the length along the trajectory, the timestamps of the vertices only order them
+//The result after each vertex is the same as Trajectory::get_hotspot_fixed_length_contiguous on such a trajectory of all vertices so far
+//An update costs O(k log n), with k the number of segments within the length of the new segment
+//
+//Segments can be evicted from the front to keep a window over the most recent part of the stream
+//Every breakpoint only depends on the segments between its start and end, so the hotspot of the window is the smallest
+//hotspot found so far that starts in the window. The candidates are kept in a deque ordered by start, without the ones
+//that are larger than a later one, which can never be the smallest again
+class Fixed_Length_Contiguous_Stream
+{
+public:
+
+    explicit Fixed_Length_Contiguous_Stream(const Float length);
+
+    //Appends a vertex and updates the hotspot, returns false and ignores the vertex if t is not after the timestamp of the last vertex
+    //A vertex at the same position as the last vertex adds no movement and is accepted without adding a segment
+    bool push_back(const Vec2& point, const Float t);
+
+    //Removes the segments that end at a vertex with a timestamp before t, the hotspot is then the one of the remaining segments
+    void evict_before(const Float t);
+
+    //Smallest hotspot that contains a subtrajectory of the length, an empty AABB while the segments are shorter than the length
+    AABB get_hotspot() const;
+
+    Float get_length() const { return length; }
+
+    //Vertices pushed so far, including evicted ones
+    size_t get_vertex_count() const { return vertex_count; }
+
+    //Segments that are not evicted, and their length along the trajectory
+    size_t get_segment_count() const { return tree.size(); }
+    Float get_segments_length() const;
+
+private:
+
+    struct Candidate
+    {
+        Float start_t;
+        AABB hotspot;
+    };
+
+    //Evaluates the breakpoints of the subtrajectories that end on the last segment
+    void update_hotspot();
+
+    //Adds the candidates of the last update to the deque, in order of their start
+    void add_new_candidates();
+
+    void test_hotspot(const AABB& hotspot, const Float start_t);
+
+    Float length;
+
+    size_t vertex_count = 0;
+    Vec2 last_point;
+    Float last_timestamp = 0.f;
+
+    //The end of the last segment, the start of the next one
+    Float trajectory_length = 0.f;
+
+    Dynamic_Segment_Search_Tree tree;
+
+    //Timestamp of the vertex at the end of each segment in the tree
+    std::deque<Float> segment_end_timestamps;
+
+    std::deque<Candidate> candidates;
+    std::vector<Candidate> new_candidates;
+
+    //Buffers of the batch kernels, reused between updates
+    Segment_Batch end_segment_single_batch;
+    Segment_Batch start_segment_batch;
+    Segment_Batch end_segment_batch;
+
+    Same_Axis_Point_Batch x_axis_points;
+    Same_Axis_Point_Batch y_axis_points;
+
+    std::vector<float> vertical_lines;
+    std::vector<float> horizontal_lines;
+    std::vector<AABB> uv_bounding_boxes;
+
+    Axis_Intersection_Batch start_x_intersections;
+    Axis_Intersection_Batch start_y_intersections;
+    Axis_Intersection_Batch end_x_intersections;
+    Axis_Intersection_Batch end_y_intersections;
+};
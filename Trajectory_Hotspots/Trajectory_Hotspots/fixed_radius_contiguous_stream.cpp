@@ -0,0 +1,275 @@
+#include "pch.h"
+#include "vec2.h"
+#include "fixed_radius_contiguous_stream.h"
+
+Fixed_Radius_Contiguous_Stream::Fixed_Radius_Contiguous_Stream(const Float radius) :
+    radius(radius)
+{
+}
+
+bool Fixed_Radius_Contiguous_Stream::push_back(const Vec2& point, const Float t)
+{
+    if (vertex_count > 0 && t <= last_timestamp)
+    {
+        return false;
+    }
+
+    if (vertex_count > 0)
+    {
+        //Keep segments without movement, time spent standing still is what we are looking for
+        const Segment segment(last_point, point, last_timestamp, t);
+
+        tree.push_back(segment);
+        trajectory_bounding_box.combine(SIMD_AABB(segment));
+
+        add_to_blocks(segment);
+
+        //The open tests first, the tests of the new vertex already see the new segment
+        update_open_tests();
+        test_last_vertex();
+
+        update_optimal_hotspot();
+    }
+
+    last_point = point;
+    last_timestamp = t;
+    vertex_count++;
+
+    return true;
+}
+
+void Fixed_Radius_Contiguous_Stream::add_to_blocks(const Segment& segment)
+{
+    blocks.emplace_back();
+    block_sizes.push_back(1);
+
+    for (const bool axis : { true, false })
+    {
+        const Float start_value = axis ? segment.start.x : segment.start.y;
+        const Float end_value = axis ? segment.end.x : segment.end.y;
+
+        //Same projection as Trajectory::frc_project_segments_on_axis
+        blocks.back().projected_segments[axis ? 0 : 1].emplace_back(Vec2(segment.start_t, start_value), Vec2(segment.end_t, end_value), segment.start_t, segment.end_t);
+    }
+
+    //Merge like a binary counter, every segment is moved to a new block at most log n times
+    while (block_sizes.size() > 1 && block_sizes[block_sizes.size() - 2] == block_sizes.back())
+    {
+        Map_Block& older_block = blocks[blocks.size() - 2];
+        Map_Block& newer_block = blocks.back();
+
+        for (size_t i = 0; i < 2; i++)
+        {
+            //The map points into the segments, remove it before they move
+            older_block.maps[i].reset();
+            older_block.projected_segments[i].insert(older_block.projected_segments[i].end(), newer_block.projected_segments[i].begin(), newer_block.projected_segments[i].end());
+        }
+
+        blocks.pop_back();
+        block_sizes.pop_back();
+        block_sizes.back() *= 2;
+    }
+
+    //Random insertion order, with a seed so results are reproducible
+    const unsigned int seed = static_cast<unsigned int>(tree.size());
+
+    for (size_t i = 0; i < 2; i++)
+    {
+        blocks.back().maps[i] = std::make_unique<Trapezoidal_Map>(blocks.back().projected_segments[i], seed);
+    }
+}
+
+void Fixed_Radius_Contiguous_Stream::trace_blocks(const size_t first_block, const bool axis, const Vec2& point, const bool prefer_top, Float& left_t, bool& left_hit, Float& right_t, bool& right_hit) const
+{
+    left_hit = false;
+    right_hit = false;
+
+    for (size_t i = first_block; i < blocks.size(); i++)
+    {
+        const Segment* left_segment = nullptr;
+        const Segment* right_segment = nullptr;
+        blocks[i].maps[axis ? 0 : 1]->trace_left_right(point, prefer_top, left_segment, right_segment);
+
+        assert(left_segment != nullptr && right_segment != nullptr);
+
+        //Segments at infinity are the borders of the map, there is no trajectory on that side in this block
+        //A segment without movement on the axis at the height of the point has no crossing time, it only bounds a flat trapezoid
+        if (!left_segment->start.x.is_inf())
+        {
+            const Float time = left_segment->get_time_at_y(point.y);
+
+            if (std::isfinite(time.get_value()) && (!left_hit || time > left_t))
+            {
+                left_t = time;
+                left_hit = true;
+            }
+        }
+
+        if (!right_segment->start.x.is_inf())
+        {
+            const Float time = right_segment->get_time_at_y(point.y);
+
+            if (std::isfinite(time.get_value()) && (!right_hit || time < right_t))
+            {
+                right_t = time;
+                right_hit = true;
+            }
+        }
+    }
+}
+
+//The same tests as Trajectory::frc_query_vertices for one vertex
+void Fixed_Radius_Contiguous_Stream::test_last_vertex()
+{
+    const Segment& segment = tree.get_segment(tree.size() - 1);
+
+    const Float trajectory_start = tree.get_segment(0).start_t;
+    const Float trajectory_end = segment.end_t;
+
+    for (const bool axis : { true, false })
+    {
+        const Vec2 current_vert(segment.start_t, axis ? segment.start.x : segment.start.y);
+
+        //Vertex at the top or at the bottom of the boundary
+        for (const bool above : { true, false })
+        {
+            const Vec2 vert_at_radius(current_vert.x, above ? current_vert.y - radius : current_vert.y + radius);
+
+            Float start_at_vert, end_at_vert, start_at_radius, end_at_radius;
+            bool left_hit_at_vert, right_hit_at_vert, left_hit_at_radius, right_hit_at_radius;
+
+            trace_blocks(0, axis, current_vert, above, start_at_vert, left_hit_at_vert, end_at_vert, right_hit_at_vert);
+            trace_blocks(0, axis, vert_at_radius, !above, start_at_radius, left_hit_at_radius, end_at_radius, right_hit_at_radius);
+
+            if (!left_hit_at_vert) start_at_vert = trajectory_start;
+            if (!left_hit_at_radius) start_at_radius = trajectory_start;
+
+            //Keep the shortest start and end, like Trajectory::frc_get_subtrajectory_within_boundary
+            const Float subtrajectory_start = (start_at_vert > start_at_radius) ? start_at_vert : start_at_radius;
+
+            if (right_hit_at_vert || right_hit_at_radius)
+            {
+                if (!right_hit_at_vert) end_at_vert = trajectory_end;
+                if (!right_hit_at_radius) end_at_radius = trajectory_end;
+
+                test_closed(subtrajectory_start, (end_at_vert < end_at_radius) ? end_at_vert : end_at_radius);
+                continue;
+            }
+
+            //The end moves with the end of the trajectory, only keep the test while it fits
+            const AABB bounding_box = tree.query(subtrajectory_start, trajectory_end);
+
+            if (bounding_box.max_size() <= radius)
+            {
+                open_tests.push_back({ axis, current_vert, above, vert_at_radius, subtrajectory_start, bounding_box });
+            }
+        }
+    }
+}
+
+void Fixed_Radius_Contiguous_Stream::update_open_tests()
+{
+    const Segment& segment = tree.get_segment(tree.size() - 1);
+    const Float trajectory_end = segment.end_t;
+
+    size_t kept_tests = 0;
+
+    for (size_t i = 0; i < open_tests.size(); i++)
+    {
+        Open_Test& test = open_tests[i];
+
+        //Only the new segment can be hit, the older ones were in the maps when the test was done
+        const Float min_value = test.axis ? std::min(segment.start.x, segment.end.x) : std::min(segment.start.y, segment.end.y);
+        const Float max_value = test.axis ? std::max(segment.start.x, segment.end.x) : std::max(segment.start.y, segment.end.y);
+
+        const bool may_cross_vert = !(test.vert.y < min_value || test.vert.y > max_value);
+        const bool may_cross_radius = !(test.vert_at_radius.y < min_value || test.vert_at_radius.y > max_value);
+
+        Float left_t, end_at_vert, end_at_radius;
+        bool left_hit, right_hit_at_vert = false, right_hit_at_radius = false;
+
+        //The new segment is in the last block
+        if (may_cross_vert)
+        {
+            trace_blocks(blocks.size() - 1, test.axis, test.vert, test.vert_prefer_top, left_t, left_hit, end_at_vert, right_hit_at_vert);
+        }
+
+        if (may_cross_radius)
+        {
+            trace_blocks(blocks.size() - 1, test.axis, test.vert_at_radius, !test.vert_prefer_top, left_t, left_hit, end_at_radius, right_hit_at_radius);
+        }
+
+        if (right_hit_at_vert || right_hit_at_radius)
+        {
+            if (!right_hit_at_vert) end_at_vert = trajectory_end;
+            if (!right_hit_at_radius) end_at_radius = trajectory_end;
+
+            test_closed(test.start, (end_at_vert < end_at_radius) ? end_at_vert : end_at_radius);
+            continue;
+        }
+
+        //Still open, the subtrajectory now contains the whole new segment
+        test.bounding_box.augment(segment.end);
+
+        //The end only moves further, so the subtrajectory will never fit again
+        if (test.bounding_box.max_size() > radius)
+        {
+            continue;
+        }
+
+        open_tests[kept_tests++] = test;
+    }
+
+    open_tests.resize(kept_tests);
+}
+
+//Same check as Trajectory::frc_test_between_lines
+void Fixed_Radius_Contiguous_Stream::test_closed(const Float start, const Float end)
+{
+    if ((end - start) > longest_closed_subtrajectory)
+    {
+        const AABB subtrajectory_bounding_box = tree.query(start, end);
+
+        if (subtrajectory_bounding_box.max_size() <= radius)
+        {
+            longest_closed_subtrajectory = end - start;
+            closed_hotspot = subtrajectory_bounding_box;
+        }
+    }
+}
+
+void Fixed_Radius_Contiguous_Stream::update_optimal_hotspot()
+{
+    const Float trajectory_start = tree.get_segment(0).start_t;
+    const Float trajectory_end = tree.get_segment(tree.size() - 1).end_t;
+
+    //If the whole trajectory fits inside the hotspot it is the longest subtrajectory
+    const AABB whole_bounding_box = trajectory_bounding_box.to_AABB();
+
+    if (whole_bounding_box.max_size() <= radius)
+    {
+        longest_valid_subtrajectory = trajectory_end - trajectory_start;
+        optimal_hotspot = whole_bounding_box;
+        return;
+    }
+
+    longest_valid_subtrajectory = longest_closed_subtrajectory;
+    optimal_hotspot = closed_hotspot;
+
+    const Open_Test* longest_open_test = nullptr;
+
+    for (const Open_Test& test : open_tests)
+    {
+        if ((trajectory_end - test.start) > longest_valid_subtrajectory)
+        {
+            longest_valid_subtrajectory = trajectory_end - test.start;
+            longest_open_test = &test;
+        }
+    }
+
+    //The augmented box is only used to drop tests, query the tree like a closed test to get the exact hotspot
+    if (longest_open_test != nullptr)
+    {
+        optimal_hotspot = tree.query(longest_open_test->start, trajectory_end);
+    }
+}
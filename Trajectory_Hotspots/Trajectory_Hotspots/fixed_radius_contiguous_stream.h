@@ -0,0 +1,98 @@
+#pragma once
+
+//Fixed radius contiguous hotspot of a trajectory that grows one vertex at a time, for continuous dwell detection
+//The result after each vertex is the same as Trajectory::get_hotspot_fixed_radius_contiguous on the timestamped trajectory of all vertices so far
+//
+//Appending a segment only changes the traces that found no segment on the right of their vertex, every other trace hit an older segment first.
+//The tests of a vertex are done once its segment is added. Tests without a right segment stay open until a new segment closes them,
+//or until the subtrajectory from their start to the end no longer fits in the radius, which can't change anymore.
+//
+//Inserting segments in time order in a single trapezoidal map makes its search structure as deep as the trajectory is long when a
+//coordinate keeps increasing, so the maps are kept in blocks of a power of two segments that are merged when two have the same size,
+//each built in random order. A trace over all blocks takes the nearest segment of each block. Appending is amortized O(log^2 n)
+//plus the open tests that are not left behind by the new segment
+class Fixed_Radius_Contiguous_Stream
+{
+public:
+
+    explicit Fixed_Radius_Contiguous_Stream(const Float radius);
+
+    //Appends a vertex and updates the hotspot, returns false and ignores the vertex if t is not after the timestamp of the last vertex
+    bool push_back(const Vec2& point, const Float t);
+
+    //Hotspot of the radius that contains the longest subtrajectory so far, an empty AABB until the second vertex
+    AABB get_hotspot() const { return optimal_hotspot; }
+
+    //Time spent in the hotspot, the length of the subtrajectory it contains
+    Float get_hotspot_duration() const { return longest_valid_subtrajectory; }
+
+    Float get_radius() const { return radius; }
+    size_t get_vertex_count() const { return vertex_count; }
+
+    //Tests of vertices that still depend on future segments
+    size_t get_open_test_count() const { return open_tests.size(); }
+
+private:
+
+    //Segments projected to the (t, x) and (t, y) planes, the maps point into the vectors so they are never changed after building the maps
+    struct Map_Block
+    {
+        std::vector<Segment> projected_segments[2];
+        std::unique_ptr<Trapezoidal_Map> maps[2];
+    };
+
+    //frc_test_between_lines of a vertex whose end is the end of the trajectory so far
+    struct Open_Test
+    {
+        bool axis;
+
+        Vec2 vert;
+        bool vert_prefer_top;
+        Vec2 vert_at_radius;
+
+        Float start;
+
+        //Bounding box from start to the end of the trajectory
+        AABB bounding_box;
+    };
+
+    //Adds the segment to a new block and merges the blocks with the same size
+    void add_to_blocks(const Segment& segment);
+
+    //Traces left and right from the point through the maps of the blocks from first_block on, nearest crossing times or false when nothing is hit
+    void trace_blocks(const size_t first_block, const bool axis, const Vec2& point, const bool prefer_top, Float& left_t, bool& left_hit, Float& right_t, bool& right_hit) const;
+
+    //Runs the tests of the vertex at the start of the last segment
+    void test_last_vertex();
+
+    //Closes the open tests that the last segment crossed, and drops the ones that no longer fit
+    void update_open_tests();
+
+    void test_closed(const Float start, const Float end);
+
+    void update_optimal_hotspot();
+
+    Float radius;
+
+    size_t vertex_count = 0;
+    Vec2 last_point;
+    Float last_timestamp = 0.f;
+
+    Dynamic_Segment_Search_Tree tree;
+
+    //Sizes decrease from front to back
+    std::vector<Map_Block> blocks;
+    std::vector<size_t> block_sizes;
+
+    std::vector<Open_Test> open_tests;
+
+    //Longest subtrajectory of the closed tests
+    Float longest_closed_subtrajectory = 0.f;
+    AABB closed_hotspot;
+
+    //Bounding box of the whole trajectory, if it fits it is the hotspot
+    SIMD_AABB trajectory_bounding_box;
+
+    Float longest_valid_subtrajectory = 0.f;
+    AABB optimal_hotspot;
+};
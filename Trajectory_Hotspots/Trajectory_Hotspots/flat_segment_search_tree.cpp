@@ -0,0 +1,251 @@
+#include "pch.h"
+#include "vec2.h"
+#include "flat_segment_search_tree.h"
+
+namespace
+{
+    //Same arithmetic as Segment::get_point_at_time with the kinematics of the segment, so the results match the trees that are built with kinematics
+    Vec2 get_point_at_time(const Segment& segment, const Float time)
+    {
+        const Float fraction = (time - segment.start_t) * (1.f / (segment.end_t - segment.start_t));
+
+        return Vec2(segment.start.x + ((segment.end.x - segment.start.x) * fraction), segment.start.y + ((segment.end.y - segment.start.y) * fraction));
+    }
+
+    //Appends the subtree over [start_index, end_index] in pre-order, splits the same way as Segment_Search_Tree_Node
+    int32_t build_subtree(const std::vector<Segment>& ordered_segments, const size_t start_index, const size_t end_index, std::vector<Flat_Segment_Search_Tree_Node>& nodes)
+    {
+        const int32_t node_index = static_cast<int32_t>(nodes.size());
+        nodes.emplace_back();
+
+        if (end_index == start_index)
+        {
+            //Leaf node
+            const Segment& segment = ordered_segments[start_index];
+
+            Flat_Segment_Search_Tree_Node& node = nodes[node_index];
+            node.node_start_t = segment.start_t.get_value();
+            node.node_end_t = segment.end_t.get_value();
+            node.values[0] = segment.start.x.get_value();
+            node.values[1] = segment.start.y.get_value();
+            node.values[2] = segment.end.x.get_value();
+            node.values[3] = segment.end.y.get_value();
+            node.right = -1;
+            node.segment_index = static_cast<int32_t>(start_index);
+
+            return node_index;
+        }
+
+        //Internal node, split
+        const size_t middle_index = (start_index + end_index) / 2;
+
+        const int32_t left = build_subtree(ordered_segments, start_index, middle_index, nodes);
+        const int32_t right = build_subtree(ordered_segments, middle_index + 1, end_index, nodes);
+
+        const Flat_Segment_Search_Tree_Node& left_node = nodes[left];
+        const Flat_Segment_Search_Tree_Node& right_node = nodes[right];
+
+        const AABB bounding_box = SIMD_AABB::combine(
+            left_node.is_leaf() ? SIMD_AABB(ordered_segments[left_node.segment_index]) : SIMD_AABB(AABB(left_node.values[0], left_node.values[1], left_node.values[2], left_node.values[3])),
+            right_node.is_leaf() ? SIMD_AABB(ordered_segments[right_node.segment_index]) : SIMD_AABB(AABB(right_node.values[0], right_node.values[1], right_node.values[2], right_node.values[3]))).to_AABB();
+
+        Flat_Segment_Search_Tree_Node& node = nodes[node_index];
+        node.node_start_t = left_node.node_start_t;
+        node.node_end_t = right_node.node_end_t;
+        node.values[0] = bounding_box.min.x.get_value();
+        node.values[1] = bounding_box.min.y.get_value();
+        node.values[2] = bounding_box.max.x.get_value();
+        node.values[3] = bounding_box.max.y.get_value();
+        node.right = right;
+        node.segment_index = -1;
+
+        return node_index;
+    }
+}
+
+std::vector<Flat_Segment_Search_Tree_Node> Flat_Segment_Search_Tree::build_nodes(const std::vector<Segment>& ordered_segments)
+{
+    std::vector<Flat_Segment_Search_Tree_Node> nodes;
+
+    if (ordered_segments.empty())
+    {
+        return nodes;
+    }
+
+    nodes.reserve(ordered_segments.size() * 2 - 1);
+    build_subtree(ordered_segments, 0, ordered_segments.size() - 1, nodes);
+
+    return nodes;
+}
+
+//Query tree, returns bounding box from start_t to end_t
+AABB Flat_Segment_Search_Tree::query(const Float start_t, const Float end_t) const
+{
+    return query_range(0, start_t, end_t).to_AABB();
+}
+
+//Query tree, returns segment index that contains t (or first/last when before/after range)
+int Flat_Segment_Search_Tree::query(const Float t) const
+{
+    return query_index(0, t);
+}
+
+SIMD_AABB Flat_Segment_Search_Tree::query_range(const int32_t node_index, const Float start_t, const Float end_t) const
+{
+    const Flat_Segment_Search_Tree_Node& node = nodes[node_index];
+
+    //Leaf node, calculate segment portion (both points are in the segment)
+    if (node.is_leaf())
+    {
+        const Segment segment = get_segment(node_index);
+        return SIMD_AABB(get_point_at_time(segment, start_t), get_point_at_time(segment, end_t));
+    }
+
+    //Starts empty
+    SIMD_AABB bounding_box;
+
+    const int32_t left = node_index + 1;
+    const int32_t right = node.right;
+
+    //Range completely contained in left
+    if (Float(nodes[left].node_start_t) <= start_t && end_t <= nodes[left].node_end_t)
+    {
+        return query_range(left, start_t, end_t);
+    }//Query range starts in left
+    else if (start_t < nodes[left].node_end_t)
+    {
+        bounding_box.combine(query_left(left, start_t));
+    }
+
+    //Range completely contained in right
+    if (Float(nodes[right].node_start_t) <= start_t && end_t <= nodes[right].node_end_t)
+    {
+        return query_range(right, start_t, end_t);
+    }//Query range ends in right
+    else if (Float(nodes[right].node_start_t) < end_t)
+    {
+        bounding_box.combine(query_right(right, end_t));
+    }
+
+    return bounding_box;
+}
+
+//Query tree, returns bounding box from start_t to the last point contained in the (sub)tree
+SIMD_AABB Flat_Segment_Search_Tree::query_left(const int32_t node_index, const Float start_t) const
+{
+    const Flat_Segment_Search_Tree_Node& node = nodes[node_index];
+
+    //Leaf node, calculate boundingbox from point at start_t to the endpoint of the segment
+    if (node.is_leaf())
+    {
+        const Segment segment = get_segment(node_index);
+        return SIMD_AABB(get_point_at_time(segment, start_t), segment.end);
+    }
+
+    const int32_t left = node_index + 1;
+    const int32_t right = node.right;
+
+    //Right fully contained in query range?
+    if (start_t <= nodes[right].node_start_t)
+    {
+        return SIMD_AABB::combine(get_bounding_box(right), query_left(left, start_t));
+    }
+
+    //Query range starts in right side, ignore left side
+    return query_left(right, start_t);
+}
+
+//Query tree, returns bounding box from the first point in the (sub)tree to end_t
+SIMD_AABB Flat_Segment_Search_Tree::query_right(const int32_t node_index, const Float end_t) const
+{
+    const Flat_Segment_Search_Tree_Node& node = nodes[node_index];
+
+    //Leaf node, calculate boundingbox from the startpoint of the segment to the point at end_t
+    if (node.is_leaf())
+    {
+        const Segment segment = get_segment(node_index);
+        return SIMD_AABB(segment.start, get_point_at_time(segment, end_t));
+    }
+
+    const int32_t left = node_index + 1;
+    const int32_t right = node.right;
+
+    //Left side fully contained in query range?
+    if (Float(nodes[left].node_end_t) <= end_t)
+    {
+        return SIMD_AABB::combine(get_bounding_box(left), query_right(right, end_t));
+    }
+
+    //Query range ends in left side, ignore right side
+    return query_right(left, end_t);
+}
+
+bool Flat_Segment_Search_Tree::is_valid() const
+{
+    if (node_count == 0 || node_count > static_cast<size_t>(std::numeric_limits<int32_t>::max()))
+    {
+        return false;
+    }
+
+    //A tree of n segments has n leaves
+    const size_t segment_count = (node_count + 1) / 2;
+
+    for (size_t i = 0; i < node_count; i++)
+    {
+        const Flat_Segment_Search_Tree_Node& node = nodes[i];
+
+        if (node.is_leaf())
+        {
+            if (node.right != -1 || static_cast<size_t>(node.segment_index) >= segment_count) return false;
+        }
+        //The left child is the next node and the right child comes after it, so walking down always terminates
+        else if (node.segment_index != -1 || node.right < 0 || static_cast<size_t>(node.right) <= i + 1 || static_cast<size_t>(node.right) >= node_count)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int Flat_Segment_Search_Tree::query_index(const int32_t node_index, const Float t) const
+{
+    const Flat_Segment_Search_Tree_Node& node = nodes[node_index];
+
+    if (node.is_leaf())
+    {
+        return node.segment_index;
+    }
+
+    const int32_t left = node_index + 1;
+
+    if (t <= nodes[left].node_end_t)
+    {
+        return query_index(left, t);
+    }
+
+    if (Float(nodes[node.right].node_start_t) < t)
+    {
+        return query_index(node.right, t);
+    }
+
+    return 0;
+}
+
+SIMD_AABB Flat_Segment_Search_Tree::get_bounding_box(const int32_t node_index) const
+{
+    const Flat_Segment_Search_Tree_Node& node = nodes[node_index];
+
+    if (node.is_leaf())
+    {
+        return SIMD_AABB(Vec2(node.values[0], node.values[1]), Vec2(node.values[2], node.values[3]));
+    }
+
+    return SIMD_AABB(AABB(node.values[0], node.values[1], node.values[2], node.values[3]));
+}
+
+Segment Flat_Segment_Search_Tree::get_segment(const int32_t node_index) const
+{
+    const Flat_Segment_Search_Tree_Node& node = nodes[node_index];
+    return Segment(Vec2(node.values[0], node.values[1]), Vec2(node.values[2], node.values[3]), node.node_start_t, node.node_end_t);
+}
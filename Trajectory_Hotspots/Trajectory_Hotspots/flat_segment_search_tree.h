@@ -0,0 +1,72 @@
+#pragma once
+
+//Node of a Segment_Search_Tree stored in a flat array, refers to its children by index instead of by pointer
+//The nodes are stored in pre-order, so the left child of an internal node is always the next node
+class Flat_Segment_Search_Tree_Node
+{
+public:
+
+    bool is_leaf() const { return segment_index >= 0; }
+
+    float node_start_t;
+    float node_end_t;
+
+    //Internal nodes: the bounding box (min.x, min.y, max.x, max.y)
+    //Leaves: the segment (start.x, start.y, end.x, end.y), so queries don't need the segments themselves
+    float values[4];
+
+    //Index of the right child for internal nodes, -1 for leaves
+    int32_t right;
+
+    //Index of the segment for leaves, -1 for internal nodes
+    int32_t segment_index;
+};
+
+static_assert(sizeof(Flat_Segment_Search_Tree_Node) == 32, "Flat_Segment_Search_Tree_Node is part of the file formats, its layout must not change");
+
+//Position-independent version of Segment_Search_Tree, the nodes can be written to a file and queried in place from a memory mapping
+//Has the same shape and query semantics as Segment_Search_Tree without kinematics
+class Flat_Segment_Search_Tree
+{
+public:
+
+    Flat_Segment_Search_Tree() = default;
+
+    //Query the given nodes in place, the nodes must outlive the tree
+    Flat_Segment_Search_Tree(const Flat_Segment_Search_Tree_Node* nodes, const size_t node_count) : nodes(nodes), node_count(node_count)
+    {
+    }
+
+    //Build the nodes of the tree over a list of ordered segments, 2n - 1 nodes for n segments
+    static std::vector<Flat_Segment_Search_Tree_Node> build_nodes(const std::vector<Segment>& ordered_segments);
+
+    //Query tree, returns bounding box from start_t to end_t
+    [[nodiscard]]
+    AABB query(const Float start_t, const Float end_t) const;
+
+    //Query tree, returns segment index that contains t (or first/last when before/after range)
+    [[nodiscard]]
+    int query(const Float t) const;
+
+    //Checks the child and segment indices of all nodes, linear in the number of nodes
+    //Use it before querying nodes read from a file that may be corrupt
+    bool is_valid() const;
+
+    const Flat_Segment_Search_Tree_Node* get_nodes() const { return nodes; }
+    size_t get_node_count() const { return node_count; }
+
+private:
+
+    SIMD_AABB query_range(const int32_t node_index, const Float start_t, const Float end_t) const;
+    SIMD_AABB query_left(const int32_t node_index, const Float start_t) const;
+    SIMD_AABB query_right(const int32_t node_index, const Float end_t) const;
+    int query_index(const int32_t node_index, const Float t) const;
+
+    SIMD_AABB get_bounding_box(const int32_t node_index) const;
+
+    //Returns the segment of a leaf
+    Segment get_segment(const int32_t node_index) const;
+
+    const Flat_Segment_Search_Tree_Node* nodes = nullptr;
+    size_t node_count = 0;
+};
@@ -0,0 +1,242 @@
+#include "pch.h"
+#include "vec2.h"
+#include "flat_trapezoidal_map.h"
+
+#include <unordered_map>
+
+namespace
+{
+    class Flat_Trapezoidal_Map_Builder
+    {
+    public:
+
+        explicit Flat_Trapezoidal_Map_Builder(Flat_Trapezoidal_Map_Data& data) : data(data)
+        {
+        }
+
+        //Adds all nodes reachable from the root in reverse post-order, so every node is stored before its children and the root at index 0
+        void add_nodes(const Trapezoidal_Node* root)
+        {
+            std::vector<const Trapezoidal_Node*> post_order;
+            std::unordered_map<const Trapezoidal_Node*, bool> visited;
+
+            //Iterative depth first search, the map can be degenerate when it is built without randomization
+            std::vector<std::pair<const Trapezoidal_Node*, bool>> stack;
+            stack.emplace_back(root, false);
+
+            while (!stack.empty())
+            {
+                const auto [node, children_done] = stack.back();
+                stack.pop_back();
+
+                if (children_done)
+                {
+                    post_order.push_back(node);
+                    continue;
+                }
+
+                if (visited[node])
+                {
+                    continue;
+                }
+                visited[node] = true;
+
+                stack.emplace_back(node, true);
+
+                const Trapezoidal_Node* first = nullptr;
+                const Trapezoidal_Node* second = nullptr;
+                get_children(node, first, second);
+
+                if (second != nullptr && !visited[second]) stack.emplace_back(second, false);
+                if (first != nullptr && !visited[first]) stack.emplace_back(first, false);
+            }
+
+            data.nodes.resize(post_order.size());
+            for (size_t i = 0; i < post_order.size(); i++)
+            {
+                node_indices.emplace(post_order[post_order.size() - 1 - i], static_cast<int32_t>(i));
+            }
+
+            for (size_t i = 0; i < post_order.size(); i++)
+            {
+                data.nodes[i] = flatten(post_order[post_order.size() - 1 - i]);
+            }
+        }
+
+    private:
+
+        static void get_children(const Trapezoidal_Node* node, const Trapezoidal_Node*& first, const Trapezoidal_Node*& second)
+        {
+            if (const Trapezoidal_X_Node* x_node = dynamic_cast<const Trapezoidal_X_Node*>(node))
+            {
+                first = x_node->left.get();
+                second = x_node->right.get();
+            }
+            else if (const Trapezoidal_Y_Node* y_node = dynamic_cast<const Trapezoidal_Y_Node*>(node))
+            {
+                first = y_node->below.get();
+                second = y_node->above.get();
+            }
+        }
+
+        Flat_Trapezoidal_Node flatten(const Trapezoidal_Node* node)
+        {
+            Flat_Trapezoidal_Node flat_node;
+
+            if (const Trapezoidal_X_Node* x_node = dynamic_cast<const Trapezoidal_X_Node*>(node))
+            {
+                flat_node.type = Flat_Trapezoidal_Node::x_node;
+                flat_node.reference = add_segment(x_node->segment);
+                flat_node.first = node_indices.at(x_node->left.get());
+                flat_node.second = node_indices.at(x_node->right.get());
+            }
+            else if (const Trapezoidal_Y_Node* y_node = dynamic_cast<const Trapezoidal_Y_Node*>(node))
+            {
+                flat_node.type = Flat_Trapezoidal_Node::y_node;
+                flat_node.reference = static_cast<int32_t>(data.points.size() / 2);
+                data.points.push_back(y_node->point->x.get_value());
+                data.points.push_back(y_node->point->y.get_value());
+                flat_node.first = node_indices.at(y_node->below.get());
+                flat_node.second = node_indices.at(y_node->above.get());
+            }
+            else
+            {
+                const Trapezoidal_Leaf_Node* leaf_node = static_cast<const Trapezoidal_Leaf_Node*>(node);
+
+                flat_node.type = Flat_Trapezoidal_Node::leaf;
+                flat_node.reference = -1;
+                flat_node.first = add_segment(leaf_node->left_segment);
+                flat_node.second = add_segment(leaf_node->right_segment);
+            }
+
+            return flat_node;
+        }
+
+        int32_t add_segment(const Segment* segment)
+        {
+            const auto existing = segment_indices.find(segment);
+            if (existing != segment_indices.end())
+            {
+                return existing->second;
+            }
+
+            const int32_t index = static_cast<int32_t>(data.segments.size());
+            segment_indices.emplace(segment, index);
+
+            data.segments.push_back({ segment->start.x.get_value(), segment->start.y.get_value(), segment->end.x.get_value(), segment->end.y.get_value(), segment->start_t.get_value(), segment->end_t.get_value() });
+
+            return index;
+        }
+
+        Flat_Trapezoidal_Map_Data& data;
+
+        std::unordered_map<const Trapezoidal_Node*, int32_t> node_indices;
+        std::unordered_map<const Segment*, int32_t> segment_indices;
+    };
+}
+
+Flat_Trapezoidal_Map_Data Flat_Trapezoidal_Map::build_data(const Trapezoidal_Map& trapezoidal_map)
+{
+    Flat_Trapezoidal_Map_Data data;
+
+    Flat_Trapezoidal_Map_Builder builder(data);
+    builder.add_nodes(trapezoidal_map.root.get());
+
+    return data;
+}
+
+//Walks down the same way as the trace_left_right functions of the Trapezoidal_Map nodes
+void Flat_Trapezoidal_Map::trace_left_right(const Vec2& point, const bool prefer_top, Segment& left_segment, Segment& right_segment) const
+{
+    int32_t index = 0;
+
+    while (nodes[index].type != Flat_Trapezoidal_Node::leaf)
+    {
+        TRAJECTORY_HOTSPOTS_COUNT(statistics->current_map_query_depth++);
+
+        const Flat_Trapezoidal_Node& node = nodes[index];
+
+        if (node.type == Flat_Trapezoidal_Node::x_node)
+        {
+            //This works based on the assumption that a point query reaching a x-node will always lay left, right, or on the segment, never above or below.
+            const Segment segment = segments[node.reference].to_segment();
+            const Float point_direction = segment.point_direction(point);
+
+            if (point_direction > 0.f)
+            {
+                index = node.second;
+            }
+            else if (point_direction < 0.f)
+            {
+                index = node.first;
+            }
+            else
+            {
+                //Point lies on the segment (including its endpoints), check if the segment points left up or left down
+                const Vec2 segment_vec = *segment.get_right_point() - *segment.get_left_point();
+                const Float orientation = Vec2(1.f, 0.f).cross(segment_vec);
+                const bool upwards_segment = orientation >= 0.f;
+
+                index = (upwards_segment == prefer_top) ? node.first : node.second;
+            }
+        }
+        else
+        {
+            const Vec2 node_point(points[node.reference * 2], points[node.reference * 2 + 1]);
+
+            //Points at the height of the node's point go to the side the query prefers, like in Trapezoidal_Y_Node::trace_left_right
+            if (point.y.get_value() > node_point.y.get_value())
+            {
+                index = node.second;
+            }
+            else if (point.y.get_value() < node_point.y.get_value())
+            {
+                index = node.first;
+            }
+            else
+            {
+                index = prefer_top ? node.second : node.first;
+            }
+        }
+    }
+
+    left_segment = segments[nodes[index].first].to_segment();
+    right_segment = segments[nodes[index].second].to_segment();
+
+    TRAJECTORY_HOTSPOTS_COUNT(statistics->end_map_query());
+}
+
+bool Flat_Trapezoidal_Map::is_valid() const
+{
+    if (node_count == 0)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < node_count; i++)
+    {
+        const Flat_Trapezoidal_Node& node = nodes[i];
+
+        const bool children_valid = node.first >= 0 && node.second >= 0;
+
+        switch (node.type)
+        {
+        case Flat_Trapezoidal_Node::leaf:
+            if (!children_valid || static_cast<size_t>(node.first) >= segment_count || static_cast<size_t>(node.second) >= segment_count) return false;
+            break;
+        case Flat_Trapezoidal_Node::x_node:
+            //Children are always stored after their parents, so walking down always terminates
+            if (!children_valid || node.reference < 0 || static_cast<size_t>(node.reference) >= segment_count ||
+                static_cast<size_t>(node.first) <= i || static_cast<size_t>(node.first) >= node_count || static_cast<size_t>(node.second) <= i || static_cast<size_t>(node.second) >= node_count) return false;
+            break;
+        case Flat_Trapezoidal_Node::y_node:
+            if (!children_valid || node.reference < 0 || static_cast<size_t>(node.reference) >= point_count ||
+                static_cast<size_t>(node.first) <= i || static_cast<size_t>(node.first) >= node_count || static_cast<size_t>(node.second) <= i || static_cast<size_t>(node.second) >= node_count) return false;
+            break;
+        default:
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+class Trapezoidal_Map;
+
+//Segment stored as plain floats, so it can be written to a file and read from a memory mapping
+class Flat_Trapezoidal_Segment
+{
+public:
+
+    Segment to_segment() const
+    {
+        return Segment(Vec2(start_x, start_y), Vec2(end_x, end_y), start_t, end_t);
+    }
+
+    float start_x;
+    float start_y;
+    float end_x;
+    float end_y;
+    float start_t;
+    float end_t;
+};
+
+static_assert(sizeof(Flat_Trapezoidal_Segment) == 24, "Flat_Trapezoidal_Segment is part of the file formats, its layout must not change");
+
+//Node of a Trapezoidal_Map search structure stored in a flat array, refers to children, segments, and points by index
+class Flat_Trapezoidal_Node
+{
+public:
+
+    static constexpr int32_t leaf = 0;
+    static constexpr int32_t x_node = 1;
+    static constexpr int32_t y_node = 2;
+
+    int32_t type;
+
+    //X nodes: the segment index, Y nodes: the point index, unused for leaves
+    int32_t reference;
+
+    //X nodes: left and right child, Y nodes: below and above child, leaves: left and right segment index
+    int32_t first;
+    int32_t second;
+};
+
+static_assert(sizeof(Flat_Trapezoidal_Node) == 16, "Flat_Trapezoidal_Node is part of the file formats, its layout must not change");
+
+//The arrays of a flattened trapezoidal map, as built from a Trapezoidal_Map
+class Flat_Trapezoidal_Map_Data
+{
+public:
+
+    std::vector<Flat_Trapezoidal_Node> nodes;
+    std::vector<Flat_Trapezoidal_Segment> segments;
+
+    //Y node points as (x, y) pairs
+    std::vector<float> points;
+};
+
+//Position-independent version of the search structure of a Trapezoidal_Map, queried in place from arrays that may live in a memory mapping
+//The node at index 0 is the root, nodes are stored before their children and nodes shared by multiple parents are stored once
+class Flat_Trapezoidal_Map
+{
+public:
+
+    Flat_Trapezoidal_Map() = default;
+
+    //Query the given arrays in place, they must outlive the map
+    Flat_Trapezoidal_Map(const Flat_Trapezoidal_Node* nodes, const size_t node_count, const Flat_Trapezoidal_Segment* segments, const size_t segment_count, const float* points, const size_t point_count) :
+        nodes(nodes), node_count(node_count), segments(segments), segment_count(segment_count), points(points), point_count(point_count)
+    {
+    }
+
+    explicit Flat_Trapezoidal_Map(const Flat_Trapezoidal_Map_Data& data) :
+        Flat_Trapezoidal_Map(data.nodes.data(), data.nodes.size(), data.segments.data(), data.segments.size(), data.points.data(), data.points.size() / 2)
+    {
+    }
+
+    //Flattens the search structure of a map
+    static Flat_Trapezoidal_Map_Data build_data(const Trapezoidal_Map& trapezoidal_map);
+
+    //Same as Trapezoidal_Map::trace_left_right, returns copies of the segments instead of pointers
+    void trace_left_right(const Vec2& point, const bool prefer_top, Segment& left_segment, Segment& right_segment) const;
+
+    //Checks that all indices lie inside the arrays, for maps read from files
+    bool is_valid() const;
+
+    size_t get_node_count() const { return node_count; }
+
+private:
+
+    const Flat_Trapezoidal_Node* nodes = nullptr;
+    size_t node_count = 0;
+
+    const Flat_Trapezoidal_Segment* segments = nullptr;
+    size_t segment_count = 0;
+
+    const float* points = nullptr;
+    size_t point_count = 0;
+};
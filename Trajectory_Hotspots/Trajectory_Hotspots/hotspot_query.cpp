@@ -0,0 +1,59 @@
+#include "pch.h"
+#include "vec2.h"
+#include "trajectory.h"
+#include "hotspot_query.h"
+
+namespace
+{
+    const Hotspot_Query all_queries[] = { Hotspot_Query::fixed_radius, Hotspot_Query::fixed_length, Hotspot_Query::fixed_radius_contiguous, Hotspot_Query::fixed_length_contiguous };
+}
+
+const char* hotspot_query_name(const Hotspot_Query query)
+{
+    switch (query)
+    {
+    case Hotspot_Query::fixed_radius: return "fixed_radius";
+    case Hotspot_Query::fixed_length: return "fixed_length";
+    case Hotspot_Query::fixed_radius_contiguous: return "fixed_radius_contiguous";
+    case Hotspot_Query::fixed_length_contiguous: return "fixed_length_contiguous";
+    }
+
+    return "";
+}
+
+bool parse_hotspot_query(const std::string& name, Hotspot_Query& query)
+{
+    for (const Hotspot_Query candidate : all_queries)
+    {
+        if (name == hotspot_query_name(candidate))
+        {
+            query = candidate;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool hotspot_query_uses_timestamps(const Hotspot_Query query)
+{
+    return query == Hotspot_Query::fixed_radius || query == Hotspot_Query::fixed_radius_contiguous;
+}
+
+bool hotspot_query_implemented(const Hotspot_Query query)
+{
+    return query == Hotspot_Query::fixed_radius_contiguous || query == Hotspot_Query::fixed_length_contiguous;
+}
+
+AABB run_hotspot_query(const Trajectory& trajectory, const Hotspot_Query query, const Float parameter, Scratch_Arena* arena)
+{
+    switch (query)
+    {
+    case Hotspot_Query::fixed_radius: return trajectory.get_hotspot_fixed_radius(parameter, arena);
+    case Hotspot_Query::fixed_length: return trajectory.get_hotspot_fixed_length(parameter, arena);
+    case Hotspot_Query::fixed_radius_contiguous: return trajectory.get_hotspot_fixed_radius_contiguous(parameter, arena);
+    case Hotspot_Query::fixed_length_contiguous: return trajectory.get_hotspot_fixed_length_contiguous(parameter, arena);
+    }
+
+    return AABB();
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+class Trajectory;
+
+//The four hotspot queries of Trajectory, for code that runs a query chosen at run time
+enum class Hotspot_Query
+{
+    fixed_radius,
+    fixed_length,
+    fixed_radius_contiguous,
+    fixed_length_contiguous
+};
+
+const char* hotspot_query_name(const Hotspot_Query query);
+
+//Returns false if the name is not one of the names above
+bool parse_hotspot_query(const std::string& name, Hotspot_Query& query);
+
+//The radius queries use the timestamps, the length queries measure the length along the trajectory in time,
+//so they need a trajectory with times set by the length, see Trajectory(const std::vector<Vec2>&)
+bool hotspot_query_uses_timestamps(const Hotspot_Query query);
+
+//False for the queries that Trajectory doesn't implement yet, those return an empty AABB
+bool hotspot_query_implemented(const Hotspot_Query query);
+
+//Runs the query on the trajectory, the parameter is the radius or the length
+//The temporaries of the query come from the arena if one is given, see Trajectory::get_hotspot_fixed_radius_contiguous
+AABB run_hotspot_query(const Trajectory& trajectory, const Hotspot_Query query, const Float parameter, Scratch_Arena* arena = nullptr);
@@ -0,0 +1,185 @@
+#include "pch.h"
+#include "memory_mapped_file.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+Memory_Mapped_File::~Memory_Mapped_File()
+{
+    close();
+}
+
+Memory_Mapped_File::Memory_Mapped_File(Memory_Mapped_File&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+Memory_Mapped_File& Memory_Mapped_File::operator=(Memory_Mapped_File&& other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+
+        mapped_data = other.mapped_data;
+        mapped_size = other.mapped_size;
+        opened = other.opened;
+
+#ifdef _WIN32
+        file_handle = other.file_handle;
+        mapping_handle = other.mapping_handle;
+
+        other.file_handle = nullptr;
+        other.mapping_handle = nullptr;
+#endif
+
+        other.mapped_data = nullptr;
+        other.mapped_size = 0;
+        other.opened = false;
+    }
+
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool Memory_Mapped_File::open(const char* path)
+{
+    close();
+
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size))
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    file_handle = file;
+    opened = true;
+
+    //A zero sized file can't be mapped
+    if (file_size.QuadPart == 0)
+    {
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        close();
+        return false;
+    }
+
+    mapping_handle = mapping;
+
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr)
+    {
+        close();
+        return false;
+    }
+
+    mapped_data = static_cast<const char*>(view);
+    mapped_size = static_cast<size_t>(file_size.QuadPart);
+
+    return true;
+}
+
+void Memory_Mapped_File::close()
+{
+    if (mapped_data != nullptr)
+    {
+        UnmapViewOfFile(mapped_data);
+    }
+
+    if (mapping_handle != nullptr)
+    {
+        CloseHandle(mapping_handle);
+    }
+
+    if (file_handle != nullptr)
+    {
+        CloseHandle(file_handle);
+    }
+
+    mapped_data = nullptr;
+    mapped_size = 0;
+    mapping_handle = nullptr;
+    file_handle = nullptr;
+    opened = false;
+}
+
+#else
+
+bool Memory_Mapped_File::open(const char* path)
+{
+    close();
+
+    const int file = ::open(path, O_RDONLY);
+    if (file < 0)
+    {
+        return false;
+    }
+
+    struct stat file_status;
+    if (fstat(file, &file_status) != 0)
+    {
+        ::close(file);
+        return false;
+    }
+
+    opened = true;
+
+    //A zero sized file can't be mapped
+    if (file_status.st_size == 0)
+    {
+        ::close(file);
+        return true;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(file_status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+    //The mapping stays valid after the descriptor is closed
+    ::close(file);
+
+    if (view == MAP_FAILED)
+    {
+        opened = false;
+        return false;
+    }
+
+    //The file is read front to back, let the kernel read ahead aggressively
+    madvise(view, static_cast<size_t>(file_status.st_size), MADV_SEQUENTIAL);
+
+    mapped_data = static_cast<const char*>(view);
+    mapped_size = static_cast<size_t>(file_status.st_size);
+
+    return true;
+}
+
+void Memory_Mapped_File::close()
+{
+    if (mapped_data != nullptr)
+    {
+        munmap(const_cast<char*>(mapped_data), mapped_size);
+    }
+
+    mapped_data = nullptr;
+    mapped_size = 0;
+    opened = false;
+}
+
+#endif
@@ -0,0 +1,38 @@
+#pragma once
+
+//Read-only view of a whole file mapped into memory
+//The mapping is released when the object is destroyed
+class Memory_Mapped_File
+{
+public:
+
+    Memory_Mapped_File() = default;
+    ~Memory_Mapped_File();
+
+    Memory_Mapped_File(const Memory_Mapped_File&) = delete;
+    Memory_Mapped_File& operator=(const Memory_Mapped_File&) = delete;
+
+    Memory_Mapped_File(Memory_Mapped_File&& other) noexcept;
+    Memory_Mapped_File& operator=(Memory_Mapped_File&& other) noexcept;
+
+    //Maps the file at path, returns false if it can't be opened or mapped
+    //Empty files open successfully with a null data pointer
+    bool open(const char* path);
+    void close();
+
+    bool is_open() const { return opened; }
+
+    const char* data() const { return mapped_data; }
+    size_t size() const { return mapped_size; }
+
+private:
+
+    const char* mapped_data = nullptr;
+    size_t mapped_size = 0;
+    bool opened = false;
+
+#ifdef _WIN32
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+#endif
+};
@@ -6,15 +6,28 @@
 #include <algorithm>
 #include <math.h>
 #include <vector>
+#include <deque>
 #include <random>
 #include <numeric>
+#include <memory>
+#include <cstring>
+#include <string>
 
 #include <cassert>
 
+#include "query_statistics.h"
+#include "trace.h"
+#include "allocation_hook.h"
+#include "scratch_arena.h"
 #include "float.h"
 #include "aabb.h"
+#include "simd_aabb.h"
 #include "segment.h"
+#include "segment_batch.h"
 #include "segment_search_tree.h"
+#include "flat_segment_search_tree.h"
+#include "dynamic_segment_search_tree.h"
 #include "trapezoidal_map.h"
+#include "flat_trapezoidal_map.h"
 
 //TODO: Axis enum
\ No newline at end of file
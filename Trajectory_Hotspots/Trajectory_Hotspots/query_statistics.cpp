@@ -0,0 +1,45 @@
+#include "pch.h"
+#include "query_statistics.h"
+
+thread_local Query_Statistics* Query_Statistics_Scope::active = nullptr;
+
+const char* query_phase_name(const Query_Phase phase)
+{
+    switch (phase)
+    {
+    case Query_Phase::tree_build: return "tree_build";
+    case Query_Phase::map_build: return "map_build";
+    case Query_Phase::search: return "search";
+    }
+
+    return "unknown";
+}
+
+void Query_Statistics::add(const Query_Statistics& other)
+{
+    tree_queries += other.tree_queries;
+    tree_nodes_visited += other.tree_nodes_visited;
+
+    map_nodes += other.map_nodes;
+    map_queries += other.map_queries;
+    map_query_depth_max = std::max(map_query_depth_max, other.map_query_depth_max);
+    map_query_depth_total += other.map_query_depth_total;
+
+    for (size_t type = 0; type < breakpoint_type_count; type++)
+    {
+        breakpoint_candidates[type] += other.breakpoint_candidates[type];
+        breakpoint_accepted[type] += other.breakpoint_accepted[type];
+    }
+
+    radius_candidates += other.radius_candidates;
+    radius_rejected += other.radius_rejected;
+
+    for (size_t phase = 0; phase < phase_count; phase++)
+    {
+        memory[phase].allocations += other.memory[phase].allocations;
+        memory[phase].bytes += other.memory[phase].bytes;
+        memory[phase].peak_live_bytes = std::max(memory[phase].peak_live_bytes, other.memory[phase].peak_live_bytes);
+    }
+
+    peak_live_bytes = std::max(peak_live_bytes, other.peak_live_bytes);
+}
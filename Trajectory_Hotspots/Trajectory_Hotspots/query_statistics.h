@@ -0,0 +1,164 @@
+#pragma once
+
+//Phases of a query, the memory counts are split by the phase that allocated
+//Allocations outside of the tree and map builds count as search.
+enum class Query_Phase
+{
+    tree_build,
+    map_build,
+    search
+};
+
+const char* query_phase_name(const Query_Phase phase);
+
+//Allocations through the allocation hook, see allocation_hook.h
+struct Memory_Statistics
+{
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+
+    //Most bytes allocated through the hook in this query and not freed yet, at any time during the phase
+    uint64_t peak_live_bytes = 0;
+};
+
+//Counts of the work done by a hotspot query, to explain why one trajectory takes much longer than another of the same size
+//The counts are only collected when the library is built with TRAJECTORY_HOTSPOTS_STATISTICS defined, as the Debug configuration does.
+//Without it the counting compiles to nothing and all counts stay zero.
+class Query_Statistics
+{
+public:
+
+#ifdef TRAJECTORY_HOTSPOTS_STATISTICS
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+
+    //Breakpoint types of fixed_length_contiguous, index 0 is type I and index 4 is type V
+    static constexpr size_t breakpoint_type_count = 5;
+
+    static constexpr size_t phase_count = 3;
+
+    //Range and time queries of the Segment_Search_Tree, and the tree nodes these visited
+    uint64_t tree_queries = 0;
+    uint64_t tree_nodes_visited = 0;
+
+    //Nodes of the trapezoidal maps that were queried, summed over both axes
+    uint64_t map_nodes = 0;
+
+    //Point queries of the trapezoidal maps, with the number of internal nodes on the path to the leaf as depth
+    uint64_t map_queries = 0;
+    uint64_t map_query_depth_max = 0;
+    uint64_t map_query_depth_total = 0;
+
+    //Fixed length contiguous breakpoints that were evaluated, and those that gave a hotspot
+    uint64_t breakpoint_candidates[breakpoint_type_count] = {};
+    uint64_t breakpoint_accepted[breakpoint_type_count] = {};
+
+    //Fixed radius contiguous subtrajectories that were tested, and those rejected because their bounding box was larger than the radius
+    uint64_t radius_candidates = 0;
+    uint64_t radius_rejected = 0;
+
+    //Allocations of each phase, indexed by Query_Phase
+    Memory_Statistics memory[phase_count];
+
+    //Most bytes allocated in this query and not freed yet, over all phases
+    uint64_t peak_live_bytes = 0;
+
+    const Memory_Statistics& get_memory(const Query_Phase phase) const
+    {
+        return memory[static_cast<size_t>(phase)];
+    }
+
+    double get_average_map_query_depth() const
+    {
+        return map_queries == 0 ? 0.0 : static_cast<double>(map_query_depth_total) / static_cast<double>(map_queries);
+    }
+
+    //Called by the map at the end of a point query
+    void end_map_query()
+    {
+        map_queries++;
+        map_query_depth_total += current_map_query_depth;
+        map_query_depth_max = std::max(map_query_depth_max, current_map_query_depth);
+        current_map_query_depth = 0;
+    }
+
+    //Adds the counts of another query, the maxima and peaks are the largest of both
+    void add(const Query_Statistics& other);
+
+    //Called by the queries when they start a phase, memory still allocated by earlier phases counts towards the peak of the new phase
+    void begin_phase(const Query_Phase phase)
+    {
+        current_phase = phase;
+        update_peak();
+    }
+
+    //Called by the allocation hook
+    void count_allocation(const size_t bytes)
+    {
+        Memory_Statistics& phase_memory = memory[static_cast<size_t>(current_phase)];
+        phase_memory.allocations++;
+        phase_memory.bytes += bytes;
+
+        live_bytes += static_cast<int64_t>(bytes);
+        update_peak();
+    }
+
+    //Memory that was allocated before the query can be freed during it, so the live bytes can drop below zero
+    void count_deallocation(const size_t bytes)
+    {
+        live_bytes -= static_cast<int64_t>(bytes);
+    }
+
+    //Depth of the map query in progress
+    uint64_t current_map_query_depth = 0;
+
+    Query_Phase current_phase = Query_Phase::search;
+    int64_t live_bytes = 0;
+
+private:
+
+    void update_peak()
+    {
+        const uint64_t live = live_bytes > 0 ? static_cast<uint64_t>(live_bytes) : 0;
+
+        Memory_Statistics& phase_memory = memory[static_cast<size_t>(current_phase)];
+        phase_memory.peak_live_bytes = std::max(phase_memory.peak_live_bytes, live);
+        peak_live_bytes = std::max(peak_live_bytes, live);
+    }
+};
+
+//Makes the statistics the target of the counts on this thread while in scope, after resetting them
+class Query_Statistics_Scope
+{
+public:
+
+    explicit Query_Statistics_Scope(Query_Statistics& statistics) : previous(active)
+    {
+        statistics = Query_Statistics();
+        active = &statistics;
+    }
+
+    ~Query_Statistics_Scope()
+    {
+        active = previous;
+    }
+
+    Query_Statistics_Scope(const Query_Statistics_Scope&) = delete;
+    Query_Statistics_Scope& operator=(const Query_Statistics_Scope&) = delete;
+
+    //The statistics counted on this thread, nullptr outside of a scope
+    static thread_local Query_Statistics* active;
+
+private:
+
+    Query_Statistics* previous;
+};
+
+//Runs the statement with `statistics` pointing to the active statistics, if there are any
+#ifdef TRAJECTORY_HOTSPOTS_STATISTICS
+#define TRAJECTORY_HOTSPOTS_COUNT(statement) do { if (Query_Statistics* statistics = Query_Statistics_Scope::active) { statement; } } while (false)
+#else
+#define TRAJECTORY_HOTSPOTS_COUNT(statement) do { } while (false)
+#endif
@@ -0,0 +1,126 @@
+#include "pch.h"
+#include "scratch_arena.h"
+
+thread_local Scratch_Arena* Scratch_Arena_Scope::active = nullptr;
+
+namespace
+{
+    size_t align_up(const size_t value)
+    {
+        return (value + Scratch_Arena::alignment - 1) & ~(Scratch_Arena::alignment - 1);
+    }
+}
+
+Scratch_Arena& get_thread_scratch_arena()
+{
+    thread_local Scratch_Arena arena;
+    return arena;
+}
+
+Scratch_Arena::Scratch_Arena(const size_t initial_capacity)
+{
+    add_chunk(std::max(align_up(initial_capacity), alignment));
+}
+
+Scratch_Arena::~Scratch_Arena()
+{
+    for (const Chunk& chunk : chunks)
+    {
+        ::operator delete(chunk.memory);
+    }
+}
+
+void Scratch_Arena::add_chunk(const size_t size)
+{
+    //Not through the hook, the arena is what the hook allocates from
+    chunks.push_back({ static_cast<char*>(::operator new(size)), size });
+}
+
+void* Scratch_Arena::allocate(const size_t bytes)
+{
+    const size_t aligned_bytes = align_up(std::max(bytes, size_t(1)));
+
+    while (current_offset + aligned_bytes > chunks[current_chunk].size)
+    {
+        //Chunks after the current one are left over from before the last reset that couldn't merge them, or were just added
+        if (current_chunk + 1 == chunks.size())
+        {
+            add_chunk(std::max(chunks.back().size * 2, aligned_bytes));
+        }
+
+        current_chunk++;
+        current_offset = 0;
+    }
+
+    void* memory = chunks[current_chunk].memory + current_offset;
+    current_offset += aligned_bytes;
+
+    return memory;
+}
+
+bool Scratch_Arena::owns(const void* memory) const
+{
+    const char* address = static_cast<const char*>(memory);
+
+    for (const Chunk& chunk : chunks)
+    {
+        if (address >= chunk.memory && address < chunk.memory + chunk.size)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Scratch_Arena::reset()
+{
+    if (chunks.size() > 1)
+    {
+        const size_t capacity = get_capacity();
+
+        for (const Chunk& chunk : chunks)
+        {
+            ::operator delete(chunk.memory);
+        }
+
+        chunks.clear();
+        add_chunk(capacity);
+    }
+
+    current_chunk = 0;
+    current_offset = 0;
+}
+
+void Scratch_Arena::rewind(const Marker& marker)
+{
+    //Chunks are only merged by reset(), so the chunks after the marker are still there to be reused
+    assert(marker.chunk < chunks.size() && marker.offset <= chunks[marker.chunk].size);
+
+    current_chunk = marker.chunk;
+    current_offset = marker.offset;
+}
+
+size_t Scratch_Arena::get_used_bytes() const
+{
+    size_t used_bytes = current_offset;
+
+    for (size_t i = 0; i < current_chunk; i++)
+    {
+        used_bytes += chunks[i].size;
+    }
+
+    return used_bytes;
+}
+
+size_t Scratch_Arena::get_capacity() const
+{
+    size_t capacity = 0;
+
+    for (const Chunk& chunk : chunks)
+    {
+        capacity += chunk.size;
+    }
+
+    return capacity;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+//Bump allocator for the temporaries of a query, reset between queries so its memory is reused instead of freed
+//While a Scratch_Arena_Scope is alive, the hooked allocations of its thread (see allocation_hook.h) come from the arena,
+//freeing them does nothing, the memory comes back on reset().
+//Everything allocated in a scope has to be destroyed before the arena is reset, so only the results of a query may leave the scope.
+class Scratch_Arena
+{
+public:
+
+    //Allocations are aligned like operator new does
+    static constexpr size_t alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+    explicit Scratch_Arena(const size_t initial_capacity = size_t(1) << 16);
+    ~Scratch_Arena();
+
+    Scratch_Arena(const Scratch_Arena&) = delete;
+    Scratch_Arena& operator=(const Scratch_Arena&) = delete;
+
+    //Takes a new chunk when the current one is full, chunks are only freed on destruction and when reset() merges them
+    void* allocate(const size_t bytes);
+
+    //Returns true if the memory lies in one of the chunks of the arena
+    bool owns(const void* memory) const;
+
+    //Makes all memory available again, and merges the chunks into one chunk of their total size,
+    //so an arena that was reset after its largest query doesn't allocate anymore
+    void reset();
+
+    //Position in the arena, rewinding to it makes the memory allocated after it available again and keeps what was allocated before
+    struct Marker
+    {
+        size_t chunk;
+        size_t offset;
+    };
+
+    Marker get_marker() const { return { current_chunk, current_offset }; }
+    void rewind(const Marker& marker);
+
+    size_t get_used_bytes() const;
+    size_t get_capacity() const;
+    size_t get_chunk_count() const { return chunks.size(); }
+
+private:
+
+    struct Chunk
+    {
+        char* memory;
+        size_t size;
+    };
+
+    void add_chunk(const size_t size);
+
+    std::vector<Chunk> chunks;
+
+    //The chunk allocations are made from, the ones before it are full
+    size_t current_chunk = 0;
+    size_t current_offset = 0;
+};
+
+//An arena per thread, for callers that don't manage their own, see Trajectory::get_hotspot_fixed_radius_contiguous
+Scratch_Arena& get_thread_scratch_arena();
+
+//Makes the arena the source of the hooked allocations of this thread while in scope
+class Scratch_Arena_Scope
+{
+public:
+
+    explicit Scratch_Arena_Scope(Scratch_Arena& arena) : previous(active)
+    {
+        active = &arena;
+    }
+
+    ~Scratch_Arena_Scope()
+    {
+        active = previous;
+    }
+
+    Scratch_Arena_Scope(const Scratch_Arena_Scope&) = delete;
+    Scratch_Arena_Scope& operator=(const Scratch_Arena_Scope&) = delete;
+
+    //The arena of this thread, nullptr outside of a scope
+    static thread_local Scratch_Arena* active;
+
+private:
+
+    Scratch_Arena* previous;
+};
+
+//Scope of a query that takes an optional arena: routes its allocations to the arena and rewinds the arena when the query returns,
+//so an arena can be passed to query after query, or be shared with allocations of the caller that outlive the query
+//Without an arena the allocations go wherever they went before.
+class Scratch_Arena_Query_Scope
+{
+public:
+
+    explicit Scratch_Arena_Query_Scope(Scratch_Arena* arena) : arena(arena), marker(arena != nullptr ? arena->get_marker() : Scratch_Arena::Marker{ 0, 0 })
+    {
+        if (arena != nullptr)
+        {
+            previous = Scratch_Arena_Scope::active;
+            Scratch_Arena_Scope::active = arena;
+        }
+    }
+
+    ~Scratch_Arena_Query_Scope()
+    {
+        if (arena != nullptr)
+        {
+            Scratch_Arena_Scope::active = previous;
+            arena->rewind(marker);
+        }
+    }
+
+    Scratch_Arena_Query_Scope(const Scratch_Arena_Query_Scope&) = delete;
+    Scratch_Arena_Query_Scope& operator=(const Scratch_Arena_Query_Scope&) = delete;
+
+private:
+
+    Scratch_Arena* arena;
+    Scratch_Arena::Marker marker;
+    Scratch_Arena* previous = nullptr;
+};
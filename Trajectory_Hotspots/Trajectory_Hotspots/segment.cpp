@@ -15,9 +15,11 @@ Float Segment::squared_length() const
     return distance_vector.squared_length();
 }
 
+//The endpoints are ordered on their exact y, the trapezoidal map needs one order for all points
+//With the tolerant comparison two points a few ulps apart count as equal, which is not transitive and makes the order depend on the segment
 const Vec2* Segment::get_bottom_point() const
 {
-    if (start.y > end.y)
+    if (start.y.get_value() > end.y.get_value())
     {
         return &end;
     }
@@ -30,7 +32,7 @@ const Vec2* Segment::get_bottom_point() const
 
 const Vec2* Segment::get_top_point() const
 {
-    if (start.y > end.y)
+    if (start.y.get_value() > end.y.get_value())
     {
         return &start;
     }
@@ -265,6 +267,70 @@ Vec2 Segment::get_point_at_time(const Float time) const
     return (start + vector_to_point);
 }
 
+Float Segment::get_time_at_x(const Float x, const Segment_Kinematics& kinematics) const
+{
+    const Float x_fraction = (x - start.x) * kinematics.inverse_dx;
+    return start_t + (x_fraction * kinematics.dt);
+}
+
+Float Segment::get_time_at_y(const Float y, const Segment_Kinematics& kinematics) const
+{
+    const Float y_fraction = (y - start.y) * kinematics.inverse_dy;
+    return start_t + (y_fraction * kinematics.dt);
+}
+
+Float Segment::get_time_at_point(const Vec2& point, const Segment_Kinematics& kinematics) const
+{
+    //Project the point on the direction of the segment, this avoids the square root of the length
+    const Float time_fraction = (((point.x - start.x) * kinematics.dx) + ((point.y - start.y) * kinematics.dy)) * kinematics.inverse_squared_length;
+    return start_t + (time_fraction * kinematics.dt);
+}
+
+//Returns the point on the segment at a given time
+Vec2 Segment::get_point_at_time(const Float time, const Segment_Kinematics& kinematics) const
+{
+    const Float fraction = (time - start_t) * kinematics.inverse_dt;
+
+    return Vec2(start.x + (kinematics.dx * fraction), start.y + (kinematics.dy * fraction));
+}
+
+Segment_Kinematics Segment::get_kinematics() const
+{
+    Segment_Kinematics kinematics;
+
+    kinematics.dx = end.x - start.x;
+    kinematics.dy = end.y - start.y;
+    kinematics.dt = end_t - start_t;
+
+    kinematics.inverse_dx = 1.f / kinematics.dx;
+    kinematics.inverse_dy = 1.f / kinematics.dy;
+    kinematics.inverse_dt = 1.f / kinematics.dt;
+
+    kinematics.length = length();
+    kinematics.inverse_length = 1.f / kinematics.length;
+    kinematics.inverse_squared_length = 1.f / ((kinematics.dx * kinematics.dx) + (kinematics.dy * kinematics.dy));
+
+    return kinematics;
+}
+
+std::vector<Segment_Kinematics> build_segment_kinematics(const std::vector<Segment>& segments)
+{
+    std::vector<Segment_Kinematics> kinematics;
+    build_segment_kinematics(segments, kinematics);
+    return kinematics;
+}
+
+void build_segment_kinematics(const std::vector<Segment>& segments, std::vector<Segment_Kinematics>& kinematics)
+{
+    kinematics.clear();
+    kinematics.reserve(segments.size());
+
+    for (const Segment& segment : segments)
+    {
+        kinematics.push_back(segment.get_kinematics());
+    }
+}
+
 //Returns the orientation of a point vs the segment, <0 is left, >0 is right, 0 is on the segment
 Float Segment::point_direction(const Vec2& point) const
 {
@@ -2,6 +2,7 @@
 
 class Vec2;
 class AABB;
+class Segment_Kinematics;
 
 class Segment
 {
@@ -62,6 +63,15 @@ public:
 
     Vec2 get_point_at_time(const Float time) const;
 
+    //Fast variants of the functions above, using the precomputed kinematics of this segment instead of recomputing differences, divisions and lengths
+    Float get_time_at_x(const Float x, const Segment_Kinematics& kinematics) const;
+    Float get_time_at_y(const Float y, const Segment_Kinematics& kinematics) const;
+    Float get_time_at_point(const Vec2& point, const Segment_Kinematics& kinematics) const;
+
+    Vec2 get_point_at_time(const Float time, const Segment_Kinematics& kinematics) const;
+
+    Segment_Kinematics get_kinematics() const;
+
     const Vec2* get_bottom_point() const;
     const Vec2* get_top_point() const;
     const Vec2* get_left_point() const;
@@ -90,6 +100,31 @@ public:
     Float end_t;
 };
 
+//Derived per-segment data that stays constant as long as the segment does not change
+//Used by the fast variants of the time and point functions of Segment
+class Segment_Kinematics
+{
+public:
+
+    Float dx;
+    Float dy;
+    Float dt;
+
+    Float inverse_dx;
+    Float inverse_dy;
+    Float inverse_dt;
+
+    Float length;
+    Float inverse_length;
+    Float inverse_squared_length;
+};
+
+//Build the kinematics for each segment, the result can be indexed with the same index as the segments
+std::vector<Segment_Kinematics> build_segment_kinematics(const std::vector<Segment>& segments);
+
+//Same as above, into an existing vector so its memory is reused
+void build_segment_kinematics(const std::vector<Segment>& segments, std::vector<Segment_Kinematics>& kinematics);
+
 //Determine if a point lies to the left or right of a segment, oriented from start to end
 //If the point lies on the segment this function will return true (right)
 bool point_right_of_segment(const Segment& segment, const Vec2& point);
\ No newline at end of file
@@ -0,0 +1,472 @@
+#include "pch.h"
+#include "segment_batch.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+void Segment_Batch::clear()
+{
+    start_x.clear();
+    start_y.clear();
+    end_x.clear();
+    end_y.clear();
+    start_t.clear();
+    dt.clear();
+    inverse_dx.clear();
+    inverse_dy.clear();
+    length.clear();
+    inverse_length.clear();
+}
+
+void Segment_Batch::reserve(const size_t count)
+{
+    start_x.reserve(count);
+    start_y.reserve(count);
+    end_x.reserve(count);
+    end_y.reserve(count);
+    start_t.reserve(count);
+    dt.reserve(count);
+    inverse_dx.reserve(count);
+    inverse_dy.reserve(count);
+    length.reserve(count);
+    inverse_length.reserve(count);
+}
+
+void Segment_Batch::push_back(const Segment& segment, const Segment_Kinematics& kinematics)
+{
+    start_x.push_back(segment.start.x.get_value());
+    start_y.push_back(segment.start.y.get_value());
+    end_x.push_back(segment.end.x.get_value());
+    end_y.push_back(segment.end.y.get_value());
+    start_t.push_back(segment.start_t.get_value());
+    dt.push_back(kinematics.dt.get_value());
+    inverse_dx.push_back(kinematics.inverse_dx.get_value());
+    inverse_dy.push_back(kinematics.inverse_dy.get_value());
+    length.push_back(kinematics.length.get_value());
+    inverse_length.push_back(kinematics.inverse_length.get_value());
+}
+
+void Axis_Intersection_Batch::resize(const size_t count)
+{
+    hits.resize(count);
+    intersections.resize(count);
+    times.resize(count);
+}
+
+void Same_Axis_Point_Batch::resize(const size_t count)
+{
+    hits.resize(count);
+    start_x.resize(count);
+    start_y.resize(count);
+    start_times.resize(count);
+    end_x.resize(count);
+    end_y.resize(count);
+    end_times.resize(count);
+}
+
+namespace
+{
+    //The kernels are written once for both axes,
+    //"along" is the coordinate the line is placed on (x for vertical lines) and "across" the coordinate of the intersection
+    struct Axis_Lanes
+    {
+        const float* along_start;
+        const float* along_end;
+        const float* across_start;
+        const float* across_end;
+        const float* inverse_along;
+    };
+
+    //Scalar version of a single lane, uses Float so the tolerant comparisons match the Segment functions exactly
+    void intersect_lane(const Segment_Batch& segments, const Axis_Lanes& lanes, const size_t i, const float line_value, Axis_Intersection_Batch& result)
+    {
+        const Float line(line_value);
+        const Float start(lanes.along_start[i]);
+        const Float end(lanes.along_end[i]);
+
+        //If the query line lies on one side of the segment there is no intersection
+        if ((line < start && line < end) || (line > start && line > end))
+        {
+            result.hits[i] = 0;
+            return;
+        }
+
+        result.hits[i] = 1;
+
+        const Float difference = end - start;
+        const Float segment_to_line = line - start;
+
+        //Segment lies on the line, either no or infinite intersections
+        if (difference == 0.f)
+        {
+            result.intersections[i] = std::numeric_limits<float>::infinity();
+        }
+        else
+        {
+            const Float across_start(lanes.across_start[i]);
+            const Float across_end(lanes.across_end[i]);
+
+            result.intersections[i] = (across_start + ((segment_to_line / difference) * (across_end - across_start))).get_value();
+        }
+
+        const Float fraction = segment_to_line * Float(lanes.inverse_along[i]);
+        result.times[i] = (Float(segments.start_t[i]) + (fraction * Float(segments.dt[i]))).get_value();
+    }
+
+    //Everything of the start segment the same axis solver needs, computed once per batch
+    struct Same_Axis_Start
+    {
+        Vec2 start;
+        Vec2 end;
+        Float start_t;
+        Float end_t;
+
+        //Lower and upper coordinate on the axis, in the same way Segment::x_overlap and Segment::y_overlap sort them
+        Float lower;
+        Float upper;
+
+        //The coordinate of the end point on the axis
+        Float end_on_axis;
+
+        Float axis_difference;
+        Float length;
+        Float inverse_length;
+        Float dt;
+    };
+
+    Same_Axis_Start same_axis_start(const Segment& segment, const Segment_Kinematics& kinematics, const bool axis)
+    {
+        const Float start = axis ? segment.start.x : segment.start.y;
+        const Float end = axis ? segment.end.x : segment.end.y;
+
+        Same_Axis_Start result;
+        result.start = segment.start;
+        result.end = segment.end;
+        result.start_t = segment.start_t;
+        result.end_t = segment.end_t;
+        result.lower = (start <= end ? start : end);
+        result.upper = (start > end ? start : end);
+        result.end_on_axis = end;
+        result.axis_difference = end - start;
+        result.length = kinematics.length;
+        result.inverse_length = kinematics.inverse_length;
+        result.dt = kinematics.dt;
+
+        return result;
+    }
+
+    //Scalar version of a single lane, follows Segment::get_points_on_same_axis_with_distance_l step by step
+    void same_axis_lane(const Same_Axis_Start& start_segment, const Segment_Batch& segments, const Axis_Lanes& lanes, const size_t i, const Float length, Same_Axis_Point_Batch& result)
+    {
+        const Float end_start(lanes.along_start[i]);
+        const Float end_end(lanes.along_end[i]);
+
+        const Float end_lower = (end_start <= end_end ? end_start : end_end);
+        const Float end_upper = (end_start > end_end ? end_start : end_end);
+
+        result.hits[i] = 0;
+
+        if (start_segment.upper < end_lower || start_segment.lower > end_upper)
+        {
+            return;
+        }
+
+        const Float end_axis_difference = end_end - end_start;
+        const Float end_length(segments.length[i]);
+
+        const Float determinant = start_segment.axis_difference * end_length - end_axis_difference * start_segment.length;
+
+        //Determinant is zero when the two segments lie on the same line, skip
+        if (determinant == 0.f)
+        {
+            return;
+        }
+
+        const Float edge_distance = (Float(segments.start_t[i]) - start_segment.end_t);
+        const Float remaining_length = length - edge_distance;
+
+        const Float start_end_difference = start_segment.end_on_axis - end_start;
+
+        //Calculate the scalar for the vectors pointing to points p and q
+        const Float lambda = ((start_end_difference * end_length) - (end_axis_difference * remaining_length)) / determinant;
+        const Float rho = ((start_segment.axis_difference * remaining_length) - (start_end_difference * start_segment.length)) / determinant;
+
+        if (lambda < 0.f || lambda > 1.0f || rho < 0.f || rho > 1.0f)
+        {
+            return;
+        }
+
+        result.hits[i] = 1;
+
+        const Vec2 end_segment_start(segments.start_x[i], segments.start_y[i]);
+        const Vec2 end_segment_end(segments.end_x[i], segments.end_y[i]);
+
+        const Vec2 p = start_segment.end + (lambda * (start_segment.start - start_segment.end));
+        const Vec2 q = end_segment_start + (rho * (end_segment_end - end_segment_start));
+
+        result.start_x[i] = p.x.get_value();
+        result.start_y[i] = p.y.get_value();
+        result.end_x[i] = q.x.get_value();
+        result.end_y[i] = q.y.get_value();
+
+        result.start_times[i] = (start_segment.start_t + (((p - start_segment.start).length() * start_segment.inverse_length) * start_segment.dt)).get_value();
+        result.end_times[i] = (Float(segments.start_t[i]) + (((q - end_segment_start).length() * Float(segments.inverse_length[i])) * Float(segments.dt[i]))).get_value();
+    }
+
+#if defined(__AVX2__)
+
+    //Vectorized version of Float::nearly_equal, see float.cpp for the scalar version
+    inline __m256 nearly_equal(const __m256 a, const __m256 b)
+    {
+        const __m256 absolute_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+
+        const __m256 exactly_equal = _mm256_cmp_ps(a, b, _CMP_EQ_OQ);
+        const __m256 near_zero = _mm256_cmp_ps(_mm256_and_ps(_mm256_sub_ps(a, b), absolute_mask), _mm256_set1_ps(Float::fixed_epsilon), _CMP_LE_OQ);
+
+        //ulps distance, only valid for finite values with the same sign
+        const __m256i bits_a = _mm256_castps_si256(a);
+        const __m256i bits_b = _mm256_castps_si256(b);
+
+        const __m256i infinity_bits = _mm256_set1_epi32(0x7f800000);
+        const __m256i finite_a = _mm256_cmpgt_epi32(infinity_bits, _mm256_and_si256(bits_a, _mm256_set1_epi32(0x7fffffff)));
+        const __m256i finite_b = _mm256_cmpgt_epi32(infinity_bits, _mm256_and_si256(bits_b, _mm256_set1_epi32(0x7fffffff)));
+        const __m256i same_sign = _mm256_cmpgt_epi32(_mm256_xor_si256(bits_a, bits_b), _mm256_set1_epi32(-1));
+
+        const __m256i ulps_distance = _mm256_abs_epi32(_mm256_sub_epi32(bits_a, bits_b));
+        const __m256i within_ulps = _mm256_cmpgt_epi32(_mm256_set1_epi32(4), ulps_distance);
+
+        const __m256i ulps_equal = _mm256_and_si256(_mm256_and_si256(finite_a, finite_b), _mm256_and_si256(same_sign, within_ulps));
+
+        return _mm256_or_ps(_mm256_or_ps(exactly_equal, near_zero), _mm256_castsi256_ps(ulps_equal));
+    }
+
+    //Float::operator<, not nearly equal and less
+    inline __m256 nearly_less(const __m256 a, const __m256 b, const __m256 equal)
+    {
+        return _mm256_andnot_ps(equal, _mm256_cmp_ps(a, b, _CMP_LT_OQ));
+    }
+
+    //Float::operator>, not nearly equal and not less (NaN counts as greater, same as the scalar version)
+    inline __m256 nearly_greater(const __m256 a, const __m256 b, const __m256 equal)
+    {
+        return _mm256_andnot_ps(equal, _mm256_cmp_ps(a, b, _CMP_NLT_UQ));
+    }
+
+    void intersect_lanes(const Segment_Batch& segments, const Axis_Lanes& lanes, const float* lines, const float broadcast_line, Axis_Intersection_Batch& result)
+    {
+        const size_t count = segments.size();
+
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 infinity = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256 line = lines != nullptr ? _mm256_loadu_ps(lines + i) : _mm256_set1_ps(broadcast_line);
+            const __m256 start = _mm256_loadu_ps(lanes.along_start + i);
+            const __m256 end = _mm256_loadu_ps(lanes.along_end + i);
+
+            const __m256 equal_start = nearly_equal(line, start);
+            const __m256 equal_end = nearly_equal(line, end);
+
+            const __m256 before = _mm256_and_ps(nearly_less(line, start, equal_start), nearly_less(line, end, equal_end));
+            const __m256 after = _mm256_and_ps(nearly_greater(line, start, equal_start), nearly_greater(line, end, equal_end));
+
+            const int hit_mask = ~_mm256_movemask_ps(_mm256_or_ps(before, after));
+
+            const __m256 across_start = _mm256_loadu_ps(lanes.across_start + i);
+            const __m256 across_end = _mm256_loadu_ps(lanes.across_end + i);
+
+            const __m256 difference = _mm256_sub_ps(end, start);
+            const __m256 segment_to_line = _mm256_sub_ps(line, start);
+
+            const __m256 intersection = _mm256_add_ps(across_start, _mm256_mul_ps(_mm256_div_ps(segment_to_line, difference), _mm256_sub_ps(across_end, across_start)));
+            const __m256 on_line = nearly_equal(difference, zero);
+
+            const __m256 fraction = _mm256_mul_ps(segment_to_line, _mm256_loadu_ps(lanes.inverse_along + i));
+            const __m256 time = _mm256_add_ps(_mm256_loadu_ps(segments.start_t.data() + i), _mm256_mul_ps(fraction, _mm256_loadu_ps(segments.dt.data() + i)));
+
+            _mm256_storeu_ps(result.intersections.data() + i, _mm256_blendv_ps(intersection, infinity, on_line));
+            _mm256_storeu_ps(result.times.data() + i, time);
+
+            for (int lane = 0; lane < 8; lane++)
+            {
+                result.hits[i + lane] = static_cast<uint8_t>((hit_mask >> lane) & 1);
+            }
+        }
+
+        for (; i < count; i++)
+        {
+            intersect_lane(segments, lanes, i, lines != nullptr ? lines[i] : broadcast_line, result);
+        }
+    }
+
+    //Float::operator<= and Float::operator>=
+    inline __m256 nearly_less_or_equal(const __m256 a, const __m256 b, const __m256 equal)
+    {
+        return _mm256_or_ps(equal, nearly_less(a, b, equal));
+    }
+
+    //Vec2::length of (x, y)
+    inline __m256 vector_length(const __m256 x, const __m256 y)
+    {
+        return _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)));
+    }
+
+    void same_axis_lanes(const Same_Axis_Start& start_segment, const Segment_Batch& segments, const Axis_Lanes& lanes, const Float length_l, Same_Axis_Point_Batch& result)
+    {
+        const size_t count = segments.size();
+
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 one = _mm256_set1_ps(1.f);
+
+        const __m256 start_lower = _mm256_set1_ps(start_segment.lower.get_value());
+        const __m256 start_upper = _mm256_set1_ps(start_segment.upper.get_value());
+        const __m256 start_axis_difference = _mm256_set1_ps(start_segment.axis_difference.get_value());
+        const __m256 start_length = _mm256_set1_ps(start_segment.length.get_value());
+        const __m256 start_end_t = _mm256_set1_ps(start_segment.end_t.get_value());
+        const __m256 start_end_on_axis = _mm256_set1_ps(start_segment.end_on_axis.get_value());
+        const __m256 length = _mm256_set1_ps(length_l.get_value());
+
+        const __m256 start_end_x = _mm256_set1_ps(start_segment.end.x.get_value());
+        const __m256 start_end_y = _mm256_set1_ps(start_segment.end.y.get_value());
+        const __m256 start_direction_x = _mm256_set1_ps((start_segment.start.x - start_segment.end.x).get_value());
+        const __m256 start_direction_y = _mm256_set1_ps((start_segment.start.y - start_segment.end.y).get_value());
+        const __m256 start_start_x = _mm256_set1_ps(start_segment.start.x.get_value());
+        const __m256 start_start_y = _mm256_set1_ps(start_segment.start.y.get_value());
+        const __m256 start_start_t = _mm256_set1_ps(start_segment.start_t.get_value());
+        const __m256 start_inverse_length = _mm256_set1_ps(start_segment.inverse_length.get_value());
+        const __m256 start_dt = _mm256_set1_ps(start_segment.dt.get_value());
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256 end_start = _mm256_loadu_ps(lanes.along_start + i);
+            const __m256 end_end = _mm256_loadu_ps(lanes.along_end + i);
+
+            //Sort the end segment on the axis the same way the overlap functions do
+            const __m256 equal_ends = nearly_equal(end_start, end_end);
+            const __m256 end_lower = _mm256_blendv_ps(end_end, end_start, nearly_less_or_equal(end_start, end_end, equal_ends));
+            const __m256 end_upper = _mm256_blendv_ps(end_end, end_start, nearly_greater(end_start, end_end, equal_ends));
+
+            const __m256 no_overlap = _mm256_or_ps(
+                nearly_less(start_upper, end_lower, nearly_equal(start_upper, end_lower)),
+                nearly_greater(start_lower, end_upper, nearly_equal(start_lower, end_upper)));
+
+            const __m256 end_axis_difference = _mm256_sub_ps(end_end, end_start);
+            const __m256 end_length = _mm256_loadu_ps(segments.length.data() + i);
+
+            const __m256 determinant = _mm256_sub_ps(_mm256_mul_ps(start_axis_difference, end_length), _mm256_mul_ps(end_axis_difference, start_length));
+            const __m256 parallel = nearly_equal(determinant, zero);
+
+            const __m256 end_start_t = _mm256_loadu_ps(segments.start_t.data() + i);
+            const __m256 remaining_length = _mm256_sub_ps(length, _mm256_sub_ps(end_start_t, start_end_t));
+
+            const __m256 start_end_difference = _mm256_sub_ps(start_end_on_axis, end_start);
+
+            const __m256 lambda = _mm256_div_ps(_mm256_sub_ps(_mm256_mul_ps(start_end_difference, end_length), _mm256_mul_ps(end_axis_difference, remaining_length)), determinant);
+            const __m256 rho = _mm256_div_ps(_mm256_sub_ps(_mm256_mul_ps(start_axis_difference, remaining_length), _mm256_mul_ps(start_end_difference, start_length)), determinant);
+
+            const __m256 outside = _mm256_or_ps(
+                _mm256_or_ps(nearly_less(lambda, zero, nearly_equal(lambda, zero)), nearly_greater(lambda, one, nearly_equal(lambda, one))),
+                _mm256_or_ps(nearly_less(rho, zero, nearly_equal(rho, zero)), nearly_greater(rho, one, nearly_equal(rho, one))));
+
+            const int hit_mask = ~_mm256_movemask_ps(_mm256_or_ps(_mm256_or_ps(no_overlap, parallel), outside));
+
+            //p = start_segment.end + lambda * (start_segment.start - start_segment.end)
+            const __m256 p_x = _mm256_add_ps(start_end_x, _mm256_mul_ps(start_direction_x, lambda));
+            const __m256 p_y = _mm256_add_ps(start_end_y, _mm256_mul_ps(start_direction_y, lambda));
+
+            //q = end_segment.start + rho * (end_segment.end - end_segment.start)
+            const __m256 end_start_x = _mm256_loadu_ps(segments.start_x.data() + i);
+            const __m256 end_start_y = _mm256_loadu_ps(segments.start_y.data() + i);
+            const __m256 q_x = _mm256_add_ps(end_start_x, _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(segments.end_x.data() + i), end_start_x), rho));
+            const __m256 q_y = _mm256_add_ps(end_start_y, _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(segments.end_y.data() + i), end_start_y), rho));
+
+            const __m256 start_time = _mm256_add_ps(start_start_t, _mm256_mul_ps(_mm256_mul_ps(vector_length(_mm256_sub_ps(p_x, start_start_x), _mm256_sub_ps(p_y, start_start_y)), start_inverse_length), start_dt));
+            const __m256 end_time = _mm256_add_ps(end_start_t, _mm256_mul_ps(_mm256_mul_ps(vector_length(_mm256_sub_ps(q_x, end_start_x), _mm256_sub_ps(q_y, end_start_y)), _mm256_loadu_ps(segments.inverse_length.data() + i)), _mm256_loadu_ps(segments.dt.data() + i)));
+
+            _mm256_storeu_ps(result.start_x.data() + i, p_x);
+            _mm256_storeu_ps(result.start_y.data() + i, p_y);
+            _mm256_storeu_ps(result.end_x.data() + i, q_x);
+            _mm256_storeu_ps(result.end_y.data() + i, q_y);
+            _mm256_storeu_ps(result.start_times.data() + i, start_time);
+            _mm256_storeu_ps(result.end_times.data() + i, end_time);
+
+            for (int lane = 0; lane < 8; lane++)
+            {
+                result.hits[i + lane] = static_cast<uint8_t>((hit_mask >> lane) & 1);
+            }
+        }
+
+        for (; i < count; i++)
+        {
+            same_axis_lane(start_segment, segments, lanes, i, length_l, result);
+        }
+    }
+
+#else
+
+    void intersect_lanes(const Segment_Batch& segments, const Axis_Lanes& lanes, const float* lines, const float broadcast_line, Axis_Intersection_Batch& result)
+    {
+        const size_t count = segments.size();
+
+        for (size_t i = 0; i < count; i++)
+        {
+            intersect_lane(segments, lanes, i, lines != nullptr ? lines[i] : broadcast_line, result);
+        }
+    }
+
+    void same_axis_lanes(const Same_Axis_Start& start_segment, const Segment_Batch& segments, const Axis_Lanes& lanes, const Float length, Same_Axis_Point_Batch& result)
+    {
+        const size_t count = segments.size();
+
+        for (size_t i = 0; i < count; i++)
+        {
+            same_axis_lane(start_segment, segments, lanes, i, length, result);
+        }
+    }
+
+#endif
+
+    Axis_Lanes x_lanes(const Segment_Batch& segments)
+    {
+        return { segments.start_x.data(), segments.end_x.data(), segments.start_y.data(), segments.end_y.data(), segments.inverse_dx.data() };
+    }
+
+    Axis_Lanes y_lanes(const Segment_Batch& segments)
+    {
+        return { segments.start_y.data(), segments.end_y.data(), segments.start_x.data(), segments.end_x.data(), segments.inverse_dy.data() };
+    }
+}
+
+void batch_x_intersects(const Segment_Batch& segments, const float* lines, Axis_Intersection_Batch& result)
+{
+    result.resize(segments.size());
+    intersect_lanes(segments, x_lanes(segments), lines, 0.f, result);
+}
+
+void batch_y_intersects(const Segment_Batch& segments, const float* lines, Axis_Intersection_Batch& result)
+{
+    result.resize(segments.size());
+    intersect_lanes(segments, y_lanes(segments), lines, 0.f, result);
+}
+
+void batch_x_intersects(const Segment_Batch& segments, const float line, Axis_Intersection_Batch& result)
+{
+    result.resize(segments.size());
+    intersect_lanes(segments, x_lanes(segments), nullptr, line, result);
+}
+
+void batch_y_intersects(const Segment_Batch& segments, const float line, Axis_Intersection_Batch& result)
+{
+    result.resize(segments.size());
+    intersect_lanes(segments, y_lanes(segments), nullptr, line, result);
+}
+
+void batch_points_on_same_axis_with_distance_l(const Segment& start_segment, const Segment_Kinematics& start_kinematics, const Segment_Batch& end_segments, const Float length, const bool axis, Same_Axis_Point_Batch& result)
+{
+    result.resize(end_segments.size());
+    same_axis_lanes(same_axis_start(start_segment, start_kinematics, axis), end_segments, axis ? x_lanes(end_segments) : y_lanes(end_segments), length, result);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+class Segment;
+class Segment_Kinematics;
+
+//A run of segments copied into structure-of-arrays form, the input of the batch kernels below
+//Each lane holds a segment and the derived values the kernels need, the same segment may be stored in multiple lanes
+class Segment_Batch
+{
+public:
+
+    void clear();
+    void reserve(const size_t count);
+    size_t size() const { return start_x.size(); }
+
+    void push_back(const Segment& segment, const Segment_Kinematics& kinematics);
+
+    Hooked_Vector<float> start_x;
+    Hooked_Vector<float> start_y;
+    Hooked_Vector<float> end_x;
+    Hooked_Vector<float> end_y;
+
+    Hooked_Vector<float> start_t;
+    Hooked_Vector<float> dt;
+
+    Hooked_Vector<float> inverse_dx;
+    Hooked_Vector<float> inverse_dy;
+
+    Hooked_Vector<float> length;
+    Hooked_Vector<float> inverse_length;
+};
+
+//Results of intersecting axis-aligned lines with a segment batch, one entry per lane
+class Axis_Intersection_Batch
+{
+public:
+
+    void resize(const size_t count);
+    size_t size() const { return hits.size(); }
+
+    //1 if the line intersects the segment in this lane, 0 otherwise, the other values are undefined on a miss
+    Hooked_Vector<uint8_t> hits;
+
+    //The y-coordinate of the intersection for vertical lines, the x-coordinate for horizontal lines
+    //Infinity if the segment lies on the line, same as Segment::x_intersect and Segment::y_intersect
+    Hooked_Vector<float> intersections;
+
+    //The time on the segment at the intersection
+    Hooked_Vector<float> times;
+};
+
+//Results of solving breakpoint V for one start segment against a batch of end segments, one entry per lane
+class Same_Axis_Point_Batch
+{
+public:
+
+    void resize(const size_t count);
+    size_t size() const { return hits.size(); }
+
+    //1 if valid points p and q were found for the end segment in this lane, 0 otherwise, the other values are undefined on a miss
+    Hooked_Vector<uint8_t> hits;
+
+    //Point p on the start segment and the time at p
+    Hooked_Vector<float> start_x;
+    Hooked_Vector<float> start_y;
+    Hooked_Vector<float> start_times;
+
+    //Point q on the end segment and the time at q
+    Hooked_Vector<float> end_x;
+    Hooked_Vector<float> end_y;
+    Hooked_Vector<float> end_times;
+};
+
+//Intersect the vertical line at lines[i] with the segment in lane i, for all lanes
+//Gives the same results as Segment::x_intersects and the kinematics variant of Segment::get_time_at_x
+//Uses AVX2 when the library is compiled with it enabled, otherwise a scalar loop
+void batch_x_intersects(const Segment_Batch& segments, const float* lines, Axis_Intersection_Batch& result);
+
+//Intersect the horizontal line at lines[i] with the segment in lane i, for all lanes
+//Gives the same results as Segment::y_intersects and the kinematics variant of Segment::get_time_at_y
+void batch_y_intersects(const Segment_Batch& segments, const float* lines, Axis_Intersection_Batch& result);
+
+//Intersect a single vertical line with all segments in the batch
+void batch_x_intersects(const Segment_Batch& segments, const float line, Axis_Intersection_Batch& result);
+
+//Intersect a single horizontal line with all segments in the batch
+void batch_y_intersects(const Segment_Batch& segments, const float line, Axis_Intersection_Batch& result);
+
+//Solve Segment::get_points_on_same_axis_with_distance_l for the start segment against the end segment in every lane
+//Gives the same points as the scalar version, and the times at the points as the kinematics variant of Segment::get_time_at_point
+//When axis is set to true, uses the x-axis, else the y-axis
+void batch_points_on_same_axis_with_distance_l(const Segment& start_segment, const Segment_Kinematics& start_kinematics, const Segment_Batch& end_segments, const Float length, const bool axis, Same_Axis_Point_Batch& result);
@@ -6,7 +6,9 @@
 //}
 
 //Build the tree bottom-up from a list of ordered segments
-Segment_Search_Tree_Node::Segment_Search_Tree_Node(const std::vector<Segment>& ordered_segments, const size_t start_index, const size_t end_index) : segment_list(ordered_segments)
+Segment_Search_Tree_Node::Segment_Search_Tree_Node(const std::vector<Segment>& ordered_segments, const size_t start_index, const size_t end_index, const std::vector<Segment_Kinematics>* segment_kinematics) :
+    segment_list(ordered_segments),
+    kinematics_list(segment_kinematics)
 {
     if (end_index == start_index)
     {
@@ -15,7 +17,7 @@ Segment_Search_Tree_Node::Segment_Search_Tree_Node(const std::vector<Segment>& o
 
         const Segment& segment = segment_list.at(segment_index);
 
-        bounding_box = segment.get_AABB();
+        bounding_box = SIMD_AABB(segment);
 
         left = nullptr;
         right = nullptr;
@@ -28,10 +30,10 @@ Segment_Search_Tree_Node::Segment_Search_Tree_Node(const std::vector<Segment>& o
         //Internal node, split
         const size_t middle_index = (start_index + end_index) / 2;
 
-        left = std::make_unique<Segment_Search_Tree_Node>(ordered_segments, start_index, middle_index);
-        right = std::make_unique<Segment_Search_Tree_Node>(ordered_segments, middle_index + 1, end_index);
+        left = std::make_unique<Segment_Search_Tree_Node>(ordered_segments, start_index, middle_index, segment_kinematics);
+        right = std::make_unique<Segment_Search_Tree_Node>(ordered_segments, middle_index + 1, end_index, segment_kinematics);
 
-        bounding_box = AABB::combine(left->bounding_box, right->bounding_box);
+        bounding_box = SIMD_AABB::combine(left->bounding_box, right->bounding_box);
 
         segment_index = -1;
 
@@ -41,10 +43,12 @@ Segment_Search_Tree_Node::Segment_Search_Tree_Node(const std::vector<Segment>& o
 }
 
 //Query tree, returns bounding box from start_t to end_t
-AABB Segment_Search_Tree_Node::query(const Float start_t, const Float end_t) const
+SIMD_AABB Segment_Search_Tree_Node::query(const Float start_t, const Float end_t) const
 {
-    //TODO: Pass bounding box as ref to avoid construction?
-    AABB bounding_box(std::numeric_limits<float>::max() / 2.f, std::numeric_limits<float>::max() / 2.f, std::numeric_limits<float>::lowest() / 2.f, std::numeric_limits<float>::lowest() / 2.f);
+    TRAJECTORY_HOTSPOTS_COUNT(statistics->tree_nodes_visited++);
+
+    //Starts empty
+    SIMD_AABB bounding_box;
 
     if (left != nullptr)
     {
@@ -75,29 +79,23 @@ AABB Segment_Search_Tree_Node::query(const Float start_t, const Float end_t) con
     //leaf node, calculate segment portion (both points are in the segment)
     if (segment_index != -1)
     {
-        const Segment& segment = segment_list.at(segment_index);
-
-        const Vec2 start_point = segment.get_point_at_time(start_t);
-        const Vec2 end_point = segment.get_point_at_time(end_t);
-
-        const Vec2 min(std::min(start_point.x, end_point.x), std::min(start_point.y, end_point.y));
-        const Vec2 max(std::max(start_point.x, end_point.x), std::max(start_point.y, end_point.y));
-
-        return AABB(min, max);
+        return SIMD_AABB(get_point_at_time(start_t), get_point_at_time(end_t));
     }
 
     return bounding_box;
 }
 
 //Query tree, returns bounding box from start_t to the last point contained in the (sub)tree
-AABB Segment_Search_Tree_Node::query_left(const Float start_t) const
+SIMD_AABB Segment_Search_Tree_Node::query_left(const Float start_t) const
 {
+    TRAJECTORY_HOTSPOTS_COUNT(statistics->tree_nodes_visited++);
+
     if (right != nullptr)
     {
         //Right fully contained in query range?
         if (start_t <= right->node_start_t)
         {
-            AABB bounding_box = right->bounding_box;
+            SIMD_AABB bounding_box = right->bounding_box;
 
             if (left != nullptr)
             {
@@ -119,27 +117,24 @@ AABB Segment_Search_Tree_Node::query_left(const Float start_t) const
         const Segment& segment = segment_list.at(segment_index);
 
         //Calculate boundingbox from point at start_t to the endpoint of the segment
-        const Vec2 point_on_segment = segment.get_point_at_time(start_t);
-
-        const Vec2 min(std::min(point_on_segment.x, segment.end.x), std::min(point_on_segment.y, segment.end.y));
-        const Vec2 max(std::max(point_on_segment.x, segment.end.x), std::max(point_on_segment.y, segment.end.y));
-
-        return AABB(min, max);
+        return SIMD_AABB(get_point_at_time(start_t), segment.end);
     }
 
-    return AABB(std::numeric_limits<float>::max() / 2.f, std::numeric_limits<float>::max() / 2.f, std::numeric_limits<float>::lowest() / 2.f, std::numeric_limits<float>::lowest() / 2.f);
+    return SIMD_AABB();
 
 }
 
 //Query tree, returns bounding box from the first point in the (sub)tree to end_t
-AABB Segment_Search_Tree_Node::query_right(const Float end_t) const
+SIMD_AABB Segment_Search_Tree_Node::query_right(const Float end_t) const
 {
+    TRAJECTORY_HOTSPOTS_COUNT(statistics->tree_nodes_visited++);
+
     if (left != nullptr)
     {
         //Left side fully contained in query range?
         if (left->node_end_t <= end_t)
         {
-            AABB bounding_box = left->bounding_box;
+            SIMD_AABB bounding_box = left->bounding_box;
 
             if (right != nullptr)
             {
@@ -150,8 +145,8 @@ AABB Segment_Search_Tree_Node::query_right(const Float end_t) const
         }
         else
         {
-            //Query range start in left side, ignore right side
-            return right->query_right(end_t);
+            //Query range ends in left side, ignore right side
+            return left->query_right(end_t);
         }
     }
 
@@ -161,19 +156,16 @@ AABB Segment_Search_Tree_Node::query_right(const Float end_t) const
         const Segment& segment = segment_list.at(segment_index);
 
         //Calculate boundingbox from the startpoint of the segment to the point at end_t
-        const Vec2 point_on_segment = segment.get_point_at_time(end_t);
-
-        const Vec2 min(std::min(point_on_segment.x, segment.start.x), std::min(point_on_segment.y, segment.start.y));
-        const Vec2 max(std::max(point_on_segment.x, segment.start.x), std::max(point_on_segment.y, segment.start.y));
-
-        return AABB(min, max);
+        return SIMD_AABB(segment.start, get_point_at_time(end_t));
     }
 
-    return AABB(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest());
+    return SIMD_AABB();
 }
 
 int Segment_Search_Tree_Node::query(const Float t) const
 {
+    TRAJECTORY_HOTSPOTS_COUNT(statistics->tree_nodes_visited++);
+
     if (left != nullptr)
     {
         if (t <= left->node_end_t)
@@ -200,6 +192,19 @@ int Segment_Search_Tree_Node::query(const Float t) const
     return 0;
 }
 
-Segment_Search_Tree::Segment_Search_Tree(const std::vector<Segment>& ordered_segments) : root(ordered_segments, 0, ordered_segments.size() - 1)
+//Returns the point at time t on the segment of this leaf node
+Vec2 Segment_Search_Tree_Node::get_point_at_time(const Float t) const
+{
+    const Segment& segment = segment_list.at(segment_index);
+
+    if (kinematics_list != nullptr)
+    {
+        return segment.get_point_at_time(t, (*kinematics_list)[segment_index]);
+    }
+
+    return segment.get_point_at_time(t);
+}
+
+Segment_Search_Tree::Segment_Search_Tree(const std::vector<Segment>& ordered_segments, const std::vector<Segment_Kinematics>* segment_kinematics) : root(ordered_segments, 0, ordered_segments.size() - 1, segment_kinematics)
 {
 }
\ No newline at end of file
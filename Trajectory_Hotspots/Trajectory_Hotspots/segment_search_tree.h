@@ -7,20 +7,25 @@ public:
     //Segment_Search_Tree_Node();
 
     //Build the tree bottom-up from a list of ordered segments
-    Segment_Search_Tree_Node(const std::vector<Segment>& ordered_segments, const size_t start_index, const size_t end_index);
+    //When the kinematics of the segments are given, leaf queries use the fast segment functions
+    Segment_Search_Tree_Node(const std::vector<Segment>& ordered_segments, const size_t start_index, const size_t end_index, const std::vector<Segment_Kinematics>* segment_kinematics = nullptr);
 
     //Query tree, returns bounding box from start_t to end_t
-    AABB query(const Float start_t, const Float end_t) const;
+    SIMD_AABB query(const Float start_t, const Float end_t) const;
 
     //Query tree, returns bounding box from start_t to the last point contained in the (sub)tree
-    AABB query_left(const Float start_t) const;
+    SIMD_AABB query_left(const Float start_t) const;
 
     //Query tree, returns bounding box from the first point in the (sub)tree to end_t
-    AABB query_right(const Float end_t) const;
+    SIMD_AABB query_right(const Float end_t) const;
 
     //Query tree, returns segment index that contains t (or first/last when before/after range)
     int query(const Float t) const;
 
+    //Nodes are allocated through the allocation hook
+    static void* operator new(const size_t bytes) { return hooked_allocate(bytes); }
+    static void operator delete(void* memory, const size_t bytes) { hooked_deallocate(memory, bytes); }
+
     std::unique_ptr<Segment_Search_Tree_Node> left;
     std::unique_ptr<Segment_Search_Tree_Node> right;
 
@@ -29,8 +34,14 @@ public:
 
     int segment_index;
     const std::vector<Segment>& segment_list;
+    const std::vector<Segment_Kinematics>* kinematics_list;
+
+    SIMD_AABB bounding_box;
+
+private:
 
-    AABB bounding_box;
+    //Returns the point at time t on the segment of this leaf node
+    Vec2 get_point_at_time(const Float t) const;
 };
 
 class Segment_Search_Tree
@@ -38,19 +49,22 @@ class Segment_Search_Tree
 public:
 
     //Build the tree bottom-up from a list of ordered segments
-    Segment_Search_Tree(const std::vector<Segment>& ordered_segments);
+    //The optional kinematics must have the same ordering and outlive the tree
+    Segment_Search_Tree(const std::vector<Segment>& ordered_segments, const std::vector<Segment_Kinematics>* segment_kinematics = nullptr);
 
     //Query tree, returns bounding box from start_t to end_t
     [[nodiscard]]
     AABB query(const Float start_t, const Float end_t) const
     {
-        return root.query(start_t, end_t);
+        TRAJECTORY_HOTSPOTS_COUNT(statistics->tree_queries++);
+        return root.query(start_t, end_t).to_AABB();
     }
 
     //Query tree, returns segment index that contains t (or first/last when before/after range)
     [[nodiscard]]
     int query(const Float t) const
     {
+        TRAJECTORY_HOTSPOTS_COUNT(statistics->tree_queries++);
         return root.query(t);
     }
 
@@ -0,0 +1,154 @@
+#include "pch.h"
+#include "simd_aabb.h"
+
+namespace
+{
+    //Empty boxes use half the float range, same as the empty AABBs in the segment search tree
+    constexpr float empty_value = std::numeric_limits<float>::max() / 2.f;
+}
+
+#ifdef TRAJECTORY_HOTSPOTS_SSE
+
+namespace
+{
+    //Returns the lane (x, y, -x, -y) of a single point
+    inline __m128 point_lane(const Vec2& point)
+    {
+        const float x = point.x.get_value();
+        const float y = point.y.get_value();
+        return _mm_setr_ps(x, y, -x, -y);
+    }
+}
+
+SIMD_AABB::SIMD_AABB() : values(_mm_set1_ps(empty_value))
+{
+}
+
+SIMD_AABB::SIMD_AABB(const AABB& aabb) : values(_mm_setr_ps(aabb.min.x.get_value(), aabb.min.y.get_value(), -aabb.max.x.get_value(), -aabb.max.y.get_value()))
+{
+}
+
+SIMD_AABB::SIMD_AABB(const Vec2& a, const Vec2& b) : values(_mm_min_ps(point_lane(a), point_lane(b)))
+{
+}
+
+SIMD_AABB::SIMD_AABB(const Segment& segment) : SIMD_AABB(segment.start, segment.end)
+{
+}
+
+void SIMD_AABB::combine(const SIMD_AABB& other)
+{
+    values = _mm_min_ps(values, other.values);
+}
+
+SIMD_AABB SIMD_AABB::combine(const SIMD_AABB& a, const SIMD_AABB& b)
+{
+    return SIMD_AABB(_mm_min_ps(a.values, b.values));
+}
+
+void SIMD_AABB::augment(const Vec2& point)
+{
+    values = _mm_min_ps(values, point_lane(point));
+}
+
+AABB SIMD_AABB::to_AABB() const
+{
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, values);
+
+    return AABB(lanes[0], lanes[1], -lanes[2], -lanes[3]);
+}
+
+SIMD_AABB SIMD_AABB::from_segments(const Segment* segments, const size_t segment_count)
+{
+    //Four independent accumulators so consecutive minimums don't wait on each other
+    __m128 accumulator_0 = _mm_set1_ps(empty_value);
+    __m128 accumulator_1 = accumulator_0;
+    __m128 accumulator_2 = accumulator_0;
+    __m128 accumulator_3 = accumulator_0;
+
+    size_t i = 0;
+    for (; i + 1 < segment_count; i += 2)
+    {
+        accumulator_0 = _mm_min_ps(accumulator_0, point_lane(segments[i].start));
+        accumulator_1 = _mm_min_ps(accumulator_1, point_lane(segments[i].end));
+        accumulator_2 = _mm_min_ps(accumulator_2, point_lane(segments[i + 1].start));
+        accumulator_3 = _mm_min_ps(accumulator_3, point_lane(segments[i + 1].end));
+    }
+
+    if (i < segment_count)
+    {
+        accumulator_0 = _mm_min_ps(accumulator_0, point_lane(segments[i].start));
+        accumulator_1 = _mm_min_ps(accumulator_1, point_lane(segments[i].end));
+    }
+
+    return SIMD_AABB(_mm_min_ps(_mm_min_ps(accumulator_0, accumulator_1), _mm_min_ps(accumulator_2, accumulator_3)));
+}
+
+#else
+
+//Scalar fallback for targets without SSE, same layout and semantics
+
+SIMD_AABB::SIMD_AABB() : values{ empty_value, empty_value, empty_value, empty_value }
+{
+}
+
+SIMD_AABB::SIMD_AABB(const AABB& aabb) : values{ aabb.min.x.get_value(), aabb.min.y.get_value(), -aabb.max.x.get_value(), -aabb.max.y.get_value() }
+{
+}
+
+SIMD_AABB::SIMD_AABB(const Vec2& a, const Vec2& b) : SIMD_AABB()
+{
+    augment(a);
+    augment(b);
+}
+
+SIMD_AABB::SIMD_AABB(const Segment& segment) : SIMD_AABB(segment.start, segment.end)
+{
+}
+
+void SIMD_AABB::combine(const SIMD_AABB& other)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        values[i] = std::min(values[i], other.values[i]);
+    }
+}
+
+SIMD_AABB SIMD_AABB::combine(const SIMD_AABB& a, const SIMD_AABB& b)
+{
+    SIMD_AABB combined = a;
+    combined.combine(b);
+    return combined;
+}
+
+void SIMD_AABB::augment(const Vec2& point)
+{
+    const float x = point.x.get_value();
+    const float y = point.y.get_value();
+
+    values[0] = std::min(values[0], x);
+    values[1] = std::min(values[1], y);
+    values[2] = std::min(values[2], -x);
+    values[3] = std::min(values[3], -y);
+}
+
+AABB SIMD_AABB::to_AABB() const
+{
+    return AABB(values[0], values[1], -values[2], -values[3]);
+}
+
+SIMD_AABB SIMD_AABB::from_segments(const Segment* segments, const size_t segment_count)
+{
+    SIMD_AABB bounding_box;
+
+    for (size_t i = 0; i < segment_count; i++)
+    {
+        bounding_box.augment(segments[i].start);
+        bounding_box.augment(segments[i].end);
+    }
+
+    return bounding_box;
+}
+
+#endif
@@ -0,0 +1,54 @@
+#pragma once
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define TRAJECTORY_HOTSPOTS_SSE
+#include <xmmintrin.h>
+#endif
+
+class Vec2;
+class AABB;
+class Segment;
+
+//Axis-aligned bounding box stored as (min.x, min.y, -max.x, -max.y) in a single 128-bit lane
+//Because the maximum is stored negated, combining two boxes is a single component-wise minimum
+//Used in the hot paths (Segment_Search_Tree), convert to an AABB for everything else
+class SIMD_AABB
+{
+public:
+
+    //Constructs an empty box, combining with an empty box leaves the other box unchanged
+    SIMD_AABB();
+
+    explicit SIMD_AABB(const AABB& aabb);
+
+    //Constructs the bounding box of two points
+    SIMD_AABB(const Vec2& a, const Vec2& b);
+
+    explicit SIMD_AABB(const Segment& segment);
+
+    //Combine this box with another by keeping the extremes in all four directions
+    void combine(const SIMD_AABB& other);
+
+    //Combine two boxes with each other by keeping the extremes in all four directions
+    static SIMD_AABB combine(const SIMD_AABB& a, const SIMD_AABB& b);
+
+    //Potentially increase the size of the box based on the given point
+    void augment(const Vec2& point);
+
+    AABB to_AABB() const;
+
+    //Returns the bounding box of all the given segments
+    static SIMD_AABB from_segments(const Segment* segments, const size_t segment_count);
+
+private:
+
+#ifdef TRAJECTORY_HOTSPOTS_SSE
+    explicit SIMD_AABB(const __m128 values) : values(values)
+    {
+    }
+
+    __m128 values;
+#else
+    float values[4];
+#endif
+};
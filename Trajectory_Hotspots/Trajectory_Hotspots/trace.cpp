@@ -0,0 +1,178 @@
+#include "pch.h"
+#include "trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+
+namespace
+{
+    struct Trace_Buffer
+    {
+        size_t thread_index = 0;
+        std::vector<Trace_Event> events;
+    };
+
+    std::atomic<bool> tracing_enabled(false);
+
+    //All buffers ever registered, owned here so they outlive their threads
+    std::mutex& get_buffers_mutex()
+    {
+        static std::mutex buffers_mutex;
+        return buffers_mutex;
+    }
+
+    std::vector<std::unique_ptr<Trace_Buffer>>& get_buffers()
+    {
+        static std::vector<std::unique_ptr<Trace_Buffer>> buffers;
+        return buffers;
+    }
+
+    thread_local Trace_Buffer* thread_buffer = nullptr;
+
+    Trace_Buffer& get_thread_buffer()
+    {
+        if (thread_buffer == nullptr)
+        {
+            const std::lock_guard<std::mutex> lock(get_buffers_mutex());
+
+            std::vector<std::unique_ptr<Trace_Buffer>>& buffers = get_buffers();
+            buffers.push_back(std::make_unique<Trace_Buffer>());
+            buffers.back()->thread_index = buffers.size() - 1;
+            buffers.back()->events.reserve(1024);
+
+            thread_buffer = buffers.back().get();
+        }
+
+        return *thread_buffer;
+    }
+
+    //Names are literals in the library, escape them anyway in case a caller passes its own
+    void write_json_string(std::ostream& output, const char* text)
+    {
+        output << '"';
+
+        for (const char* c = text; *c != '\0'; c++)
+        {
+            if (*c == '"' || *c == '\\') output << '\\' << *c;
+            else if (static_cast<unsigned char>(*c) < 0x20) output << ' ';
+            else output << *c;
+        }
+
+        output << '"';
+    }
+}
+
+void set_tracing_enabled(const bool enabled)
+{
+    tracing_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool is_tracing_enabled()
+{
+    return tracing_enabled.load(std::memory_order_relaxed);
+}
+
+int64_t get_trace_time()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void record_trace_event(const char* name, const int64_t start_ns, const int64_t end_ns)
+{
+    get_thread_buffer().events.push_back({ name, start_ns, end_ns });
+}
+
+void clear_trace()
+{
+    const std::lock_guard<std::mutex> lock(get_buffers_mutex());
+
+    for (const std::unique_ptr<Trace_Buffer>& buffer : get_buffers())
+    {
+        buffer->events.clear();
+    }
+}
+
+size_t get_trace_event_count()
+{
+    const std::lock_guard<std::mutex> lock(get_buffers_mutex());
+
+    size_t count = 0;
+    for (const std::unique_ptr<Trace_Buffer>& buffer : get_buffers())
+    {
+        count += buffer->events.size();
+    }
+
+    return count;
+}
+
+void write_chrome_trace(std::ostream& output)
+{
+    const std::lock_guard<std::mutex> lock(get_buffers_mutex());
+    const std::vector<std::unique_ptr<Trace_Buffer>>& buffers = get_buffers();
+
+    int64_t first_ns = std::numeric_limits<int64_t>::max();
+    for (const std::unique_ptr<Trace_Buffer>& buffer : buffers)
+    {
+        for (const Trace_Event& event : buffer->events)
+        {
+            first_ns = std::min(first_ns, event.start_ns);
+        }
+    }
+
+    //Chrome trace times are in microseconds, keep the nanoseconds as decimals
+    const auto write_microseconds = [&output](const int64_t ns)
+    {
+        output << ns / 1000 << '.' << static_cast<char>('0' + (ns / 100) % 10) << static_cast<char>('0' + (ns / 10) % 10) << static_cast<char>('0' + ns % 10);
+    };
+
+    output << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+
+    bool first_event = true;
+    for (const std::unique_ptr<Trace_Buffer>& buffer : buffers)
+    {
+        if (buffer->events.empty())
+        {
+            continue;
+        }
+
+        output << (first_event ? "" : ",\n")
+            << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->thread_index
+            << ",\"args\":{\"name\":\"thread " << buffer->thread_index << "\"}}";
+        first_event = false;
+
+        for (const Trace_Event& event : buffer->events)
+        {
+            output << ",\n{\"name\":";
+            write_json_string(output, event.name);
+            output << ",\"cat\":\"trajectory_hotspots\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread_index << ",\"ts\":";
+            write_microseconds(event.start_ns - first_ns);
+            output << ",\"dur\":";
+            write_microseconds(std::max<int64_t>(event.end_ns - event.start_ns, 0));
+            output << '}';
+        }
+    }
+
+    output << "\n]}\n";
+}
+
+bool write_chrome_trace(const std::string& path, std::string& error)
+{
+    std::ofstream output(path, std::ios::trunc);
+    if (!output)
+    {
+        error = "can't write trace";
+        return false;
+    }
+
+    write_chrome_trace(output);
+
+    if (!output)
+    {
+        error = "can't write trace";
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+//Phase level tracing of the hotspot queries, written as Chrome trace JSON to open in chrome://tracing or ui.perfetto.dev
+//Tracing is off until set_tracing_enabled(true), a disabled span only checks the flag.
+//Every thread records its spans in its own buffer without locking, only the first span of a thread locks to register its buffer.
+//The buffers outlive their threads, so spans of finished worker threads are still written.
+//write_chrome_trace and clear_trace read and reset the buffers of all threads, only call them while no queries are running.
+
+struct Trace_Event
+{
+    //The name has to outlive the trace, spans are named with string literals
+    const char* name;
+    int64_t start_ns;
+    int64_t end_ns;
+};
+
+void set_tracing_enabled(const bool enabled);
+bool is_tracing_enabled();
+
+//Nanoseconds on a steady clock
+int64_t get_trace_time();
+
+//Appends the event to the buffer of the calling thread
+void record_trace_event(const char* name, const int64_t start_ns, const int64_t end_ns);
+
+//Removes the events of all threads
+void clear_trace();
+
+size_t get_trace_event_count();
+
+//Writes the events of all threads as Chrome trace events, one track per thread with times relative to the first event
+void write_chrome_trace(std::ostream& output);
+bool write_chrome_trace(const std::string& path, std::string& error);
+
+//Records the time from construction to end() or destruction as an event on the calling thread
+class Trace_Span
+{
+public:
+
+    explicit Trace_Span(const char* name) : name(name), start_ns(is_tracing_enabled() ? get_trace_time() : -1)
+    {
+    }
+
+    ~Trace_Span()
+    {
+        end();
+    }
+
+    Trace_Span(const Trace_Span&) = delete;
+    Trace_Span& operator=(const Trace_Span&) = delete;
+
+    //Ends the span early, for phases that construct an object that has to outlive the span
+    void end()
+    {
+        if (start_ns >= 0)
+        {
+            record_trace_event(name, start_ns, get_trace_time());
+            start_ns = -1;
+        }
+    }
+
+private:
+
+    const char* name;
+    int64_t start_ns;
+};
@@ -1,5 +1,28 @@
 #include "pch.h"
 #include "trajectory.h"
+#include "trajectory_index_snapshot.h"
+
+namespace
+{
+    //The built map returns the traced segments by pointer, the flat map by value
+    void trace_left_right(const Trapezoidal_Map& trapezoidal_map, const Vec2& point, const bool prefer_top, Segment& left_segment, Segment& right_segment)
+    {
+        const Segment* left = nullptr;
+        const Segment* right = nullptr;
+        trapezoidal_map.trace_left_right(point, prefer_top, left, right);
+
+        //Neither segment should ever be nullptr
+        assert(left != nullptr && right != nullptr);
+
+        left_segment = *left;
+        right_segment = *right;
+    }
+
+    void trace_left_right(const Flat_Trapezoidal_Map& trapezoidal_map, const Vec2& point, const bool prefer_top, Segment& left_segment, Segment& right_segment)
+    {
+        trapezoidal_map.trace_left_right(point, prefer_top, left_segment, right_segment);
+    }
+}
 
 Trajectory::Trajectory(const std::vector<Segment>& ordered_segments) : trajectory_segments(ordered_segments)
 {
@@ -10,6 +33,8 @@ Trajectory::Trajectory(const std::vector<Segment>& ordered_segments) : trajector
     {
         trajectory_length += i.length();
     }
+
+    trajectory_kinematics = build_segment_kinematics(trajectory_segments);
 }
 
 Trajectory::Trajectory(const std::vector<Vec2>& ordered_trajectory_points)
@@ -28,6 +53,46 @@ Trajectory::Trajectory(const std::vector<Vec2>& ordered_trajectory_points)
     trajectory_end = trajectory_segments.back().end_t;
 
     trajectory_length = start_t;
+
+    trajectory_kinematics = build_segment_kinematics(trajectory_segments);
+}
+
+Trajectory::Trajectory(const float* x, const float* y, const float* t, const size_t vertex_count)
+{
+    assign(x, y, t, vertex_count);
+}
+
+void Trajectory::assign(const float* x, const float* y, const float* t, const size_t vertex_count)
+{
+    trajectory_segments.clear();
+    trajectory_segments.reserve(vertex_count - 1);
+
+    trajectory_length = 0.f;
+
+    Float start_t = t != nullptr ? t[0] : 0.f;
+    for (size_t i = 0; i + 1 < vertex_count; i++)
+    {
+        if (t != nullptr)
+        {
+            trajectory_segments.emplace_back(Vec2(x[i], y[i]), Vec2(x[i + 1], y[i + 1]), t[i], t[i + 1]);
+            trajectory_length += trajectory_segments.back().length();
+        }
+        else
+        {
+            trajectory_segments.emplace_back(Vec2(x[i], y[i]), Vec2(x[i + 1], y[i + 1]), start_t);
+            start_t += trajectory_segments.back().length();
+        }
+    }
+
+    trajectory_start = trajectory_segments.front().start_t;
+    trajectory_end = trajectory_segments.back().end_t;
+
+    if (t == nullptr)
+    {
+        trajectory_length = start_t;
+    }
+
+    build_segment_kinematics(trajectory_segments, trajectory_kinematics);
 }
 
 const std::vector<Segment>& Trajectory::get_ordered_trajectory_segments() const
@@ -36,73 +101,176 @@ const std::vector<Segment>& Trajectory::get_ordered_trajectory_segments() const
 }
 
 //Returns a hotspot with a fixed radius at a position that maximizes the trajectory inside it
-AABB Trajectory::get_hotspot_fixed_radius(Float radius) const
+AABB Trajectory::get_hotspot_fixed_radius(Float radius, [[maybe_unused]] Scratch_Arena* arena) const
 {
     return AABB();
 }
 
-AABB Trajectory::get_hotspot_fixed_length(Float length) const
+AABB Trajectory::get_hotspot_fixed_length(Float length, [[maybe_unused]] Scratch_Arena* arena) const
 {
     return AABB();
 }
 
-AABB Trajectory::get_hotspot_fixed_radius_contiguous(Float radius) const
+AABB Trajectory::get_hotspot_fixed_radius_contiguous(Float radius, Scratch_Arena* arena) const
 {
+    const Scratch_Arena_Query_Scope arena_scope(arena);
+    const Trace_Span query_span("fixed_radius_contiguous");
+
     Float longest_valid_subtrajectory(0.f);
     AABB optimal_hotspot;
 
-    //Setup trapezoidal maps representing the graphs with the x or y coördinates on the y-axis and time on the x-axis
-    std::vector<Segment> x_segments;
-    std::vector<Segment> y_segments;
-
-    for (auto& trajectory_segment : trajectory_segments)
+    if (frc_whole_trajectory_fits(radius, optimal_hotspot))
     {
-        x_segments.emplace_back(Vec2(trajectory_segment.start_t, trajectory_segment.start.x), Vec2(trajectory_segment.end_t, trajectory_segment.end.x), trajectory_segment.start_t, trajectory_segment.end_t);
-        y_segments.emplace_back(Vec2(trajectory_segment.start_t, trajectory_segment.start.y), Vec2(trajectory_segment.end_t, trajectory_segment.end.y), trajectory_segment.start_t, trajectory_segment.end_t);
+        return optimal_hotspot;
     }
 
-    Trapezoidal_Map trapezoidal_map_x(x_segments);
-    Trapezoidal_Map trapezoidal_map_y(y_segments);
+    //Setup segment search tree, with the kinematics so the query interpolates like the other trees
+    Trace_Span tree_span("frc_tree_build");
+    TRAJECTORY_HOTSPOTS_COUNT(statistics->begin_phase(Query_Phase::tree_build));
+    Segment_Search_Tree segment_tree(trajectory_segments, &trajectory_kinematics);
+    tree_span.end();
+
+    frc_build_maps_and_query(segment_tree, radius, longest_valid_subtrajectory, optimal_hotspot);
+
+    //TODO: Don't forget last point? Or can we skip?
+    //TODO: Remove bool?
+
+    return optimal_hotspot;
+}
+
+AABB Trajectory::get_hotspot_fixed_radius_contiguous(Float radius, Query_Statistics& statistics, Scratch_Arena* arena) const
+{
+    const Query_Statistics_Scope statistics_scope(statistics);
+    return get_hotspot_fixed_radius_contiguous(radius, arena);
+}
+
+AABB Trajectory::get_hotspot_fixed_radius_contiguous(Float radius, const Dynamic_Segment_Search_Tree& segment_tree, Scratch_Arena* arena) const
+{
+    const Scratch_Arena_Query_Scope arena_scope(arena);
+    const Trace_Span query_span("fixed_radius_contiguous");
 
-    //Setup segment search tree
-    Segment_Search_Tree segment_tree(trajectory_segments);
+    assert(segment_tree.size() == trajectory_segments.size());
 
-    //Loop through all vertices and query trapezoidal maps and the segment search tree
-    for (size_t i = 0; i < trajectory_segments.size(); i++)
+    Float longest_valid_subtrajectory(0.f);
+    AABB optimal_hotspot;
+
+    if (frc_whole_trajectory_fits(radius, optimal_hotspot))
     {
-        Vec2 current_x_vert = x_segments[i].start;
-        Vec2 current_y_vert = y_segments[i].start;
+        return optimal_hotspot;
+    }
 
-        //We slightly diverge from the paper here by tracing left and right from both the vector and vector + or - radius and taking the shortest of both.
-        //instead of going up from the found point on the left and tracing back. 
-        //This gives the same answer and we remove a number of checks.
+    frc_build_maps_and_query(segment_tree, radius, longest_valid_subtrajectory, optimal_hotspot);
 
-        //Test vertical lines
-        //Test left, current vert is at top
-        Vec2 vert_at_radius(current_x_vert.x, current_x_vert.y - radius); //TODO: Remove, can calc in function..
-        frc_test_between_lines(trapezoidal_map_x, current_x_vert, vert_at_radius, true, segment_tree, radius, longest_valid_subtrajectory, optimal_hotspot);
+    return optimal_hotspot;
+}
+
+AABB Trajectory::get_hotspot_fixed_radius_contiguous(Float radius, const Trajectory_Index_Snapshot& snapshot, Scratch_Arena* arena) const
+{
+    const Scratch_Arena_Query_Scope arena_scope(arena);
+    const Trace_Span query_span("fixed_radius_contiguous");
 
-        //Test right, current vert is at bottom
-        vert_at_radius = Vec2(current_x_vert.x, current_x_vert.y + radius);
-        frc_test_between_lines(trapezoidal_map_x, current_x_vert, vert_at_radius, false, segment_tree, radius, longest_valid_subtrajectory, optimal_hotspot);
+    assert(snapshot.matches(*this));
 
-        //Test horizontal lines
-        //Test below, current vert is at top
-        vert_at_radius = Vec2(current_y_vert.x, current_y_vert.y - radius);
-        frc_test_between_lines(trapezoidal_map_y, current_y_vert, vert_at_radius, true, segment_tree, radius, longest_valid_subtrajectory, optimal_hotspot);
+    Float longest_valid_subtrajectory(0.f);
+    AABB optimal_hotspot;
 
-        //Test above, current vert is at bottom
-        vert_at_radius = Vec2(current_y_vert.x, current_y_vert.y + radius);
-        frc_test_between_lines(trapezoidal_map_y, current_y_vert, vert_at_radius, false, segment_tree, radius, longest_valid_subtrajectory, optimal_hotspot);
+    if (frc_whole_trajectory_fits(radius, optimal_hotspot))
+    {
+        return optimal_hotspot;
     }
 
-    //TODO: Don't forget last point? Or can we skip?
-    //TODO: Remove bool?
+    for (const bool axis : { true, false })
+    {
+        frc_query_vertices(snapshot.get_map(axis), axis, snapshot.get_tree(), radius, longest_valid_subtrajectory, optimal_hotspot);
+    }
 
     return optimal_hotspot;
 }
 
-void Trajectory::frc_test_between_lines(Trapezoidal_Map& trapezoidal_map, Vec2& current_vert, Vec2& vert_at_radius, bool above, Segment_Search_Tree& segment_tree, Float& radius, Float& longest_valid_subtrajectory, AABB& optimal_hotspot) const
+//If the whole trajectory fits inside the hotspot it is the longest subtrajectory, the maps would find the same hotspot so there is no need to build them
+bool Trajectory::frc_whole_trajectory_fits(const Float radius, AABB& hotspot) const
+{
+    const AABB trajectory_bounding_box = SIMD_AABB::from_segments(trajectory_segments.data(), trajectory_segments.size()).to_AABB();
+
+    if (trajectory_bounding_box.max_size() <= radius)
+    {
+        hotspot = trajectory_bounding_box;
+        return true;
+    }
+
+    return false;
+}
+
+//Builds the trapezoidal map of each axis and queries it from every vertex
+template<typename Tree>
+void Trajectory::frc_build_maps_and_query(const Tree& segment_tree, const Float radius, Float& longest_valid_subtrajectory, AABB& optimal_hotspot) const
+{
+    //The trapezoidal maps represent the graphs with the x or y coördinates on the y-axis and time on the x-axis.
+    //The maps only store pointers to the projected segments, so we handle one axis at a time and reuse the same buffer for both,
+    //this way we never hold more than one projected copy of the trajectory in memory.
+    Hooked_Vector<Segment> projected_segments;
+    projected_segments.reserve(trajectory_segments.size());
+
+    for (const bool axis : { true, false })
+    {
+        Trace_Span projection_span(axis ? "frc_reprojection_x" : "frc_reprojection_y");
+        TRAJECTORY_HOTSPOTS_COUNT(statistics->begin_phase(Query_Phase::map_build));
+        frc_project_segments_on_axis(axis, projected_segments);
+        projection_span.end();
+
+        Trace_Span map_span(axis ? "frc_map_build_x" : "frc_map_build_y");
+        Trapezoidal_Map trapezoidal_map(projected_segments);
+        map_span.end();
+
+        frc_query_vertices(trapezoidal_map, axis, segment_tree, radius, longest_valid_subtrajectory, optimal_hotspot);
+    }
+}
+
+//Fills the buffer with the trajectory segments projected to the (t, x) plane when axis is true, or the (t, y) plane when false
+//The buffer is cleared first, so its capacity can be reused between axes
+void Trajectory::frc_project_segments_on_axis(const bool axis, Hooked_Vector<Segment>& projected_segments) const
+{
+    projected_segments.clear();
+
+    for (const Segment& trajectory_segment : trajectory_segments)
+    {
+        const Float start_value = axis ? trajectory_segment.start.x : trajectory_segment.start.y;
+        const Float end_value = axis ? trajectory_segment.end.x : trajectory_segment.end.y;
+
+        projected_segments.emplace_back(Vec2(trajectory_segment.start_t, start_value), Vec2(trajectory_segment.end_t, end_value), trajectory_segment.start_t, trajectory_segment.end_t);
+    }
+}
+
+//Query the map of the given axis and the segment search tree from every vertex, keeping the longest subtrajectory that fits in a hotspot of the radius
+template<typename Map, typename Tree>
+void Trajectory::frc_query_vertices(const Map& trapezoidal_map, const bool axis, const Tree& segment_tree, const Float radius, Float& longest_valid_subtrajectory, AABB& optimal_hotspot) const
+{
+    const Trace_Span vertex_span(axis ? "frc_vertex_loop_x" : "frc_vertex_loop_y");
+    TRAJECTORY_HOTSPOTS_COUNT(statistics->begin_phase(Query_Phase::search));
+
+    TRAJECTORY_HOTSPOTS_COUNT(statistics->map_nodes += trapezoidal_map.get_node_count());
+
+    //Loop through all vertices and query the trapezoidal map and the segment search tree
+    for (const Segment& trajectory_segment : trajectory_segments)
+    {
+        Vec2 current_vert(trajectory_segment.start_t, axis ? trajectory_segment.start.x : trajectory_segment.start.y);
+
+        //We slightly diverge from the paper here by tracing left and right from both the vector and vector + or - radius and taking the shortest of both.
+        //instead of going up from the found point on the left and tracing back. 
+        //This gives the same answer and we remove a number of checks.
+
+        //Test left or below, current vert is at top
+        Vec2 vert_at_radius(current_vert.x, current_vert.y - radius); //TODO: Remove, can calc in function..
+        frc_test_between_lines(trapezoidal_map, current_vert, vert_at_radius, true, segment_tree, radius, longest_valid_subtrajectory, optimal_hotspot);
+
+        //Test right or above, current vert is at bottom
+        vert_at_radius = Vec2(current_vert.x, current_vert.y + radius);
+        frc_test_between_lines(trapezoidal_map, current_vert, vert_at_radius, false, segment_tree, radius, longest_valid_subtrajectory, optimal_hotspot);
+    }
+}
+
+template<typename Map, typename Tree>
+void Trajectory::frc_test_between_lines(const Map& trapezoidal_map, const Vec2& current_vert, const Vec2& vert_at_radius, const bool above, const Tree& segment_tree, const Float radius, Float& longest_valid_subtrajectory, AABB& optimal_hotspot) const
 {
     Float subtrajectory_start;
     Float subtrajectory_end;
@@ -114,15 +282,22 @@ void Trajectory::frc_test_between_lines(Trapezoidal_Map& trapezoidal_map, Vec2&
     {
         AABB subtrajectory_bounding_box = segment_tree.query(subtrajectory_start, subtrajectory_end);
 
+        TRAJECTORY_HOTSPOTS_COUNT(statistics->radius_candidates++);
+
         if (subtrajectory_bounding_box.max_size() <= radius)
         {
             longest_valid_subtrajectory = (subtrajectory_end - subtrajectory_start);
             optimal_hotspot = subtrajectory_bounding_box;
         }
+        else
+        {
+            TRAJECTORY_HOTSPOTS_COUNT(statistics->radius_rejected++);
+        }
     }
 }
 
-void Trajectory::frc_get_subtrajectory_within_boundary(const Trapezoidal_Map& trapezoidal_map, const Vec2& current_vert, const Vec2& vert_at_radius, const bool above_point, Float& subtrajectory_start, Float& subtrajectory_end) const
+template<typename Map>
+void Trajectory::frc_get_subtrajectory_within_boundary(const Map& trapezoidal_map, const Vec2& current_vert, const Vec2& vert_at_radius, const bool above_point, Float& subtrajectory_start, Float& subtrajectory_end) const
 {
     //Query the start and end of the subtrajectory from the vertex and at the point one radius away.
     Float start_at_vert;
@@ -135,48 +310,51 @@ void Trajectory::frc_get_subtrajectory_within_boundary(const Trapezoidal_Map& tr
     frc_get_subtrajectory_start_and_end(trapezoidal_map, vert_at_radius, !above_point, start_at_radius, end_at_radius);
 
     //Keep the shortest start and end, the trajectory leaves the boundary at that point so the subtrajectory towards the longer intersection will leave the boundary.
-    subtrajectory_start = (start_at_vert < start_at_radius) ? start_at_vert : start_at_radius;
+    //The shortest start is the latest one
+    subtrajectory_start = (start_at_vert > start_at_radius) ? start_at_vert : start_at_radius;
     subtrajectory_end = (end_at_vert < end_at_radius) ? end_at_vert : end_at_radius;
 }
 
-void Trajectory::frc_get_subtrajectory_start_and_end(const Trapezoidal_Map& trapezoidal_map, const Vec2& query_vert, const bool above_point, Float& subtrajectory_start, Float& subtrajectory_end) const
+template<typename Map>
+void Trajectory::frc_get_subtrajectory_start_and_end(const Map& trapezoidal_map, const Vec2& query_vert, const bool above_point, Float& subtrajectory_start, Float& subtrajectory_end) const
 {
-    const Segment* left_segment = nullptr;
-    const Segment* right_segment = nullptr;
-    trapezoidal_map.trace_left_right(query_vert, above_point, left_segment, right_segment);
+    Segment left_segment;
+    Segment right_segment;
+    trace_left_right(trapezoidal_map, query_vert, above_point, left_segment, right_segment);
 
-    if (left_segment != nullptr && right_segment != nullptr)
+    //If the left_segment is at infinity there is no trajectory on the left, set start_t to the start of the trajectory
+    if (left_segment.start.x.is_inf())
     {
-        //If the left_segment is at infinity there is no trajectory on the left, set start_t to the start of the trajectory
-        if (left_segment->start.x.is_inf())
-        {
-            subtrajectory_start = this->trajectory_start;
-        }
-        else
-        {
-            subtrajectory_start = left_segment->get_time_at_y(query_vert.y);
-        }
+        subtrajectory_start = this->trajectory_start;
+    }
+    else
+    {
+        subtrajectory_start = left_segment.get_time_at_y(query_vert.y);
+    }
 
-        //If the right_segment is at infinity there is no trajectory on the right, set end_t to the end of the trajectory
-        if (right_segment->start.x.is_inf())
-        {
-            subtrajectory_end = this->trajectory_end;
-        }
-        else
-        {
-            subtrajectory_end = right_segment->get_time_at_y(query_vert.y);
-        }
+    //If the right_segment is at infinity there is no trajectory on the right, set end_t to the end of the trajectory
+    if (right_segment.start.x.is_inf())
+    {
+        subtrajectory_end = this->trajectory_end;
     }
     else
     {
-        //Neither segment should ever be nullptr
-        assert(false);
+        subtrajectory_end = right_segment.get_time_at_y(query_vert.y);
     }
 }
 
+AABB Trajectory::get_hotspot_fixed_length_contiguous(Float length, Query_Statistics& statistics, Scratch_Arena* arena) const
+{
+    const Query_Statistics_Scope statistics_scope(statistics);
+    return get_hotspot_fixed_length_contiguous(length, arena);
+}
+
 //Find the smallest hotspot that contains a subtrajectory with at least the given length inside of it
-AABB Trajectory::get_hotspot_fixed_length_contiguous(Float length) const
+AABB Trajectory::get_hotspot_fixed_length_contiguous(Float length, Scratch_Arena* arena) const
 {
+    const Scratch_Arena_Query_Scope arena_scope(arena);
+    const Trace_Span query_span("fixed_length_contiguous");
+
     if (length > trajectory_length)
     {
         //Invalid length
@@ -184,7 +362,10 @@ AABB Trajectory::get_hotspot_fixed_length_contiguous(Float length) const
     }
 
     //TODO:Check if length is enough for an UV to exist..
-    Segment_Search_Tree tree(trajectory_segments);
+    Trace_Span tree_span("flc_tree_build");
+    TRAJECTORY_HOTSPOTS_COUNT(statistics->begin_phase(Query_Phase::tree_build));
+    Segment_Search_Tree tree(trajectory_segments, &trajectory_kinematics);
+    tree_span.end();
 
     AABB smallest_hotspot(
         std::numeric_limits<float>::lowest() / 2.f,
@@ -192,6 +373,29 @@ AABB Trajectory::get_hotspot_fixed_length_contiguous(Float length) const
         std::numeric_limits<float>::max() / 2.f,
         std::numeric_limits<float>::max() / 2.f);
 
+    AABB current_hotspot;
+
+    //Keeps the current hotspot if a breakpoint of the type (0 is type I) found one and it is smaller, and counts the breakpoint
+    const auto consider_breakpoint = [&]([[maybe_unused]] const size_t type, const bool found)
+    {
+        TRAJECTORY_HOTSPOTS_COUNT(statistics->breakpoint_candidates[type]++);
+
+        if (!found)
+        {
+            return;
+        }
+
+        TRAJECTORY_HOTSPOTS_COUNT(statistics->breakpoint_accepted[type]++);
+
+        if (current_hotspot.max_size() < smallest_hotspot.max_size())
+        {
+            smallest_hotspot = current_hotspot;
+        }
+    };
+
+    Trace_Span breakpoints_I_II_span("flc_breakpoints_I_II");
+    TRAJECTORY_HOTSPOTS_COUNT(statistics->begin_phase(Query_Phase::search));
+
     //Breakpoint type I, the subtrajectory starts at a vertex of the trajectory
     for (auto& trajectory_segment : trajectory_segments)
     {
@@ -204,12 +408,8 @@ AABB Trajectory::get_hotspot_fixed_length_contiguous(Float length) const
             break;
         }
 
-        const AABB current_hotspot = tree.query(start, end);
-
-        if (current_hotspot.max_size() < smallest_hotspot.max_size())
-        {
-            smallest_hotspot = current_hotspot;
-        }
+        current_hotspot = tree.query(start, end);
+        consider_breakpoint(0, true);
     }
 
     //Breakpoint type II, the subtrajectory ends at a vertex of the trajectory
@@ -225,14 +425,12 @@ AABB Trajectory::get_hotspot_fixed_length_contiguous(Float length) const
             break;
         }
 
-        const AABB current_hotspot = tree.query(start, end);
-
-        if (current_hotspot.max_size() < smallest_hotspot.max_size())
-        {
-            smallest_hotspot = current_hotspot;
-        }
+        current_hotspot = tree.query(start, end);
+        consider_breakpoint(1, true);
     }
 
+    breakpoints_I_II_span.end();
+
     //Breakpoint type III and IV, the start/end of the subtrajectory coincides 
     //with the minimum or maximum x or y-coordinate of the bounding box 
     //based on the subtrajectory between the first and last vertex on the optimal subtrajectory
@@ -240,6 +438,29 @@ AABB Trajectory::get_hotspot_fixed_length_contiguous(Float length) const
     //For each segment, query with start + L and end + L, iterate from first to last.
     //For each end segment query bounding box uv, then check if the border lines intersect the start of end segment
 
+    //The line intersections for breakpoints III and IV are computed in batches, one batch per start segment.
+    //Lane j holds the line through the minimum side of the uv AABB of the j-th end segment in the block, lane j + block_size the maximum side.
+    //Buffers are reused between start segments.
+    Segment_Batch start_segment_batch;
+    Segment_Batch end_segment_batch;
+
+    //Breakpoint V is solved in one batch for all end segments of a start segment, lane j holds the j-th end segment after the start segment
+    Segment_Batch end_segment_range_batch;
+
+    Same_Axis_Point_Batch x_axis_points;
+    Same_Axis_Point_Batch y_axis_points;
+
+    Hooked_Vector<float> vertical_lines;
+    Hooked_Vector<float> horizontal_lines;
+    Hooked_Vector<AABB> uv_bounding_boxes;
+
+    Axis_Intersection_Batch start_x_intersections;
+    Axis_Intersection_Batch start_y_intersections;
+    Axis_Intersection_Batch end_x_intersections;
+    Axis_Intersection_Batch end_y_intersections;
+
+    const Trace_Span breakpoints_III_IV_V_span("flc_breakpoints_III_IV_V");
+
     for (size_t start_index = 0; start_index < trajectory_segments.size(); ++start_index)
     {
         const Segment& start_segment = trajectory_segments[start_index];
@@ -248,55 +469,101 @@ AABB Trajectory::get_hotspot_fixed_length_contiguous(Float length) const
         const Float end_range_start = start_segment.start_t + length;
         const Float end_range_end = start_segment.end_t + length;
 
-        const int end_range_start_index = tree.query(end_range_start);
-        const int end_range_end_index = tree.query(end_range_end);
+        //The tree returns the first or last segment for times outside the trajectory, so the indices are never negative
+        const size_t end_range_start_index = static_cast<size_t>(tree.query(end_range_start));
+        const size_t end_range_end_index = static_cast<size_t>(tree.query(end_range_end));
 
         //Get u, the time at the first vertex after the sub-trajectory start point
         Float start = start_segment.end_t;
 
-        //Loop through all the possible end segments and query for an AABB of the sub-trajectory between u and v
-        //Check breakpoints III, IV, and V
+        //Breakpoint V needs at least the next segment as end segment
+        const size_t range_start_index = std::max(end_range_start_index, start_index + 1);
+
+        end_segment_range_batch.clear();
+
+        for (size_t end_index = range_start_index; end_index <= end_range_end_index; ++end_index)
+        {
+            end_segment_range_batch.push_back(trajectory_segments[end_index], trajectory_kinematics[end_index]);
+        }
+
+        batch_points_on_same_axis_with_distance_l(start_segment, trajectory_kinematics[start_index], end_segment_range_batch, length, true, x_axis_points);
+        batch_points_on_same_axis_with_distance_l(start_segment, trajectory_kinematics[start_index], end_segment_range_batch, length, false, y_axis_points);
+
+        //Breakpoints III and IV need at least one segment between the start and end segment (else U & V are the same point)
+        const size_t block_start_index = std::max(end_range_start_index, start_index + 2);
+        const size_t block_size = (end_range_end_index >= block_start_index) ? (end_range_end_index - block_start_index + 1) : 0;
+
+        uv_bounding_boxes.clear();
+        start_segment_batch.clear();
+        end_segment_batch.clear();
+        vertical_lines.clear();
+        horizontal_lines.clear();
+
+        for (size_t end_index = block_start_index; end_index < block_start_index + block_size; ++end_index)
+        {
+            //Get v, the time at the first vertex before the sub-trajectory end point
+            Float end = trajectory_segments[end_index].start_t;
+
+            //Obtain the bounding box of the subtrajectory between u and v
+            uv_bounding_boxes.push_back(tree.query(start, end));
+        }
+
+        for (const bool minimum_side : { true, false })
+        {
+            for (size_t j = 0; j < block_size; ++j)
+            {
+                const AABB& uv_bounding_box = uv_bounding_boxes[j];
+
+                vertical_lines.push_back(minimum_side ? uv_bounding_box.min.x.get_value() : uv_bounding_box.max.x.get_value());
+                horizontal_lines.push_back(minimum_side ? uv_bounding_box.min.y.get_value() : uv_bounding_box.max.y.get_value());
+
+                start_segment_batch.push_back(start_segment, trajectory_kinematics[start_index]);
+                end_segment_batch.push_back(trajectory_segments[block_start_index + j], trajectory_kinematics[block_start_index + j]);
+            }
+        }
+
+        batch_x_intersects(start_segment_batch, vertical_lines.data(), start_x_intersections);
+        batch_y_intersects(start_segment_batch, horizontal_lines.data(), start_y_intersections);
+        batch_x_intersects(end_segment_batch, vertical_lines.data(), end_x_intersections);
+        batch_y_intersects(end_segment_batch, horizontal_lines.data(), end_y_intersections);
+
+        //Loop through all the possible end segments and check breakpoints III, IV, and V
         for (size_t end_index = end_range_start_index; end_index <= end_range_end_index; ++end_index)
         {
-            if (end_index - start_index < 1)
+            if (end_index <= start_index)
             {
                 //Skip if same segment (No U & V)
                 continue;
             }
 
-            AABB current_hotspot;
-
-            const Segment& end_segment = trajectory_segments[end_index];
-
             //Breakpoint V, the start and end of the subtrajectory lie on the same x or y coordinate
-            if (flc_breakpoint_V(tree, length, start_segment, end_segment, true, current_hotspot)) { if (current_hotspot.max_size() < smallest_hotspot.max_size()) { smallest_hotspot = current_hotspot; } }
-            if (flc_breakpoint_V(tree, length, start_segment, end_segment, false, current_hotspot)) { if (current_hotspot.max_size() < smallest_hotspot.max_size()) { smallest_hotspot = current_hotspot; } }
+            const size_t range_lane = end_index - range_start_index;
+
+            consider_breakpoint(4, flc_breakpoint_V(tree, x_axis_points, range_lane, current_hotspot));
+            consider_breakpoint(4, flc_breakpoint_V(tree, y_axis_points, range_lane, current_hotspot));
 
-            if (end_index - start_index < 2)
+            if (end_index <= start_index + 1)
             {
                 //Skip III & IV if connected segments
                 //U & V are the same point (so no bounding box)
                 continue;
             }
 
+            const size_t min_lane = end_index - block_start_index;
+            const size_t max_lane = min_lane + block_size;
 
-            //Get v, the time at the first vertex before the sub-trajectory end point
-            Float end = end_segment.start_t;
-
-            //Obtain the bounding box of the subtrajectory between u and v
-            AABB uv_bounding_box = tree.query(start, end);
+            const AABB& uv_bounding_box = uv_bounding_boxes[min_lane];
 
             //Breakpoints III and IV, Check if any of the four sides of the AABB of the subtrajectory between u and v intersects either the start or end segment, if so, check for new hotspot
-            if (flc_breakpoint_III_x(length, start_segment, end_segment, uv_bounding_box.min.x, uv_bounding_box, current_hotspot)) { if (current_hotspot.max_size() < smallest_hotspot.max_size()) { smallest_hotspot = current_hotspot; } }
-            if (flc_breakpoint_III_x(length, start_segment, end_segment, uv_bounding_box.max.x, uv_bounding_box, current_hotspot)) { if (current_hotspot.max_size() < smallest_hotspot.max_size()) { smallest_hotspot = current_hotspot; } }
-            if (flc_breakpoint_III_y(length, start_segment, end_segment, uv_bounding_box.min.y, uv_bounding_box, current_hotspot)) { if (current_hotspot.max_size() < smallest_hotspot.max_size()) { smallest_hotspot = current_hotspot; } }
-            if (flc_breakpoint_III_y(length, start_segment, end_segment, uv_bounding_box.max.y, uv_bounding_box, current_hotspot)) { if (current_hotspot.max_size() < smallest_hotspot.max_size()) { smallest_hotspot = current_hotspot; } }
-
-            if (flc_breakpoint_IV_x(length, start_segment, end_segment, uv_bounding_box.min.x, uv_bounding_box, current_hotspot)) { if (current_hotspot.max_size() < smallest_hotspot.max_size()) { smallest_hotspot = current_hotspot; } }
-            if (flc_breakpoint_IV_x(length, start_segment, end_segment, uv_bounding_box.max.x, uv_bounding_box, current_hotspot)) { if (current_hotspot.max_size() < smallest_hotspot.max_size()) { smallest_hotspot = current_hotspot; } }
-            if (flc_breakpoint_IV_y(length, start_segment, end_segment, uv_bounding_box.min.y, uv_bounding_box, current_hotspot)) { if (current_hotspot.max_size() < smallest_hotspot.max_size()) { smallest_hotspot = current_hotspot; } }
-            if (flc_breakpoint_IV_y(length, start_segment, end_segment, uv_bounding_box.max.y, uv_bounding_box, current_hotspot)) { if (current_hotspot.max_size() < smallest_hotspot.max_size()) { smallest_hotspot = current_hotspot; } }
-
+            consider_breakpoint(2, flc_breakpoint_III_x(length, trajectory_segments[start_index], trajectory_segments[end_index], trajectory_kinematics[end_index], uv_bounding_box.min.x, start_x_intersections, min_lane, uv_bounding_box, current_hotspot));
+            consider_breakpoint(2, flc_breakpoint_III_x(length, trajectory_segments[start_index], trajectory_segments[end_index], trajectory_kinematics[end_index], uv_bounding_box.max.x, start_x_intersections, max_lane, uv_bounding_box, current_hotspot));
+            consider_breakpoint(2, flc_breakpoint_III_y(length, trajectory_segments[start_index], trajectory_segments[end_index], trajectory_kinematics[end_index], uv_bounding_box.min.y, start_y_intersections, min_lane, uv_bounding_box, current_hotspot));
+            consider_breakpoint(2, flc_breakpoint_III_y(length, trajectory_segments[start_index], trajectory_segments[end_index], trajectory_kinematics[end_index], uv_bounding_box.max.y, start_y_intersections, max_lane, uv_bounding_box, current_hotspot));
+
+            consider_breakpoint(3, flc_breakpoint_IV_x(length, trajectory_segments[start_index], trajectory_segments[end_index], trajectory_kinematics[start_index], uv_bounding_box.min.x, end_x_intersections, min_lane, uv_bounding_box, current_hotspot));
+            consider_breakpoint(3, flc_breakpoint_IV_x(length, trajectory_segments[start_index], trajectory_segments[end_index], trajectory_kinematics[start_index], uv_bounding_box.max.x, end_x_intersections, max_lane, uv_bounding_box, current_hotspot));
+            consider_breakpoint(3, flc_breakpoint_IV_y(length, trajectory_segments[start_index], trajectory_segments[end_index], trajectory_kinematics[start_index], uv_bounding_box.min.y, end_y_intersections, min_lane, uv_bounding_box, current_hotspot));
+            consider_breakpoint(3, flc_breakpoint_IV_y(length, trajectory_segments[start_index], trajectory_segments[end_index], trajectory_kinematics[start_index], uv_bounding_box.max.y, end_y_intersections, max_lane, uv_bounding_box, current_hotspot));
         }
     }
 
@@ -304,23 +571,23 @@ AABB Trajectory::get_hotspot_fixed_length_contiguous(Float length) const
 }
 
 //Checks if the vertical line through the side of the uv AABB intersects the starting segment and returns a potential hotspot if the subtrajectory still ends in the end segment
-bool Trajectory::flc_breakpoint_III_x(const Float length, const Segment& start_segment, const Segment& end_segment, const Float vertical_line_x, const AABB& uv_bounding_box, AABB& potential_hotspot) const
+bool Trajectory::flc_breakpoint_III_x(const Float length, const Segment& start_segment, const Segment& end_segment, const Segment_Kinematics& end_kinematics, const Float vertical_line_x, const Axis_Intersection_Batch& intersections, const size_t lane, const AABB& uv_bounding_box, AABB& potential_hotspot)
 {
-    Float intersection_y;
-
     //Does the line through the side of the AABB intersect the start segment?
-    if (!start_segment.x_intersects(vertical_line_x, intersection_y))
+    if (!intersections.hits[lane])
     {
         return false;
     }
 
+    const Float intersection_y = intersections.intersections[lane];
+
     //If the found point is the end point of the starting segment we can skip, this is just breakpoint type I
     if (start_segment.end.y == intersection_y)
     {
         return false;
     }
 
-    Float start_time = start_segment.get_time_at_x(vertical_line_x);
+    Float start_time = intersections.times[lane];
     Float end_time = start_time + length;
 
     //TODO: If intersection is infinite we exit here, is that ok?
@@ -334,7 +601,7 @@ bool Trajectory::flc_breakpoint_III_x(const Float length, const Segment& start_s
     Vec2 start_point(vertical_line_x, intersection_y);
 
     //Find the end point of the trajectory on the end segment
-    Vec2 end_point = end_segment.get_point_at_time(end_time);
+    Vec2 end_point = end_segment.get_point_at_time(end_time, end_kinematics);
 
     //Augment the hotspot with the start and end points and return
     potential_hotspot = AABB::augment(uv_bounding_box, start_point);
@@ -344,23 +611,23 @@ bool Trajectory::flc_breakpoint_III_x(const Float length, const Segment& start_s
 }
 
 //Checks if the horizontal line through the side of the uv AABB intersects the starting segment and returns a potential hotspot if the subtrajectory still ends in the end segment
-bool Trajectory::flc_breakpoint_III_y(const Float length, const Segment& start_segment, const Segment& end_segment, const Float horizontal_line_y, const AABB& uv_bounding_box, AABB& potential_hotspot) const
+bool Trajectory::flc_breakpoint_III_y(const Float length, const Segment& start_segment, const Segment& end_segment, const Segment_Kinematics& end_kinematics, const Float horizontal_line_y, const Axis_Intersection_Batch& intersections, const size_t lane, const AABB& uv_bounding_box, AABB& potential_hotspot)
 {
-    Float intersection_x;
-
     //Does the line through the side of the AABB intersect the start segment?
-    if (!start_segment.y_intersects(horizontal_line_y, intersection_x))
+    if (!intersections.hits[lane])
     {
         return false;
     }
 
+    const Float intersection_x = intersections.intersections[lane];
+
     //If the found point is the end point of the starting segment we can skip, this is just breakpoint type I
     if (start_segment.end.x == intersection_x)
     {
         return false;
     }
 
-    Float start_time = start_segment.get_time_at_y(horizontal_line_y);
+    Float start_time = intersections.times[lane];
     Float end_time = start_time + length;
 
     //The trajectory must start and end on the start and end segments or it violates the breakpoint because u and v change
@@ -373,7 +640,7 @@ bool Trajectory::flc_breakpoint_III_y(const Float length, const Segment& start_s
     Vec2 start_point(intersection_x, horizontal_line_y);
 
     //Find the end point of the trajectory on the end segment
-    Vec2 end_point = end_segment.get_point_at_time(end_time);
+    Vec2 end_point = end_segment.get_point_at_time(end_time, end_kinematics);
 
     //Augment the hotspot with the start and end points and return
     potential_hotspot = AABB::augment(uv_bounding_box, start_point);
@@ -383,23 +650,23 @@ bool Trajectory::flc_breakpoint_III_y(const Float length, const Segment& start_s
 }
 
 //Checks if the vertical line through the side of the uv AABB intersects the end segment and returns a potential hotspot if the subtrajectory still starts in the start segment
-bool Trajectory::flc_breakpoint_IV_x(const Float length, const Segment& start_segment, const Segment& end_segment, const Float vertical_line_x, const AABB& uv_bounding_box, AABB& potential_hotspot) const
+bool Trajectory::flc_breakpoint_IV_x(const Float length, const Segment& start_segment, const Segment& end_segment, const Segment_Kinematics& start_kinematics, const Float vertical_line_x, const Axis_Intersection_Batch& intersections, const size_t lane, const AABB& uv_bounding_box, AABB& potential_hotspot)
 {
-    Float intersection_y;
-
     //Does the line through the side of the AABB intersect the end segment?
-    if (!end_segment.x_intersects(vertical_line_x, intersection_y))
+    if (!intersections.hits[lane])
     {
         return false;
     }
 
+    const Float intersection_y = intersections.intersections[lane];
+
     //If the found point is the start point of the end segment we can skip, this is just breakpoint type II
     if (end_segment.start.y == intersection_y)
     {
         return false;
     }
 
-    Float end_time = end_segment.get_time_at_x(vertical_line_x);
+    Float end_time = intersections.times[lane];
     Float start_time = end_time - length;
 
     //The trajectory must start and end on the start and end segments or it violates the breakpoint because u and v change
@@ -412,7 +679,7 @@ bool Trajectory::flc_breakpoint_IV_x(const Float length, const Segment& start_se
     Vec2 end_point(vertical_line_x, intersection_y);
 
     //Find the start point of the trajectory on the start segment
-    Vec2 start_point = end_segment.get_point_at_time(start_time);
+    Vec2 start_point = start_segment.get_point_at_time(start_time, start_kinematics);
 
     //Augment the hotspot with the start and end points and return
     potential_hotspot = AABB::augment(uv_bounding_box, start_point);
@@ -422,23 +689,23 @@ bool Trajectory::flc_breakpoint_IV_x(const Float length, const Segment& start_se
 }
 
 //Checks if the horizontal line through the side of the uv AABB intersects the end segment and returns a potential hotspot if the subtrajectory still starts in the start segment
-bool Trajectory::flc_breakpoint_IV_y(const Float length, const Segment& start_segment, const Segment& end_segment, const Float horizontal_line_y, const AABB& uv_bounding_box, AABB& potential_hotspot) const
+bool Trajectory::flc_breakpoint_IV_y(const Float length, const Segment& start_segment, const Segment& end_segment, const Segment_Kinematics& start_kinematics, const Float horizontal_line_y, const Axis_Intersection_Batch& intersections, const size_t lane, const AABB& uv_bounding_box, AABB& potential_hotspot)
 {
-    Float intersection_x;
-
     //Does the line through the side of the AABB intersect the end segment?
-    if (!end_segment.y_intersects(horizontal_line_y, intersection_x))
+    if (!intersections.hits[lane])
     {
         return false;
     }
 
+    const Float intersection_x = intersections.intersections[lane];
+
     //If the found point is the start point of the end segment we can skip, this is just breakpoint type II
     if (end_segment.start.x == intersection_x)
     {
         return false;
     }
 
-    Float end_time = end_segment.get_time_at_y(horizontal_line_y);
+    Float end_time = intersections.times[lane];
     Float start_time = end_time - length;
 
     //The trajectory must start and end on the start and end segments or it violates the breakpoint because u and v change
@@ -451,7 +718,7 @@ bool Trajectory::flc_breakpoint_IV_y(const Float length, const Segment& start_se
     Vec2 end_point(intersection_x, horizontal_line_y);
 
     //Find the start point of the trajectory on the start segment
-    Vec2 start_point = end_segment.get_point_at_time(start_time);
+    Vec2 start_point = start_segment.get_point_at_time(start_time, start_kinematics);
 
     //Augment the hotspot with the start and end points and return
     potential_hotspot = AABB::augment(uv_bounding_box, start_point);
@@ -460,21 +727,16 @@ bool Trajectory::flc_breakpoint_IV_y(const Float length, const Segment& start_se
     return true;
 }
 
-bool Trajectory::flc_breakpoint_V(const Segment_Search_Tree& tree, const Float length, const Segment& start_segment, const Segment& end_segment, const bool axis, AABB& potential_hotspot) const
+bool Trajectory::flc_breakpoint_V(const Segment_Search_Tree& tree, const Same_Axis_Point_Batch& axis_points, const size_t lane, AABB& potential_hotspot) const
 {
-    //Calculate start and end point
-    Vec2 p;
-    Vec2 q;
-
-    const bool found_valid_points = Segment::get_points_on_same_axis_with_distance_l(start_segment, end_segment, length, axis, p, q);
-
-    if (!found_valid_points)
+    //Were there valid start and end points?
+    if (!axis_points.hits[lane])
     {
         return false;
     }
 
-    //Query the tree using the found start and end point
-    potential_hotspot = tree.query(start_segment.get_time_at_point(p), end_segment.get_time_at_point(q));
+    //Query the tree using the times at the found start and end point
+    potential_hotspot = tree.query(axis_points.start_times[lane], axis_points.end_times[lane]);
 
     return true;
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+class Trajectory_Index_Snapshot;
+
 //TODO: Pre-build trees for fast queries?
 //TODO: Move tree into this class to make AABB query easier
 class Trajectory
@@ -9,12 +11,35 @@ public:
     Trajectory(const std::vector<Segment>& ordered_segments);
     Trajectory(const std::vector<Vec2>& ordered_points);
 
+    //Builds the trajectory from vertex coordinate arrays, t may be nullptr to set times with the length along the trajectory like above
+    Trajectory(const float* x, const float* y, const float* t, const size_t vertex_count);
+
+    //Rebuilds the trajectory like the constructor above, reusing the memory of the segments, so a trajectory can be reused for many trips
+    void assign(const float* x, const float* y, const float* t, const size_t vertex_count);
+
+
+    //The queries take an optional arena for their temporaries, which is rewound when they return, see Scratch_Arena_Query_Scope
+    //Reusing an arena, like the one of get_thread_scratch_arena(), avoids all heap allocations once it has grown to the largest query.
+    //Without an arena the temporaries are allocated through the allocation hook as before.
+
+    AABB get_hotspot_fixed_radius(Float radius, Scratch_Arena* arena = nullptr) const;
+    AABB get_hotspot_fixed_length(Float length, Scratch_Arena* arena = nullptr) const;
+
+    AABB get_hotspot_fixed_radius_contiguous(Float radius, Scratch_Arena* arena = nullptr) const;
 
-    AABB get_hotspot_fixed_radius(Float radius) const;
-    AABB get_hotspot_fixed_length(Float length) const;
+    //Same as above, but queries the prebuilt indexes of a snapshot written for this trajectory instead of building them
+    AABB get_hotspot_fixed_radius_contiguous(Float radius, const Trajectory_Index_Snapshot& snapshot, Scratch_Arena* arena = nullptr) const;
 
-    AABB get_hotspot_fixed_radius_contiguous(Float radius) const;
-    AABB get_hotspot_fixed_length_contiguous(Float length) const;
+    //Same as above, but queries a tree that is kept up to date over the same segments, like the one of a Trajectory_Window
+    AABB get_hotspot_fixed_radius_contiguous(Float radius, const Dynamic_Segment_Search_Tree& segment_tree, Scratch_Arena* arena = nullptr) const;
+
+    //Same as above, and counts the work done by the query in the statistics, see query_statistics.h
+    AABB get_hotspot_fixed_radius_contiguous(Float radius, Query_Statistics& statistics, Scratch_Arena* arena = nullptr) const;
+
+    AABB get_hotspot_fixed_length_contiguous(Float length, Scratch_Arena* arena = nullptr) const;
+
+    //Same as above, and counts the work done by the query in the statistics
+    AABB get_hotspot_fixed_length_contiguous(Float length, Query_Statistics& statistics, Scratch_Arena* arena = nullptr) const;
 
     const std::vector<Segment>& get_ordered_trajectory_segments() const;
 
@@ -26,18 +51,40 @@ private:
 
     std::vector<Segment> trajectory_segments;
 
+    //Precomputed kinematics of the trajectory segments, indexed the same as trajectory_segments
+    std::vector<Segment_Kinematics> trajectory_kinematics;
+
+    //Snapshots build the same indexes as fixed_radius_contiguous
+    friend class Trajectory_Index_Snapshot;
+
+    //Streams evaluate the fixed_length_contiguous breakpoints of each new segment
+    friend class Fixed_Length_Contiguous_Stream;
+
     //Helper functions for fixed_radius_contiguous
+    //The helpers are templated on the map and tree types, so they work on both the built (Trapezoidal_Map, Segment_Search_Tree) and the flat indexes
 
-    void frc_test_between_lines(Trapezoidal_Map& trapezoidal_map, Vec2& current_vert, Vec2& vert_at_radius, bool above, Segment_Search_Tree& segment_tree, Float& radius, Float& longest_valid_subtrajectory, AABB& optimal_hotspot) const;
-    void frc_get_subtrajectory_within_boundary(const Trapezoidal_Map& trapezoidal_map, const Vec2& current_vert, const Vec2& vert_at_radius, const bool above_point, Float& subtrajectory_start, Float& subtrajectory_end) const;
-    void frc_get_subtrajectory_start_and_end(const Trapezoidal_Map& trapezoidal_map, const Vec2& query_vert, const bool above_point, Float& subtrajectory_start, Float& subtrajectory_end) const;
+    bool frc_whole_trajectory_fits(const Float radius, AABB& hotspot) const;
+    void frc_project_segments_on_axis(const bool axis, Hooked_Vector<Segment>& projected_segments) const;
+    template<typename Tree>
+    void frc_build_maps_and_query(const Tree& segment_tree, const Float radius, Float& longest_valid_subtrajectory, AABB& optimal_hotspot) const;
+    template<typename Map, typename Tree>
+    void frc_query_vertices(const Map& trapezoidal_map, const bool axis, const Tree& segment_tree, const Float radius, Float& longest_valid_subtrajectory, AABB& optimal_hotspot) const;
+    template<typename Map, typename Tree>
+    void frc_test_between_lines(const Map& trapezoidal_map, const Vec2& current_vert, const Vec2& vert_at_radius, const bool above, const Tree& segment_tree, const Float radius, Float& longest_valid_subtrajectory, AABB& optimal_hotspot) const;
+    template<typename Map>
+    void frc_get_subtrajectory_within_boundary(const Map& trapezoidal_map, const Vec2& current_vert, const Vec2& vert_at_radius, const bool above_point, Float& subtrajectory_start, Float& subtrajectory_end) const;
+    template<typename Map>
+    void frc_get_subtrajectory_start_and_end(const Map& trapezoidal_map, const Vec2& query_vert, const bool above_point, Float& subtrajectory_start, Float& subtrajectory_end) const;
     //Helper functions for fixed_length_contiguous
 
-    bool flc_breakpoint_III_x(const Float length, const Segment& start_segment, const Segment& end_segment, const Float vertical_line_x, const AABB& uv_bounding_box, AABB& potential_hotspot) const;
-    bool flc_breakpoint_III_y(const Float length, const Segment& start_segment, const Segment& end_segment, const Float horizontal_line_y, const AABB& uv_bounding_box, AABB& potential_hotspot) const;
-    bool flc_breakpoint_IV_x(const Float length, const Segment& start_segment, const Segment& end_segment, const Float vertical_line_x, const AABB& uv_bounding_box, AABB& potential_hotspot) const;
-    bool flc_breakpoint_IV_y(const Float length, const Segment& start_segment, const Segment& end_segment, const Float horizontal_line_y, const AABB& uv_bounding_box, AABB& potential_hotspot) const;
+    //The breakpoint functions take the start and end segments and the precomputed kinematics of the end segment, so streams can pass their own
+    //Breakpoints III and IV read the line intersection with the start (III) or end (IV) segment from the given lane of a batch
+    static bool flc_breakpoint_III_x(const Float length, const Segment& start_segment, const Segment& end_segment, const Segment_Kinematics& end_kinematics, const Float vertical_line_x, const Axis_Intersection_Batch& intersections, const size_t lane, const AABB& uv_bounding_box, AABB& potential_hotspot);
+    static bool flc_breakpoint_III_y(const Float length, const Segment& start_segment, const Segment& end_segment, const Segment_Kinematics& end_kinematics, const Float horizontal_line_y, const Axis_Intersection_Batch& intersections, const size_t lane, const AABB& uv_bounding_box, AABB& potential_hotspot);
+    static bool flc_breakpoint_IV_x(const Float length, const Segment& start_segment, const Segment& end_segment, const Segment_Kinematics& start_kinematics, const Float vertical_line_x, const Axis_Intersection_Batch& intersections, const size_t lane, const AABB& uv_bounding_box, AABB& potential_hotspot);
+    static bool flc_breakpoint_IV_y(const Float length, const Segment& start_segment, const Segment& end_segment, const Segment_Kinematics& start_kinematics, const Float horizontal_line_y, const Axis_Intersection_Batch& intersections, const size_t lane, const AABB& uv_bounding_box, AABB& potential_hotspot);
 
     //bool flc_breakpoint_V(const Segment_Search_Tree& tree, const float length, const Segment& start_segment, const Segment& end_segment, AABB& potential_hotspot) const;
-    bool flc_breakpoint_V(const Segment_Search_Tree& tree, const Float length, const Segment& start_segment, const Segment& end_segment, const bool axis, AABB& potential_hotspot) const;
+    //Breakpoint V reads the points solved for an end segment from the given lane of a batch
+    bool flc_breakpoint_V(const Segment_Search_Tree& tree, const Same_Axis_Point_Batch& axis_points, const size_t lane, AABB& potential_hotspot) const;
 };
\ No newline at end of file
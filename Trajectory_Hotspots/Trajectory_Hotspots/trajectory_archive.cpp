@@ -0,0 +1,466 @@
+#include "pch.h"
+#include "vec2.h"
+#include "trajectory.h"
+#include "trajectory_csv.h"
+#include "trajectory_archive.h"
+#include "binary_file.h"
+
+namespace
+{
+    //Writes one coordinate array in the archive's precision, through a fixed size buffer
+    template<typename T, typename Get_Value>
+    void write_values(std::ofstream& output, const size_t count, Get_Value get_value)
+    {
+        constexpr size_t buffer_size = 4096;
+        T buffer[buffer_size];
+
+        for (size_t begin = 0; begin < count; begin += buffer_size)
+        {
+            const size_t end = std::min(count, begin + buffer_size);
+
+            for (size_t i = begin; i < end; i++)
+            {
+                buffer[i - begin] = static_cast<T>(get_value(i));
+            }
+
+            output.write(reinterpret_cast<const char*>(buffer), static_cast<std::streamsize>((end - begin) * sizeof(T)));
+        }
+    }
+}
+
+bool Trajectory_Archive::is_archive(const char* data, const size_t size)
+{
+    return size >= sizeof(Trajectory_Archive_Header::archive_magic) && memcmp(data, Trajectory_Archive_Header::archive_magic, sizeof(Trajectory_Archive_Header::archive_magic)) == 0;
+}
+
+bool Trajectory_Archive::open(const char* path, std::string& error)
+{
+    header = {};
+    entries = nullptr;
+    nodes = nullptr;
+
+    if (!file.open(path))
+    {
+        error = "can't open archive";
+        return false;
+    }
+
+    const uint64_t file_size = file.size();
+
+    //Version 1 headers end before the compressed section fields
+    constexpr size_t version_1_header_size = offsetof(Trajectory_Archive_Header, compressed_offset);
+
+    if (file_size < version_1_header_size || !is_archive(file.data(), file.size()))
+    {
+        error = "not a trajectory archive";
+        return false;
+    }
+
+    Trajectory_Archive_Header file_values = {};
+    memcpy(&file_values, file.data(), version_1_header_size);
+
+    if (file_values.version != 1 && file_values.version != Trajectory_Archive_Header::current_version)
+    {
+        error = "unsupported archive version " + std::to_string(file_values.version);
+        return false;
+    }
+
+    if (file_values.version >= 2)
+    {
+        if (file_size < sizeof(Trajectory_Archive_Header))
+        {
+            error = "archive is truncated or corrupt";
+            return false;
+        }
+
+        memcpy(&file_values, file.data(), sizeof(Trajectory_Archive_Header));
+    }
+
+    //Validate the section bounds, entries are checked on access so opening stays independent of the archive size
+    const uint64_t value_size = (file_values.flags & Trajectory_Archive_Header::float64_vertices) ? 8 : 4;
+    const uint64_t vertex_bytes = file_values.vertex_count * value_size;
+    const bool has_time = (file_values.flags & Trajectory_Archive_Header::has_time) != 0;
+    const bool has_trees = (file_values.flags & Trajectory_Archive_Header::has_trees) != 0;
+    const bool compressed = (file_values.flags & Trajectory_Archive_Header::compressed_vertices) != 0;
+
+    if (file_values.trajectory_count > file_size / sizeof(Trajectory_Archive_Entry) || file_values.node_count > file_size / sizeof(Flat_Segment_Search_Tree_Node) ||
+        !section_fits(file_values.entries_offset, file_values.trajectory_count * sizeof(Trajectory_Archive_Entry), file_size) ||
+        (compressed && (file_values.version < 2 || !section_fits(file_values.compressed_offset, file_values.compressed_size, file_size))) ||
+        (!compressed && (file_values.vertex_count > file_size / value_size ||
+            !section_fits(file_values.x_offset, vertex_bytes, file_size) ||
+            !section_fits(file_values.y_offset, vertex_bytes, file_size) ||
+            (has_time && !section_fits(file_values.t_offset, vertex_bytes, file_size)))) ||
+        (has_trees && !section_fits(file_values.nodes_offset, file_values.node_count * sizeof(Flat_Segment_Search_Tree_Node), file_size)))
+    {
+        error = "archive is truncated or corrupt";
+        return false;
+    }
+
+    header = file_values;
+    entries = reinterpret_cast<const Trajectory_Archive_Entry*>(file.data() + file_values.entries_offset);
+    nodes = has_trees ? reinterpret_cast<const Flat_Segment_Search_Tree_Node*>(file.data() + file_values.nodes_offset) : nullptr;
+
+    return true;
+}
+
+bool Trajectory_Archive::is_entry_valid(const size_t index) const
+{
+    const Trajectory_Archive_Entry& entry = entries[index];
+
+    if (entry.vertex_count < 2)
+    {
+        return false;
+    }
+
+    if (is_compressed())
+    {
+        if (entry.compressed_offset > header.compressed_size)
+        {
+            return false;
+        }
+
+        const Compressed_Trajectory compressed(file.data() + header.compressed_offset + entry.compressed_offset, static_cast<size_t>(header.compressed_size - entry.compressed_offset));
+
+        if (!compressed.is_valid() || compressed.get_vertex_count() != entry.vertex_count || compressed.has_time() != has_time())
+        {
+            return false;
+        }
+    }
+    else if (entry.first_vertex > header.vertex_count || entry.vertex_count > header.vertex_count - entry.first_vertex)
+    {
+        return false;
+    }
+
+    if (has_trees())
+    {
+        return entry.first_node <= header.node_count && entry.node_count <= header.node_count - entry.first_node && entry.node_count == entry.vertex_count * 2 - 3 &&
+            get_tree(index).is_valid();
+    }
+
+    return true;
+}
+
+bool Trajectory_Archive::find(const int64_t trajectory_id, size_t& index) const
+{
+    const Trajectory_Archive_Entry* end = entries + trajectory_count();
+    const Trajectory_Archive_Entry* entry = std::lower_bound(entries, end, trajectory_id, [](const Trajectory_Archive_Entry& entry, const int64_t id) { return entry.trajectory_id < id; });
+
+    if (entry == end || entry->trajectory_id != trajectory_id)
+    {
+        return false;
+    }
+
+    index = static_cast<size_t>(entry - entries);
+    return true;
+}
+
+double Trajectory_Archive::read_value(const uint64_t offset, const size_t i) const
+{
+    if (header.flags & Trajectory_Archive_Header::float64_vertices)
+    {
+        return reinterpret_cast<const double*>(file.data() + offset)[i];
+    }
+
+    return reinterpret_cast<const float*>(file.data() + offset)[i];
+}
+
+Vec2 Trajectory_Archive::get_vertex(const size_t index, const size_t i) const
+{
+    if (is_compressed())
+    {
+        std::vector<float> x, y, t;
+        get_compressed(index).decode(i, i + 1, x, y, t);
+        return Vec2(x[0], y[0]);
+    }
+
+    const size_t vertex = static_cast<size_t>(entries[index].first_vertex) + i;
+    return Vec2(static_cast<float>(read_value(header.x_offset, vertex)), static_cast<float>(read_value(header.y_offset, vertex)));
+}
+
+Float Trajectory_Archive::get_time(const size_t index, const size_t i) const
+{
+    if (is_compressed())
+    {
+        std::vector<float> x, y, t;
+        get_compressed(index).decode(i, i + 1, x, y, t);
+        return t[0];
+    }
+
+    const size_t vertex = static_cast<size_t>(entries[index].first_vertex) + i;
+    return static_cast<float>(read_value(header.t_offset, vertex));
+}
+
+Compressed_Trajectory Trajectory_Archive::get_compressed(const size_t index) const
+{
+    const uint64_t offset = entries[index].compressed_offset;
+    return Compressed_Trajectory(file.data() + header.compressed_offset + offset, static_cast<size_t>(header.compressed_size - offset));
+}
+
+Trajectory Trajectory_Archive::build_trajectory(const size_t index, const bool use_timestamps) const
+{
+    const size_t vertex_count = static_cast<size_t>(entries[index].vertex_count);
+
+    //Decode straight into coordinate arrays
+    if (is_compressed())
+    {
+        std::vector<float> x, y, t;
+        get_compressed(index).decode(x, y, t);
+
+        return Trajectory(x.data(), y.data(), has_time() && use_timestamps ? t.data() : nullptr, vertex_count);
+    }
+
+    if (!has_time() || !use_timestamps)
+    {
+        std::vector<Vec2> points;
+        points.reserve(vertex_count);
+
+        for (size_t i = 0; i < vertex_count; i++)
+        {
+            points.push_back(get_vertex(index, i));
+        }
+
+        return Trajectory(points);
+    }
+
+    std::vector<Segment> segments;
+    segments.reserve(vertex_count - 1);
+
+    Vec2 start = get_vertex(index, 0);
+    Float start_t = get_time(index, 0);
+
+    for (size_t i = 1; i < vertex_count; i++)
+    {
+        const Vec2 end = get_vertex(index, i);
+        const Float end_t = get_time(index, i);
+
+        segments.emplace_back(start, end, start_t, end_t);
+
+        start = end;
+        start_t = end_t;
+    }
+
+    return Trajectory(segments);
+}
+
+Flat_Segment_Search_Tree Trajectory_Archive::get_tree(const size_t index) const
+{
+    const Trajectory_Archive_Entry& entry = entries[index];
+    return Flat_Segment_Search_Tree(nodes + entry.first_node, static_cast<size_t>(entry.node_count));
+}
+
+bool write_trajectory_archive(const char* path, const Trajectory_CSV& trajectories, const Trajectory_Archive_Options& options, std::string& error)
+{
+    //Collect the trajectories with at least one segment, their vertices keep the order of the input
+    std::vector<Trajectory_Archive_Entry> entries;
+    std::vector<size_t> input_indices;
+
+    uint64_t vertex_count = 0;
+    uint64_t node_count = 0;
+
+    for (size_t i = 0; i < trajectories.trajectory_count(); i++)
+    {
+        const uint64_t trajectory_vertex_count = trajectories.trajectory_end(i) - trajectories.trajectory_begin(i);
+
+        if (trajectory_vertex_count < 2)
+        {
+            continue;
+        }
+
+        Trajectory_Archive_Entry entry;
+        entry.trajectory_id = trajectories.trajectory_ids[i];
+        entry.first_vertex = vertex_count;
+        entry.vertex_count = trajectory_vertex_count;
+        entry.first_node = node_count;
+        entry.node_count = options.embed_trees ? trajectory_vertex_count * 2 - 3 : 0;
+
+        entries.push_back(entry);
+        input_indices.push_back(i);
+
+        vertex_count += trajectory_vertex_count;
+        node_count += entry.node_count;
+    }
+
+    //Vertex offsets of the kept trajectories in the input, in output order
+    std::vector<size_t> vertex_sources;
+    vertex_sources.reserve(static_cast<size_t>(vertex_count));
+
+    for (const size_t i : input_indices)
+    {
+        for (size_t vertex = trajectories.trajectory_begin(i); vertex < trajectories.trajectory_end(i); vertex++)
+        {
+            vertex_sources.push_back(vertex);
+        }
+    }
+
+    //Compressed archives encode every trajectory into a blob, in the same order as the vertices
+    std::vector<char> compressed_blobs;
+
+    if (options.compress_vertices)
+    {
+        std::vector<float> x, y, t;
+
+        for (size_t k = 0; k < input_indices.size(); k++)
+        {
+            const size_t begin = trajectories.trajectory_begin(input_indices[k]);
+            const size_t end = trajectories.trajectory_end(input_indices[k]);
+
+            x.clear();
+            y.clear();
+            for (size_t vertex = begin; vertex < end; vertex++)
+            {
+                x.push_back(trajectories.points[vertex].x.get_value());
+                y.push_back(trajectories.points[vertex].y.get_value());
+            }
+
+            if (trajectories.has_time)
+            {
+                t.assign(trajectories.times.begin() + begin, trajectories.times.begin() + end);
+            }
+
+            entries[k].compressed_offset = compressed_blobs.size();
+
+            if (!encode_compressed_trajectory(x.data(), y.data(), trajectories.has_time ? t.data() : nullptr, x.size(), options.compression, compressed_blobs, error))
+            {
+                error = "trajectory " + std::to_string(entries[k].trajectory_id) + ": " + error;
+                return false;
+            }
+        }
+    }
+
+    //Sort the entries by id for lookups, the node ranges move along with them
+    std::vector<size_t> entry_order(entries.size());
+    std::iota(entry_order.begin(), entry_order.end(), 0);
+    std::stable_sort(entry_order.begin(), entry_order.end(), [&entries](const size_t a, const size_t b) { return entries[a].trajectory_id < entries[b].trajectory_id; });
+
+    //Section layout
+    const uint64_t value_size = options.compress_vertices ? 0 : (options.float64_vertices ? 8 : 4);
+
+    Trajectory_Archive_Header header = {};
+    memcpy(header.magic, Trajectory_Archive_Header::archive_magic, sizeof(header.magic));
+    header.version = Trajectory_Archive_Header::current_version;
+    header.flags = (options.float64_vertices ? Trajectory_Archive_Header::float64_vertices : 0) |
+        (trajectories.has_time ? Trajectory_Archive_Header::has_time : 0) |
+        (options.embed_trees ? Trajectory_Archive_Header::has_trees : 0) |
+        (options.compress_vertices ? Trajectory_Archive_Header::compressed_vertices : 0);
+    header.trajectory_count = entries.size();
+    header.vertex_count = vertex_count;
+    header.node_count = node_count;
+
+    header.entries_offset = align_to_8(sizeof(Trajectory_Archive_Header));
+
+    uint64_t vertices_end = header.entries_offset + entries.size() * sizeof(Trajectory_Archive_Entry);
+
+    if (options.compress_vertices)
+    {
+        header.compressed_offset = align_to_8(vertices_end);
+        header.compressed_size = compressed_blobs.size();
+        vertices_end = header.compressed_offset + header.compressed_size;
+    }
+    else
+    {
+        header.x_offset = align_to_8(vertices_end);
+        header.y_offset = align_to_8(header.x_offset + vertex_count * value_size);
+        header.t_offset = trajectories.has_time ? align_to_8(header.y_offset + vertex_count * value_size) : 0;
+        vertices_end = (trajectories.has_time ? header.t_offset : header.y_offset) + vertex_count * value_size;
+    }
+
+    header.nodes_offset = options.embed_trees ? align_to_8(vertices_end) : 0;
+
+    //Archives are mapped by the processes that read them, the archive at path is replaced by a new file instead of overwritten
+    Replacing_File_Writer writer(path);
+    std::ofstream& output = writer.output;
+
+    if (!output)
+    {
+        error = "can't write archive";
+        return false;
+    }
+
+    uint64_t position = 0;
+
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    position += sizeof(header);
+
+    write_padding(output, position, header.entries_offset);
+    for (const size_t i : entry_order)
+    {
+        output.write(reinterpret_cast<const char*>(&entries[i]), sizeof(Trajectory_Archive_Entry));
+    }
+    position = header.entries_offset + entries.size() * sizeof(Trajectory_Archive_Entry);
+
+    if (options.compress_vertices)
+    {
+        write_padding(output, position, header.compressed_offset);
+        output.write(compressed_blobs.data(), static_cast<std::streamsize>(compressed_blobs.size()));
+        position = header.compressed_offset + compressed_blobs.size();
+    }
+    else
+    {
+        //Coordinate arrays
+        const size_t count = vertex_sources.size();
+        const auto get_x = [&](const size_t i) { return trajectories.points[vertex_sources[i]].x.get_value(); };
+        const auto get_y = [&](const size_t i) { return trajectories.points[vertex_sources[i]].y.get_value(); };
+        const auto get_t = [&](const size_t i) { return trajectories.times[vertex_sources[i]]; };
+
+        const uint64_t array_offsets[3] = { header.x_offset, header.y_offset, header.t_offset };
+        const int array_count = trajectories.has_time ? 3 : 2;
+
+        for (int array = 0; array < array_count; array++)
+        {
+            write_padding(output, position, array_offsets[array]);
+
+            if (options.float64_vertices)
+            {
+                if (array == 0) write_values<double>(output, count, get_x);
+                else if (array == 1) write_values<double>(output, count, get_y);
+                else write_values<double>(output, count, get_t);
+            }
+            else
+            {
+                if (array == 0) write_values<float>(output, count, get_x);
+                else if (array == 1) write_values<float>(output, count, get_y);
+                else write_values<float>(output, count, get_t);
+            }
+
+            position = array_offsets[array] + count * value_size;
+        }
+    }
+
+    //Trees, in the same order as the vertices
+    if (options.embed_trees)
+    {
+        write_padding(output, position, header.nodes_offset);
+
+        std::vector<float> x, y, t;
+
+        for (size_t k = 0; k < input_indices.size(); k++)
+        {
+            //Compressed trees are built from the decoded vertices, so they match the trajectories read back from the archive
+            Trajectory trajectory;
+            if (options.compress_vertices)
+            {
+                const Compressed_Trajectory compressed(compressed_blobs.data() + entries[k].compressed_offset, compressed_blobs.size() - static_cast<size_t>(entries[k].compressed_offset));
+                compressed.decode(x, y, t);
+                trajectory = Trajectory(x.data(), y.data(), trajectories.has_time ? t.data() : nullptr, x.size());
+            }
+            else
+            {
+                trajectory = trajectories.build_trajectory(input_indices[k]);
+            }
+
+            const std::vector<Flat_Segment_Search_Tree_Node> tree_nodes = Flat_Segment_Search_Tree::build_nodes(trajectory.get_ordered_trajectory_segments());
+
+            output.write(reinterpret_cast<const char*>(tree_nodes.data()), static_cast<std::streamsize>(tree_nodes.size() * sizeof(Flat_Segment_Search_Tree_Node)));
+        }
+    }
+
+    output.flush();
+
+    if (!output)
+    {
+        error = "failed writing archive";
+        return false;
+    }
+
+    return writer.commit(error);
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "memory_mapped_file.h"
+#include "compressed_trajectory.h"
+
+class Trajectory;
+class Trajectory_CSV;
+
+//Binary container for many trajectories, opened through a memory mapping without copying or parsing
+//
+//Layout, all values little-endian and every section aligned to 8 bytes:
+//  Trajectory_Archive_Header
+//  Trajectory_Archive_Entry[trajectory_count], sorted by trajectory id
+//  x[vertex_count], y[vertex_count], and t[vertex_count] if the archive has times, as float32 or float64
+//  or, for compressed archives, one Compressed_Trajectory blob per trajectory
+//  Flat_Segment_Search_Tree_Node[node_count] if the archive has trees
+//Version 1 archives have no compressed section and a shorter header without its offset and size
+class Trajectory_Archive_Header
+{
+public:
+
+    static constexpr char archive_magic[8] = { 'T', 'H', 'T', 'R', 'A', 'J', 'A', 'R' };
+    static constexpr uint32_t current_version = 2;
+
+    //Flags
+    static constexpr uint32_t float64_vertices = 1;
+    static constexpr uint32_t has_time = 2;
+    static constexpr uint32_t has_trees = 4;
+    static constexpr uint32_t compressed_vertices = 8;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+
+    uint64_t trajectory_count;
+    uint64_t vertex_count;
+    uint64_t node_count;
+
+    //Byte offsets of the sections from the start of the file
+    uint64_t entries_offset;
+    uint64_t x_offset;
+    uint64_t y_offset;
+    uint64_t t_offset;
+    uint64_t nodes_offset;
+
+    //Version 2
+    uint64_t compressed_offset;
+    uint64_t compressed_size;
+};
+
+static_assert(sizeof(Trajectory_Archive_Header) == 96, "Trajectory_Archive_Header is part of the file format, its layout must not change");
+
+class Trajectory_Archive_Entry
+{
+public:
+
+    int64_t trajectory_id;
+
+    //Range of the trajectory in the vertex arrays, or for compressed archives the byte offset of its blob in the compressed section
+    union
+    {
+        uint64_t first_vertex;
+        uint64_t compressed_offset;
+    };
+    uint64_t vertex_count;
+
+    //Range of the trajectory's segment search tree in the node array, node_count is 0 without trees
+    uint64_t first_node;
+    uint64_t node_count;
+};
+
+static_assert(sizeof(Trajectory_Archive_Entry) == 40, "Trajectory_Archive_Entry is part of the file format, its layout must not change");
+
+class Trajectory_Archive_Options
+{
+public:
+
+    //Store the vertices as float64 instead of float32
+    bool float64_vertices = false;
+
+    //Embed a serialized segment search tree for each trajectory
+    bool embed_trees = false;
+
+    //Store the vertices as quantized deltas instead of arrays, float64_vertices is ignored
+    bool compress_vertices = false;
+    Compressed_Trajectory_Options compression;
+};
+
+//Read-only view of an archive file
+//Opening only validates the header and section bounds, trajectories are read on access
+//Use is_entry_valid before accessing a trajectory of an archive that may be corrupt
+class Trajectory_Archive
+{
+public:
+
+    //Maps the archive at path, returns false and sets error if it can't be opened or isn't a valid archive
+    bool open(const char* path, std::string& error);
+
+    //Returns true if the data starts like an archive
+    static bool is_archive(const char* data, const size_t size);
+
+    size_t trajectory_count() const { return static_cast<size_t>(header.trajectory_count); }
+
+    bool has_time() const { return (header.flags & Trajectory_Archive_Header::has_time) != 0; }
+    bool has_trees() const { return (header.flags & Trajectory_Archive_Header::has_trees) != 0; }
+    bool is_compressed() const { return (header.flags & Trajectory_Archive_Header::compressed_vertices) != 0; }
+
+    const Trajectory_Archive_Entry& get_entry(const size_t index) const { return entries[index]; }
+
+    //Checks that the vertex and node ranges of the trajectory at index lie inside the archive, and that its compressed blob and tree are intact
+    bool is_entry_valid(const size_t index) const;
+
+    //Finds the trajectory with the given id with a binary search, returns false if there is none
+    bool find(const int64_t trajectory_id, size_t& index) const;
+
+    //Returns vertex i of the trajectory at index, compressed archives decode the block holding the vertex
+    Vec2 get_vertex(const size_t index, const size_t i) const;
+    Float get_time(const size_t index, const size_t i) const;
+
+    //Returns the compressed vertices of the trajectory at index, for decoding ranges, the archive must be compressed
+    Compressed_Trajectory get_compressed(const size_t index) const;
+
+    //Builds the trajectory at index, times are taken from the archive if present and use_timestamps is true, else the length along the trajectory is used
+    //The fixed length queries measure the length in time, so they need the latter. The trajectory needs at least two vertices
+    Trajectory build_trajectory(const size_t index, const bool use_timestamps = true) const;
+
+    //Returns the embedded segment search tree of the trajectory at index, which is queried in place
+    //The archive needs trees and must outlive the returned tree
+    Flat_Segment_Search_Tree get_tree(const size_t index) const;
+
+private:
+
+    double read_value(const uint64_t offset, const size_t i) const;
+
+    Memory_Mapped_File file;
+
+    //Copied from the file, so version 1 headers read the same
+    Trajectory_Archive_Header header = {};
+    const Trajectory_Archive_Entry* entries = nullptr;
+    const Flat_Segment_Search_Tree_Node* nodes = nullptr;
+};
+
+//Converts parsed CSV trajectories to an archive at path, returns false and sets error on failure
+//Trajectories with less than two vertices are skipped
+bool write_trajectory_archive(const char* path, const Trajectory_CSV& trajectories, const Trajectory_Archive_Options& options, std::string& error);
@@ -0,0 +1,164 @@
+#include "pch.h"
+#include "trajectory_batch.h"
+
+Trajectory_Batch_Engine::Trajectory_Batch_Engine(const size_t thread_count)
+{
+    const size_t worker_count = thread_count != 0 ? thread_count : std::max(1u, std::thread::hardware_concurrency());
+
+    for (size_t i = 0; i < worker_count; i++)
+    {
+        workers.push_back(std::make_unique<Worker>());
+    }
+
+    //Started after all workers exist, so none of them sees the vector change
+    for (const std::unique_ptr<Worker>& worker : workers)
+    {
+        worker->thread = std::thread(&Trajectory_Batch_Engine::work, this, std::ref(*worker));
+    }
+}
+
+Trajectory_Batch_Engine::~Trajectory_Batch_Engine()
+{
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    work_ready.notify_all();
+
+    for (const std::unique_ptr<Worker>& worker : workers)
+    {
+        worker->thread.join();
+    }
+}
+
+bool Trajectory_Batch_Engine::run(const Trajectory_Batch& batch, const Trajectory_Batch_Query& query, AABB* results, std::string& error)
+{
+    if (batch.trajectory_count == 0)
+    {
+        return true;
+    }
+
+    if (batch.x == nullptr || batch.y == nullptr || batch.offsets == nullptr || results == nullptr)
+    {
+        error = "the batch needs x, y, offsets and results";
+        return false;
+    }
+
+    for (size_t i = 0; i < batch.trajectory_count; i++)
+    {
+        if (batch.offsets[i + 1] < batch.offsets[i])
+        {
+            error = "offset " + std::to_string(i + 1) + " is smaller than the one before it";
+            return false;
+        }
+    }
+
+    const std::lock_guard<std::mutex> run_lock(run_mutex);
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    this->batch = &batch;
+    this->query = &query;
+    this->results = results;
+    this->error.clear();
+
+    next_trajectory.store(0, std::memory_order_relaxed);
+    busy_workers = workers.size();
+    generation++;
+
+    work_ready.notify_all();
+    work_done.wait(lock, [this]() { return busy_workers == 0; });
+
+    this->batch = nullptr;
+    this->query = nullptr;
+    this->results = nullptr;
+
+    if (!this->error.empty())
+    {
+        error = this->error;
+        return false;
+    }
+
+    return true;
+}
+
+void Trajectory_Batch_Engine::work(Worker& worker)
+{
+    uint64_t last_generation = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            work_ready.wait(lock, [&]() { return stopping || generation != last_generation; });
+
+            if (stopping)
+            {
+                return;
+            }
+
+            last_generation = generation;
+        }
+
+        run_trajectories(worker);
+
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            busy_workers--;
+        }
+
+        work_done.notify_one();
+    }
+}
+
+void Trajectory_Batch_Engine::run_trajectories(Worker& worker)
+{
+    //Set before the workers were woken, and constant until they are all done
+    const Trajectory_Batch& batch = *this->batch;
+    const Trajectory_Batch_Query& query = *this->query;
+
+    while (true)
+    {
+        const size_t i = next_trajectory.fetch_add(1, std::memory_order_relaxed);
+
+        if (i >= batch.trajectory_count)
+        {
+            return;
+        }
+
+        const size_t first_vertex = batch.offsets[i];
+        const size_t vertex_count = batch.offsets[i + 1] - first_vertex;
+
+        if (vertex_count < 2)
+        {
+            results[i] = AABB();
+            continue;
+        }
+
+        try
+        {
+            //The length queries measure the length along the trajectory in time, so they ignore the timestamps
+            const bool use_timestamps = batch.t != nullptr && hotspot_query_uses_timestamps(query.query);
+
+            worker.trajectory.assign(batch.x + first_vertex, batch.y + first_vertex, use_timestamps ? batch.t + first_vertex : nullptr, vertex_count);
+
+            results[i] = run_hotspot_query(worker.trajectory, query.query, query.parameter, &worker.arena);
+
+            //The query rewound the arena, merge the chunks it grew so the next trajectories allocate from one chunk
+            worker.arena.reset();
+        }
+        catch (const std::exception& exception)
+        {
+            worker.arena.reset();
+            results[i] = AABB();
+
+            //The first error is reported, the other trajectories still run
+            const std::lock_guard<std::mutex> lock(mutex);
+            if (error.empty())
+            {
+                error = "trajectory " + std::to_string(i) + ": " + exception.what();
+            }
+        }
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "trajectory.h"
+#include "hotspot_query.h"
+
+//Many trajectories in one vertex buffer, trajectory i has the vertices [offsets[i], offsets[i + 1])
+//The buffers are not copied, they have to outlive the run of the batch
+class Trajectory_Batch
+{
+public:
+
+    const float* x = nullptr;
+    const float* y = nullptr;
+
+    //nullptr to set times with the length along each trajectory, the length queries always do and ignore the timestamps
+    const float* t = nullptr;
+
+    //trajectory_count + 1 offsets, increasing
+    const size_t* offsets = nullptr;
+    size_t trajectory_count = 0;
+};
+
+//The query that runs on every trajectory of a batch, the parameter is the radius or the length
+class Trajectory_Batch_Query
+{
+public:
+
+    Hotspot_Query query = Hotspot_Query::fixed_length_contiguous;
+    Float parameter = 0.f;
+};
+
+//Runs a query on every trajectory of a batch on a pool of worker threads
+//Every worker reuses its trajectory and a scratch arena for the trees and maps of the queries across trajectories,
+//so once they have grown to the largest trip the trajectories themselves don't allocate.
+//Workers take the next trajectory when they finish one, so trips of very different sizes spread evenly.
+class Trajectory_Batch_Engine
+{
+public:
+
+    //0 threads starts one per hardware thread
+    explicit Trajectory_Batch_Engine(const size_t thread_count = 0);
+    ~Trajectory_Batch_Engine();
+
+    Trajectory_Batch_Engine(const Trajectory_Batch_Engine&) = delete;
+    Trajectory_Batch_Engine& operator=(const Trajectory_Batch_Engine&) = delete;
+
+    size_t get_thread_count() const { return workers.size(); }
+
+    //Writes the hotspot of trajectory i to results[i], results has to hold trajectory_count hotspots
+    //Trajectories with fewer than two vertices get an empty AABB.
+    //Returns false and sets error if the offsets are invalid or a query failed, calls from several threads run one after the other
+    bool run(const Trajectory_Batch& batch, const Trajectory_Batch_Query& query, AABB* results, std::string& error);
+
+private:
+
+    struct Worker
+    {
+        std::thread thread;
+        Trajectory trajectory;
+        Scratch_Arena arena;
+    };
+
+    void work(Worker& worker);
+    void run_trajectories(Worker& worker);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    std::mutex run_mutex;
+
+    //Guards everything below
+    std::mutex mutex;
+    std::condition_variable work_ready;
+    std::condition_variable work_done;
+
+    //Incremented for every run, workers wait for a new one
+    uint64_t generation = 0;
+    size_t busy_workers = 0;
+    bool stopping = false;
+
+    const Trajectory_Batch* batch = nullptr;
+    const Trajectory_Batch_Query* query = nullptr;
+    AABB* results = nullptr;
+    std::string error;
+
+    std::atomic<size_t> next_trajectory{ 0 };
+};
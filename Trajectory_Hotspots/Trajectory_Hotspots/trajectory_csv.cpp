@@ -0,0 +1,321 @@
+#include "pch.h"
+#include "trajectory_csv.h"
+#include "trajectory.h"
+
+#include <charconv>
+#include <unordered_set>
+
+namespace
+{
+    enum class CSV_Column
+    {
+        x,
+        y,
+        t,
+        trajectory_id,
+        ignored
+    };
+
+    inline bool is_space(const char c)
+    {
+        return c == ' ' || c == '\t';
+    }
+
+    //Returns the end of the line starting at position, excluding the line break
+    inline const char* line_end(const char* position, const char* end)
+    {
+        const void* line_break = memchr(position, '\n', static_cast<size_t>(end - position));
+        return line_break != nullptr ? static_cast<const char*>(line_break) : end;
+    }
+
+    //Trims spaces, tabs, and a trailing carriage return of the field [begin, end)
+    inline void trim(const char*& begin, const char*& end)
+    {
+        while (begin < end && is_space(*begin)) begin++;
+        while (end > begin && (is_space(end[-1]) || end[-1] == '\r')) end--;
+    }
+
+    //A line is a header if its first field doesn't start like a number
+    bool is_header(const char* begin, const char* end)
+    {
+        trim(begin, end);
+
+        if (begin == end)
+        {
+            return false;
+        }
+
+        const char c = *begin;
+        return !((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.');
+    }
+
+    bool parse_header(const char* begin, const char* end, std::vector<CSV_Column>& columns, std::string& error)
+    {
+        while (true)
+        {
+            const char* field_end = static_cast<const char*>(memchr(begin, ',', static_cast<size_t>(end - begin)));
+            const char* next = field_end != nullptr ? field_end + 1 : end;
+            if (field_end == nullptr) field_end = end;
+
+            const char* name_begin = begin;
+            const char* name_end = field_end;
+            trim(name_begin, name_end);
+
+            const std::string name(name_begin, name_end);
+
+            if (name == "x") columns.push_back(CSV_Column::x);
+            else if (name == "y") columns.push_back(CSV_Column::y);
+            else if (name == "t" || name == "time") columns.push_back(CSV_Column::t);
+            else if (name == "trajectory_id" || name == "id") columns.push_back(CSV_Column::trajectory_id);
+            else columns.push_back(CSV_Column::ignored);
+
+            if (next == end)
+            {
+                break;
+            }
+
+            begin = next;
+        }
+
+        if (std::count(columns.begin(), columns.end(), CSV_Column::x) != 1 || std::count(columns.begin(), columns.end(), CSV_Column::y) != 1)
+        {
+            error = "header needs exactly one x and one y column";
+            return false;
+        }
+
+        if (std::count(columns.begin(), columns.end(), CSV_Column::t) > 1 || std::count(columns.begin(), columns.end(), CSV_Column::trajectory_id) > 1)
+        {
+            error = "header has duplicate t or trajectory_id columns";
+            return false;
+        }
+
+        return true;
+    }
+
+    //Columns in order x,y[,t][,trajectory_id] for a file without header
+    bool default_columns(const char* begin, const char* end, std::vector<CSV_Column>& columns, std::string& error)
+    {
+        const size_t field_count = std::count(begin, end, ',') + 1;
+
+        if (field_count < 2 || field_count > 4)
+        {
+            error = "expected 2 to 4 columns (x,y[,t][,trajectory_id])";
+            return false;
+        }
+
+        const CSV_Column order[] = { CSV_Column::x, CSV_Column::y, CSV_Column::t, CSV_Column::trajectory_id };
+        columns.assign(order, order + field_count);
+
+        return true;
+    }
+
+    //Parses the number at position and moves position past it and any spaces after it
+    template<typename T>
+    inline bool parse_number(const char*& position, const char* end, T& value)
+    {
+        while (position < end && is_space(*position)) position++;
+
+        //from_chars doesn't accept a leading plus sign
+        if (position < end && *position == '+') position++;
+
+        const std::from_chars_result result = std::from_chars(position, end, value);
+        if (result.ec != std::errc())
+        {
+            return false;
+        }
+
+        position = result.ptr;
+        while (position < end && (is_space(*position) || *position == '\r')) position++;
+
+        return true;
+    }
+
+    //Moves position to the separator after the field
+    inline void skip_field(const char*& position, const char* end)
+    {
+        while (position < end && *position != ',' && *position != '\n') position++;
+    }
+}
+
+void Trajectory_CSV::clear()
+{
+    has_time = false;
+    has_trajectory_id = false;
+    points.clear();
+    times.clear();
+    trajectory_ids.clear();
+    trajectory_offsets.clear();
+    repeated_trajectory_ids.clear();
+}
+
+bool Trajectory_CSV::parse(const char* text, const size_t text_size, std::string& error)
+{
+    clear();
+
+    const char* position = text;
+    const char* const end = text + text_size;
+
+    //Skip a UTF-8 byte order mark
+    if (text_size >= 3 && memcmp(text, "\xEF\xBB\xBF", 3) == 0)
+    {
+        position += 3;
+    }
+
+    //Skip blank lines in front of the first line
+    while (position < end && (*position == '\n' || *position == '\r'))
+    {
+        position++;
+    }
+
+    if (position == end)
+    {
+        trajectory_offsets.push_back(0);
+        return true;
+    }
+
+    std::vector<CSV_Column> columns;
+    size_t line_number = 1;
+
+    const char* first_line_end = line_end(position, end);
+    if (is_header(position, first_line_end))
+    {
+        if (!parse_header(position, first_line_end, columns, error))
+        {
+            return false;
+        }
+
+        position = first_line_end < end ? first_line_end + 1 : end;
+        line_number++;
+    }
+    else if (!default_columns(position, first_line_end, columns, error))
+    {
+        return false;
+    }
+
+    has_time = std::find(columns.begin(), columns.end(), CSV_Column::t) != columns.end();
+    has_trajectory_id = std::find(columns.begin(), columns.end(), CSV_Column::trajectory_id) != columns.end();
+
+    //Size the buffers once so the row loop doesn't allocate, every line holds at most one row
+    const size_t line_estimate = std::count(position, end, '\n') + 1;
+    points.reserve(line_estimate);
+    if (has_time)
+    {
+        times.reserve(line_estimate);
+    }
+
+    //Ids that started a trajectory, to find ids that appear again after rows with other ids
+    std::unordered_set<int64_t> seen_trajectory_ids;
+
+    //Single pass over the rows, each field is parsed in place and followed by a separator
+    while (position < end)
+    {
+        //Skip blank lines
+        const char* line_start = position;
+        while (line_start < end && (is_space(*line_start) || *line_start == '\r')) line_start++;
+
+        if (line_start == end)
+        {
+            break;
+        }
+
+        if (*line_start == '\n')
+        {
+            position = line_start + 1;
+            line_number++;
+            continue;
+        }
+
+        float x = 0.f;
+        float y = 0.f;
+        float t = 0.f;
+        int64_t trajectory_id = 0;
+
+        for (size_t column = 0; column < columns.size(); column++)
+        {
+            bool parsed = true;
+
+            switch (columns[column])
+            {
+            case CSV_Column::x: parsed = parse_number(position, end, x); break;
+            case CSV_Column::y: parsed = parse_number(position, end, y); break;
+            case CSV_Column::t: parsed = parse_number(position, end, t); break;
+            case CSV_Column::trajectory_id: parsed = parse_number(position, end, trajectory_id); break;
+            case CSV_Column::ignored: skip_field(position, end); break;
+            }
+
+            const bool last_column = column + 1 == columns.size();
+            const bool at_line_end = position == end || *position == '\n';
+
+            if (parsed && (last_column ? at_line_end : (position < end && *position == ',')))
+            {
+                //Step over the separator
+                if (position < end) position++;
+                continue;
+            }
+
+            if (parsed && at_line_end)
+            {
+                error = "line " + std::to_string(line_number) + ": expected " + std::to_string(columns.size()) + " columns";
+            }
+            else
+            {
+                error = "line " + std::to_string(line_number) + ": invalid value in column " + std::to_string(column + 1);
+            }
+
+            return false;
+        }
+
+        //Start a new trajectory on the first row and when the id changes
+        if (trajectory_ids.empty() || trajectory_ids.back() != trajectory_id)
+        {
+            if (!seen_trajectory_ids.insert(trajectory_id).second &&
+                std::find(repeated_trajectory_ids.begin(), repeated_trajectory_ids.end(), trajectory_id) == repeated_trajectory_ids.end())
+            {
+                repeated_trajectory_ids.push_back(trajectory_id);
+            }
+
+            trajectory_ids.push_back(trajectory_id);
+            trajectory_offsets.push_back(points.size());
+        }
+        //Every step of a trajectory has to move forward in time, without a t column the time is the length along the trajectory
+        else if (has_time ? !(t > times.back()) : (x == points.back().x.get_value() && y == points.back().y.get_value()))
+        {
+            error = "line " + std::to_string(line_number) + ": " + (has_time ? "time doesn't increase" : "point repeats the previous point") +
+                " in trajectory " + std::to_string(trajectory_id);
+            return false;
+        }
+
+        points.emplace_back(x, y);
+        if (has_time)
+        {
+            times.push_back(t);
+        }
+
+        line_number++;
+    }
+
+    trajectory_offsets.push_back(points.size());
+
+    return true;
+}
+
+Trajectory Trajectory_CSV::build_trajectory(const size_t i, const bool use_timestamps) const
+{
+    const size_t begin = trajectory_begin(i);
+    const size_t end = trajectory_end(i);
+
+    if (!has_time || !use_timestamps)
+    {
+        return Trajectory(std::vector<Vec2>(points.begin() + begin, points.begin() + end));
+    }
+
+    std::vector<Segment> segments;
+    segments.reserve(end - begin - 1);
+
+    for (size_t vertex = begin; vertex + 1 < end; vertex++)
+    {
+        segments.emplace_back(points[vertex], points[vertex + 1], times[vertex], times[vertex + 1]);
+    }
+
+    return Trajectory(segments);
+}
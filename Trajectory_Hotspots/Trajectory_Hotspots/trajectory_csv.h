@@ -0,0 +1,46 @@
+#pragma once
+
+class Trajectory;
+
+//Trajectories read from CSV text with the columns x,y[,t][,trajectory_id]
+//All vertices are stored in one buffer, consecutive rows with the same trajectory id form one trajectory
+class Trajectory_CSV
+{
+public:
+
+    //Parses the text, returns false and sets error on malformed input
+    //Rows with a time that doesn't increase within a trajectory, or without a t column a point equal to the previous one, are malformed
+    //A header line is optional, with a header the columns may be in any order (names x, y, t or time, trajectory_id or id)
+    //Without a header 2 columns are x,y, 3 columns x,y,t, and 4 columns x,y,t,trajectory_id
+    bool parse(const char* text, const size_t text_size, std::string& error);
+
+    void clear();
+
+    size_t trajectory_count() const { return trajectory_ids.size(); }
+    size_t vertex_count() const { return points.size(); }
+
+    //Returns the range [begin, end) of the vertices of trajectory i
+    size_t trajectory_begin(const size_t i) const { return trajectory_offsets[i]; }
+    size_t trajectory_end(const size_t i) const { return trajectory_offsets[i + 1]; }
+
+    //Builds trajectory i, times are taken from the t column if present and use_timestamps is true, else the length along the trajectory is used
+    //The fixed length queries measure the length in time, so they need the latter. Trajectory i needs at least two vertices
+    Trajectory build_trajectory(const size_t i, const bool use_timestamps = true) const;
+
+    bool has_time = false;
+    bool has_trajectory_id = false;
+
+    std::vector<Vec2> points;
+
+    //Empty if there is no t column, else one time per vertex
+    std::vector<float> times;
+
+    //One id per trajectory, 0 if there is no trajectory_id column
+    std::vector<int64_t> trajectory_ids;
+
+    //Start offset of every trajectory into points, followed by the total vertex count
+    std::vector<size_t> trajectory_offsets;
+
+    //Ids that appear again after rows with other ids, each run of consecutive rows is read as its own trajectory
+    std::vector<int64_t> repeated_trajectory_ids;
+};
@@ -0,0 +1,226 @@
+#include "pch.h"
+#include "vec2.h"
+#include "trajectory.h"
+#include "trajectory_generator.h"
+
+namespace
+{
+    const Trajectory_Shape all_shapes[] = { Trajectory_Shape::random_walk, Trajectory_Shape::levy_flight, Trajectory_Shape::vehicle, Trajectory_Shape::degenerate };
+
+    //The standard distributions differ between standard libraries, only the engine is fully specified
+    //These give the same numbers everywhere, so a seed gives the same trajectory on every platform
+
+    //Uniform in [0, 1)
+    float random_unit(std::mt19937& generator)
+    {
+        return static_cast<float>(generator() >> 8) * (1.f / 16777216.f);
+    }
+
+    float random_uniform(std::mt19937& generator, const float min, const float max)
+    {
+        return min + (max - min) * random_unit(generator);
+    }
+
+    //Normal distribution with the Box-Muller transform
+    float random_normal(std::mt19937& generator, const float standard_deviation)
+    {
+        const float u = 1.f - random_unit(generator);
+        const float v = random_unit(generator);
+
+        return standard_deviation * sqrtf(-2.f * logf(u)) * cosf(6.2831853f * v);
+    }
+
+    int random_int(std::mt19937& generator, const int min, const int max)
+    {
+        return min + static_cast<int>(generator() % static_cast<uint32_t>(max - min + 1));
+    }
+
+    void generate_random_walk(std::mt19937& generator, Synthetic_Trajectory& result)
+    {
+        float x = 0.f;
+        float y = 0.f;
+
+        for (size_t i = 0; i < result.x.size(); i++)
+        {
+            result.x[i] = x;
+            result.y[i] = y;
+
+            x += random_uniform(generator, -1.f, 1.f);
+            y += random_uniform(generator, -1.f, 1.f);
+        }
+    }
+
+    void generate_levy_flight(std::mt19937& generator, Synthetic_Trajectory& result)
+    {
+        //Pareto distributed step lengths with exponent 1.5, capped so coordinates stay far from the float limits
+        const float alpha = 1.5f;
+        const float min_step = 0.35f;
+        const float max_step = 1000.f;
+
+        float x = 0.f;
+        float y = 0.f;
+
+        for (size_t i = 0; i < result.x.size(); i++)
+        {
+            result.x[i] = x;
+            result.y[i] = y;
+
+            const float step = std::min(max_step, min_step * powf(1.f - random_unit(generator), -1.f / alpha));
+            const float direction = random_uniform(generator, 0.f, 6.2831853f);
+
+            x += step * cosf(direction);
+            y += step * sinf(direction);
+        }
+    }
+
+    void generate_vehicle(std::mt19937& generator, Synthetic_Trajectory& result)
+    {
+        float x = 0.f;
+        float y = 0.f;
+        float heading = 0.f;
+        float speed = 1.f;
+        size_t stop_remaining = 0;
+
+        for (size_t i = 0; i < result.x.size(); i++)
+        {
+            result.x[i] = x + random_normal(generator, 0.05f);
+            result.y[i] = y + random_normal(generator, 0.05f);
+
+            if (stop_remaining > 0)
+            {
+                stop_remaining--;
+                continue;
+            }
+
+            //About one stop every 300 vertices, between 30 seconds and 5 minutes
+            if (random_unit(generator) < 1.f / 300.f)
+            {
+                stop_remaining = 30 + static_cast<size_t>(random_unit(generator) * 270.f);
+                speed = 0.f;
+                continue;
+            }
+
+            //Accelerate towards a cruising speed of about 1.2, with sharper turns at low speeds like at crossings
+            speed = std::min(1.6f, speed + 0.1f * random_unit(generator) + (speed < 1.2f ? 0.05f : -0.05f));
+            heading += random_normal(generator, 0.05f) / std::max(speed, 0.2f);
+
+            x += speed * cosf(heading);
+            y += speed * sinf(heading);
+        }
+    }
+
+    void generate_degenerate(std::mt19937& generator, Synthetic_Trajectory& result)
+    {
+        //Lines through the origin: horizontal, vertical and diagonal
+        const int directions[3][2] = { { 1, 0 }, { 0, 1 }, { 1, 1 } };
+
+        int line = 0;
+        int position = 0;
+        int direction = 1;
+
+        for (size_t i = 0; i < result.x.size(); i++)
+        {
+            //Coordinates on a grid of 0.5, so the same values keep coming back exactly
+            result.x[i] = 0.5f * static_cast<float>(position * directions[line][0]);
+            result.y[i] = 0.5f * static_cast<float>(position * directions[line][1]);
+
+            const int action = random_int(generator, 0, 15);
+
+            if (action < 3)
+            {
+                //Repeat the point
+                continue;
+            }
+
+            if (action == 3 && position == 0)
+            {
+                //Switch to another line at the origin, all lines cross there
+                line = (line + 1) % 3;
+                continue;
+            }
+
+            if (action < 6)
+            {
+                direction = -direction;
+            }
+
+            //Stay near the origin so the segments overlap
+            position += direction * random_int(generator, 1, 4);
+
+            if (position > 40 || position < -40)
+            {
+                direction = -direction;
+                position = std::max(-40, std::min(40, position));
+            }
+        }
+    }
+}
+
+Trajectory Synthetic_Trajectory::build_trajectory(const bool use_timestamps) const
+{
+    return Trajectory(x.data(), y.data(), use_timestamps ? t.data() : nullptr, x.size());
+}
+
+Synthetic_Trajectory generate_trajectory(const Trajectory_Shape shape, const size_t vertex_count, const unsigned int seed)
+{
+    std::mt19937 generator(seed);
+
+    Synthetic_Trajectory result;
+    result.x.resize(vertex_count);
+    result.y.resize(vertex_count);
+    result.t.resize(vertex_count);
+
+    for (size_t i = 0; i < vertex_count; i++)
+    {
+        result.t[i] = static_cast<float>(i);
+    }
+
+    switch (shape)
+    {
+    case Trajectory_Shape::random_walk:
+        generate_random_walk(generator, result);
+        break;
+    case Trajectory_Shape::levy_flight:
+        generate_levy_flight(generator, result);
+        break;
+    case Trajectory_Shape::vehicle:
+        generate_vehicle(generator, result);
+        break;
+    case Trajectory_Shape::degenerate:
+        generate_degenerate(generator, result);
+        break;
+    }
+
+    return result;
+}
+
+const char* trajectory_shape_name(const Trajectory_Shape shape)
+{
+    switch (shape)
+    {
+    case Trajectory_Shape::random_walk:
+        return "random_walk";
+    case Trajectory_Shape::levy_flight:
+        return "levy_flight";
+    case Trajectory_Shape::vehicle:
+        return "vehicle";
+    case Trajectory_Shape::degenerate:
+        return "degenerate";
+    }
+
+    return "";
+}
+
+bool parse_trajectory_shape(const std::string& name, Trajectory_Shape& shape)
+{
+    for (const Trajectory_Shape candidate : all_shapes)
+    {
+        if (name == trajectory_shape_name(candidate))
+        {
+            shape = candidate;
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+class Trajectory;
+
+//Shapes of synthetic trajectories, for benchmarks and tests on data that looks like real input
+enum class Trajectory_Shape
+{
+    //Uniform random steps
+    random_walk,
+    //Random directions with heavy tailed step lengths, long jumps between clusters
+    levy_flight,
+    //Smooth curves with varying speed, GPS noise and stops of up to a few minutes with one vertex per second
+    vehicle,
+    //Back and forth on a few lines with coordinates on a grid, exactly repeated points and collinear overlapping segments
+    degenerate
+};
+
+//Vertices of a synthetic trajectory, the same shape, count and seed always give the same vertices
+//Vertices are one time unit apart and the average step is about one unit, so radii and lengths mean the same on every shape
+struct Synthetic_Trajectory
+{
+    size_t vertex_count() const { return x.size(); }
+
+    //Builds the trajectory with the timestamps as times, or with the length along the trajectory as times when use_timestamps is false
+    //The fixed length queries measure the length in time, so they need the latter
+    Trajectory build_trajectory(const bool use_timestamps) const;
+
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> t;
+};
+
+Synthetic_Trajectory generate_trajectory(const Trajectory_Shape shape, const size_t vertex_count, const unsigned int seed);
+
+const char* trajectory_shape_name(const Trajectory_Shape shape);
+
+//Returns false if the name is not one of the names above
+bool parse_trajectory_shape(const std::string& name, Trajectory_Shape& shape);
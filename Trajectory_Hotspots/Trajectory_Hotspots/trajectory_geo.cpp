@@ -0,0 +1,672 @@
+#include "pch.h"
+#include "vec2.h"
+#include "trajectory_csv.h"
+#include "trajectory_geo.h"
+
+#include <charconv>
+#include <string_view>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    //Mean earth radius in meters
+    constexpr double earth_radius = 6371008.8;
+    constexpr double pi = 3.14159265358979323846;
+
+    //Difference of two longitudes wrapped to [-180, 180], so trajectories crossing the antimeridian stay continuous
+    inline double longitude_difference(const double longitude, const double origin_longitude)
+    {
+        double difference = longitude - origin_longitude;
+
+        if (difference > 180.0) difference -= 360.0;
+        else if (difference < -180.0) difference += 360.0;
+
+        return difference;
+    }
+
+    inline bool is_space(const char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    inline void skip_spaces(const char*& position, const char* end)
+    {
+        while (position < end && is_space(*position)) position++;
+    }
+
+    //Parses the number at position and moves position past it
+    inline bool parse_number(const char*& position, const char* end, double& value)
+    {
+        //from_chars doesn't accept a leading plus sign
+        if (position < end && *position == '+') position++;
+
+        const std::from_chars_result result = std::from_chars(position, end, value);
+        if (result.ec != std::errc())
+        {
+            return false;
+        }
+
+        position = result.ptr;
+        return true;
+    }
+
+    //Parses exactly digit_count digits
+    inline bool parse_digits(const char*& position, const char* end, const int digit_count, int& value)
+    {
+        if (end - position < digit_count)
+        {
+            return false;
+        }
+
+        value = 0;
+        for (int i = 0; i < digit_count; i++)
+        {
+            const char c = position[i];
+            if (c < '0' || c > '9')
+            {
+                return false;
+            }
+
+            value = value * 10 + (c - '0');
+        }
+
+        position += digit_count;
+        return true;
+    }
+
+    //Days since 1970-01-01 of a date in the proleptic Gregorian calendar
+    int64_t days_from_civil(int64_t year, const int64_t month, const int64_t day)
+    {
+        year -= month <= 2;
+        const int64_t era = (year >= 0 ? year : year - 399) / 400;
+        const int64_t year_of_era = year - era * 400;
+        const int64_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        const int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+
+        return era * 146097 + day_of_era - 719468;
+    }
+
+    //Parses an ISO 8601 time as used by GPX, YYYY-MM-DDThh:mm:ss[.fraction][Z|+hh:mm|-hh:mm], to seconds since 1970
+    bool parse_iso8601(const char* position, const char* end, double& seconds)
+    {
+        int year, month, day, hour, minute, second;
+
+        if (!parse_digits(position, end, 4, year) || position == end || *position++ != '-' ||
+            !parse_digits(position, end, 2, month) || position == end || *position++ != '-' ||
+            !parse_digits(position, end, 2, day) || position == end || (*position != 'T' && *position != ' '))
+        {
+            return false;
+        }
+        position++;
+
+        if (!parse_digits(position, end, 2, hour) || position == end || *position++ != ':' ||
+            !parse_digits(position, end, 2, minute) || position == end || *position++ != ':' ||
+            !parse_digits(position, end, 2, second))
+        {
+            return false;
+        }
+
+        seconds = static_cast<double>(days_from_civil(year, month, day)) * 86400.0 + hour * 3600.0 + minute * 60.0 + second;
+
+        if (position < end && *position == '.')
+        {
+            double scale = 0.1;
+            for (position++; position < end && *position >= '0' && *position <= '9'; position++)
+            {
+                seconds += (*position - '0') * scale;
+                scale *= 0.1;
+            }
+        }
+
+        if (position < end && (*position == '+' || *position == '-'))
+        {
+            const double sign = *position == '+' ? 1.0 : -1.0;
+            position++;
+
+            int offset_hour, offset_minute = 0;
+            if (!parse_digits(position, end, 2, offset_hour))
+            {
+                return false;
+            }
+
+            if (position < end && *position == ':') position++;
+            parse_digits(position, end, 2, offset_minute);
+
+            seconds -= sign * (offset_hour * 3600.0 + offset_minute * 60.0);
+        }
+
+        return true;
+    }
+
+    //Collects the points of a reader and projects them in batches into the result
+    class Geo_Point_Sink
+    {
+    public:
+
+        Geo_Point_Sink(Geo_Projection& projection, Trajectory_CSV& result) : projection(projection), result(result)
+        {
+            result.clear();
+            result.has_time = true;
+            result.has_trajectory_id = true;
+        }
+
+        //Points added after this belong to a trajectory with the given id, trajectories without points are dropped
+        void begin_trajectory(const int64_t trajectory_id)
+        {
+            pending_trajectory_id = trajectory_id;
+            trajectory_pending = true;
+        }
+
+        void add(const double latitude, const double longitude, const bool has_time, const double time)
+        {
+            if (!projection.has_origin())
+            {
+                projection = Geo_Projection(latitude, longitude);
+            }
+
+            if (trajectory_pending)
+            {
+                result.trajectory_ids.push_back(pending_trajectory_id);
+                result.trajectory_offsets.push_back(result.points.size() + buffered);
+                trajectory_pending = false;
+            }
+
+            if (has_time && !time_set)
+            {
+                first_time = time;
+                time_set = true;
+            }
+
+            all_times = all_times && has_time;
+            result.times.push_back(has_time ? static_cast<float>(time - first_time) : 0.f);
+
+            latitudes[buffered] = latitude;
+            longitudes[buffered] = longitude;
+            buffered++;
+
+            if (buffered == batch_size)
+            {
+                flush();
+            }
+        }
+
+        void finish()
+        {
+            flush();
+
+            result.trajectory_offsets.push_back(result.points.size());
+
+            if (!all_times || result.points.empty())
+            {
+                result.has_time = false;
+                result.times.clear();
+                result.times.shrink_to_fit();
+            }
+        }
+
+    private:
+
+        void flush()
+        {
+            project_to_local_frame(projection, latitudes, longitudes, buffered, x, y);
+
+            for (size_t i = 0; i < buffered; i++)
+            {
+                result.points.emplace_back(x[i], y[i]);
+            }
+
+            buffered = 0;
+        }
+
+        static constexpr size_t batch_size = 1024;
+
+        Geo_Projection& projection;
+        Trajectory_CSV& result;
+
+        double latitudes[batch_size];
+        double longitudes[batch_size];
+        float x[batch_size];
+        float y[batch_size];
+        size_t buffered = 0;
+
+        int64_t pending_trajectory_id = 0;
+        bool trajectory_pending = true;
+
+        double first_time = 0.0;
+        bool time_set = false;
+        bool all_times = true;
+    };
+
+    //Returns the value of the attribute with the given name in the tag [position, end), or false if it isn't there
+    bool find_attribute(const char* position, const char* end, const char* name, const char*& value_begin, const char*& value_end)
+    {
+        const size_t name_size = strlen(name);
+
+        while (position < end)
+        {
+            skip_spaces(position, end);
+
+            const char* attribute_begin = position;
+            while (position < end && *position != '=' && !is_space(*position) && *position != '>' && *position != '/') position++;
+            const char* attribute_end = position;
+
+            skip_spaces(position, end);
+            if (position == end || *position != '=')
+            {
+                //Not an attribute, step over the character
+                position = attribute_end < end ? attribute_end + 1 : end;
+                continue;
+            }
+            position++;
+            skip_spaces(position, end);
+
+            if (position == end || (*position != '"' && *position != '\''))
+            {
+                return false;
+            }
+
+            const char quote = *position++;
+            const char* quote_end = static_cast<const char*>(memchr(position, quote, static_cast<size_t>(end - position)));
+            if (quote_end == nullptr)
+            {
+                return false;
+            }
+
+            if (static_cast<size_t>(attribute_end - attribute_begin) == name_size && memcmp(attribute_begin, name, name_size) == 0)
+            {
+                value_begin = position;
+                value_end = quote_end;
+                return true;
+            }
+
+            position = quote_end + 1;
+        }
+
+        return false;
+    }
+
+    bool parse_attribute_number(const char* tag_begin, const char* tag_end, const char* name, double& value)
+    {
+        const char* value_begin;
+        const char* value_end;
+
+        if (!find_attribute(tag_begin, tag_end, name, value_begin, value_end))
+        {
+            return false;
+        }
+
+        skip_spaces(value_begin, value_end);
+        return parse_number(value_begin, value_end, value);
+    }
+
+    //Line number of position, only used for error messages
+    size_t line_number(const char* text, const char* position)
+    {
+        return static_cast<size_t>(std::count(text, position, '\n')) + 1;
+    }
+
+    //Finds the next occurrence of the needle in [position, end)
+    const char* find(const char* position, const char* end, const char* needle)
+    {
+        const size_t needle_size = strlen(needle);
+
+        while (static_cast<size_t>(end - position) >= needle_size)
+        {
+            const char* candidate = static_cast<const char*>(memchr(position, needle[0], static_cast<size_t>(end - position) - needle_size + 1));
+            if (candidate == nullptr)
+            {
+                return nullptr;
+            }
+
+            if (memcmp(candidate, needle, needle_size) == 0)
+            {
+                return candidate;
+            }
+
+            position = candidate + 1;
+        }
+
+        return nullptr;
+    }
+}
+
+Geo_Projection::Geo_Projection(const double origin_latitude, const double origin_longitude) :
+    origin_latitude(origin_latitude), origin_longitude(origin_longitude), origin_set(true)
+{
+    meters_per_degree_latitude = earth_radius * pi / 180.0;
+    meters_per_degree_longitude = meters_per_degree_latitude * cos(origin_latitude * pi / 180.0);
+}
+
+Vec2 Geo_Projection::project(const double latitude, const double longitude) const
+{
+    return Vec2(static_cast<float>(longitude_difference(longitude, origin_longitude) * meters_per_degree_longitude), static_cast<float>((latitude - origin_latitude) * meters_per_degree_latitude));
+}
+
+void project_to_local_frame(const Geo_Projection& projection, const double* latitudes, const double* longitudes, const size_t count, float* x, float* y)
+{
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    const __m256d origin_latitude = _mm256_set1_pd(projection.origin_latitude);
+    const __m256d origin_longitude = _mm256_set1_pd(projection.origin_longitude);
+    const __m256d meters_per_degree_latitude = _mm256_set1_pd(projection.meters_per_degree_latitude);
+    const __m256d meters_per_degree_longitude = _mm256_set1_pd(projection.meters_per_degree_longitude);
+
+    const __m256d half_turn = _mm256_set1_pd(180.0);
+    const __m256d minus_half_turn = _mm256_set1_pd(-180.0);
+    const __m256d full_turn = _mm256_set1_pd(360.0);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m256d latitude = _mm256_loadu_pd(latitudes + i);
+        __m256d longitude = _mm256_sub_pd(_mm256_loadu_pd(longitudes + i), origin_longitude);
+
+        //Same wrapping as longitude_difference
+        const __m256d above = _mm256_cmp_pd(longitude, half_turn, _CMP_GT_OQ);
+        const __m256d below = _mm256_cmp_pd(longitude, minus_half_turn, _CMP_LT_OQ);
+        longitude = _mm256_blendv_pd(longitude, _mm256_sub_pd(longitude, full_turn), above);
+        longitude = _mm256_blendv_pd(longitude, _mm256_add_pd(longitude, full_turn), below);
+
+        _mm_storeu_ps(x + i, _mm256_cvtpd_ps(_mm256_mul_pd(longitude, meters_per_degree_longitude)));
+        _mm_storeu_ps(y + i, _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_sub_pd(latitude, origin_latitude), meters_per_degree_latitude)));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        x[i] = static_cast<float>(longitude_difference(longitudes[i], projection.origin_longitude) * projection.meters_per_degree_longitude);
+        y[i] = static_cast<float>((latitudes[i] - projection.origin_latitude) * projection.meters_per_degree_latitude);
+    }
+}
+
+bool parse_gpx(const char* text, const size_t text_size, Geo_Projection& projection, Trajectory_CSV& result, std::string& error)
+{
+    Geo_Point_Sink sink(projection, result);
+
+    const char* position = text;
+    const char* const end = text + text_size;
+
+    int64_t segment_count = 0;
+
+    //State of the trkpt being read
+    bool in_point = false;
+    double latitude = 0.0;
+    double longitude = 0.0;
+    bool point_has_time = false;
+    double point_time = 0.0;
+
+    while (position < end)
+    {
+        const char* tag_begin = static_cast<const char*>(memchr(position, '<', static_cast<size_t>(end - position)));
+        if (tag_begin == nullptr)
+        {
+            break;
+        }
+
+        position = tag_begin + 1;
+
+        //Comments and CDATA may contain '>', skip to their terminator
+        if (end - position >= 3 && memcmp(position, "!--", 3) == 0)
+        {
+            const char* comment_end = find(position, end, "-->");
+            position = comment_end != nullptr ? comment_end + 3 : end;
+            continue;
+        }
+
+        if (end - position >= 8 && memcmp(position, "![CDATA[", 8) == 0)
+        {
+            const char* cdata_end = find(position, end, "]]>");
+            position = cdata_end != nullptr ? cdata_end + 3 : end;
+            continue;
+        }
+
+        const char* tag_end = static_cast<const char*>(memchr(position, '>', static_cast<size_t>(end - position)));
+        if (tag_end == nullptr)
+        {
+            error = "line " + std::to_string(line_number(text, tag_begin)) + ": unterminated tag";
+            return false;
+        }
+
+        const bool closing = *position == '/';
+        if (closing) position++;
+
+        const char* name_begin = position;
+        while (position < tag_end && !is_space(*position) && *position != '/') position++;
+        const char* name_end = position;
+
+        //Ignore namespace prefixes
+        for (const char* c = name_begin; c < name_end; c++)
+        {
+            if (*c == ':') name_begin = c + 1;
+        }
+
+        const std::string_view name(name_begin, static_cast<size_t>(name_end - name_begin));
+        const bool self_closing = tag_end[-1] == '/';
+
+        if (name == "trkpt")
+        {
+            if (!closing)
+            {
+                if (!parse_attribute_number(name_end, tag_end, "lat", latitude) || !parse_attribute_number(name_end, tag_end, "lon", longitude))
+                {
+                    error = "line " + std::to_string(line_number(text, tag_begin)) + ": trkpt needs numeric lat and lon attributes";
+                    return false;
+                }
+
+                in_point = true;
+                point_has_time = false;
+            }
+
+            if (in_point && (closing || self_closing))
+            {
+                sink.add(latitude, longitude, point_has_time, point_time);
+                in_point = false;
+            }
+        }
+        else if (name == "trkseg" && !closing)
+        {
+            sink.begin_trajectory(segment_count++);
+        }
+        else if (name == "time" && !closing && in_point)
+        {
+            const char* value_begin = tag_end + 1;
+            const char* value_end = static_cast<const char*>(memchr(value_begin, '<', static_cast<size_t>(end - value_begin)));
+            if (value_end == nullptr) value_end = end;
+
+            skip_spaces(value_begin, value_end);
+
+            if (!parse_iso8601(value_begin, value_end, point_time))
+            {
+                error = "line " + std::to_string(line_number(text, tag_begin)) + ": invalid time";
+                return false;
+            }
+
+            point_has_time = true;
+        }
+
+        position = tag_end + 1;
+    }
+
+    sink.finish();
+
+    return true;
+}
+
+bool parse_plt(const char* text, const size_t text_size, Geo_Projection& projection, Trajectory_CSV& result, std::string& error)
+{
+    Geo_Point_Sink sink(projection, result);
+    sink.begin_trajectory(0);
+
+    const char* position = text;
+    const char* const end = text + text_size;
+
+    //Skip the header
+    constexpr size_t header_lines = 6;
+    for (size_t i = 0; i < header_lines && position < end; i++)
+    {
+        const char* line_break = static_cast<const char*>(memchr(position, '\n', static_cast<size_t>(end - position)));
+        position = line_break != nullptr ? line_break + 1 : end;
+    }
+
+    size_t line = header_lines + 1;
+
+    for (; position < end; line++)
+    {
+        const char* line_break = static_cast<const char*>(memchr(position, '\n', static_cast<size_t>(end - position)));
+        const char* line_end = line_break != nullptr ? line_break : end;
+
+        const char* field = position;
+        position = line_break != nullptr ? line_break + 1 : end;
+
+        skip_spaces(field, line_end);
+        if (field == line_end)
+        {
+            continue;
+        }
+
+        //latitude,longitude,0,altitude,days since 1899-12-30,date,time
+        double values[5];
+        for (int column = 0; column < 5; column++)
+        {
+            skip_spaces(field, line_end);
+
+            if (!parse_number(field, line_end, values[column]))
+            {
+                error = "line " + std::to_string(line) + ": invalid value in column " + std::to_string(column + 1);
+                return false;
+            }
+
+            const char* separator = static_cast<const char*>(memchr(field, ',', static_cast<size_t>(line_end - field)));
+            if (separator == nullptr && column < 4)
+            {
+                error = "line " + std::to_string(line) + ": expected at least 5 columns";
+                return false;
+            }
+
+            field = separator != nullptr ? separator + 1 : line_end;
+        }
+
+        sink.add(values[0], values[1], true, values[4] * 86400.0);
+    }
+
+    sink.finish();
+
+    return true;
+}
+
+bool parse_geojson(const char* text, const size_t text_size, Geo_Projection& projection, Trajectory_CSV& result, std::string& error)
+{
+    Geo_Point_Sink sink(projection, result);
+
+    const char* position = text;
+    const char* const end = text + text_size;
+
+    int64_t line_count = 0;
+
+    while (const char* key = find(position, end, "\"coordinates\""))
+    {
+        position = key + 13;
+        skip_spaces(position, end);
+
+        //Only a member name is followed by a colon, the same text in a string value is skipped
+        if (position == end || *position != ':')
+        {
+            continue;
+        }
+        position++;
+        skip_spaces(position, end);
+
+        //The nesting depth of the array tells the geometry type, positions are the innermost arrays
+        int depth = 0;
+        for (const char* c = position; c < end && (*c == '[' || is_space(*c)); c++)
+        {
+            if (*c == '[') depth++;
+        }
+
+        if (depth == 0)
+        {
+            error = "line " + std::to_string(line_number(text, key)) + ": coordinates must be an array";
+            return false;
+        }
+
+        int current_depth = 0;
+        bool line_has_points = false;
+
+        do
+        {
+            skip_spaces(position, end);
+
+            if (position == end)
+            {
+                error = "line " + std::to_string(line_number(text, key)) + ": unterminated coordinates";
+                return false;
+            }
+
+            const char c = *position;
+
+            if (c == '[')
+            {
+                current_depth++;
+                position++;
+
+                if (current_depth == depth - 1)
+                {
+                    sink.begin_trajectory(line_count);
+                    line_has_points = false;
+                }
+                else if (current_depth == depth && depth >= 2)
+                {
+                    //Position, longitude first, further values like elevation are ignored
+                    double values[2];
+                    for (int i = 0; i < 2; i++)
+                    {
+                        skip_spaces(position, end);
+
+                        if (!parse_number(position, end, values[i]))
+                        {
+                            error = "line " + std::to_string(line_number(text, position)) + ": invalid position";
+                            return false;
+                        }
+
+                        skip_spaces(position, end);
+                        if (position < end && *position == ',') position++;
+                    }
+
+                    sink.add(values[1], values[0], false, 0.0);
+                    line_has_points = true;
+
+                    const char* position_end = static_cast<const char*>(memchr(position, ']', static_cast<size_t>(end - position)));
+                    if (position_end == nullptr)
+                    {
+                        error = "line " + std::to_string(line_number(text, key)) + ": unterminated coordinates";
+                        return false;
+                    }
+
+                    position = position_end;
+                }
+            }
+            else if (c == ']')
+            {
+                if (current_depth == depth - 1 && line_has_points)
+                {
+                    line_count++;
+                }
+
+                current_depth--;
+                position++;
+            }
+            else
+            {
+                //Separators and the values of single points
+                position++;
+            }
+        } while (current_depth > 0);
+    }
+
+    sink.finish();
+
+    return true;
+}
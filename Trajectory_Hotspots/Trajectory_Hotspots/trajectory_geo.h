@@ -0,0 +1,47 @@
+#pragma once
+
+class Trajectory_CSV;
+
+//Local equirectangular projection of latitude and longitude in degrees to meters east (x) and north (y) of an origin
+//Accurate for trajectories spanning up to a few hundred kilometers around the origin
+class Geo_Projection
+{
+public:
+
+    Geo_Projection() = default;
+    Geo_Projection(const double origin_latitude, const double origin_longitude);
+
+    //A projection without origin takes the first point it is used on as origin
+    bool has_origin() const { return origin_set; }
+
+    Vec2 project(const double latitude, const double longitude) const;
+
+    double origin_latitude = 0.0;
+    double origin_longitude = 0.0;
+
+    double meters_per_degree_latitude = 0.0;
+    double meters_per_degree_longitude = 0.0;
+
+private:
+
+    bool origin_set = false;
+};
+
+//Projects count points at once, same results as Geo_Projection::project
+//Uses AVX2 when the library is compiled with it enabled, otherwise a scalar loop
+void project_to_local_frame(const Geo_Projection& projection, const double* latitudes, const double* longitudes, const size_t count, float* x, float* y);
+
+//Streaming readers for geographic trajectory formats, they scan the text once without building a document tree
+//The points are projected in batches with the given projection and stored in the same form as parsed CSV trajectories
+//Times are in seconds since the first point of the text, if any point has no time the result has no times
+//Return false and set error on malformed input
+
+//GPX: every trkseg becomes a trajectory, ids count the trksegs in the text, times are read from the time elements of the trkpts
+bool parse_gpx(const char* text, const size_t text_size, Geo_Projection& projection, Trajectory_CSV& result, std::string& error);
+
+//GeoLife PLT: six header lines followed by latitude,longitude,0,altitude,days,date,time, the whole text is one trajectory with id 0
+bool parse_plt(const char* text, const size_t text_size, Geo_Projection& projection, Trajectory_CSV& result, std::string& error);
+
+//GeoJSON: every line of positions in a coordinates member becomes a trajectory (LineString, MultiLineString, and polygon rings), points are skipped
+//Ids count the lines in the text, GeoJSON has no times
+bool parse_geojson(const char* text, const size_t text_size, Geo_Projection& projection, Trajectory_CSV& result, std::string& error);
@@ -0,0 +1,207 @@
+#include "pch.h"
+#include "vec2.h"
+#include "trajectory.h"
+#include "trajectory_index_snapshot.h"
+#include "binary_file.h"
+
+namespace
+{
+    //FNV-1a over the raw floats of the segments
+    uint64_t fnv1a(uint64_t hash, const float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+
+        for (int i = 0; i < 4; i++)
+        {
+            hash ^= (bits >> (i * 8)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+
+        return hash;
+    }
+
+    template<typename T>
+    void write_array(std::ofstream& output, uint64_t& position, const uint64_t offset, const std::vector<T>& values)
+    {
+        write_padding(output, position, offset);
+        output.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+        position = offset + values.size() * sizeof(T);
+    }
+}
+
+uint64_t Trajectory_Index_Snapshot::get_segment_checksum(const std::vector<Segment>& segments)
+{
+    uint64_t hash = 14695981039346656037ull;
+
+    for (const Segment& segment : segments)
+    {
+        hash = fnv1a(hash, segment.start.x.get_value());
+        hash = fnv1a(hash, segment.start.y.get_value());
+        hash = fnv1a(hash, segment.end.x.get_value());
+        hash = fnv1a(hash, segment.end.y.get_value());
+        hash = fnv1a(hash, segment.start_t.get_value());
+        hash = fnv1a(hash, segment.end_t.get_value());
+    }
+
+    return hash;
+}
+
+bool Trajectory_Index_Snapshot::open(const char* path, std::string& error)
+{
+    header = nullptr;
+    tree = Flat_Segment_Search_Tree();
+    maps[0] = Flat_Trapezoidal_Map();
+    maps[1] = Flat_Trapezoidal_Map();
+
+    if (!file.open(path))
+    {
+        error = "can't open snapshot";
+        return false;
+    }
+
+    const uint64_t file_size = file.size();
+
+    if (file_size < sizeof(Trajectory_Index_Snapshot_Header) || memcmp(file.data(), Trajectory_Index_Snapshot_Header::snapshot_magic, sizeof(Trajectory_Index_Snapshot_Header::snapshot_magic)) != 0)
+    {
+        error = "not a trajectory index snapshot";
+        return false;
+    }
+
+    const Trajectory_Index_Snapshot_Header* file_header = reinterpret_cast<const Trajectory_Index_Snapshot_Header*>(file.data());
+
+    if (file_header->version != Trajectory_Index_Snapshot_Header::current_version)
+    {
+        error = "unsupported snapshot version " + std::to_string(file_header->version);
+        return false;
+    }
+
+    //The tree has 2n - 1 nodes for n segments, same as Flat_Segment_Search_Tree::build_nodes
+    bool sections_valid = file_header->segment_count > 0 && file_header->segment_count <= file_size &&
+        file_header->tree_node_count == file_header->segment_count * 2 - 1 &&
+        section_fits(file_header->tree_nodes_offset, file_header->tree_node_count * sizeof(Flat_Segment_Search_Tree_Node), file_size);
+
+    for (const Trajectory_Index_Snapshot_Map_Section& map : file_header->maps)
+    {
+        sections_valid = sections_valid && map.node_count > 0 &&
+            map.node_count <= file_size / sizeof(Flat_Trapezoidal_Node) && map.segment_count <= file_size / sizeof(Flat_Trapezoidal_Segment) && map.point_count <= file_size / (2 * sizeof(float)) &&
+            section_fits(map.nodes_offset, map.node_count * sizeof(Flat_Trapezoidal_Node), file_size) &&
+            section_fits(map.segments_offset, map.segment_count * sizeof(Flat_Trapezoidal_Segment), file_size) &&
+            section_fits(map.points_offset, map.point_count * 2 * sizeof(float), file_size);
+    }
+
+    if (!sections_valid)
+    {
+        error = "snapshot is truncated or corrupt";
+        return false;
+    }
+
+    header = file_header;
+    tree = Flat_Segment_Search_Tree(reinterpret_cast<const Flat_Segment_Search_Tree_Node*>(file.data() + header->tree_nodes_offset), static_cast<size_t>(header->tree_node_count));
+
+    for (int axis = 0; axis < 2; axis++)
+    {
+        const Trajectory_Index_Snapshot_Map_Section& map = header->maps[axis];
+
+        maps[axis] = Flat_Trapezoidal_Map(
+            reinterpret_cast<const Flat_Trapezoidal_Node*>(file.data() + map.nodes_offset), static_cast<size_t>(map.node_count),
+            reinterpret_cast<const Flat_Trapezoidal_Segment*>(file.data() + map.segments_offset), static_cast<size_t>(map.segment_count),
+            reinterpret_cast<const float*>(file.data() + map.points_offset), static_cast<size_t>(map.point_count));
+    }
+
+    return true;
+}
+
+bool Trajectory_Index_Snapshot::matches(const Trajectory& trajectory) const
+{
+    const std::vector<Segment>& segments = trajectory.get_ordered_trajectory_segments();
+    return header != nullptr && header->segment_count == segments.size() && header->segment_checksum == get_segment_checksum(segments);
+}
+
+bool Trajectory_Index_Snapshot::is_valid() const
+{
+    return header != nullptr && tree.is_valid() && maps[0].is_valid() && maps[1].is_valid();
+}
+
+bool Trajectory_Index_Snapshot::write(const char* path, const Trajectory& trajectory, std::string& error)
+{
+    const std::vector<Segment>& segments = trajectory.get_ordered_trajectory_segments();
+
+    if (segments.empty())
+    {
+        error = "can't write a snapshot of an empty trajectory";
+        return false;
+    }
+
+    const std::vector<Flat_Segment_Search_Tree_Node> tree_nodes = Flat_Segment_Search_Tree::build_nodes(segments);
+
+    //Build the maps the same way as Trajectory::get_hotspot_fixed_radius_contiguous
+    Flat_Trapezoidal_Map_Data map_data[2];
+    Hooked_Vector<Segment> projected_segments;
+    projected_segments.reserve(segments.size());
+
+    for (const bool axis : { true, false })
+    {
+        trajectory.frc_project_segments_on_axis(axis, projected_segments);
+
+        const Trapezoidal_Map trapezoidal_map(projected_segments);
+        map_data[axis ? 0 : 1] = Flat_Trapezoidal_Map::build_data(trapezoidal_map);
+    }
+
+    //Section layout
+    Trajectory_Index_Snapshot_Header header = {};
+    memcpy(header.magic, Trajectory_Index_Snapshot_Header::snapshot_magic, sizeof(header.magic));
+    header.version = Trajectory_Index_Snapshot_Header::current_version;
+    header.segment_count = segments.size();
+    header.segment_checksum = get_segment_checksum(segments);
+    header.tree_node_count = tree_nodes.size();
+    header.tree_nodes_offset = align_to_8(sizeof(Trajectory_Index_Snapshot_Header));
+
+    uint64_t end_offset = header.tree_nodes_offset + tree_nodes.size() * sizeof(Flat_Segment_Search_Tree_Node);
+
+    for (int axis = 0; axis < 2; axis++)
+    {
+        Trajectory_Index_Snapshot_Map_Section& map = header.maps[axis];
+
+        map.node_count = map_data[axis].nodes.size();
+        map.segment_count = map_data[axis].segments.size();
+        map.point_count = map_data[axis].points.size() / 2;
+
+        map.nodes_offset = align_to_8(end_offset);
+        map.segments_offset = align_to_8(map.nodes_offset + map.node_count * sizeof(Flat_Trapezoidal_Node));
+        map.points_offset = align_to_8(map.segments_offset + map.segment_count * sizeof(Flat_Trapezoidal_Segment));
+        end_offset = map.points_offset + map.point_count * 2 * sizeof(float);
+    }
+
+    //Other processes may have the snapshot at path mapped, it is replaced by a new file instead of overwritten
+    Replacing_File_Writer writer(path);
+    std::ofstream& output = writer.output;
+
+    if (!output)
+    {
+        error = "can't write snapshot";
+        return false;
+    }
+
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    uint64_t position = sizeof(header);
+
+    write_array(output, position, header.tree_nodes_offset, tree_nodes);
+
+    for (int axis = 0; axis < 2; axis++)
+    {
+        write_array(output, position, header.maps[axis].nodes_offset, map_data[axis].nodes);
+        write_array(output, position, header.maps[axis].segments_offset, map_data[axis].segments);
+        write_array(output, position, header.maps[axis].points_offset, map_data[axis].points);
+    }
+
+    output.flush();
+
+    if (!output)
+    {
+        error = "failed writing snapshot";
+        return false;
+    }
+
+    return writer.commit(error);
+}
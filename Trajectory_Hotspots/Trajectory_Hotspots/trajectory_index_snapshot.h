@@ -0,0 +1,87 @@
+#pragma once
+
+#include "memory_mapped_file.h"
+
+class Trajectory;
+
+//Position-independent copy of the indexes fixed radius contiguous builds for a trajectory, the segment search tree and the two trapezoidal maps
+//A snapshot is mapped read-only and queried in place, so processes opening the same file share it through the page cache
+//
+//Layout, all values little-endian and every section aligned to 8 bytes:
+//  Trajectory_Index_Snapshot_Header
+//  Flat_Segment_Search_Tree_Node[tree_node_count]
+//  For the x and y map: Flat_Trapezoidal_Node[node_count], Flat_Trapezoidal_Segment[segment_count], float[point_count * 2]
+class Trajectory_Index_Snapshot_Map_Section
+{
+public:
+
+    uint64_t node_count;
+    uint64_t segment_count;
+    uint64_t point_count;
+
+    //Byte offsets of the arrays from the start of the file
+    uint64_t nodes_offset;
+    uint64_t segments_offset;
+    uint64_t points_offset;
+};
+
+class Trajectory_Index_Snapshot_Header
+{
+public:
+
+    static constexpr char snapshot_magic[8] = { 'T', 'H', 'I', 'N', 'D', 'E', 'X', '1' };
+    static constexpr uint32_t current_version = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+
+    //The trajectory the indexes were built for, checked with Trajectory_Index_Snapshot::matches
+    uint64_t segment_count;
+    uint64_t segment_checksum;
+
+    uint64_t tree_node_count;
+    uint64_t tree_nodes_offset;
+
+    //Maps of the segments projected on the (t, x) and (t, y) planes
+    Trajectory_Index_Snapshot_Map_Section maps[2];
+};
+
+static_assert(sizeof(Trajectory_Index_Snapshot_Header) == 144, "Trajectory_Index_Snapshot_Header is part of the file format, its layout must not change");
+
+//Read-only view of a snapshot file
+//Opening validates the header and section bounds, use is_valid to also check every tree and map node of a snapshot that may be corrupt
+class Trajectory_Index_Snapshot
+{
+public:
+
+    //Maps the snapshot at path, returns false and sets error if it can't be opened or isn't a valid snapshot
+    bool open(const char* path, std::string& error);
+
+    //Builds the indexes of the trajectory and writes them to a snapshot at path, returns false and sets error on failure
+    static bool write(const char* path, const Trajectory& trajectory, std::string& error);
+
+    //Returns true if the snapshot was written for this trajectory
+    bool matches(const Trajectory& trajectory) const;
+
+    //Checks the indices of all tree and map nodes, linear in the size of the snapshot
+    bool is_valid() const;
+
+    //The returned index is queried in place, the snapshot must outlive it
+    const Flat_Segment_Search_Tree& get_tree() const { return tree; }
+
+    //When axis is set to true, returns the map of the x-coordinates, else the map of the y-coordinates
+    const Flat_Trapezoidal_Map& get_map(const bool axis) const { return axis ? maps[0] : maps[1]; }
+
+    //Checksum of the segments of a trajectory as stored in a snapshot header
+    static uint64_t get_segment_checksum(const std::vector<Segment>& segments);
+
+private:
+
+    Memory_Mapped_File file;
+
+    const Trajectory_Index_Snapshot_Header* header = nullptr;
+
+    Flat_Segment_Search_Tree tree;
+    Flat_Trapezoidal_Map maps[2];
+};
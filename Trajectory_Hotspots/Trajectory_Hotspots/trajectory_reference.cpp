@@ -0,0 +1,663 @@
+#include "pch.h"
+#include "vec2.h"
+#include "trajectory.h"
+#include "trajectory_reference.h"
+
+#include <cstdio>
+
+namespace
+{
+    //The references work on their own double precision copy of the segments, so rounding in the fast code can't hide in both
+    struct Reference_Segment
+    {
+        double x0, y0, x1, y1;
+        double t0, t1;
+
+        double x_at(const double u) const { return x0 + u * (x1 - x0); }
+        double y_at(const double u) const { return y0 + u * (y1 - y0); }
+        double t_at(const double u) const { return t0 + u * (t1 - t0); }
+
+        //Fraction along the segment at time t, clamped to the segment
+        double u_at(const double t) const
+        {
+            if (t1 <= t0)
+            {
+                return 0.0;
+            }
+
+            return std::min(1.0, std::max(0.0, (t - t0) / (t1 - t0)));
+        }
+    };
+
+    struct Reference_Box
+    {
+        double min_x = std::numeric_limits<double>::max();
+        double min_y = std::numeric_limits<double>::max();
+        double max_x = std::numeric_limits<double>::lowest();
+        double max_y = std::numeric_limits<double>::lowest();
+
+        void augment(const double x, const double y)
+        {
+            min_x = std::min(min_x, x);
+            min_y = std::min(min_y, y);
+            max_x = std::max(max_x, x);
+            max_y = std::max(max_y, y);
+        }
+
+        double max_size() const { return std::max(max_x - min_x, max_y - min_y); }
+
+        AABB to_AABB() const
+        {
+            return AABB(static_cast<float>(min_x), static_cast<float>(min_y), static_cast<float>(max_x), static_cast<float>(max_y));
+        }
+    };
+
+    std::vector<Reference_Segment> get_reference_segments(const Trajectory& trajectory)
+    {
+        std::vector<Reference_Segment> segments;
+
+        for (const Segment& segment : trajectory.get_ordered_trajectory_segments())
+        {
+            segments.push_back({
+                segment.start.x.get_value(), segment.start.y.get_value(), segment.end.x.get_value(), segment.end.y.get_value(),
+                segment.start_t.get_value(), segment.end_t.get_value() });
+        }
+
+        return segments;
+    }
+
+    //The same trajectory traversed backwards with negated times, a walk forward on it is a walk backward on the original
+    std::vector<Reference_Segment> get_reversed_segments(const std::vector<Reference_Segment>& segments)
+    {
+        std::vector<Reference_Segment> reversed;
+
+        for (auto segment = segments.rbegin(); segment != segments.rend(); ++segment)
+        {
+            reversed.push_back({ segment->x1, segment->y1, segment->x0, segment->y0, -segment->t1, -segment->t0 });
+        }
+
+        return reversed;
+    }
+
+    //Bounding box of the subtrajectory from start_t to end_t
+    Reference_Box get_bounding_box(const std::vector<Reference_Segment>& segments, const double start_t, const double end_t)
+    {
+        Reference_Box box;
+
+        for (const Reference_Segment& segment : segments)
+        {
+            if (segment.t1 < start_t || segment.t0 > end_t)
+            {
+                continue;
+            }
+
+            const double start_u = segment.u_at(start_t);
+            const double end_u = segment.u_at(end_t);
+
+            box.augment(segment.x_at(start_u), segment.y_at(start_u));
+            box.augment(segment.x_at(end_u), segment.y_at(end_u));
+        }
+
+        return box;
+    }
+
+    //Clips the segment to the box, returns false if no part of it lies inside
+    bool clip_segment(const Reference_Segment& segment, const Reference_Box& box, double& start_u, double& end_u)
+    {
+        start_u = 0.0;
+        end_u = 1.0;
+
+        const double deltas[2] = { segment.x1 - segment.x0, segment.y1 - segment.y0 };
+        const double starts[2] = { segment.x0, segment.y0 };
+        const double mins[2] = { box.min_x, box.min_y };
+        const double maxs[2] = { box.max_x, box.max_y };
+
+        for (int axis = 0; axis < 2; axis++)
+        {
+            if (deltas[axis] == 0.0)
+            {
+                if (starts[axis] < mins[axis] || starts[axis] > maxs[axis])
+                {
+                    return false;
+                }
+
+                continue;
+            }
+
+            double u_at_min = (mins[axis] - starts[axis]) / deltas[axis];
+            double u_at_max = (maxs[axis] - starts[axis]) / deltas[axis];
+
+            if (u_at_min > u_at_max)
+            {
+                std::swap(u_at_min, u_at_max);
+            }
+
+            start_u = std::max(start_u, u_at_min);
+            end_u = std::min(end_u, u_at_max);
+        }
+
+        return start_u <= end_u;
+    }
+
+    Reference_Box to_reference_box(const AABB& hotspot, const double margin)
+    {
+        Reference_Box box;
+        box.min_x = hotspot.min.x.get_value() - margin;
+        box.min_y = hotspot.min.y.get_value() - margin;
+        box.max_x = hotspot.max.x.get_value() + margin;
+        box.max_y = hotspot.max.y.get_value() + margin;
+        return box;
+    }
+
+    double get_length_inside(const std::vector<Reference_Segment>& segments, const Reference_Box& box)
+    {
+        double length = 0.0;
+
+        for (const Reference_Segment& segment : segments)
+        {
+            double start_u, end_u;
+
+            if (clip_segment(segment, box, start_u, end_u))
+            {
+                length += segment.t_at(end_u) - segment.t_at(start_u);
+            }
+        }
+
+        return length;
+    }
+
+    //Contiguous parts inside the box continue over a vertex when one segment leaves the box at its end and the next enters at its start
+    double get_longest_subtrajectory_inside(const std::vector<Reference_Segment>& segments, const Reference_Box& box)
+    {
+        double longest = 0.0;
+
+        bool inside = false;
+        double run_start = 0.0;
+
+        for (const Reference_Segment& segment : segments)
+        {
+            double start_u, end_u;
+
+            if (!clip_segment(segment, box, start_u, end_u))
+            {
+                inside = false;
+                continue;
+            }
+
+            if (!inside || start_u > 0.0)
+            {
+                run_start = segment.t_at(start_u);
+            }
+
+            longest = std::max(longest, segment.t_at(end_u) - run_start);
+            inside = end_u >= 1.0;
+        }
+
+        return longest;
+    }
+
+    //The start times of every segment at the given number of even steps, starting with the vertex,
+    //and the times the trajectory crosses the lines through every vertex and the lines the offset away from those
+    std::vector<double> get_candidate_times(const std::vector<Reference_Segment>& segments, const size_t samples_per_segment, const double line_offset)
+    {
+        std::vector<double> times;
+        const size_t samples = std::max<size_t>(samples_per_segment, 1);
+
+        for (const Reference_Segment& segment : segments)
+        {
+            for (size_t i = 0; i < samples; i++)
+            {
+                times.push_back(segment.t_at(static_cast<double>(i) / static_cast<double>(samples)));
+            }
+        }
+
+        if (segments.empty())
+        {
+            return times;
+        }
+
+        times.push_back(segments.back().t1);
+
+        for (const bool x_axis : { true, false })
+        {
+            std::vector<double> lines;
+
+            for (const Reference_Segment& segment : segments)
+            {
+                for (const double value : { x_axis ? segment.x0 : segment.y0, x_axis ? segment.x1 : segment.y1 })
+                {
+                    lines.push_back(value);
+
+                    if (line_offset > 0.0)
+                    {
+                        lines.push_back(value - line_offset);
+                        lines.push_back(value + line_offset);
+                    }
+                }
+            }
+
+            std::sort(lines.begin(), lines.end());
+            lines.erase(std::unique(lines.begin(), lines.end()), lines.end());
+
+            for (const Reference_Segment& segment : segments)
+            {
+                const double start = x_axis ? segment.x0 : segment.y0;
+                const double end = x_axis ? segment.x1 : segment.y1;
+
+                //Only the lines strictly between the endpoints, the endpoints are in already
+                auto line = std::upper_bound(lines.begin(), lines.end(), std::min(start, end));
+                for (; line != lines.end() && *line < std::max(start, end); ++line)
+                {
+                    times.push_back(segment.t_at((*line - start) / (end - start)));
+                }
+            }
+        }
+
+        std::sort(times.begin(), times.end());
+        times.erase(std::unique(times.begin(), times.end()), times.end());
+        return times;
+    }
+
+    //Walks forward from start_t as long as the bounding box of the walked subtrajectory fits in the radius, returns the time it stops
+    double walk_within_radius(const std::vector<Reference_Segment>& segments, const double start_t, const double radius)
+    {
+        Reference_Box box;
+        bool started = false;
+        double end_t = start_t;
+
+        for (const Reference_Segment& segment : segments)
+        {
+            if (segment.t1 < start_t)
+            {
+                continue;
+            }
+
+            const double start_u = segment.u_at(start_t);
+
+            if (!started)
+            {
+                box.augment(segment.x_at(start_u), segment.y_at(start_u));
+                started = true;
+            }
+
+            //The point moves in one direction per axis along a segment, it leaves the box when it gets a radius away from the opposite side
+            double exit_u = 1.0;
+
+            const double deltas[2] = { segment.x1 - segment.x0, segment.y1 - segment.y0 };
+            const double limits[2][2] = { { box.max_x - radius, box.min_x + radius }, { box.max_y - radius, box.min_y + radius } };
+            const double origins[2] = { segment.x0, segment.y0 };
+
+            for (int axis = 0; axis < 2; axis++)
+            {
+                if (deltas[axis] > 0.0 && origins[axis] + deltas[axis] > limits[axis][1])
+                {
+                    exit_u = std::min(exit_u, std::max(start_u, (limits[axis][1] - origins[axis]) / deltas[axis]));
+                }
+                else if (deltas[axis] < 0.0 && origins[axis] + deltas[axis] < limits[axis][0])
+                {
+                    exit_u = std::min(exit_u, std::max(start_u, (limits[axis][0] - origins[axis]) / deltas[axis]));
+                }
+            }
+
+            box.augment(segment.x_at(exit_u), segment.y_at(exit_u));
+            end_t = segment.t_at(exit_u);
+
+            if (exit_u < 1.0)
+            {
+                break;
+            }
+        }
+
+        return end_t;
+    }
+
+    //Candidate positions of a side of the hotspot on one axis, the vertices on either side plus an even grid over the trajectory
+    std::vector<double> get_candidate_sides(const std::vector<Reference_Segment>& segments, const bool x_axis, const double radius, const size_t samples_per_segment)
+    {
+        std::vector<double> sides;
+        double min = std::numeric_limits<double>::max();
+        double max = std::numeric_limits<double>::lowest();
+
+        for (const Reference_Segment& segment : segments)
+        {
+            for (const double value : { x_axis ? segment.x0 : segment.y0, x_axis ? segment.x1 : segment.y1 })
+            {
+                sides.push_back(value);
+                sides.push_back(value - radius);
+                min = std::min(min, value);
+                max = std::max(max, value);
+            }
+        }
+
+        const size_t steps = samples_per_segment * segments.size();
+
+        for (size_t i = 0; i <= steps && steps > 0; i++)
+        {
+            sides.push_back(min - radius + (max - min + radius) * static_cast<double>(i) / static_cast<double>(steps));
+        }
+
+        std::sort(sides.begin(), sides.end());
+        sides.erase(std::unique(sides.begin(), sides.end()), sides.end());
+        return sides;
+    }
+
+    //Hotspot of the radius with the most trajectory inside, and that length
+    Reference_Box reference_fixed_radius(const std::vector<Reference_Segment>& segments, const double radius, const size_t samples_per_segment, double& length_inside)
+    {
+        const std::vector<double> x_sides = get_candidate_sides(segments, true, radius, samples_per_segment);
+        const std::vector<double> y_sides = get_candidate_sides(segments, false, radius, samples_per_segment);
+
+        Reference_Box best;
+        length_inside = -1.0;
+
+        for (const double x : x_sides)
+        {
+            for (const double y : y_sides)
+            {
+                Reference_Box box;
+                box.augment(x, y);
+                box.augment(x + radius, y + radius);
+
+                const double length = get_length_inside(segments, box);
+
+                if (length > length_inside)
+                {
+                    length_inside = length;
+                    best = box;
+                }
+            }
+        }
+
+        return best;
+    }
+
+    double get_tolerance(const double tolerance, const double value)
+    {
+        return tolerance * std::max(1.0, fabs(value));
+    }
+
+    //The hotspots are grown by the tolerance relative to the size of the trajectory before they are measured
+    double get_margin(const std::vector<Reference_Segment>& segments, const double tolerance)
+    {
+        const Reference_Box trajectory_box = get_bounding_box(segments, segments.front().t0, segments.back().t1);
+        return get_tolerance(tolerance, std::max(fabs(trajectory_box.min_x), std::max(fabs(trajectory_box.max_x), std::max(fabs(trajectory_box.min_y), fabs(trajectory_box.max_y)))));
+    }
+
+    //The longest subtrajectory inside the grown hotspot for the contiguous queries, all trajectory inside it otherwise
+    double measure_hotspot(const std::vector<Reference_Segment>& segments, const Hotspot_Query query, const AABB& hotspot, const double margin)
+    {
+        const bool contiguous = query == Hotspot_Query::fixed_radius_contiguous || query == Hotspot_Query::fixed_length_contiguous;
+        const Reference_Box grown_box = to_reference_box(hotspot, margin);
+        return contiguous ? get_longest_subtrajectory_inside(segments, grown_box) : get_length_inside(segments, grown_box);
+    }
+
+    bool is_radius_query(const Hotspot_Query query)
+    {
+        return query == Hotspot_Query::fixed_radius || query == Hotspot_Query::fixed_radius_contiguous;
+    }
+}
+
+const char* hotspot_query_known_issue(const Hotspot_Query query)
+{
+    switch (query)
+    {
+    case Hotspot_Query::fixed_radius_contiguous: return "the start and end are bounded on one axis at a time, a subtrajectory bounded on both axes like around a corner is missed";
+    case Hotspot_Query::fixed_length_contiguous: return "only the breakpoints are evaluated, a smaller hotspot between them where its width and height are equal is missed";
+    default: return nullptr;
+    }
+}
+
+AABB run_reference_hotspot_query(const Trajectory& trajectory, const Hotspot_Query query, const Float parameter, const size_t samples_per_segment)
+{
+    switch (query)
+    {
+    case Hotspot_Query::fixed_radius: return reference_hotspot_fixed_radius(trajectory, parameter, samples_per_segment);
+    case Hotspot_Query::fixed_length: return reference_hotspot_fixed_length(trajectory, parameter, samples_per_segment);
+    case Hotspot_Query::fixed_radius_contiguous: return reference_hotspot_fixed_radius_contiguous(trajectory, parameter, samples_per_segment);
+    case Hotspot_Query::fixed_length_contiguous: return reference_hotspot_fixed_length_contiguous(trajectory, parameter, samples_per_segment);
+    }
+
+    return AABB();
+}
+
+//Tries every hotspot with its sides at a vertex, or a radius away from one, or on a grid
+AABB reference_hotspot_fixed_radius(const Trajectory& trajectory, const Float radius, const size_t samples_per_segment)
+{
+    const std::vector<Reference_Segment> segments = get_reference_segments(trajectory);
+
+    if (segments.empty())
+    {
+        return AABB();
+    }
+
+    double length_inside;
+    return reference_fixed_radius(segments, radius.get_value(), samples_per_segment, length_inside).to_AABB();
+}
+
+//Binary search on the radius of the fixed radius reference
+AABB reference_hotspot_fixed_length(const Trajectory& trajectory, const Float length, const size_t samples_per_segment)
+{
+    const std::vector<Reference_Segment> segments = get_reference_segments(trajectory);
+
+    if (segments.empty() || length.get_value() > segments.back().t1 - segments.front().t0)
+    {
+        return AABB();
+    }
+
+    const Reference_Box trajectory_box = get_bounding_box(segments, segments.front().t0, segments.back().t1);
+
+    Reference_Box best = trajectory_box;
+    double low = 0.0;
+    double high = trajectory_box.max_size();
+
+    for (int i = 0; i < 32 && high - low > 1e-7 * std::max(1.0, high); i++)
+    {
+        const double radius = (low + high) / 2.0;
+
+        double length_inside;
+        const Reference_Box box = reference_fixed_radius(segments, radius, samples_per_segment, length_inside);
+
+        if (length_inside >= length.get_value())
+        {
+            high = radius;
+            best = box;
+        }
+        else
+        {
+            low = radius;
+        }
+    }
+
+    return best.to_AABB();
+}
+
+//Walks forward from every candidate start and backward from every candidate end as long as the subtrajectory fits in the radius
+//A longest subtrajectory has an end at a vertex, or on a line through a vertex or a radius away from one, those are all candidates
+AABB reference_hotspot_fixed_radius_contiguous(const Trajectory& trajectory, const Float radius, const size_t samples_per_segment)
+{
+    const std::vector<Reference_Segment> segments = get_reference_segments(trajectory);
+
+    if (segments.empty())
+    {
+        return AABB();
+    }
+
+    const std::vector<Reference_Segment> reversed_segments = get_reversed_segments(segments);
+
+    double longest = -1.0;
+    double best_start = 0.0;
+    double best_end = 0.0;
+
+    for (const double start : get_candidate_times(segments, samples_per_segment, radius.get_value()))
+    {
+        const double end = walk_within_radius(segments, start, radius.get_value());
+
+        if (end - start > longest)
+        {
+            longest = end - start;
+            best_start = start;
+            best_end = end;
+        }
+    }
+
+    for (const double reversed_end : get_candidate_times(reversed_segments, samples_per_segment, radius.get_value()))
+    {
+        const double reversed_start = walk_within_radius(reversed_segments, reversed_end, radius.get_value());
+
+        if (reversed_start - reversed_end > longest)
+        {
+            longest = reversed_start - reversed_end;
+            best_start = -reversed_start;
+            best_end = -reversed_end;
+        }
+    }
+
+    return get_bounding_box(segments, best_start, best_end).to_AABB();
+}
+
+//Tries every subtrajectory of the length that starts or ends at a candidate time
+//Subtrajectories with an end on a line through a vertex are candidates, the breakpoints where both ends decide the size are found on the grid
+AABB reference_hotspot_fixed_length_contiguous(const Trajectory& trajectory, const Float length, const size_t samples_per_segment)
+{
+    const std::vector<Reference_Segment> segments = get_reference_segments(trajectory);
+
+    if (segments.empty() || length.get_value() > segments.back().t1 - segments.front().t0)
+    {
+        return AABB();
+    }
+
+    const double trajectory_start = segments.front().t0;
+    const double trajectory_end = segments.back().t1;
+    const double subtrajectory_length = length.get_value();
+
+    Reference_Box best;
+    double best_size = std::numeric_limits<double>::max();
+
+    for (const double time : get_candidate_times(segments, samples_per_segment, 0.0))
+    {
+        for (const double start : { time, time - subtrajectory_length })
+        {
+            if (start < trajectory_start || start + subtrajectory_length > trajectory_end)
+            {
+                continue;
+            }
+
+            const Reference_Box box = get_bounding_box(segments, start, start + subtrajectory_length);
+
+            if (box.max_size() < best_size)
+            {
+                best_size = box.max_size();
+                best = box;
+            }
+        }
+    }
+
+    return best.to_AABB();
+}
+
+double get_length_inside(const Trajectory& trajectory, const AABB& hotspot)
+{
+    return get_length_inside(get_reference_segments(trajectory), to_reference_box(hotspot, 0.0));
+}
+
+double get_longest_subtrajectory_inside(const Trajectory& trajectory, const AABB& hotspot)
+{
+    return get_longest_subtrajectory_inside(get_reference_segments(trajectory), to_reference_box(hotspot, 0.0));
+}
+
+bool check_hotspot_valid(const Trajectory& trajectory, const Hotspot_Query query, const Float parameter, const AABB& hotspot, const double tolerance, std::string& error)
+{
+    const std::vector<Reference_Segment> segments = get_reference_segments(trajectory);
+
+    if (segments.empty())
+    {
+        return true;
+    }
+
+    const double margin = get_margin(segments, tolerance);
+    const double size = hotspot.max_size().get_value();
+
+    char message[256];
+
+    if (is_radius_query(query))
+    {
+        if (size > parameter.get_value() + margin)
+        {
+            std::snprintf(message, sizeof(message), "%s: hotspot size %.9g is larger than the radius %.9g", hotspot_query_name(query), size, parameter.get_value());
+            error = message;
+            return false;
+        }
+    }
+    else
+    {
+        //An invalid length has no hotspot
+        if (parameter.get_value() > segments.back().t1 - segments.front().t0)
+        {
+            return true;
+        }
+
+        const double length_inside = measure_hotspot(segments, query, hotspot, margin);
+
+        if (length_inside < parameter.get_value() - get_tolerance(tolerance, parameter.get_value()))
+        {
+            std::snprintf(message, sizeof(message), "%s: hotspot contains a length of %.9g, less than the length %.9g", hotspot_query_name(query), length_inside, parameter.get_value());
+            error = message;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool check_hotspot(const Trajectory& trajectory, const Hotspot_Query query, const Float parameter, const AABB& hotspot, const AABB& reference_hotspot, const double tolerance, std::string& error)
+{
+    if (!check_hotspot_valid(trajectory, query, parameter, hotspot, tolerance, error))
+    {
+        return false;
+    }
+
+    const std::vector<Reference_Segment> segments = get_reference_segments(trajectory);
+
+    if (segments.empty())
+    {
+        return true;
+    }
+
+    //Both answers are measured the same way, so the reference is held to the same standard
+    const double margin = get_margin(segments, tolerance);
+
+    char message[256];
+
+    if (is_radius_query(query))
+    {
+        const double length_inside = measure_hotspot(segments, query, hotspot, margin);
+        const double reference_length_inside = measure_hotspot(segments, query, reference_hotspot, margin);
+
+        if (length_inside < reference_length_inside - get_tolerance(tolerance, reference_length_inside))
+        {
+            std::snprintf(message, sizeof(message), "%s: hotspot contains a length of %.9g, the reference %.9g", hotspot_query_name(query), length_inside, reference_length_inside);
+            error = message;
+            return false;
+        }
+    }
+    else
+    {
+        //An invalid length has no hotspot
+        if (parameter.get_value() > segments.back().t1 - segments.front().t0)
+        {
+            return true;
+        }
+
+        const double size = hotspot.max_size().get_value();
+        const double reference_size = reference_hotspot.max_size().get_value();
+
+        if (size > reference_size + margin)
+        {
+            std::snprintf(message, sizeof(message), "%s: hotspot size %.9g is larger than the reference size %.9g", hotspot_query_name(query), size, reference_size);
+            error = message;
+            return false;
+        }
+    }
+
+    return true;
+}
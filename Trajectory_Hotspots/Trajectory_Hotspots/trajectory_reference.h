@@ -0,0 +1,38 @@
+#pragma once
+
+#include "hotspot_query.h"
+
+class Trajectory;
+
+//Slow reference implementations of the hotspot queries, to check the fast ones against
+//They don't share code with Trajectory, every candidate subtrajectory or hotspot is enumerated and measured directly in double precision.
+//The candidates are the positions derived from the vertices plus a dense grid with the given number of samples per segment,
+//so a reference answer is always valid but can be slightly worse than the optimum, a fast answer should be at least as good.
+//Like Trajectory, the length of a subtrajectory is measured in time.
+
+//Describes why the query can return a valid hotspot that is worse than the reference, nullptr if that is not a known issue
+//The differential harness reports these trials as known failures, see Known issues in the README
+const char* hotspot_query_known_issue(const Hotspot_Query query);
+
+//Runs the reference implementation of the query
+AABB run_reference_hotspot_query(const Trajectory& trajectory, const Hotspot_Query query, const Float parameter, const size_t samples_per_segment = 4);
+
+AABB reference_hotspot_fixed_radius(const Trajectory& trajectory, const Float radius, const size_t samples_per_segment = 4);
+AABB reference_hotspot_fixed_length(const Trajectory& trajectory, const Float length, const size_t samples_per_segment = 4);
+AABB reference_hotspot_fixed_radius_contiguous(const Trajectory& trajectory, const Float radius, const size_t samples_per_segment = 4);
+AABB reference_hotspot_fixed_length_contiguous(const Trajectory& trajectory, const Float length, const size_t samples_per_segment = 4);
+
+//Total length of the trajectory inside the hotspot
+double get_length_inside(const Trajectory& trajectory, const AABB& hotspot);
+
+//Length of the longest subtrajectory inside the hotspot
+double get_longest_subtrajectory_inside(const Trajectory& trajectory, const AABB& hotspot);
+
+//Checks a hotspot against the reference hotspot of the same query
+//The hotspot may not be larger than the radius, or than the reference hotspot for the length queries, by more than the tolerance,
+//and it has to contain as much trajectory as the reference, or the length, when it is grown by the tolerance.
+//Returns false with a description of the difference when the hotspot is worse.
+bool check_hotspot(const Trajectory& trajectory, const Hotspot_Query query, const Float parameter, const AABB& hotspot, const AABB& reference_hotspot, const double tolerance, std::string& error);
+
+//Checks only that the hotspot answers the query, it may not be larger than the radius or has to contain the length, without comparing to a reference
+bool check_hotspot_valid(const Trajectory& trajectory, const Hotspot_Query query, const Float parameter, const AABB& hotspot, const double tolerance, std::string& error);
@@ -0,0 +1,77 @@
+#include "pch.h"
+#include "vec2.h"
+#include "trajectory.h"
+#include "fixed_length_contiguous_stream.h"
+#include "trajectory_window.h"
+
+Trajectory_Window::Trajectory_Window(const Float duration, const Float length) :
+    duration(duration),
+    length_stream(length)
+{
+}
+
+bool Trajectory_Window::push_back(const Vec2& point, const Float t)
+{
+    if (vertex_count > 0 && t <= last_timestamp)
+    {
+        return false;
+    }
+
+    length_stream.push_back(point, t);
+
+    //Unlike the stream, keep segments without movement, time spent standing still counts for fixed radius contiguous
+    if (vertex_count > 0)
+    {
+        segment_tree.push_back(Segment(last_point, point, last_timestamp, t));
+    }
+
+    last_point = point;
+    last_timestamp = t;
+    vertex_count++;
+
+    const Float window_start = t - duration;
+
+    while (!segment_tree.empty() && segment_tree.get_segment(0).end_t < window_start)
+    {
+        segment_tree.pop_front();
+    }
+
+    length_stream.evict_before(window_start);
+
+    return true;
+}
+
+AABB Trajectory_Window::get_hotspot_fixed_length_contiguous() const
+{
+    return length_stream.get_hotspot();
+}
+
+AABB Trajectory_Window::get_hotspot_fixed_radius_contiguous(const Float radius, Scratch_Arena* arena) const
+{
+    if (segment_tree.empty())
+    {
+        return AABB();
+    }
+
+    std::vector<Segment> segments;
+    segments.reserve(segment_tree.size());
+
+    for (size_t i = 0; i < segment_tree.size(); i++)
+    {
+        segments.push_back(segment_tree.get_segment(i));
+    }
+
+    const Trajectory window_trajectory(segments);
+
+    return window_trajectory.get_hotspot_fixed_radius_contiguous(radius, segment_tree, arena);
+}
+
+Float Trajectory_Window::get_start_time() const
+{
+    if (segment_tree.empty())
+    {
+        return last_timestamp;
+    }
+
+    return segment_tree.get_segment(0).start_t;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+//Hotspots of the most recent part of a live trajectory, like the last 30 minutes of a vehicle
+//Vertices are appended at the back and segments that end before the window are evicted from the front, the indexes support both
+//so nothing is rebuilt from scratch when the window moves:
+// - The fixed length contiguous hotspot of the given length is kept up to date by a Fixed_Length_Contiguous_Stream,
+//   so like there the length is measured along the trajectory
+// - The segments are kept in a Dynamic_Segment_Search_Tree with their timestamps as times, for fixed radius contiguous queries
+//   The trapezoidal maps can't evict segments, so those are built per query, O(n log n) for the n segments in the window
+//A window stores a few hundred bytes per segment, an hour of positions every 5 seconds is about 300 kB
+class Trajectory_Window
+{
+public:
+
+    //The window holds the segments that end at most duration before the last timestamp
+    Trajectory_Window(const Float duration, const Float length);
+
+    //Appends a vertex and evicts the segments that end before t - duration
+    //Returns false and ignores the vertex if t is not after the timestamp of the last vertex
+    bool push_back(const Vec2& point, const Float t);
+
+    //Smallest hotspot that contains a subtrajectory of the length in the window, an empty AABB while the window is shorter
+    AABB get_hotspot_fixed_length_contiguous() const;
+
+    //Hotspot of the radius that contains the longest subtrajectory of the window in time, an empty AABB while the window has no segments
+    //The maps and other temporaries of the query come from the arena if one is given, see Trajectory::get_hotspot_fixed_radius_contiguous
+    AABB get_hotspot_fixed_radius_contiguous(const Float radius, Scratch_Arena* arena = nullptr) const;
+
+    Float get_duration() const { return duration; }
+    Float get_length() const { return length_stream.get_length(); }
+
+    size_t get_segment_count() const { return segment_tree.size(); }
+
+    //Time of the first vertex in the window, or of the last vertex when there are no segments
+    Float get_start_time() const;
+    Float get_end_time() const { return last_timestamp; }
+
+private:
+
+    Float duration;
+
+    size_t vertex_count = 0;
+    Vec2 last_point;
+    Float last_timestamp = 0.f;
+
+    Dynamic_Segment_Search_Tree segment_tree;
+    Fixed_Length_Contiguous_Stream length_stream;
+};
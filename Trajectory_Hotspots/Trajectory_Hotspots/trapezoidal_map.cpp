@@ -1,6 +1,8 @@
 #include "pch.h"
 #include "trapezoidal_map.h"
 
+#include <unordered_set>
+
 Trapezoidal_Map::Trapezoidal_Map()
 {
     AABB bounding_box(-std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity());
@@ -11,10 +13,23 @@ Trapezoidal_Map::Trapezoidal_Map()
     bottom_point = bounding_box.min;
     top_point = bounding_box.max;
 
-    root = std::make_unique<Trapezoidal_Leaf_Node>(&left_border, &right_border, &bottom_point, &top_point);
+    root = make_hooked_shared<Trapezoidal_Leaf_Node>(&left_border, &right_border, &bottom_point, &top_point);
 }
 
 Trapezoidal_Map::Trapezoidal_Map(const std::vector<Segment>& trajectory_segments, const unsigned int seed, const bool randomized_construction)
+{
+    initialize_bounding_box();
+    add_segments(trajectory_segments.data(), trajectory_segments.size(), seed, randomized_construction);
+}
+
+Trapezoidal_Map::Trapezoidal_Map(const Hooked_Vector<Segment>& trajectory_segments, const unsigned int seed, const bool randomized_construction)
+{
+    initialize_bounding_box();
+    add_segments(trajectory_segments.data(), trajectory_segments.size(), seed, randomized_construction);
+}
+
+//Starts with a single trapezoid between vertical borders at infinity
+void Trapezoidal_Map::initialize_bounding_box()
 {
     AABB bounding_box(-std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity());
 
@@ -24,10 +39,13 @@ Trapezoidal_Map::Trapezoidal_Map(const std::vector<Segment>& trajectory_segments
     bottom_point = bounding_box.min;
     top_point = bounding_box.max;
 
-    root = std::make_unique<Trapezoidal_Leaf_Node>(&left_border, &right_border, &bottom_point, &top_point);
+    root = make_hooked_shared<Trapezoidal_Leaf_Node>(&left_border, &right_border, &bottom_point, &top_point);
+}
 
+void Trapezoidal_Map::add_segments(const Segment* segments, const size_t segment_count, const unsigned int seed, const bool randomized_construction)
+{
     //Compute random permutation and add segments in this order
-    std::vector<size_t> random_permutation(trajectory_segments.size());
+    Hooked_Vector<size_t> random_permutation(segment_count);
 
     std::iota(random_permutation.begin(), random_permutation.end(), 0);
 
@@ -45,17 +63,18 @@ Trapezoidal_Map::Trapezoidal_Map(const std::vector<Segment>& trajectory_segments
 
     for (size_t i : random_permutation)
     {
-        add_segment(trajectory_segments.at(i));
+        add_segment(segments[i]);
     }
 }
 
 void Trapezoidal_Map::add_segment(const Segment& segment)
 {
     //Order endpoints bottom to top
+    //Building the map compares the exact y coordinates, like Segment::get_bottom_point, so points that are nearly equal still have one order
     //TODO: Move to member function of segment?
     const Vec2* queried_bottom_point;
     const Vec2* queried_top_point;
-    if (segment.start.y > segment.end.y)
+    if (segment.start.y.get_value() > segment.end.y.get_value())
     {
         queried_bottom_point = &segment.end;
         queried_top_point = &segment.start;
@@ -67,7 +86,7 @@ void Trapezoidal_Map::add_segment(const Segment& segment)
     }
 
     //Find all the trapezoids that contain a part of this segment
-    std::vector<Trapezoidal_Leaf_Node*> intersecting_trapezoids = follow_segment(Segment(*queried_bottom_point, *queried_top_point));
+    Hooked_Vector<Trapezoidal_Leaf_Node*> intersecting_trapezoids = follow_segment(Segment(*queried_bottom_point, *queried_top_point));
 
 
     if (intersecting_trapezoids.size() == 1)
@@ -113,20 +132,20 @@ void Trapezoidal_Map::add_fully_embedded_segment(Trapezoidal_Leaf_Node* current_
     const Vec2* queried_bottom_point = segment.get_bottom_point();
     const Vec2* queried_top_point = segment.get_top_point();
 
-    std::shared_ptr<Trapezoidal_Leaf_Node> left_trapezoid = std::make_shared<Trapezoidal_Leaf_Node>(
+    std::shared_ptr<Trapezoidal_Leaf_Node> left_trapezoid = make_hooked_shared<Trapezoidal_Leaf_Node>(
         current_trapezoid->left_segment,    //Left border
         &segment,                           //Right border
         queried_bottom_point,               //Bottom point
         queried_top_point);                 //Top point
 
-    std::shared_ptr<Trapezoidal_Leaf_Node> right_trapezoid = std::make_shared<Trapezoidal_Leaf_Node>(
+    std::shared_ptr<Trapezoidal_Leaf_Node> right_trapezoid = make_hooked_shared<Trapezoidal_Leaf_Node>(
         &segment,                           //Left border
         current_trapezoid->right_segment,   //Right border
         queried_bottom_point,               //Bottom point
         queried_top_point);                 //Top point
 
 
-    std::shared_ptr<Trapezoidal_Leaf_Node> bottom_trapezoid = std::make_shared<Trapezoidal_Leaf_Node>(
+    std::shared_ptr<Trapezoidal_Leaf_Node> bottom_trapezoid = make_hooked_shared<Trapezoidal_Leaf_Node>(
         current_trapezoid->left_segment,    //Left border
         current_trapezoid->right_segment,   //Right border
         current_trapezoid->bottom_point,    //Bottom point
@@ -139,7 +158,7 @@ void Trapezoidal_Map::add_fully_embedded_segment(Trapezoidal_Leaf_Node* current_
     left_trapezoid->bottom_left = bottom_trapezoid.get();
     right_trapezoid->bottom_right = bottom_trapezoid.get();
 
-    std::shared_ptr<Trapezoidal_Leaf_Node> top_trapezoid = std::make_shared<Trapezoidal_Leaf_Node>(
+    std::shared_ptr<Trapezoidal_Leaf_Node> top_trapezoid = make_hooked_shared<Trapezoidal_Leaf_Node>(
         current_trapezoid->left_segment,    //Left border
         current_trapezoid->right_segment,   //Right border
         queried_top_point,                  //Bottom point
@@ -172,17 +191,17 @@ void Trapezoidal_Map::add_fully_embedded_segment(Trapezoidal_Leaf_Node* current_
         current_trapezoid->top_right->replace_bottom_neighbour(current_trapezoid, top_trapezoid.get());
     }
 
-    std::shared_ptr<Trapezoidal_X_Node> x_node = std::make_shared<Trapezoidal_X_Node>(
+    std::shared_ptr<Trapezoidal_X_Node> x_node = make_hooked_shared<Trapezoidal_X_Node>(
         &segment,
         std::move(left_trapezoid),
         std::move(right_trapezoid));
 
-    std::shared_ptr<Trapezoidal_Y_Node> top_y_node = std::make_shared<Trapezoidal_Y_Node>(
+    std::shared_ptr<Trapezoidal_Y_Node> top_y_node = make_hooked_shared<Trapezoidal_Y_Node>(
         queried_top_point,
         std::move(x_node),
         std::move(top_trapezoid));
 
-    std::shared_ptr<Trapezoidal_Y_Node> bottom_y_node = std::make_shared<Trapezoidal_Y_Node>(
+    std::shared_ptr<Trapezoidal_Y_Node> bottom_y_node = make_hooked_shared<Trapezoidal_Y_Node>(
         queried_bottom_point,
         std::move(bottom_trapezoid),
         std::move(top_y_node));
@@ -193,13 +212,13 @@ void Trapezoidal_Map::add_fully_embedded_segment(Trapezoidal_Leaf_Node* current_
 
 void Trapezoidal_Map::add_fully_embedded_segment_with_both_endpoints_overlapping(Trapezoidal_Leaf_Node* current_trapezoid, const Segment& segment)
 {
-    std::shared_ptr<Trapezoidal_Leaf_Node> left_trapezoid = std::make_shared<Trapezoidal_Leaf_Node>(
+    std::shared_ptr<Trapezoidal_Leaf_Node> left_trapezoid = make_hooked_shared<Trapezoidal_Leaf_Node>(
         current_trapezoid->left_segment,    //Left border
         &segment,                           //Right border
         current_trapezoid->bottom_point,    //Bottom point
         current_trapezoid->top_point);      //Top point
 
-    std::shared_ptr<Trapezoidal_Leaf_Node> right_trapezoid = std::make_shared<Trapezoidal_Leaf_Node>(
+    std::shared_ptr<Trapezoidal_Leaf_Node> right_trapezoid = make_hooked_shared<Trapezoidal_Leaf_Node>(
         &segment,                           //Left border
         current_trapezoid->right_segment,   //Right border
         current_trapezoid->bottom_point,    //Bottom point
@@ -251,7 +270,7 @@ void Trapezoidal_Map::add_fully_embedded_segment_with_both_endpoints_overlapping
     }
 
     //Segment node with left and right leafs
-    std::shared_ptr<Trapezoidal_X_Node> x_node = std::make_shared<Trapezoidal_X_Node>(
+    std::shared_ptr<Trapezoidal_X_Node> x_node = make_hooked_shared<Trapezoidal_X_Node>(
         &segment,
         std::move(left_trapezoid),
         std::move(right_trapezoid));
@@ -262,19 +281,19 @@ void Trapezoidal_Map::add_fully_embedded_segment_with_both_endpoints_overlapping
 
 void Trapezoidal_Map::add_fully_embedded_segment_with_top_endpoint_overlapping(Trapezoidal_Leaf_Node* current_trapezoid, const Segment& segment)
 {
-    std::shared_ptr<Trapezoidal_Leaf_Node> left_trapezoid = std::make_shared<Trapezoidal_Leaf_Node>(
+    std::shared_ptr<Trapezoidal_Leaf_Node> left_trapezoid = make_hooked_shared<Trapezoidal_Leaf_Node>(
         current_trapezoid->left_segment,    //Left border
         &segment,                           //Right border
         segment.get_bottom_point(),         //Bottom point
         current_trapezoid->top_point);      //Top point
 
-    std::shared_ptr<Trapezoidal_Leaf_Node> right_trapezoid = std::make_shared<Trapezoidal_Leaf_Node>(
+    std::shared_ptr<Trapezoidal_Leaf_Node> right_trapezoid = make_hooked_shared<Trapezoidal_Leaf_Node>(
         &segment,                           //Left border
         current_trapezoid->right_segment,   //Right border
         segment.get_bottom_point(),         //Bottom point
         current_trapezoid->top_point);      //Top point
 
-    std::shared_ptr<Trapezoidal_Leaf_Node> bottom_trapezoid = std::make_shared<Trapezoidal_Leaf_Node>(
+    std::shared_ptr<Trapezoidal_Leaf_Node> bottom_trapezoid = make_hooked_shared<Trapezoidal_Leaf_Node>(
         current_trapezoid->left_segment,    //Left border
         current_trapezoid->right_segment,   //Right border
         current_trapezoid->bottom_point,    //Bottom point
@@ -321,12 +340,12 @@ void Trapezoidal_Map::add_fully_embedded_segment_with_top_endpoint_overlapping(T
     }
 
     //Segment node with left and right leafs
-    std::shared_ptr<Trapezoidal_X_Node> x_node = std::make_shared<Trapezoidal_X_Node>(
+    std::shared_ptr<Trapezoidal_X_Node> x_node = make_hooked_shared<Trapezoidal_X_Node>(
         &segment,
         std::move(left_trapezoid),
         std::move(right_trapezoid));
 
-    std::shared_ptr<Trapezoidal_Y_Node> bottom_y_node = std::make_shared<Trapezoidal_Y_Node>(
+    std::shared_ptr<Trapezoidal_Y_Node> bottom_y_node = make_hooked_shared<Trapezoidal_Y_Node>(
         segment.get_bottom_point(),
         std::move(bottom_trapezoid),
         std::move(x_node));
@@ -337,19 +356,19 @@ void Trapezoidal_Map::add_fully_embedded_segment_with_top_endpoint_overlapping(T
 
 void Trapezoidal_Map::add_fully_embedded_segment_with_bottom_endpoint_overlapping(Trapezoidal_Leaf_Node* current_trapezoid, const Segment& segment)
 {
-    std::shared_ptr<Trapezoidal_Leaf_Node> left_trapezoid = std::make_shared<Trapezoidal_Leaf_Node>(
+    std::shared_ptr<Trapezoidal_Leaf_Node> left_trapezoid = make_hooked_shared<Trapezoidal_Leaf_Node>(
         current_trapezoid->left_segment,    //Left border
         &segment,                           //Right border
         current_trapezoid->bottom_point,    //Bottom point
         segment.get_top_point());           //Top point
 
-    std::shared_ptr<Trapezoidal_Leaf_Node> right_trapezoid = std::make_shared<Trapezoidal_Leaf_Node>(
+    std::shared_ptr<Trapezoidal_Leaf_Node> right_trapezoid = make_hooked_shared<Trapezoidal_Leaf_Node>(
         &segment,                           //Left border
         current_trapezoid->right_segment,   //Right border
         current_trapezoid->bottom_point,    //Bottom point
         segment.get_top_point());           //Top point
 
-    std::shared_ptr<Trapezoidal_Leaf_Node> top_trapezoid = std::make_shared<Trapezoidal_Leaf_Node>(
+    std::shared_ptr<Trapezoidal_Leaf_Node> top_trapezoid = make_hooked_shared<Trapezoidal_Leaf_Node>(
         current_trapezoid->left_segment,    //Left border
         current_trapezoid->right_segment,   //Right border
         segment.get_top_point(),            //Bottom point
@@ -396,12 +415,12 @@ void Trapezoidal_Map::add_fully_embedded_segment_with_bottom_endpoint_overlappin
     }
 
     //Segment node with left and right leafs
-    std::shared_ptr<Trapezoidal_X_Node> x_node = std::make_shared<Trapezoidal_X_Node>(
+    std::shared_ptr<Trapezoidal_X_Node> x_node = make_hooked_shared<Trapezoidal_X_Node>(
         &segment,
         std::move(left_trapezoid),
         std::move(right_trapezoid));
 
-    std::shared_ptr<Trapezoidal_Y_Node> top_y_node = std::make_shared<Trapezoidal_Y_Node>(
+    std::shared_ptr<Trapezoidal_Y_Node> top_y_node = make_hooked_shared<Trapezoidal_Y_Node>(
         segment.get_top_point(),
         std::move(x_node),
         std::move(top_trapezoid));
@@ -410,12 +429,12 @@ void Trapezoidal_Map::add_fully_embedded_segment_with_bottom_endpoint_overlappin
     replace_leaf_node_with_subgraph(current_trapezoid, top_y_node);
 }
 
-void Trapezoidal_Map::add_overlapping_segment(const std::vector<Trapezoidal_Leaf_Node*>& overlapping_trapezoids, const Segment& segment)
+void Trapezoidal_Map::add_overlapping_segment(const Hooked_Vector<Trapezoidal_Leaf_Node*>& overlapping_trapezoids, const Segment& segment)
 {
-    std::vector<Trapezoidal_Leaf_Node*>::const_iterator current = overlapping_trapezoids.begin();
-    std::vector<Trapezoidal_Leaf_Node*>::const_iterator end = overlapping_trapezoids.end();
+    Hooked_Vector<Trapezoidal_Leaf_Node*>::const_iterator current = overlapping_trapezoids.begin();
+    Hooked_Vector<Trapezoidal_Leaf_Node*>::const_iterator end = overlapping_trapezoids.end();
 
-    std::vector<std::shared_ptr<Trapezoidal_Internal_Node>> new_subgraphs;
+    Hooked_Vector<std::shared_ptr<Trapezoidal_Internal_Node>> new_subgraphs;
 
     std::shared_ptr<Trapezoidal_Leaf_Node> left_trapezoid;
     std::shared_ptr<Trapezoidal_Leaf_Node> right_trapezoid;
@@ -424,19 +443,19 @@ void Trapezoidal_Map::add_overlapping_segment(const std::vector<Trapezoidal_Leaf
     Trapezoidal_Leaf_Node* old_bottom_trapezoid = *current;
     if (*old_bottom_trapezoid->bottom_point != *segment.get_bottom_point())
     {
-        left_trapezoid = std::make_shared<Trapezoidal_Leaf_Node>(
+        left_trapezoid = make_hooked_shared<Trapezoidal_Leaf_Node>(
             old_bottom_trapezoid->left_segment,  //Left border
             &segment,                            //Right border
             segment.get_bottom_point(),          //Bottom point
             nullptr);                            //Top point
 
-        right_trapezoid = std::make_shared<Trapezoidal_Leaf_Node>(
+        right_trapezoid = make_hooked_shared<Trapezoidal_Leaf_Node>(
             &segment,                            //Left border
             old_bottom_trapezoid->right_segment, //Right border
             segment.get_bottom_point(),          //Bottom point
             nullptr);                            //Top point
 
-        std::shared_ptr<Trapezoidal_Leaf_Node> bottom_trapezoid = std::make_shared<Trapezoidal_Leaf_Node>(
+        std::shared_ptr<Trapezoidal_Leaf_Node> bottom_trapezoid = make_hooked_shared<Trapezoidal_Leaf_Node>(
             old_bottom_trapezoid->left_segment,  //Left border
             old_bottom_trapezoid->right_segment, //Right border
             old_bottom_trapezoid->bottom_point,  //Bottom point
@@ -461,9 +480,9 @@ void Trapezoidal_Map::add_overlapping_segment(const std::vector<Trapezoidal_Leaf
         }
 
         //Construct subgraph with the y_node of the bottom point as the root node
-        std::shared_ptr<Trapezoidal_X_Node> x_node = std::make_shared<Trapezoidal_X_Node>(&segment, left_trapezoid, right_trapezoid);
+        std::shared_ptr<Trapezoidal_X_Node> x_node = make_hooked_shared<Trapezoidal_X_Node>(&segment, left_trapezoid, right_trapezoid);
 
-        std::shared_ptr<Trapezoidal_Y_Node> bottom_y_node = std::make_shared<Trapezoidal_Y_Node>(
+        std::shared_ptr<Trapezoidal_Y_Node> bottom_y_node = make_hooked_shared<Trapezoidal_Y_Node>(
             segment.get_bottom_point(),
             bottom_trapezoid,
             x_node);
@@ -473,7 +492,7 @@ void Trapezoidal_Map::add_overlapping_segment(const std::vector<Trapezoidal_Leaf
     else
     {
         //Bottom points overlap, just split in two
-        left_trapezoid = std::make_shared<Trapezoidal_Leaf_Node>(
+        left_trapezoid = make_hooked_shared<Trapezoidal_Leaf_Node>(
             old_bottom_trapezoid->left_segment,  //Left border
             &segment,                            //Right border
             old_bottom_trapezoid->bottom_point,  //Bottom point
@@ -483,7 +502,7 @@ void Trapezoidal_Map::add_overlapping_segment(const std::vector<Trapezoidal_Leaf
             nullptr,                             //Top left
             nullptr);                            //Top right
 
-        right_trapezoid = std::make_shared<Trapezoidal_Leaf_Node>(
+        right_trapezoid = make_hooked_shared<Trapezoidal_Leaf_Node>(
             &segment,                            //Left border
             old_bottom_trapezoid->right_segment, //Right border
             old_bottom_trapezoid->bottom_point,  //Bottom point
@@ -516,7 +535,7 @@ void Trapezoidal_Map::add_overlapping_segment(const std::vector<Trapezoidal_Leaf
         }
 
         //Construct subgraph with the x_node of the segment as root node
-        std::shared_ptr<Trapezoidal_X_Node> x_node = std::make_shared<Trapezoidal_X_Node>(
+        std::shared_ptr<Trapezoidal_X_Node> x_node = make_hooked_shared<Trapezoidal_X_Node>(
             &segment,
             left_trapezoid,
             right_trapezoid);
@@ -544,7 +563,7 @@ void Trapezoidal_Map::add_overlapping_segment(const std::vector<Trapezoidal_Leaf
         if (point_right_of_segment(segment, *current_trapezoid->bottom_point))
         {
             //Create new right trapezoid, left extends
-            right_trapezoid = std::make_shared<Trapezoidal_Leaf_Node>(
+            right_trapezoid = make_hooked_shared<Trapezoidal_Leaf_Node>(
                 &segment,                            //Left border
                 current_trapezoid->right_segment,    //Right border
                 current_trapezoid->bottom_point,     //Bottom point
@@ -578,7 +597,7 @@ void Trapezoidal_Map::add_overlapping_segment(const std::vector<Trapezoidal_Leaf
             prev_right_trapezoid->top_right = prev_top_right;
 
             //Create the x_node and replace the leaf node with the new subgraph
-            std::shared_ptr<Trapezoidal_X_Node> x_node = std::make_shared<Trapezoidal_X_Node>(
+            std::shared_ptr<Trapezoidal_X_Node> x_node = make_hooked_shared<Trapezoidal_X_Node>(
                 &segment,
                 prev_left_trapezoid,
                 right_trapezoid);
@@ -590,7 +609,7 @@ void Trapezoidal_Map::add_overlapping_segment(const std::vector<Trapezoidal_Leaf
         else
         {
             //Create new left trapezoid, right extends
-            left_trapezoid = std::make_shared<Trapezoidal_Leaf_Node>(
+            left_trapezoid = make_hooked_shared<Trapezoidal_Leaf_Node>(
                 current_trapezoid->left_segment,     //Left border
                 &segment,                            //Right border
                 current_trapezoid->bottom_point,     //Bottom point
@@ -624,7 +643,7 @@ void Trapezoidal_Map::add_overlapping_segment(const std::vector<Trapezoidal_Leaf
             prev_left_trapezoid->top_right = left_trapezoid.get();
 
             //Create the x_node and replace the leaf node with the new subgraph
-            std::shared_ptr<Trapezoidal_X_Node> x_node = std::make_shared<Trapezoidal_X_Node>(
+            std::shared_ptr<Trapezoidal_X_Node> x_node = make_hooked_shared<Trapezoidal_X_Node>(
                 &segment,
                 left_trapezoid,
                 prev_right_trapezoid);
@@ -653,7 +672,7 @@ void Trapezoidal_Map::add_overlapping_segment(const std::vector<Trapezoidal_Leaf
     //Check if top points overlap, skip top_trapezoid if true
     if (*old_top_trapezoid->top_point != *segment.get_top_point())
     {
-        top_trapezoid = std::make_shared<Trapezoidal_Leaf_Node>(
+        top_trapezoid = make_hooked_shared<Trapezoidal_Leaf_Node>(
             old_top_trapezoid->left_segment,  //Left border
             old_top_trapezoid->right_segment, //Right border
             segment.get_top_point(),          //Bottom point
@@ -685,7 +704,7 @@ void Trapezoidal_Map::add_overlapping_segment(const std::vector<Trapezoidal_Leaf
     if (point_right_of_segment(segment, *old_top_trapezoid->bottom_point))
     {
         //Create new right trapezoid
-        right_trapezoid = std::make_shared<Trapezoidal_Leaf_Node>(
+        right_trapezoid = make_hooked_shared<Trapezoidal_Leaf_Node>(
             &segment,                         //Left border
             old_top_trapezoid->right_segment, //Right border
             old_top_trapezoid->bottom_point,  //Bottom point
@@ -731,7 +750,7 @@ void Trapezoidal_Map::add_overlapping_segment(const std::vector<Trapezoidal_Leaf
     else
     {
         //Create new left trapezoid, right extends
-        left_trapezoid = std::make_shared<Trapezoidal_Leaf_Node>(
+        left_trapezoid = make_hooked_shared<Trapezoidal_Leaf_Node>(
             old_top_trapezoid->left_segment, //Left border
             &segment,                        //Right border
             old_top_trapezoid->bottom_point, //Bottom point
@@ -781,12 +800,12 @@ void Trapezoidal_Map::add_overlapping_segment(const std::vector<Trapezoidal_Leaf
         top_trapezoid->bottom_right = right_trapezoid.get();
 
         //Create the final subgraph for the top trapezoids with the y_node of the top point as the root node
-        std::shared_ptr<Trapezoidal_X_Node> top_x_node = std::make_shared<Trapezoidal_X_Node>(
+        std::shared_ptr<Trapezoidal_X_Node> top_x_node = make_hooked_shared<Trapezoidal_X_Node>(
             &segment,
             left_trapezoid,
             right_trapezoid);
 
-        std::shared_ptr<Trapezoidal_Y_Node> top_y_node = std::make_shared<Trapezoidal_Y_Node>(
+        std::shared_ptr<Trapezoidal_Y_Node> top_y_node = make_hooked_shared<Trapezoidal_Y_Node>(
             segment.get_top_point(),
             std::move(top_x_node),
             std::move(top_trapezoid));
@@ -807,7 +826,7 @@ void Trapezoidal_Map::add_overlapping_segment(const std::vector<Trapezoidal_Leaf
         }
 
         //Create the final subgraph for the top trapezoids with the x_node of the segment as the root node
-        std::shared_ptr<Trapezoidal_X_Node> top_x_node = std::make_shared<Trapezoidal_X_Node>(
+        std::shared_ptr<Trapezoidal_X_Node> top_x_node = make_hooked_shared<Trapezoidal_X_Node>(
             &segment,
             left_trapezoid,
             right_trapezoid);
@@ -827,11 +846,11 @@ void Trapezoidal_Map::add_overlapping_segment(const std::vector<Trapezoidal_Leaf
 
 //Follow along the segment from bottom to top registering the trapezoids it intersects
 //Returns the intersected trapezoids ordered from bottom to top
-std::vector<Trapezoidal_Leaf_Node*> Trapezoidal_Map::follow_segment(const Segment& query_segment)
+Hooked_Vector<Trapezoidal_Leaf_Node*> Trapezoidal_Map::follow_segment(const Segment& query_segment)
 {
     assert(query_segment.start.y <= query_segment.end.y);
 
-    std::vector<Trapezoidal_Leaf_Node*> intersecting_trapezoids;
+    Hooked_Vector<Trapezoidal_Leaf_Node*> intersecting_trapezoids;
 
     //Find the trapezoid the starting point is inside of
     Trapezoidal_Leaf_Node* starting_trapezoid = root->query_start_point(query_segment);
@@ -839,7 +858,7 @@ std::vector<Trapezoidal_Leaf_Node*> Trapezoidal_Map::follow_segment(const Segmen
 
     //Follow along the segment to find all intersecting trapezoids
     const Vec2* top_point = query_segment.get_top_point();
-    while (top_point->y > intersecting_trapezoids.back()->top_point->y)
+    while (top_point->y.get_value() > intersecting_trapezoids.back()->top_point->y.get_value())
     {
         if (point_right_of_segment(query_segment, *intersecting_trapezoids.back()->top_point))
         {
@@ -1029,7 +1048,7 @@ Trapezoidal_Leaf_Node* Trapezoidal_X_Node::query_start_point(const Segment& quer
 Trapezoidal_Leaf_Node* Trapezoidal_Y_Node::query_start_point(const Segment& query_segment)
 {
     //Test if query point lies above or below the Y-nodes point
-    if (query_segment.start.y >= point->y)
+    if (query_segment.start.y.get_value() >= point->y.get_value())
     {
         return above->query_start_point(query_segment);
     }
@@ -1042,10 +1061,45 @@ Trapezoidal_Leaf_Node* Trapezoidal_Y_Node::query_start_point(const Segment& quer
 void Trapezoidal_Map::trace_left_right(const Vec2& point, const bool prefer_top, const Segment*& left_segment, const Segment*& right_segment) const
 {
     root->trace_left_right(point, prefer_top, left_segment, right_segment);
+
+    TRAJECTORY_HOTSPOTS_COUNT(statistics->end_map_query());
+}
+
+//Counts the nodes reachable from the root, nodes with multiple parents are counted once
+size_t Trapezoidal_Map::get_node_count() const
+{
+    std::unordered_set<const Trapezoidal_Node*> visited;
+    std::vector<const Trapezoidal_Node*> stack = { root.get() };
+
+    while (!stack.empty())
+    {
+        const Trapezoidal_Node* node = stack.back();
+        stack.pop_back();
+
+        if (node == nullptr || !visited.insert(node).second)
+        {
+            continue;
+        }
+
+        if (const Trapezoidal_X_Node* x_node = dynamic_cast<const Trapezoidal_X_Node*>(node))
+        {
+            stack.push_back(x_node->left.get());
+            stack.push_back(x_node->right.get());
+        }
+        else if (const Trapezoidal_Y_Node* y_node = dynamic_cast<const Trapezoidal_Y_Node*>(node))
+        {
+            stack.push_back(y_node->below.get());
+            stack.push_back(y_node->above.get());
+        }
+    }
+
+    return visited.size();
 }
 
 void Trapezoidal_X_Node::trace_left_right(const Vec2& point, const bool prefer_top, const Segment*& left_segment, const Segment*& right_segment) const
 {
+    TRAJECTORY_HOTSPOTS_COUNT(statistics->current_map_query_depth++);
+
     //This works based on the assumption that a point query reaching a x-node will always lay left, right, or on the segment, never above or below.
     Float point_direction = segment->point_direction(point);
 
@@ -1066,8 +1120,11 @@ void Trapezoidal_X_Node::trace_left_right(const Vec2& point, const bool prefer_t
         const Float orientation = Vec2(1.f, 0.f).cross(segment_vec);
         const bool upwards_segment = orientation >= 0.f;
 
-        assert((*segment->get_top_point() == point) != prefer_top);
-        assert((*segment->get_bottom_point() == point) != !prefer_top);
+        //Points inside the segment can be traced either way, but the y-nodes send a point exactly at an endpoint
+        //away from the segment, so tracing above the top point or below the bottom point never reaches it.
+        //Nearly equal points can still reach it from either side, only the exact endpoints are checked.
+        assert(!(point.x.get_value() == segment->get_top_point()->x.get_value() && point.y.get_value() == segment->get_top_point()->y.get_value()) || !prefer_top);
+        assert(!(point.x.get_value() == segment->get_bottom_point()->x.get_value() && point.y.get_value() == segment->get_bottom_point()->y.get_value()) || prefer_top);
 
         if (upwards_segment == prefer_top)
         {
@@ -1082,29 +1139,27 @@ void Trapezoidal_X_Node::trace_left_right(const Vec2& point, const bool prefer_t
 
 void Trapezoidal_Y_Node::trace_left_right(const Vec2& point, const bool prefer_top, const Segment*& left_segment, const Segment*& right_segment) const
 {
-    if (point.y > this->point->y)
+    TRAJECTORY_HOTSPOTS_COUNT(statistics->current_map_query_depth++);
+
+    //The ray is traced just above or below the point, so a point at the height of this node's point,
+    //whether it is the same point or another point on the same horizontal line, goes to the side the query prefers.
+    //Choosing one side for points on the line made the result depend on the order the map was built in.
+    //The heights are compared exactly, nearly equal heights would make the side depend on the node.
+    if (point.y.get_value() > this->point->y.get_value())
     {
         above->trace_left_right(point, prefer_top, left_segment, right_segment);
     }
-    else if (point.y < this->point->y)
+    else if (point.y.get_value() < this->point->y.get_value())
     {
         below->trace_left_right(point, prefer_top, left_segment, right_segment);
     }
-    else if (point == *this->point)
+    else if (prefer_top)
     {
-        if (prefer_top)
-        {
-            above->trace_left_right(point, prefer_top, left_segment, right_segment);
-        }
-        else
-        {
-            below->trace_left_right(point, prefer_top, left_segment, right_segment);
-        }
+        above->trace_left_right(point, prefer_top, left_segment, right_segment);
     }
     else
     {
-        //Point lies on the same horizontal line, arbitrarily choose above
-        above->trace_left_right(point, prefer_top, left_segment, right_segment);
+        below->trace_left_right(point, prefer_top, left_segment, right_segment);
     }
 }
 
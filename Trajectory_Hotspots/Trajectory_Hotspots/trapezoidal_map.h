@@ -15,9 +15,8 @@ public:
 
     virtual void trace_left_right(const Vec2& point, const bool prefer_top, const Segment*& left_segment, const Segment*& right_segment) const = 0;
 
-    std::vector<Trapezoidal_Internal_Node*> parents;
+    Hooked_Vector<Trapezoidal_Internal_Node*> parents;
 
-    friend class Trapezoidal_Node;
     friend class Trapezoidal_Leaf_Node;
     friend class Trapezoidal_X_Node;
     friend class Trapezoidal_Y_Node;
@@ -150,6 +149,9 @@ public:
 
     Trapezoidal_Map(const std::vector<Segment>& trajectory_segments, const unsigned int seed = 0, const bool randomized_construction = true);
 
+    //Same as above, for the projected segments that the queries allocate through the allocation hook
+    Trapezoidal_Map(const Hooked_Vector<Segment>& trajectory_segments, const unsigned int seed = 0, const bool randomized_construction = true);
+
 
     Trapezoidal_Leaf_Node* query_point(const Vec2& point);
 
@@ -158,13 +160,21 @@ public:
     void add_fully_embedded_segment_with_both_endpoints_overlapping(Trapezoidal_Leaf_Node* current_trapezoid, const Segment& segment);
     void add_fully_embedded_segment_with_top_endpoint_overlapping(Trapezoidal_Leaf_Node* current_trapezoid, const Segment& segment);
     void add_fully_embedded_segment_with_bottom_endpoint_overlapping(Trapezoidal_Leaf_Node* current_trapezoid, const Segment& segment);
-    void add_overlapping_segment(const std::vector<Trapezoidal_Leaf_Node*>& overlapping_trapezoids, const Segment& segment);
+    void add_overlapping_segment(const Hooked_Vector<Trapezoidal_Leaf_Node*>& overlapping_trapezoids, const Segment& segment);
 
     void trace_left_right(const Vec2& point, const bool prefer_top, const Segment*& left_segment, const Segment*& right_segment) const;
 
+    //Number of nodes in the search structure, walks the whole structure
+    size_t get_node_count() const;
+
 private:
 
-    std::vector<Trapezoidal_Leaf_Node*> follow_segment(const Segment& query_segment);
+    void initialize_bounding_box();
+
+    //Adds the segments in a random order, or in the given order when the construction is not randomized
+    void add_segments(const Segment* segments, const size_t segment_count, const unsigned int seed, const bool randomized_construction);
+
+    Hooked_Vector<Trapezoidal_Leaf_Node*> follow_segment(const Segment& query_segment);
 
     void replace_leaf_node_with_subgraph(Trapezoidal_Leaf_Node* old_trapezoid, std::shared_ptr<Trapezoidal_Internal_Node> new_subgraph);
 
@@ -0,0 +1,62 @@
+# Profile guided optimization flags for all targets, set by TRAJECTORY_HOTSPOTS_PGO.
+# GENERATE instruments the build, running the benchmarks then writes profiles to TRAJECTORY_HOTSPOTS_PGO_DIRECTORY.
+# USE optimizes with those profiles. GCC finds them by object file path, so both stages have to use the same build directory,
+# cmake/pgo_build.cmake takes care of that.
+
+string(TOUPPER "${TRAJECTORY_HOTSPOTS_PGO}" pgo_stage)
+
+if(pgo_stage STREQUAL "OFF" OR pgo_stage STREQUAL "")
+    return()
+endif()
+
+if(NOT pgo_stage STREQUAL "GENERATE" AND NOT pgo_stage STREQUAL "USE")
+    message(FATAL_ERROR "TRAJECTORY_HOTSPOTS_PGO is OFF, GENERATE or USE, not ${TRAJECTORY_HOTSPOTS_PGO}")
+endif()
+
+set(pgo_directory "${TRAJECTORY_HOTSPOTS_PGO_DIRECTORY}")
+
+if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+    if(pgo_stage STREQUAL "GENERATE")
+        set(pgo_flags "-fprofile-generate=${pgo_directory}" -fprofile-update=prefer-atomic)
+    else()
+        # Code the training doesn't reach is still optimized for speed, and files without a profile are not a warning
+        set(pgo_flags "-fprofile-use=${pgo_directory}" -fprofile-partial-training -Wno-missing-profile)
+    endif()
+elseif(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+    set(pgo_profile "${pgo_directory}/merged.profdata")
+
+    if(pgo_stage STREQUAL "GENERATE")
+        set(pgo_flags "-fprofile-instr-generate=${pgo_directory}/%m.profraw")
+    else()
+        # The raw profiles of the training run are merged into the one the compiler reads
+        get_filename_component(compiler_directory "${CMAKE_CXX_COMPILER}" DIRECTORY)
+        find_program(LLVM_PROFDATA NAMES llvm-profdata HINTS "${compiler_directory}")
+
+        file(GLOB raw_profiles "${pgo_directory}/*.profraw")
+
+        if(raw_profiles)
+            if(NOT LLVM_PROFDATA)
+                message(FATAL_ERROR "llvm-profdata is needed to merge the profiles in ${pgo_directory}")
+            endif()
+
+            execute_process(COMMAND "${LLVM_PROFDATA}" merge "-output=${pgo_profile}" ${raw_profiles} RESULT_VARIABLE merge_result)
+
+            if(NOT merge_result EQUAL 0)
+                message(FATAL_ERROR "Merging the profiles in ${pgo_directory} failed")
+            endif()
+        endif()
+
+        set(pgo_flags "-fprofile-instr-use=${pgo_profile}" -Wno-profile-instr-unprofiled -Wno-profile-instr-out-of-date)
+    endif()
+else()
+    message(FATAL_ERROR "Profile guided optimization is set up for GCC and Clang, build with Trajectory_Hotspots.sln for MSVC")
+endif()
+
+if(pgo_stage STREQUAL "USE" AND NOT EXISTS "${pgo_directory}")
+    message(FATAL_ERROR "No profiles in ${pgo_directory}, build with TRAJECTORY_HOTSPOTS_PGO=GENERATE and run the benchmarks first")
+endif()
+
+message(STATUS "Profile guided optimization: ${pgo_stage} with ${pgo_directory}")
+
+add_compile_options(${pgo_flags})
+add_link_options(${pgo_flags})
@@ -0,0 +1,52 @@
+# Two stage profile guided build:
+#
+#   cmake -DBUILD_DIRECTORY=build-pgo -P cmake/pgo_build.cmake
+#
+# Builds the instrumented benchmarks, trains them on the synthetic trajectories of the scaling benchmark,
+# and rebuilds everything in the same directory with the profiles.
+# Optional: -DCMAKE_CXX_COMPILER=clang++, -DTRAINING_ARGUMENTS="scaling;--max-vertices=20000"
+
+cmake_minimum_required(VERSION 3.16)
+
+get_filename_component(source_directory "${CMAKE_CURRENT_LIST_DIR}/.." ABSOLUTE)
+
+if(NOT BUILD_DIRECTORY)
+    set(BUILD_DIRECTORY "${source_directory}/build-pgo")
+endif()
+get_filename_component(build_directory "${BUILD_DIRECTORY}" ABSOLUTE)
+set(pgo_directory "${build_directory}/pgo")
+
+# Every shape and query, on sizes where all of them finish in a few seconds
+if(NOT TRAINING_ARGUMENTS)
+    set(TRAINING_ARGUMENTS scaling --min-vertices=1000 --max-vertices=20000 --steps-per-decade=3 --max-seconds=2 --min-time=0.05)
+endif()
+
+set(configure_arguments -DCMAKE_BUILD_TYPE=Release "-DTRAJECTORY_HOTSPOTS_PGO_DIRECTORY=${pgo_directory}")
+if(CMAKE_CXX_COMPILER)
+    list(APPEND configure_arguments "-DCMAKE_CXX_COMPILER=${CMAKE_CXX_COMPILER}")
+endif()
+
+function(run_step description)
+    message(STATUS "${description}")
+    execute_process(COMMAND ${ARGN} RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "${description} failed")
+    endif()
+endfunction()
+
+file(REMOVE_RECURSE "${pgo_directory}")
+
+run_step("Configuring the instrumented build" "${CMAKE_COMMAND}" -S "${source_directory}" -B "${build_directory}" ${configure_arguments} -DTRAJECTORY_HOTSPOTS_PGO=GENERATE)
+run_step("Building the instrumented build" "${CMAKE_COMMAND}" --build "${build_directory}" --config Release --parallel)
+
+set(benchmark "${build_directory}/Benchmark_Trajectory_Hotspots/Benchmark_Trajectory_Hotspots${CMAKE_EXECUTABLE_SUFFIX}")
+if(NOT EXISTS "${benchmark}")
+    message(FATAL_ERROR "The instrumented build has no ${benchmark}")
+endif()
+
+run_step("Training on ${TRAINING_ARGUMENTS}" "${benchmark}" ${TRAINING_ARGUMENTS})
+
+run_step("Configuring the optimized build" "${CMAKE_COMMAND}" -S "${source_directory}" -B "${build_directory}" ${configure_arguments} -DTRAJECTORY_HOTSPOTS_PGO=USE)
+run_step("Building the optimized build" "${CMAKE_COMMAND}" --build "${build_directory}" --config Release --parallel)
+
+message(STATUS "Profile guided build is in ${build_directory}")